@@ -185,7 +185,47 @@ public:
         // Step 5: Create ray with camera position and world space direction
         return Ray(position, world_direction);
     }
-    
+
+    // Project a world space point back to pixel coordinates (inverse of generate_ray)
+    // Returns false if the point is behind the camera; pixel coordinates may fall outside the image
+    //
+    // Mathematical Process:
+    // 1. Express point in camera basis: (d·right, d·camera_up, d·forward) with d = point - position
+    // 2. Perspective divide by forward depth to reach the unit-distance screen plane
+    // 3. Undo FOV/aspect scaling to NDC, then map NDC to pixel coordinates
+    bool project_to_pixel(const Point3& world_point, int image_width, int image_height,
+                          float& pixel_x, float& pixel_y) const {
+        Vector3 d = world_point - position;
+        float camera_z = d.dot(forward);
+        if (camera_z <= 1e-6f) {
+            return false;
+        }
+
+        float fov_radians = field_of_view_degrees * M_PI / 180.0f;
+        float fov_scale = std::tan(fov_radians * 0.5f);
+        float ndc_x = (d.dot(right) / camera_z) / (aspect_ratio * fov_scale);
+        float ndc_y = (d.dot(camera_up) / camera_z) / fov_scale;
+
+        pixel_x = (ndc_x + 1.0f) * 0.5f * image_width;
+        pixel_y = (1.0f - ndc_y) * 0.5f * image_height;
+        return true;
+    }
+
+    // Angle subtended by one pixel: spread of the ray cone through a pixel (pinhole camera)
+    // The screen plane at unit distance is 2·tan(fov/2) tall and holds image_height pixels
+    float pixel_spread_angle(int image_height) const {
+        float fov_radians = field_of_view_degrees * M_PI / 180.0f;
+        return 2.0f * std::tan(fov_radians * 0.5f) / image_height;
+    }
+
+    // Move camera rigidly (position and target) by a world space offset, keeping orientation
+    // Used for camera animation in sequence rendering
+    void translate(const Vector3& offset) {
+        position = position + offset;
+        target = target + offset;
+        calculate_camera_basis_vectors();
+    }
+
     // Camera coordinate system calculations
     void calculate_camera_basis_vectors() {
         // Calculate forward vector (from position to target)
@@ -0,0 +1,222 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+// CheckerboardRenderer traces half of the primary rays per frame for preview sequences
+// Educational focus: temporal reconstruction trades exactness for a 2× reduction in rays
+//
+// Checkerboard pattern: pixel (x, y) is traced on frame f when (x + y + f) is even, so the
+// traced set alternates between the "black" and "white" squares on consecutive frames.
+// Every untraced pixel has four traced neighbours (left, right, up, down) in the current frame
+// and was traced itself in the previous frame.
+//
+// Reconstruction of an untraced pixel:
+//   1. Depth hypotheses from traced neighbours: P = eye + dir * |P_neighbour - eye| for each hit
+//      neighbour (nearest first), plus a background hypothesis if any neighbour missed
+//   2. Reprojection: project P into the previous camera (known camera motion) and fetch the
+//      previous frame's sample at that pixel
+//   3. Disocclusion test: accept history only if the previous sample is the same surface
+//      (|P_prev - P| < 5% of distance) or both are background
+//   4. Fallback: average of the traced spatial neighbours when no hypothesis matches history
+//
+// With a static camera every frame after the first reproduces the full render (history holds
+// exactly the pixels traced one frame earlier); with camera motion errors concentrate at
+// disocclusions, where the spatial fallback is used.
+class CheckerboardRenderer {
+public:
+    // Per-frame reconstruction statistics for educational reporting
+    struct FrameStatistics {
+        int frame_index = 0;
+        int total_pixels = 0;
+        int traced_rays = 0;           // Primary rays traced this frame (≈ 50% of pixels)
+        int reprojected_pixels = 0;    // Untraced pixels reconstructed from previous frame
+        int spatial_pixels = 0;        // Untraced pixels reconstructed from spatial neighbours
+        int disoccluded_pixels = 0;    // Subset of spatial pixels where history was rejected
+
+        float ray_fraction() const {
+            return total_pixels > 0 ? static_cast<float>(traced_rays) / total_pixels : 0.0f;
+        }
+
+        void print() const {
+            std::cout << "Checkerboard frame " << frame_index << ": traced " << traced_rays << "/" << total_pixels
+                      << " rays (" << (ray_fraction() * 100.0f) << "%), reprojected " << reprojected_pixels
+                      << ", spatial " << spatial_pixels << " (disoccluded " << disoccluded_pixels << ")" << std::endl;
+        }
+    };
+
+    CheckerboardRenderer(int image_width, int image_height)
+        : width(image_width), height(image_height), frame_index(0),
+          current(static_cast<size_t>(image_width) * image_height),
+          history(static_cast<size_t>(image_width) * image_height) {}
+
+    // Render the next frame of the sequence into a row-major clamped RGB buffer
+    // Camera may differ from the previous frame's camera; its motion drives reprojection
+    FrameStatistics render_frame(const Scene& scene, const Camera& camera, std::vector<Vector3>& pixels) {
+        FrameStatistics stats;
+        stats.frame_index = frame_index;
+        stats.total_pixels = width * height;
+
+        // Pass 1: trace this frame's checkerboard half
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (!is_traced(x, y)) continue;
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                Scene::Intersection hit = scene.intersect(ray, false);
+                Sample& sample = current[index(x, y)];
+                sample.hit = hit.hit;
+                sample.position = hit.hit ? hit.point : Point3();
+                sample.color = hit.hit ? Renderer::shade_direct_lighting(scene, hit, camera.position)
+                                       : Renderer::background_color();
+                stats.traced_rays++;
+            }
+        }
+
+        // Pass 2: reconstruct the other half (reads only traced samples of this frame)
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (is_traced(x, y)) continue;
+                reconstruct_pixel(x, y, camera, stats);
+            }
+        }
+
+        pixels.resize(current.size());
+        for (size_t i = 0; i < current.size(); i++) {
+            pixels[i] = Renderer::clamp_color(current[i].color);
+        }
+
+        // Current frame becomes history for the next one
+        std::swap(current, history);
+        history_camera = camera;
+        frame_index++;
+        return stats;
+    }
+
+    // Forget history (e.g. after a camera cut); next frame uses spatial reconstruction only
+    void reset_history() {
+        history_camera.reset();
+    }
+
+private:
+    // One reconstructed or traced sample: color plus surface position for disocclusion tests
+    struct Sample {
+        Vector3 color;
+        Point3 position;
+        bool hit = false;
+    };
+
+    int width;
+    int height;
+    int frame_index;
+    std::vector<Sample> current;
+    std::vector<Sample> history;
+    std::optional<Camera> history_camera;
+
+    size_t index(int x, int y) const {
+        return static_cast<size_t>(y) * width + x;
+    }
+
+    bool is_traced(int x, int y) const {
+        return ((x + y + frame_index) & 1) == 0;
+    }
+
+    void reconstruct_pixel(int x, int y, const Camera& camera, FrameStatistics& stats) {
+        const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        const Sample* neighbours[4];
+        int neighbour_count = 0;
+        bool any_miss = false;
+        for (const auto& offset : offsets) {
+            int nx = x + offset[0];
+            int ny = y + offset[1];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            neighbours[neighbour_count] = &current[index(nx, ny)];
+            any_miss |= !neighbours[neighbour_count]->hit;
+            neighbour_count++;
+        }
+
+        Sample& sample = current[index(x, y)];
+        Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+
+        // Temporal reprojection: try each neighbour depth (nearest first), then background
+        if (history_camera) {
+            float distances[4];
+            int distance_count = 0;
+            for (int i = 0; i < neighbour_count; i++) {
+                if (neighbours[i]->hit) {
+                    distances[distance_count++] = (neighbours[i]->position - camera.position).length();
+                }
+            }
+            // Insertion sort: at most 4 entries
+            for (int i = 1; i < distance_count; i++) {
+                float distance = distances[i];
+                int j = i - 1;
+                for (; j >= 0 && distances[j] > distance; j--) {
+                    distances[j + 1] = distances[j];
+                }
+                distances[j + 1] = distance;
+            }
+
+            for (int i = 0; i < distance_count; i++) {
+                Point3 estimate = ray.at(distances[i]);
+                const Sample* previous = reproject(estimate);
+                if (previous && previous->hit &&
+                    (previous->position - estimate).length() < 0.05f * distances[i]) {
+                    sample = *previous;
+                    stats.reprojected_pixels++;
+                    return;
+                }
+            }
+            if (any_miss) {
+                // Background lies at infinity: reproject a far point along the ray
+                const Sample* previous = reproject(ray.at(1e4f));
+                if (previous && !previous->hit) {
+                    sample = *previous;
+                    stats.reprojected_pixels++;
+                    return;
+                }
+            }
+            stats.disoccluded_pixels++;
+        }
+
+        // Spatial fallback: average traced neighbours, keep nearest surface for next frame's test
+        Vector3 color_sum(0, 0, 0);
+        const Sample* nearest = nullptr;
+        float nearest_distance = 0.0f;
+        for (int i = 0; i < neighbour_count; i++) {
+            color_sum += neighbours[i]->color;
+            if (neighbours[i]->hit) {
+                float distance = (neighbours[i]->position - camera.position).length();
+                if (!nearest || distance < nearest_distance) {
+                    nearest = neighbours[i];
+                    nearest_distance = distance;
+                }
+            }
+        }
+        sample.color = neighbour_count > 0 ? color_sum * (1.0f / neighbour_count) : Renderer::background_color();
+        sample.hit = nearest != nullptr && !any_miss;
+        sample.position = nearest ? ray.at(nearest_distance) : Point3();
+        stats.spatial_pixels++;
+    }
+
+    // Previous-frame sample at the pixel where world_point appeared, or nullptr if off-screen
+    const Sample* reproject(const Point3& world_point) const {
+        float px, py;
+        if (!history_camera->project_to_pixel(world_point, width, height, px, py)) {
+            return nullptr;
+        }
+        int ix = static_cast<int>(std::lround(px));
+        int iy = static_cast<int>(std::lround(py));
+        if (ix < 0 || ix >= width || iy < 0 || iy >= height) {
+            return nullptr;
+        }
+        return &history[index(ix, iy)];
+    }
+};
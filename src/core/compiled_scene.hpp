@@ -0,0 +1,33 @@
+#pragma once
+#include "vector3.hpp"
+#include "ray.hpp"
+#include "camera.hpp"
+#include <vector>
+
+// CompiledScene declares the interface implemented by translation units emitted by
+// tools/scene_compiler.cpp. A compiled scene bakes one fixed .scene file into C++:
+//   - sphere data as constexpr arrays (constant-folded by the compiler)
+//   - one unrolled intersection block per sphere (no loop, no Sphere objects)
+//   - material constants inlined (Lambert albedo/π, Cook-Torrance α and F0 precomputed)
+//   - a fixed, unrolled light loop with any-hit shadow rays
+// Only the camera remains a runtime parameter, which suits product shots rendered many
+// times with different views. Results must match Renderer::trace_primary on the same scene.
+namespace CompiledScene {
+
+    // Summary of the baked scene for reporting
+    struct Info {
+        const char* source_file;  // .scene file the translation unit was generated from
+        int sphere_count;
+        int material_count;
+        int light_count;
+    };
+
+    Info info();
+
+    // Trace one primary ray: background color on miss, direct lighting on hit
+    // eye: ray origin used for the view direction (camera position for primary rays)
+    Vector3 trace_primary(const Ray& ray, const Point3& eye);
+
+    // Render a full frame (row-major, clamped linear RGB) for the given camera
+    void render_frame(const Camera& camera, int width, int height, std::vector<Vector3>& pixels);
+}
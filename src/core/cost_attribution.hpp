@@ -0,0 +1,200 @@
+#pragma once
+#include "scene.hpp"
+#include "../lights/light_base.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// CostAttribution splits shading cost by material and by light, to show which asset makes a scene slow
+// Educational focus: attributing time to the scene data that causes it, not only to render phases
+//
+// Per material index (Scene::materials):
+//   shading events     surface hits shaded with direct lighting
+//   BRDF evaluations   one per unoccluded light at each hit, plus one per path tracing bounce
+//   shading time       direct lighting at those hits, including their light samples and shadow rays
+// Hits on level-of-detail proxies (--lod-error) have no primitive and count in a separate
+// "LOD proxies" entry, since they stand for whole clusters of spheres.
+// Per light index (Scene::lights):
+//   shadow rays cast and occluded, and the time of the light sample (illuminate) plus its shadow ray
+// The two views overlap: a shadow ray's time counts for its light and for the material at the hit.
+//
+// Every render thread owns one Counters (plain counters, nothing shared in the shading loop) and the
+// renderer merges them after its threads have joined. Without attribution no Counters exists and
+// the shading code reads no clocks; with it, two clock reads per light sample add some overhead.
+class CostAttribution {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct MaterialCost {
+        long long shading_events = 0;
+        long long brdf_evaluations = 0;
+        double shading_ms = 0.0;
+    };
+
+    struct LightCost {
+        long long shadow_rays = 0;
+        long long occluded = 0;
+        double light_ms = 0.0;           // illuminate() + shadow ray
+    };
+
+    // Material index of hits on LOD proxies
+    static constexpr int lod_proxy = -1;
+
+    // Counters of one thread, indexed like Scene::materials and Scene::lights
+    struct Counters {
+        std::vector<MaterialCost> materials;
+        MaterialCost lod_proxies;
+        std::vector<LightCost> lights;
+
+        Counters() = default;
+        explicit Counters(const Scene& scene) : materials(scene.materials.size()), lights(scene.lights.size()) {}
+
+        void record_shading(int material, Clock::time_point start) {
+            MaterialCost* cost = material_cost(material);
+            if (!cost) return;
+            cost->shading_events++;
+            cost->shading_ms += elapsed_ms(start);
+        }
+
+        void record_brdf_evaluation(int material) {
+            MaterialCost* cost = material_cost(material);
+            if (!cost) return;
+            cost->brdf_evaluations++;
+        }
+
+        void record_shadow_ray(size_t light, bool occluded, Clock::time_point start) {
+            if (light >= lights.size()) return;
+            lights[light].shadow_rays++;
+            lights[light].occluded += occluded ? 1 : 0;
+            lights[light].light_ms += elapsed_ms(start);
+        }
+
+        // Add another thread's counters
+        void merge(const Counters& other) {
+            materials.resize(std::max(materials.size(), other.materials.size()));
+            lights.resize(std::max(lights.size(), other.lights.size()));
+            for (size_t i = 0; i < other.materials.size(); i++) {
+                add(materials[i], other.materials[i]);
+            }
+            add(lod_proxies, other.lod_proxies);
+            for (size_t i = 0; i < other.lights.size(); i++) {
+                lights[i].shadow_rays += other.lights[i].shadow_rays;
+                lights[i].occluded += other.lights[i].occluded;
+                lights[i].light_ms += other.lights[i].light_ms;
+            }
+        }
+
+    private:
+        // Entry of a material index (or lod_proxy), nullptr if unknown
+        MaterialCost* material_cost(int material) {
+            if (material == lod_proxy) return &lod_proxies;
+            if (material < 0 || material >= static_cast<int>(materials.size())) return nullptr;
+            return &materials[material];
+        }
+
+        static void add(MaterialCost& total, const MaterialCost& cost) {
+            total.shading_events += cost.shading_events;
+            total.brdf_evaluations += cost.brdf_evaluations;
+            total.shading_ms += cost.shading_ms;
+        }
+    };
+
+    // Start of a timed section: reads the clock only when attribution is on
+    static Clock::time_point start(const Counters* costs) {
+        return costs ? Clock::now() : Clock::time_point();
+    }
+
+    static double elapsed_ms(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Material index of a hit (the primitive's index into Scene::materials); hits without a
+    // primitive are LOD proxies
+    static int material_index(const Scene::Intersection& hit) {
+        return hit.primitive ? hit.primitive->material_index : lod_proxy;
+    }
+
+    // Indices ordered by descending time, at most top entries, skipping entries that never ran
+    template <typename Cost, typename Time>
+    static std::vector<size_t> top_offenders(const std::vector<Cost>& costs, Time time, int top) {
+        std::vector<size_t> order;
+        for (size_t i = 0; i < costs.size(); i++) {
+            if (time(costs[i]) > 0.0) order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return time(costs[a]) > time(costs[b]); });
+        if (order.size() > static_cast<size_t>(std::max(0, top))) order.resize(std::max(0, top));
+        return order;
+    }
+
+    // Print the materials and lights that cost the most, most expensive first
+    static void print(const Counters& costs, const Scene& scene, int top = 5) {
+        double shading_total = 0.0, light_total = 0.0;
+        long long events = 0, shadow_rays = 0;
+        for (const MaterialCost& cost : costs.materials) {
+            shading_total += cost.shading_ms;
+            events += cost.shading_events;
+        }
+        shading_total += costs.lod_proxies.shading_ms;
+        events += costs.lod_proxies.shading_events;
+        for (const LightCost& cost : costs.lights) {
+            light_total += cost.light_ms;
+            shadow_rays += cost.shadow_rays;
+        }
+
+        std::cout << "\n=== Cost Attribution ===" << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Shading: " << events << " events, " << shading_total << " ms; shadow rays: " << shadow_rays
+                  << ", " << light_total << " ms" << std::endl;
+
+        std::cout << "Top materials by shading time:" << std::endl;
+        auto material_time = [](const MaterialCost& cost) { return cost.shading_ms; };
+        for (size_t index : top_offenders(costs.materials, material_time, top)) {
+            std::cout << "  material " << index << " ("
+                      << (index < scene.materials.size() ? scene.materials[index]->material_type_name() : "?") << "): ";
+            print_material_cost(costs.materials[index], shading_total);
+        }
+        if (costs.lod_proxies.shading_events > 0) {
+            std::cout << "  LOD proxies (all materials): ";
+            print_material_cost(costs.lod_proxies, shading_total);
+        }
+
+        std::cout << "Top lights by sampling + shadow ray time:" << std::endl;
+        auto light_time = [](const LightCost& cost) { return cost.light_ms; };
+        for (size_t index : top_offenders(costs.lights, light_time, top)) {
+            const LightCost& cost = costs.lights[index];
+            std::cout << "  light " << index << " ("
+                      << (index < scene.lights.size() ? light_type_name(scene.lights[index]->type) : "?") << "): "
+                      << share(cost.light_ms, light_total) << "% (" << cost.light_ms << " ms), "
+                      << cost.shadow_rays << " shadow rays, "
+                      << share(static_cast<double>(cost.occluded), static_cast<double>(cost.shadow_rays))
+                      << "% occluded" << std::endl;
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+
+private:
+    static double share(double part, double total) {
+        return total > 0.0 ? 100.0 * part / total : 0.0;
+    }
+
+    static void print_material_cost(const MaterialCost& cost, double shading_total) {
+        std::cout << share(cost.shading_ms, shading_total) << "% (" << cost.shading_ms << " ms), "
+                  << cost.shading_events << " hits, " << cost.brdf_evaluations << " BRDF evaluations, "
+                  << 1000.0 * cost.shading_ms / std::max(1LL, cost.shading_events)
+                  << " µs per hit" << std::endl;
+    }
+
+    static const char* light_type_name(LightType type) {
+        switch (type) {
+            case LightType::Point: return "Point Light";
+            case LightType::Directional: return "Directional Light";
+            case LightType::Area: return "Area Light";
+            case LightType::Sphere: return "Sphere Light";
+        }
+        return "Unknown Light";
+    }
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// CostPredictor estimates render time and memory from a sparse pre-sampling pass
+// Educational focus: survey sampling applied to rendering cost
+//
+// Stratified sampling: the image is divided into square strata of s×s pixels with
+//   s = round(1 / sqrt(fraction))            (fraction = 1% → 10×10 strata)
+// and one jittered pixel per stratum is traced and timed. Every image region is represented,
+// so a costly object cannot be missed entirely the way it can with uniform random sampling.
+//
+// Extrapolation (N pixels, n samples with mean cost μ and standard deviation σ):
+//   single-thread time  T1 = N · spp · μ
+//   95% interval        T1 ± 1.96 · N · spp · σ / sqrt(n) · sqrt(1 - n/N)   (finite population correction)
+//   threaded time       T  = spp · max(T_pass / threads, most expensive scanline)
+// The scanline bound reflects the path tracer's scheduling: scanlines are handed out atomically
+// and passes are synchronised, so no pass finishes before its costliest scanline.
+//
+// Cost map reuse: scanline costs (interpolated from the stratum costs) give a longest-first
+// scanline order for the real render, so expensive rows start early instead of forming the tail.
+class CostPredictor {
+public:
+    struct Settings {
+        float sample_fraction = 0.01f;   // Share of pixels traced during pre-sampling
+        unsigned int seed = 1;
+    };
+
+    struct Prediction {
+        int width = 0, height = 0;
+        int samples_per_pixel = 1;
+        int threads = 1;
+        int sampled_pixels = 0;
+        int interrupted_samples = 0;   // Timings rejected as preempted (> 100× median)
+        int stratum_size = 1;
+        double mean_pixel_ns = 0.0, stddev_pixel_ns = 0.0, min_pixel_ns = 0.0, max_pixel_ns = 0.0;
+        double single_thread_seconds = 0.0;
+        double estimate_seconds = 0.0;
+        double lower_seconds = 0.0, upper_seconds = 0.0;   // 95% confidence interval
+        double presampling_seconds = 0.0;
+        std::map<std::string, size_t> memory_bytes;        // Breakdown supplied by the caller
+
+        size_t total_memory_bytes() const {
+            size_t total = 0;
+            for (const auto& entry : memory_bytes) total += entry.second;
+            return total;
+        }
+
+        std::string to_json() const {
+            std::ostringstream out;
+            out.precision(6);
+            out << "{\n";
+            out << "  \"resolution\": {\"width\": " << width << ", \"height\": " << height << "},\n";
+            out << "  \"samples_per_pixel\": " << samples_per_pixel << ",\n";
+            out << "  \"threads\": " << threads << ",\n";
+            out << "  \"presampling\": {\"pixels\": " << sampled_pixels << ", \"fraction\": "
+                << (width * height > 0 ? static_cast<double>(sampled_pixels) / (width * height) : 0.0)
+                << ", \"stratum_size\": " << stratum_size << ", \"interrupted\": " << interrupted_samples
+                << ", \"seconds\": " << presampling_seconds << "},\n";
+            out << "  \"pixel_cost_ns\": {\"mean\": " << mean_pixel_ns << ", \"stddev\": " << stddev_pixel_ns
+                << ", \"min\": " << min_pixel_ns << ", \"max\": " << max_pixel_ns << "},\n";
+            out << "  \"render_seconds\": {\"estimate\": " << estimate_seconds << ", \"confidence_95\": ["
+                << lower_seconds << ", " << upper_seconds << "], \"single_thread\": " << single_thread_seconds << "},\n";
+            out << "  \"memory_bytes\": {\"total\": " << total_memory_bytes();
+            for (const auto& entry : memory_bytes) {
+                out << ", \"" << entry.first << "\": " << entry.second;
+            }
+            out << "},\n";
+            out << "  \"scanline_order\": \"longest_predicted_first\"\n";
+            out << "}\n";
+            return out.str();
+        }
+
+        void print() const {
+            std::cout << "\n=== Render Cost Prediction ===" << std::endl;
+            std::cout << "Pre-sampled " << sampled_pixels << " pixels (" << stratum_size << "x" << stratum_size
+                      << " strata) in " << presampling_seconds << " s, " << interrupted_samples
+                      << " interrupted timings rejected" << std::endl;
+            std::cout << "Pixel cost: mean " << mean_pixel_ns / 1000.0 << " us, stddev " << stddev_pixel_ns / 1000.0
+                      << " us, max " << max_pixel_ns / 1000.0 << " us" << std::endl;
+            std::cout << "Predicted render time: " << estimate_seconds << " s (95% CI " << lower_seconds << " - "
+                      << upper_seconds << " s) at " << samples_per_pixel << " spp on " << threads << " thread(s)" << std::endl;
+            std::cout << "Predicted memory: " << total_memory_bytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+        }
+    };
+
+    CostPredictor(int image_width, int image_height, const Settings& predictor_settings)
+        : width(image_width), height(image_height), settings(predictor_settings) {
+        float fraction = std::min(1.0f, std::max(1e-4f, settings.sample_fraction));
+        stratum = std::max(1, static_cast<int>(std::lround(1.0 / std::sqrt(fraction))));
+        strata_x = (width + stratum - 1) / stratum;
+        strata_y = (height + stratum - 1) / stratum;
+    }
+
+    // Trace one jittered pixel per stratum with trace_pixel(x, y) and record its wall-clock cost
+    void sample(const std::function<void(int, int)>& trace_pixel) {
+        std::mt19937 rng(settings.seed);
+        stratum_cost_ns.assign(static_cast<size_t>(strata_x) * strata_y, 0.0);
+        auto start = std::chrono::steady_clock::now();
+        for (int sy = 0; sy < strata_y; sy++) {
+            for (int sx = 0; sx < strata_x; sx++) {
+                int x0 = sx * stratum, y0 = sy * stratum;
+                int x = x0 + std::uniform_int_distribution<int>(0, std::min(stratum, width - x0) - 1)(rng);
+                int y = y0 + std::uniform_int_distribution<int>(0, std::min(stratum, height - y0) - 1)(rng);
+                auto pixel_start = std::chrono::steady_clock::now();
+                trace_pixel(x, y);
+                auto pixel_end = std::chrono::steady_clock::now();
+                stratum_cost_ns[static_cast<size_t>(sy) * strata_x + sx] =
+                    std::chrono::duration<double, std::nano>(pixel_end - pixel_start).count();
+            }
+        }
+        presampling_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // A pixel timed at over 100× the median was almost certainly preempted (context switch,
+        // page fault storm) rather than expensive: replace it by the median so one interruption
+        // does not dominate a 1% sample
+        std::vector<double> sorted = stratum_cost_ns;
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        double median = sorted[sorted.size() / 2];
+        interrupted_samples = 0;
+        for (double& cost : stratum_cost_ns) {
+            if (cost > interruption_factor * median) {
+                cost = median;
+                interrupted_samples++;
+            }
+        }
+    }
+
+    // Extrapolate to the full image; memory_bytes is the caller's buffer breakdown
+    Prediction predict(int samples_per_pixel, int thread_count, const std::map<std::string, size_t>& memory_bytes) const {
+        Prediction prediction;
+        prediction.width = width;
+        prediction.height = height;
+        prediction.samples_per_pixel = std::max(1, samples_per_pixel);
+        prediction.threads = std::max(1, thread_count);
+        prediction.sampled_pixels = static_cast<int>(stratum_cost_ns.size());
+        prediction.interrupted_samples = interrupted_samples;
+        prediction.stratum_size = stratum;
+        prediction.presampling_seconds = presampling_seconds;
+        prediction.memory_bytes = memory_bytes;
+        if (stratum_cost_ns.empty()) return prediction;
+
+        double n = static_cast<double>(stratum_cost_ns.size());
+        double total_pixels = static_cast<double>(width) * height;
+        double mean = std::accumulate(stratum_cost_ns.begin(), stratum_cost_ns.end(), 0.0) / n;
+        double squared = 0.0;
+        for (double cost : stratum_cost_ns) squared += (cost - mean) * (cost - mean);
+        double stddev = n > 1 ? std::sqrt(squared / (n - 1)) : 0.0;
+        prediction.mean_pixel_ns = mean;
+        prediction.stddev_pixel_ns = stddev;
+        prediction.min_pixel_ns = *std::min_element(stratum_cost_ns.begin(), stratum_cost_ns.end());
+        prediction.max_pixel_ns = *std::max_element(stratum_cost_ns.begin(), stratum_cost_ns.end());
+
+        double spp = prediction.samples_per_pixel;
+        double pass_seconds = total_pixels * mean * 1e-9;
+        double half_width = 1.96 * total_pixels * stddev / std::sqrt(n) * std::sqrt(std::max(0.0, 1.0 - n / total_pixels)) * 1e-9;
+        prediction.single_thread_seconds = spp * pass_seconds;
+
+        // Threaded pass time: perfect division of work, bounded below by the costliest scanline
+        double max_row_seconds = 0.0;
+        for (int y = 0; y < height; y++) max_row_seconds = std::max(max_row_seconds, row_cost_ns(y) * width * 1e-9);
+        auto threaded = [&](double single_pass) {
+            return spp * std::max(single_pass / prediction.threads, std::min(single_pass, max_row_seconds));
+        };
+        prediction.estimate_seconds = threaded(pass_seconds);
+        prediction.lower_seconds = threaded(std::max(0.0, pass_seconds - half_width));
+        prediction.upper_seconds = threaded(pass_seconds + half_width);
+        return prediction;
+    }
+
+    // Predicted cost per pixel of scanline y (ns), averaged over the stratum row containing it
+    double row_cost_ns(int y) const {
+        if (stratum_cost_ns.empty()) return 0.0;
+        int sy = std::min(strata_y - 1, std::max(0, y / stratum));
+        double sum = 0.0;
+        for (int sx = 0; sx < strata_x; sx++) sum += stratum_cost_ns[static_cast<size_t>(sy) * strata_x + sx];
+        return sum / strata_x;
+    }
+
+    // Scanlines ordered by descending predicted cost (longest processing time first)
+    std::vector<int> scanline_order() const {
+        std::vector<int> order(height);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return row_cost_ns(a) > row_cost_ns(b); });
+        return order;
+    }
+
+    int sampled_pixels() const { return static_cast<int>(stratum_cost_ns.size()); }
+
+    // Write the prediction as JSON; returns false when the file cannot be written
+    static bool write_json(const Prediction& prediction, const std::string& filename) {
+        std::ofstream file(filename);
+        if (!file) {
+            std::cout << "ERROR: Could not write prediction to " << filename << std::endl;
+            return false;
+        }
+        file << prediction.to_json();
+        return static_cast<bool>(file);
+    }
+
+private:
+    int width, height;
+    Settings settings;
+    int stratum = 10;
+    int strata_x = 0, strata_y = 0;
+    std::vector<double> stratum_cost_ns;
+    double presampling_seconds = 0.0;
+    int interrupted_samples = 0;
+
+    static constexpr double interruption_factor = 100.0;
+};
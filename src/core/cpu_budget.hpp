@@ -0,0 +1,163 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// CPU budget: how many threads this process can actually keep busy
+// Educational focus: hardware threads vs the CPUs a container is allowed to use
+//   std::thread::hardware_concurrency() reports the host's CPUs. Inside a container two other limits
+//   usually apply, and sizing thread pools from the host count oversubscribes them:
+//   1. CPU affinity (cpusets, taskset): the scheduler runs the process only on the CPUs in its mask
+//      (sched_getaffinity). Extra threads just time-slice on the allowed CPUs.
+//   2. CFS bandwidth quota (cgroup v2 cpu.max, "quota period" in microseconds, e.g. "200000 100000"
+//      = 2 CPUs): the process's threads may run for quota µs per period in total. A pool of 16 threads
+//      under a 2-CPU quota uses up the quota early in every period and is then throttled until the
+//      next period starts, which shows up as long pauses and slow last tiles.
+//   The quota applies to every ancestor cgroup too, so the smallest quota on the path from the
+//   process's cgroup (/proc/self/cgroup, line "0::/path") up to the root wins.
+//
+// Effective CPUs = min(hardware threads, affinity CPUs, floor(quota)), at least 1. Rounding the
+// quota down means a fractional quota (1.5 CPUs) leaves some capacity unused but never throttles.
+// Every thread pool that defaults to "one thread per CPU" (thread_count = 0) uses this count;
+// an explicit --threads still wins.
+namespace CpuBudget {
+
+struct Limits {
+    int hardware_threads = 1;       // std::thread::hardware_concurrency()
+    int affinity_cpus = 0;          // CPUs in the affinity mask (0 = unknown)
+    double quota_cpus = 0.0;        // cgroup v2 cpu.max quota / period (0 = no quota found)
+    std::string quota_source;       // cpu.max file that set the quota
+    int effective_cpus = 1;
+
+    void print() const {
+        std::cout << "\n=== CPU Budget ===" << std::endl;
+        std::cout << "Hardware threads: " << hardware_threads << ", affinity mask: ";
+        if (affinity_cpus > 0) {
+            std::cout << affinity_cpus << " CPU(s)" << std::endl;
+        } else {
+            std::cout << "unknown" << std::endl;
+        }
+        if (quota_cpus > 0.0) {
+            std::cout << "cgroup CPU quota: " << quota_cpus << " CPU(s) (" << quota_source << ")" << std::endl;
+        } else {
+            std::cout << "cgroup CPU quota: none" << std::endl;
+        }
+        std::cout << "Effective CPUs: " << effective_cpus << std::endl;
+    }
+};
+
+// Parse a cgroup v2 cpu.max line ("max 100000" or "<quota> <period>")
+// Returns false for malformed text; cpus = 0 means no quota
+inline bool parse_cpu_max(const std::string& text, double& cpus) {
+    std::istringstream fields(text);
+    std::string quota;
+    long long period = 0;
+    if (!(fields >> quota >> period) || period <= 0) {
+        return false;
+    }
+    if (quota == "max") {
+        cpus = 0.0;
+        return true;
+    }
+    char* end = nullptr;
+    long long quota_us = std::strtoll(quota.c_str(), &end, 10);
+    if (*end != '\0' || quota_us <= 0) {
+        return false;
+    }
+    cpus = static_cast<double>(quota_us) / period;
+    return true;
+}
+
+// cgroup v2 path of this process: the "0::<path>" line of /proc/self/cgroup ("" without cgroup v2;
+// cgroup v1 controllers use other hierarchy ids)
+inline std::string cgroup_v2_path(const std::string& proc_cgroup_file = "/proc/self/cgroup") {
+    std::ifstream proc_cgroup(proc_cgroup_file);
+    std::string line;
+    while (std::getline(proc_cgroup, line)) {
+        if (line.compare(0, 3, "0::") == 0) {
+            return line.substr(3);
+        }
+    }
+    return "";
+}
+
+// Directories of a cgroup and all its ancestors under mount, leaf first
+// Resource limits (cpu.max, memory.max) of every ancestor apply to the process as well
+inline std::vector<std::string> cgroup_directories(const std::string& mount, std::string cgroup_path) {
+    std::vector<std::string> directories;
+    while (true) {
+        directories.push_back(mount + cgroup_path + (cgroup_path.empty() || cgroup_path.back() != '/' ? "/" : ""));
+        size_t slash = cgroup_path.find_last_of('/');
+        if (cgroup_path.empty() || cgroup_path == "/" || slash == std::string::npos) break;
+        cgroup_path = slash == 0 ? "/" : cgroup_path.substr(0, slash);
+    }
+    return directories;
+}
+
+// Smallest cpu.max quota from <mount>/<cgroup_path> up to <mount>, 0 if none is set
+inline double cgroup_quota(const std::string& mount, const std::string& cgroup_path, std::string& source) {
+    double smallest = 0.0;
+    for (const std::string& directory : cgroup_directories(mount, cgroup_path)) {
+        std::ifstream cpu_max(directory + "cpu.max");
+        std::string line;
+        double cpus = 0.0;
+        if (std::getline(cpu_max, line) && parse_cpu_max(line, cpus) && cpus > 0.0 &&
+            (smallest == 0.0 || cpus < smallest)) {
+            smallest = cpus;
+            source = directory + "cpu.max";
+        }
+    }
+    return smallest;
+}
+
+// Detect the limits of this process; the paths are parameters so tests can use a fake cgroup tree
+inline Limits detect(const std::string& cgroup_mount = "/sys/fs/cgroup",
+                     const std::string& proc_cgroup_file = "/proc/self/cgroup") {
+    Limits limits;
+    limits.hardware_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        limits.affinity_cpus = CPU_COUNT(&mask);
+    }
+#endif
+
+    std::string cgroup_path = cgroup_v2_path(proc_cgroup_file);
+    if (!cgroup_path.empty()) {
+        limits.quota_cpus = cgroup_quota(cgroup_mount, cgroup_path, limits.quota_source);
+    }
+
+    int effective = limits.hardware_threads;
+    if (limits.affinity_cpus > 0) {
+        effective = std::min(effective, limits.affinity_cpus);
+    }
+    if (limits.quota_cpus > 0.0) {
+        effective = std::min(effective, static_cast<int>(std::floor(limits.quota_cpus + 1e-9)));
+    }
+    limits.effective_cpus = std::max(1, effective);
+    return limits;
+}
+
+// Limits of this process, detected on first use
+inline const Limits& process_limits() {
+    static const Limits limits = detect();
+    return limits;
+}
+
+// Thread count for pools whose setting is 0 ("one per CPU")
+inline int default_thread_count() {
+    return process_limits().effective_cpus;
+}
+
+} // namespace CpuBudget
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+#endif
+
+// Huge-page backing for large, long-lived buffers (sphere arrays, BVH nodes, framebuffers)
+// Educational focus: translation lookaside buffer (TLB) reach
+//   A TLB holds a fixed number of virtual→physical translations (typically 1-2k entries).
+//   With 4 KB pages that covers only a few MB; random access into a larger BVH or framebuffer
+//   misses the TLB and pays a page-table walk. One 2 MB page replaces 512 small pages, so the
+//   same TLB covers 512× more memory.
+//
+// Mechanism: transparent huge pages via madvise(MADV_HUGEPAGE)
+//   1. Allocate the buffer (plus 2 MB slack) without touching it
+//   2. Advise the 2 MB-aligned interior of the allocation
+//   3. Fill it: first-touch page faults in the advised range are served with 2 MB pages
+// The partial page before the first 2 MB boundary stays on 4 KB pages. Buffers below 2 MB are left alone.
+// Fallback: without THP support (non-Linux, THP disabled, allocation too small) buffers are unchanged
+// and the statistics report 0% coverage; rendering is never affected.
+//
+// Coverage is measured, not assumed: madvise splits the mapping, and /proc/self/smaps reports the
+// AnonHugePages of exactly the advised range.
+namespace HugePages {
+
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+// Advise the 2 MB-aligned interior of [data, data + bytes); returns the number of advised bytes
+inline size_t advise(void* data, size_t bytes) {
+#ifdef __linux__
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    uintptr_t aligned_begin = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+    uintptr_t aligned_end = (begin + bytes) & ~(huge_page_size - 1);
+    if (aligned_end <= aligned_begin) return 0;
+    if (madvise(reinterpret_cast<void*>(aligned_begin), aligned_end - aligned_begin, MADV_HUGEPAGE) != 0) return 0;
+    return aligned_end - aligned_begin;
+#else
+    (void)data;
+    (void)bytes;
+    return 0;
+#endif
+}
+
+// Bytes of [data, data + bytes) currently backed by huge pages, from /proc/self/smaps
+inline size_t resident_huge_bytes(const void* data, size_t bytes) {
+    size_t total = 0;
+#ifdef __linux__
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    uintptr_t end = begin + bytes;
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool overlapping = false;
+    size_t overlap_bytes = 0;
+    while (std::getline(smaps, line)) {
+        uintptr_t range_begin = 0, range_end = 0;
+        char dash = 0;
+        std::istringstream header(line);
+        if (header >> std::hex >> range_begin >> dash >> range_end && dash == '-') {
+            // Mapping header line: "start-end perms offset dev inode path"
+            overlapping = range_begin < end && range_end > begin;
+            overlap_bytes = overlapping ? std::min(range_end, end) - std::max(range_begin, begin) : 0;
+        } else if (overlapping && line.compare(0, 14, "AnonHugePages:") == 0) {
+            size_t kilobytes = std::stoull(line.substr(14));
+            total += std::min(kilobytes * 1024, overlap_bytes);
+        }
+    }
+#else
+    (void)data;
+#endif
+    return std::min(total, bytes);
+}
+
+// Record of one huge-page candidate buffer for the statistics report
+struct Buffer {
+    std::string name;
+    const void* data = nullptr;
+    size_t bytes = 0;
+    size_t advised_bytes = 0;
+};
+
+struct Statistics {
+    bool enabled = false;
+    std::vector<Buffer> buffers;
+    long long tlb_misses = -1;    // Render-phase dTLB load misses (-1 = counter unavailable)
+    long long rays = 0;
+
+    void print() const {
+        std::cout << "\n=== Huge Page Statistics ===" << std::endl;
+        if (tlb_misses >= 0) {
+            std::cout << "dTLB load misses during render: " << tlb_misses << " ("
+                      << (rays > 0 ? 1000.0 * tlb_misses / rays : 0.0) << " per 1000 primary rays)" << std::endl;
+        } else {
+            std::cout << "dTLB load misses: unavailable (no hardware perf counters)" << std::endl;
+        }
+        if (!enabled) {
+            std::cout << "Huge pages: disabled (4 KB pages; use --huge-pages to compare)" << std::endl;
+            return;
+        }
+        size_t total_bytes = 0, total_huge = 0;
+        for (const Buffer& buffer : buffers) {
+            size_t huge = resident_huge_bytes(buffer.data, buffer.bytes);
+            total_bytes += buffer.bytes;
+            total_huge += huge;
+            std::cout << "  " << buffer.name << ": " << buffer.bytes / 1024 << " KB, advised "
+                      << buffer.advised_bytes / 1024 << " KB, huge-page backed " << huge / 1024 << " KB ("
+                      << (buffer.bytes > 0 ? 100.0 * huge / buffer.bytes : 0.0) << "%)" << std::endl;
+        }
+        std::cout << "Coverage: " << total_huge / 1024 << " KB of " << total_bytes / 1024 << " KB ("
+                  << (total_bytes > 0 ? 100.0 * total_huge / total_bytes : 0.0) << "%)" << std::endl;
+        if (total_huge == 0) {
+            std::cout << "  (no huge pages: buffers below 2 MB, THP disabled, or not supported on this platform)" << std::endl;
+        }
+    }
+};
+
+// Move a vector's contents into a fresh allocation whose interior is advised for huge pages
+template<typename T>
+void rehome(std::vector<T>& buffer, const std::string& name, Statistics& stats) {
+    size_t bytes = buffer.size() * sizeof(T);
+    if (bytes < huge_page_size) {
+        stats.buffers.push_back({name, buffer.data(), bytes, 0});
+        return;
+    }
+    std::vector<T> advised_buffer;
+    advised_buffer.reserve(buffer.size() + huge_page_size / sizeof(T));
+    size_t advised = advise(advised_buffer.data(), advised_buffer.capacity() * sizeof(T));
+    advised_buffer.insert(advised_buffer.end(), buffer.begin(), buffer.end());
+    buffer.swap(advised_buffer);
+
+    // Advised bytes that hold data: the advised range starts at the first 2 MB boundary
+    uintptr_t begin = reinterpret_cast<uintptr_t>(buffer.data());
+    uintptr_t aligned_begin = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+    size_t advised_data = advised > 0 ? std::min(aligned_begin + advised, begin + bytes) - aligned_begin : 0;
+    stats.buffers.push_back({name, buffer.data(), bytes, advised_data});
+}
+
+// Data TLB load misses of the calling thread and threads it starts (Linux perf events, user space only)
+// Compare runs with and without --huge-pages to see the TLB-miss change
+class TlbMissCounter {
+public:
+    TlbMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;             // Include render threads started after start()
+        descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~TlbMissCounter() {
+#ifdef __linux__
+        if (descriptor >= 0) close(descriptor);
+#endif
+    }
+
+    TlbMissCounter(const TlbMissCounter&) = delete;
+    TlbMissCounter& operator=(const TlbMissCounter&) = delete;
+
+    bool available() const { return descriptor >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (descriptor < 0) return;
+        ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+        ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // Misses since start(), or -1 when hardware counters are unavailable
+    long long stop() {
+#ifdef __linux__
+        if (descriptor < 0) return -1;
+        ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(descriptor, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) return -1;
+        return count;
+#else
+        return -1;
+#endif
+    }
+
+private:
+    int descriptor = -1;
+};
+
+} // namespace HugePages
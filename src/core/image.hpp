@@ -1,11 +1,18 @@
 #pragma once
 #include "vector3.hpp"
+#include "huge_pages.hpp"
+#include "qoi_encoder.hpp"
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <stdexcept>
+#include <thread>
 
 // STB Image Write implementation
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -157,7 +164,7 @@ public:
     // Color clamping for display compatibility
     // Clamps linear RGB values to [0.0, 1.0] range for standard display
     // Mathematical operation: clamp(x, 0, 1) = max(0, min(x, 1))
-    Vector3 clamp_color(const Vector3& color) const {
+    static Vector3 clamp_color(const Vector3& color) {
         return Vector3(
             std::max(0.0f, std::min(color.x, 1.0f)),  // Red channel clamping
             std::max(0.0f, std::min(color.y, 1.0f)),  // Green channel clamping
@@ -297,30 +304,75 @@ public:
     // Convert to 8-bit RGB values for PNG output
     // Returns vector of bytes in RGB format (3 bytes per pixel)
     std::vector<unsigned char> to_8bit_rgb(bool apply_gamma_correction = true) const {
-        std::vector<unsigned char> rgb_data;
-        rgb_data.reserve(width * height * 3);  // 3 channels per pixel
-        
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                Vector3 linear_color = pixel(x, y);
-                
-                // Apply gamma correction if requested
-                Vector3 display_color = apply_gamma_correction ? 
-                    gamma_correct(clamp_color(linear_color)) : 
-                    clamp_color(linear_color);
-                
-                // Convert to 8-bit range [0, 255]
-                unsigned char r = (unsigned char)(display_color.x * 255.0f + 0.5f);
-                unsigned char g = (unsigned char)(display_color.y * 255.0f + 0.5f);
-                unsigned char b = (unsigned char)(display_color.z * 255.0f + 0.5f);
-                
-                rgb_data.push_back(r);
-                rgb_data.push_back(g);
-                rgb_data.push_back(b);
+        std::vector<unsigned char> rgb_data(static_cast<size_t>(width) * height * 3);  // 3 channels per pixel
+        to_8bit_rgb_rows(0, height, rgb_data.data(), apply_gamma_correction);
+        return rgb_data;
+    }
+    
+    // Convert rows [first_row, last_row) to 8-bit RGB into destination (3 bytes per pixel)
+    // Lets encoders convert independent row bands on separate threads
+    void to_8bit_rgb_rows(int first_row, int last_row, unsigned char* destination, bool apply_gamma_correction = true) const {
+        for (int y = first_row; y < last_row; y++) {
+            row_to_8bit_rgb(&pixels[static_cast<size_t>(y) * width], width, destination, apply_gamma_correction);
+            destination += static_cast<size_t>(width) * 3;
+        }
+    }
+    
+    // Convert count linear colors to 8-bit RGB (3 bytes per pixel), as to_8bit_rgb does
+    static void row_to_8bit_rgb(const Vector3* colors, int count, unsigned char* destination, bool apply_gamma_correction = true) {
+        for (int x = 0; x < count; x++) {
+            Vector3 display_color = clamp_color(colors[x]);
+            
+            // Gamma correction and rounding to [0, 255] in one step (see gamma_byte)
+            if (apply_gamma_correction) {
+                *destination++ = gamma_byte(display_color.x);
+                *destination++ = gamma_byte(display_color.y);
+                *destination++ = gamma_byte(display_color.z);
+            } else {
+                *destination++ = (unsigned char)(display_color.x * 255.0f + 0.5f);
+                *destination++ = (unsigned char)(display_color.y * 255.0f + 0.5f);
+                *destination++ = (unsigned char)(display_color.z * 255.0f + 0.5f);
             }
         }
-        
-        return rgb_data;
+    }
+    
+    // 8-bit value of a clamped channel c ∈ [0, 1] after gamma correction (γ = 2.2), bit-identical to
+    //   (unsigned char)(pow(c, 1/2.2) · 255 + 0.5)
+    // without calling pow. Non-negative floats order like their bit patterns, so the top 16 bits
+    // (exponent and 7 mantissa bits) split [0, 1] into buckets of relative width 1/128. Over such a
+    // bucket c^(1/2.2) · 255 grows by less than one, so each bucket stores its first byte and the one
+    // threshold (found by bisection) above which the byte is one larger.
+    static unsigned char gamma_byte(float clamped_channel) {
+        struct Bucket {
+            float threshold;       // Smallest value in the bucket with byte base + 1 (or above the bucket)
+            unsigned char base;    // Byte at the start of the bucket
+        };
+        static const std::vector<Bucket> buckets = [] {
+            auto reference = [](uint32_t bits) {
+                float c;
+                std::memcpy(&c, &bits, sizeof(c));
+                return (unsigned char)(std::pow(std::max(0.0f, c), 1.0f / 2.2f) * 255.0f + 0.5f);
+            };
+            const uint32_t one_bits = 0x3f800000u;   // 1.0f
+            std::vector<Bucket> result((one_bits >> 16) + 1);
+            for (uint32_t bucket = 0; bucket < result.size(); bucket++) {
+                uint32_t first = bucket << 16, last = std::min(first | 0xffffu, one_bits);
+                unsigned char base = reference(first);
+                uint32_t low = first, high = last + 1;   // First bit pattern with a larger byte
+                while (low < high) {
+                    uint32_t middle = low + (high - low) / 2;
+                    if (reference(middle) > base) high = middle; else low = middle + 1;
+                }
+                float threshold = std::numeric_limits<float>::infinity();
+                if (low <= last) std::memcpy(&threshold, &low, sizeof(threshold));
+                result[bucket] = {threshold, base};
+            }
+            return result;
+        }();
+        uint32_t bits;
+        std::memcpy(&bits, &clamped_channel, sizeof(bits));
+        const Bucket& bucket = buckets[std::min<uint32_t>(bits & 0x7fffffffu, 0x3f800000u) >> 16];
+        return static_cast<unsigned char>(bucket.base + (clamped_channel >= bucket.threshold));
     }
     
     // Save image to PNG file with proper color management
@@ -366,6 +418,88 @@ public:
         }
     }
     
+    // Save image as QOI (see qoi_encoder.hpp): lossless like PNG, encoded in parallel row bands
+    // Meant for intermediate frames (compositing, sequences) where PNG's deflate dominates output time
+    bool save_to_qoi(const std::string& filename, bool apply_gamma_correction = true,
+                     const QoiEncoder::Settings& settings = QoiEncoder::Settings()) const {
+        if (!validate_image()) {
+            std::cout << "ERROR: Cannot save invalid image to QOI" << std::endl;
+            return false;
+        }
+        
+        QoiEncoder::Settings encoder_settings = settings;
+        encoder_settings.linear = !apply_gamma_correction;
+        QoiEncoder::Statistics stats;
+        std::vector<unsigned char> data = QoiEncoder::encode(width, height, 3,
+            [&](int first_row, int last_row, unsigned char* destination) {
+                to_8bit_rgb_rows(first_row, last_row, destination, apply_gamma_correction);
+            }, encoder_settings, &stats);
+        
+        if (!QoiEncoder::write_file(filename, data)) {
+            std::cout << "✗ ERROR: Failed to save QOI file: " << filename << std::endl;
+            return false;
+        }
+        std::cout << "✓ QOI file saved: " << filename << " (" << width << " × " << height << ", " << data.size()
+                  << " bytes, " << stats.compression_ratio() << ":1, " << stats.bands << " bands on " << stats.threads
+                  << " thread(s), " << stats.encode_ms << " ms)" << std::endl;
+        return true;
+    }
+    
+    // Save an image whose rows are rendered on demand, without ever holding a float framebuffer
+    // (MemoryPlanner's streamed output). render_row(y, row) fills `width` linear colors of row y and must
+    // be safe to call from several threads. QOI renders rows inside its band threads, so only the bands
+    // in flight exist at a time; PNG needs the whole 8-bit image for deflate, rendered by settings.thread_count
+    // threads. The file is identical to rendering into an Image and saving that with gamma correction.
+    template <typename RowRenderer>
+    static bool save_streamed(const std::string& filename, int width, int height, bool qoi,
+                              const QoiEncoder::Settings& settings, RowRenderer render_row) {
+        if (width <= 0 || height <= 0) {
+            std::cout << "ERROR: Cannot stream an empty image" << std::endl;
+            return false;
+        }
+        auto render_rows = [&](int first_row, int last_row, unsigned char* destination) {
+            std::vector<Vector3> row(width);
+            for (int y = first_row; y < last_row; y++) {
+                render_row(y, row.data());
+                row_to_8bit_rgb(row.data(), width, destination, true);
+                destination += static_cast<size_t>(width) * 3;
+            }
+        };
+        
+        if (qoi) {
+            QoiEncoder::Statistics stats;
+            std::vector<unsigned char> data = QoiEncoder::encode(width, height, 3, render_rows, settings, &stats);
+            if (!QoiEncoder::write_file(filename, data)) {
+                std::cout << "✗ ERROR: Failed to save QOI file: " << filename << std::endl;
+                return false;
+            }
+            std::cout << "✓ QOI file streamed: " << filename << " (" << width << " × " << height << ", " << data.size()
+                      << " bytes, " << stats.bands << " bands on " << stats.threads << " thread(s))" << std::endl;
+            return true;
+        }
+        
+        std::vector<unsigned char> rgb_data(static_cast<size_t>(width) * height * 3);
+        int thread_count = settings.thread_count > 0 ? settings.thread_count : CpuBudget::default_thread_count();
+        thread_count = std::max(1, std::min(thread_count, height));
+        std::atomic<int> next_row{0};
+        auto worker = [&]() {
+            for (int y = next_row++; y < height; y = next_row++) {
+                render_rows(y, y + 1, rgb_data.data() + static_cast<size_t>(y) * width * 3);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int t = 1; t < thread_count; t++) threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads) thread.join();
+        if (stbi_write_png(filename.c_str(), width, height, 3, rgb_data.data(), width * 3) == 0) {
+            std::cout << "✗ ERROR: Failed to save PNG file: " << filename << std::endl;
+            return false;
+        }
+        std::cout << "✓ PNG file streamed: " << filename << " (" << width << " × " << height << ", rows rendered on "
+                  << thread_count << " thread(s))" << std::endl;
+        return true;
+    }
+    
     // Validate image consistency and detect issues
     bool validate_image() const {
         // Check dimensions
@@ -388,6 +522,11 @@ public:
         return true;
     }
     
+    // Move the pixel buffer into huge-page advised memory (see huge_pages.hpp)
+    void use_huge_pages(HugePages::Statistics& stats, const std::string& name = "Image pixels") {
+        HugePages::rehome(pixels, name, stats);
+    }
+    
     // Memory and performance monitoring methods
     size_t memory_usage_bytes() const {
         return pixels.size() * sizeof(Vector3);
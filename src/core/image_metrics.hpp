@@ -0,0 +1,143 @@
+#pragma once
+#include "vector3.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// ImageMetrics compares a test image against a reference image (row-major linear RGB in [0,1])
+// Educational focus: image-level error measures for judging approximate rendering modes
+//
+// Metrics:
+//   RMSE      = sqrt( Σ (test - ref)² / (3N) )          per-channel root mean square error
+//   PSNR      = 20 * log10(1 / RMSE) dB                  peak signal-to-noise ratio (peak = 1.0)
+//   max error = max |test - ref| over all channels       worst single-channel deviation
+//   FLIP      = mean per-pixel perceptual error in [0,1] (simplified FLIP-style metric)
+//
+// FLIP-style perceptual error (after Andersson et al. 2020, simplified):
+//   1. Clamp to display range, convert linear RGB to CIE L*a*b*
+//   2. Low-pass both images with a 3×3 Gaussian (stand-in for contrast sensitivity filtering)
+//   3. Color error: ΔE_c = (ΔE_ab / 100)^0.7, clamped to [0,1]
+//   4. Feature error: ΔE_f = |edge_test - edge_ref| from Sobel gradients of L*, clamped to [0,1]
+//   5. Per-pixel error: ΔE_c^(1 - ΔE_f) (differing edges amplify color error)
+struct ImageMetrics {
+    float rmse = 0.0f;
+    float psnr_db = std::numeric_limits<float>::infinity();
+    float max_error = 0.0f;
+    float flip = 0.0f;
+
+    // Compute all metrics; images must have width * height entries
+    // Images of any other size compare as maximally different (see size_mismatch())
+    static ImageMetrics compare(const std::vector<Vector3>& test, const std::vector<Vector3>& reference,
+                                int width, int height) {
+        size_t pixel_count = width > 0 && height > 0 ? static_cast<size_t>(width) * height : 0;
+        if (test.size() != reference.size() || reference.size() != pixel_count) {
+            return size_mismatch();
+        }
+        ImageMetrics metrics;
+        double squared_sum = 0.0;
+        for (size_t i = 0; i < reference.size(); i++) {
+            Vector3 diff = test[i] - reference[i];
+            squared_sum += static_cast<double>(diff.x) * diff.x + static_cast<double>(diff.y) * diff.y +
+                           static_cast<double>(diff.z) * diff.z;
+            metrics.max_error = std::max({metrics.max_error, std::abs(diff.x), std::abs(diff.y), std::abs(diff.z)});
+        }
+        metrics.rmse = reference.empty() ? 0.0f : static_cast<float>(std::sqrt(squared_sum / (3.0 * reference.size())));
+        if (metrics.rmse > 0.0f) {
+            metrics.psnr_db = 20.0f * std::log10(1.0f / metrics.rmse);
+        }
+        metrics.flip = flip_error(test, reference, width, height);
+        return metrics;
+    }
+
+    // Metrics of images that cannot be compared pixel by pixel: infinite RMSE and max error,
+    // PSNR of -inf and FLIP 1, so every error budget rejects them
+    static ImageMetrics size_mismatch() {
+        ImageMetrics metrics;
+        metrics.rmse = std::numeric_limits<float>::infinity();
+        metrics.psnr_db = -std::numeric_limits<float>::infinity();
+        metrics.max_error = std::numeric_limits<float>::infinity();
+        metrics.flip = 1.0f;
+        return metrics;
+    }
+
+    // Mean FLIP-style perceptual error (0 = indistinguishable, 1 = maximal difference)
+    static float flip_error(const std::vector<Vector3>& test, const std::vector<Vector3>& reference,
+                            int width, int height) {
+        if (width <= 0 || height <= 0) return 0.0f;
+        size_t pixel_count = static_cast<size_t>(width) * height;
+        if (test.size() != pixel_count || reference.size() != pixel_count) return 1.0f;
+        std::vector<Vector3> test_lab = filtered_lab(test, width, height);
+        std::vector<Vector3> reference_lab = filtered_lab(reference, width, height);
+
+        double error_sum = 0.0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                size_t i = static_cast<size_t>(y) * width + x;
+                float delta_e = (test_lab[i] - reference_lab[i]).length();
+                float color_error = std::min(1.0f, std::pow(delta_e / 100.0f, 0.7f));
+                float feature_error = std::min(1.0f, std::abs(edge_strength(test_lab, x, y, width, height) -
+                                                              edge_strength(reference_lab, x, y, width, height)));
+                error_sum += std::pow(color_error, 1.0f - feature_error);
+            }
+        }
+        return static_cast<float>(error_sum / (static_cast<double>(width) * height));
+    }
+
+private:
+    // Linear RGB → CIE L*a*b* (D65), followed by 3×3 Gaussian low-pass
+    static std::vector<Vector3> filtered_lab(const std::vector<Vector3>& image, int width, int height) {
+        std::vector<Vector3> lab(image.size());
+        for (size_t i = 0; i < image.size(); i++) {
+            lab[i] = linear_to_lab(image[i]);
+        }
+
+        const float kernel[3] = {0.25f, 0.5f, 0.25f};
+        std::vector<Vector3> filtered(image.size(), Vector3(0, 0, 0));
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Vector3 sum(0, 0, 0);
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        int sx = std::clamp(x + dx, 0, width - 1);
+                        int sy = std::clamp(y + dy, 0, height - 1);
+                        sum += lab[static_cast<size_t>(sy) * width + sx] * (kernel[dx + 1] * kernel[dy + 1]);
+                    }
+                }
+                filtered[static_cast<size_t>(y) * width + x] = sum;
+            }
+        }
+        return filtered;
+    }
+
+    static Vector3 linear_to_lab(const Vector3& color) {
+        // Display range clamp (matches Image::set_pixel); L*a*b* handles perceptual encoding
+        float r = std::clamp(color.x, 0.0f, 1.0f);
+        float g = std::clamp(color.y, 0.0f, 1.0f);
+        float b = std::clamp(color.z, 0.0f, 1.0f);
+
+        // Linear RGB → XYZ (D65), normalized by white point
+        float x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.9505f;
+        float y = (0.2126f * r + 0.7152f * g + 0.0722f * b);
+        float z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.0890f;
+
+        auto f = [](float t) { return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f; };
+        float fx = f(x), fy = f(y), fz = f(z);
+        return Vector3(116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz));
+    }
+
+    // Normalized Sobel gradient magnitude of L* (0 = flat, 1 = full-range edge)
+    static float edge_strength(const std::vector<Vector3>& lab, int x, int y, int width, int height) {
+        auto lightness = [&](int sx, int sy) {
+            sx = std::clamp(sx, 0, width - 1);
+            sy = std::clamp(sy, 0, height - 1);
+            return lab[static_cast<size_t>(sy) * width + sx].x;
+        };
+        float gx = (lightness(x + 1, y - 1) + 2.0f * lightness(x + 1, y) + lightness(x + 1, y + 1)) -
+                   (lightness(x - 1, y - 1) + 2.0f * lightness(x - 1, y) + lightness(x - 1, y + 1));
+        float gy = (lightness(x - 1, y + 1) + 2.0f * lightness(x, y + 1) + lightness(x + 1, y + 1)) -
+                   (lightness(x - 1, y - 1) + 2.0f * lightness(x, y - 1) + lightness(x + 1, y - 1));
+        // Maximum Sobel response for a 0→100 step is 400
+        return std::sqrt(gx * gx + gy * gy) / 400.0f;
+    }
+};
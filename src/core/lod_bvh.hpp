@@ -0,0 +1,595 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "../materials/material_base.hpp"
+#include "../materials/lambert.hpp"
+#include "huge_pages.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Ray cone: footprint of a ray (pixel) growing linearly with distance
+// Educational focus: how big a pixel is at distance t, used to select level of detail
+//   footprint(t) = width + spread_angle * t
+// For a pinhole camera width = 0 and spread_angle = Camera::pixel_spread_angle() (one pixel's angle)
+// Reference: Akenine-Möller et al., "Texture Level of Detail Strategies for Real-Time Ray Tracing" (Ray Tracing Gems, 2019)
+struct RayCone {
+    float width;          // Footprint diameter at the ray origin
+    float spread_angle;   // Growth of the footprint per unit distance (radians)
+
+    RayCone(float cone_width = 0.0f, float cone_spread = 0.0f) : width(cone_width), spread_angle(cone_spread) {}
+
+    float footprint(float t) const { return width + spread_angle * t; }
+};
+
+// Bounding volume hierarchy over scene spheres with level-of-detail proxies
+// Educational focus: replacing O(n) ray-scene tests with O(log n) traversal, and skipping
+// sub-pixel geometry entirely by intersecting a cluster's aggregate instead of its members
+//
+// Structure:
+//   - Binary tree built top-down by median split of sphere centers along the widest axis
+//   - Every node stores an AABB (traversal culling) and an aggregate proxy:
+//       bounding sphere enclosing all member spheres
+//       averaged material: Lambert with the surface-area weighted mean base color of the members
+//
+// LOD traversal rule (screen-space error threshold ε in pixels):
+//   t_near    = max(|C - O| - R, 0)                 nearest possible distance to the node
+//   size_px   = 2R / footprint(t_near)              node diameter measured in pixel footprints
+//   size_px ≤ ε  →  intersect the proxy sphere instead of descending
+// ε = 0 disables proxies (exact traversal, identical hits to linear Scene::intersect)
+//
+// Lazy construction (time-to-first-pixel proportional to visible complexity):
+//   The node layout is fixed before any geometry is examined. With median splits the subtree of
+//   a node holding c spheres always has size(c) = 1 (c ≤ leaf size) or 1 + size(⌊c/2⌋) + size(⌈c/2⌉)
+//   nodes, so the depth-first index of every node is known up front (left = i + 1,
+//   right = i + 1 + size(left)) and the node array can be allocated once and never moves.
+//   Only the top `eager_depth` levels are split at build time; a deeper interior node is split
+//   (partition its index range, compute both children's bounds) the first time a ray reaches it.
+//   One-time expansion per node: an atomic state (unexpanded → expanding → expanded) elects a single
+//   builder; other threads reaching the node wait for it. Subtrees write disjoint index ranges, so
+//   expansions of different nodes run concurrently. Subtrees no ray enters are never built.
+//
+// Traversal state of an in-flight ray (matters for wide batches, where every ray keeps its own):
+//   stack:      pending far children, a conventional fixed 64-entry stack (260 bytes)
+//   stackless:  current node + entry direction (8 bytes); the next node follows from the parent
+//               links and the per-ray child order, at the price of climbing back through parents
+//
+// The BVH stores primitive indices only: it is built from and queried against the same
+// primitives/materials containers, which must not change while the BVH is in use.
+class LodBVH {
+public:
+    // Closest hit found by traversal (primitive_index = -1 for proxy hits)
+    struct Hit {
+        bool hit = false;
+        float t = std::numeric_limits<float>::max();
+        Point3 point;
+        Vector3 normal;
+        const Material* material = nullptr;
+        int primitive_index = -1;
+    };
+
+    // Stack: pending far children on a per-ray stack (the conventional traversal)
+    // Stackless: parent links and the direction a node was entered from (see stackless_step)
+    enum class Traversal { Stack, Stackless };
+
+    // Default eager depth of a lazy build: 2^6 = 64 unexpanded subtrees below the eager top levels
+    static constexpr int default_eager_depth = 6;
+
+    // lazy = false builds the whole tree; lazy = true splits only the top eager_depth levels now
+    LodBVH(const std::vector<Sphere>& primitives, const std::vector<std::unique_ptr<Material>>& materials,
+           bool lazy = false, int eager_depth = default_eager_depth) : lazy_build(lazy) {
+        int count = static_cast<int>(primitives.size());
+        indices.resize(primitives.size());
+        for (int i = 0; i < count; i++) indices[i] = i;
+        if (count == 0) return;
+
+        // Fixed layout: every node slot and proxy material exists before construction starts
+        std::map<int, int> size_cache;
+        nodes.resize(subtree_size(count, size_cache));
+        proxy_materials.resize(nodes.size());
+        node_states.reset(new std::atomic<unsigned char>[nodes.size()]);
+        for (size_t i = 0; i < nodes.size(); i++) node_states[i].store(unexpanded, std::memory_order_relaxed);
+        max_depth = tree_depth(count);
+
+        compute_bounds(0, -1, 0, count, primitives, materials);
+        expand_recursive(0, 1, lazy ? eager_depth : max_depth, primitives, materials);
+    }
+
+    // Closest hit along ray; proxies are used where the cone footprint makes a node smaller than ε pixels
+    // primitive_tests counts exact ray-sphere tests (for Scene statistics)
+    Hit intersect(const Ray& ray, const RayCone& cone, float error_threshold_pixels,
+                  const std::vector<Sphere>& primitives, const std::vector<std::unique_ptr<Material>>& materials,
+                  int& primitive_tests) const {
+        Hit closest;
+        if (nodes.empty()) return closest;
+
+        RayQuery query(ray, cone, error_threshold_pixels);
+        int stack[128];   // Median splits keep depth ≈ log2(n / leaf size), far below this bound
+        int stack_size = 0;
+        stack[stack_size++] = 0;
+        long long visits = 0, proxies = 0;
+
+        while (stack_size > 0) {
+            int node_index = stack[--stack_size];
+            visits++;
+            if (visit(node_index, query, primitives, materials, closest, primitive_tests, proxies) == Visit::Skip) continue;
+
+            // Interior: visit the nearer child first (pushed last) so closest.t shrinks early
+            const Node& node = nodes[node_index];
+            stack[stack_size++] = far_child(node, ray);
+            stack[stack_size++] = near_child(node, ray);
+        }
+
+        node_visits.fetch_add(visits, std::memory_order_relaxed);
+        proxy_hits.fetch_add(proxies, std::memory_order_relaxed);
+        return closest;
+    }
+
+    // Same query without a stack: the traversal state is one node index and where it was entered from
+    Hit intersect_stackless(const Ray& ray, const RayCone& cone, float error_threshold_pixels,
+                            const std::vector<Sphere>& primitives, const std::vector<std::unique_ptr<Material>>& materials,
+                            int& primitive_tests) const {
+        Hit closest;
+        if (nodes.empty()) return closest;
+
+        RayQuery query(ray, cone, error_threshold_pixels);
+        StacklessCursor cursor;
+        long long visits = 0, proxies = 0;
+        while (stackless_step(cursor, query, primitives, materials, closest, primitive_tests, proxies)) {
+            visits++;
+        }
+
+        node_visits.fetch_add(visits, std::memory_order_relaxed);
+        proxy_hits.fetch_add(proxies, std::memory_order_relaxed);
+        return closest;
+    }
+
+    // Wide batch: every ray is in flight at once and advances one node visit per round, so each
+    // ray's traversal state must be stored between visits (exact traversal, no proxies)
+    void intersect_batch(const std::vector<Ray>& rays, Traversal traversal,
+                         const std::vector<Sphere>& primitives, const std::vector<std::unique_ptr<Material>>& materials,
+                         std::vector<Hit>& hits, int& primitive_tests) const {
+        hits.assign(rays.size(), Hit());
+        if (nodes.empty()) return;
+
+        std::vector<RayQuery> queries;
+        queries.reserve(rays.size());
+        for (const Ray& ray : rays) queries.emplace_back(ray, RayCone(), 0.0f);
+        std::vector<int> active(rays.size());
+        for (size_t i = 0; i < rays.size(); i++) active[i] = static_cast<int>(i);
+        long long visits = 0, proxies = 0;
+
+        if (traversal == Traversal::Stack) {
+            std::vector<StackCursor> cursors(rays.size());
+            while (!active.empty()) {
+                size_t still_active = 0;
+                for (int i : active) {
+                    if (stack_step(cursors[i], queries[i], primitives, materials, hits[i], primitive_tests, proxies)) {
+                        visits++;
+                        active[still_active++] = i;
+                    }
+                }
+                active.resize(still_active);
+            }
+        } else {
+            std::vector<StacklessCursor> cursors(rays.size());
+            while (!active.empty()) {
+                size_t still_active = 0;
+                for (int i : active) {
+                    if (stackless_step(cursors[i], queries[i], primitives, materials, hits[i], primitive_tests, proxies)) {
+                        visits++;
+                        active[still_active++] = i;
+                    }
+                }
+                active.resize(still_active);
+            }
+        }
+        node_visits.fetch_add(visits, std::memory_order_relaxed);
+    }
+
+    // Traversal with a caller-supplied node test, for queries that are not one ray (e.g. a shadow ray
+    // bundle culls a node for all of its rays at once, see shadow_bundle.hpp)
+    //   enter(box_min, box_max): false skips the node's subtree
+    //   leaf(primitive_index):   called for every sphere of an entered leaf; false ends the traversal
+    // Returns the number of nodes visited
+    template <typename Enter, typename Leaf>
+    long long traverse(Enter enter, Leaf leaf, const std::vector<Sphere>& primitives,
+                       const std::vector<std::unique_ptr<Material>>& materials) const {
+        if (nodes.empty()) return 0;
+        int stack[128];
+        int stack_size = 0;
+        stack[stack_size++] = 0;
+        long long visits = 0;
+        bool done = false;
+
+        while (stack_size > 0 && !done) {
+            int node_index = stack[--stack_size];
+            visits++;
+            const Node& node = nodes[node_index];
+            if (!enter(node.box_min, node.box_max)) continue;
+            if (node.count <= max_leaf_size) {
+                for (int i = node.first; i < node.first + node.count && !done; i++) {
+                    done = !leaf(indices[i]);
+                }
+                continue;
+            }
+            if (node_states[node_index].load(std::memory_order_acquire) != expanded) {
+                expand(node_index, primitives, materials);
+            }
+            stack[stack_size++] = node.right;
+            stack[stack_size++] = node.left;
+        }
+
+        node_visits.fetch_add(visits, std::memory_order_relaxed);
+        return visits;
+    }
+
+    // Bytes of traversal state each in-flight ray keeps between node visits
+    static size_t traversal_state_bytes(Traversal traversal) {
+        return traversal == Traversal::Stack ? sizeof(StackCursor) : sizeof(StacklessCursor);
+    }
+
+    // Move node and index arrays into huge-page advised memory (see huge_pages.hpp)
+    void use_huge_pages(HugePages::Statistics& stats) {
+        HugePages::rehome(nodes, "BVH nodes", stats);
+        HugePages::rehome(indices, "BVH primitive indices", stats);
+    }
+
+    size_t memory_usage_bytes() const {
+        return nodes.size() * sizeof(Node) + indices.size() * sizeof(int) + proxy_materials.size() * sizeof(LambertMaterial);
+    }
+
+    // memory_usage_bytes() of a BVH over sphere_count spheres, known before building it (see MemoryPlanner)
+    static size_t estimate_memory_bytes(size_t sphere_count) {
+        if (sphere_count == 0) return 0;
+        std::map<int, int> size_cache;
+        size_t node_total = static_cast<size_t>(subtree_size(static_cast<int>(sphere_count), size_cache));
+        return node_total * (sizeof(Node) + sizeof(LambertMaterial)) + sphere_count * sizeof(int);
+    }
+
+    int node_count() const { return static_cast<int>(nodes.size()); }
+    int depth() const { return max_depth; }
+    bool lazy() const { return lazy_build; }
+
+    // Interior nodes split so far (all of them after an eager build)
+    int expanded_node_count() const { return expanded_nodes.load(); }
+    int interior_node_count() const { return static_cast<int>(nodes.size()) / 2; }
+
+    // Aggregate proxy of a node (root = 0), exposed for validation
+    float proxy_radius(int node) const { return nodes[node].sphere_radius; }
+    Vector3 proxy_center(int node) const { return nodes[node].sphere_center; }
+    const Material& proxy_material(int node) const { return proxy_materials[nodes[node].proxy_material]; }
+
+    mutable std::atomic<long long> node_visits{0};
+    mutable std::atomic<long long> proxy_hits{0};
+
+    void print_statistics() const {
+        std::cout << "\n=== LOD BVH Statistics ===" << std::endl;
+        std::cout << "Primitives: " << indices.size() << ", nodes: " << nodes.size() << ", depth: " << max_depth << std::endl;
+        std::cout << "Node visits: " << node_visits << ", proxy hits: " << proxy_hits << std::endl;
+        if (lazy_build) {
+            std::cout << "Lazy construction: " << expanded_nodes << " of " << interior_node_count()
+                      << " interior nodes expanded (" << expansion_nanoseconds / 1e6 << " ms building)" << std::endl;
+        }
+    }
+
+private:
+    struct Node {
+        Vector3 box_min, box_max;
+        Vector3 sphere_center;
+        float sphere_radius = 0.0f;
+        Vector3 average_color;
+        int proxy_material = -1;
+        int left = -1, right = -1;   // Interior children (valid once expanded)
+        int parent = -1;             // Set with the bounds, so it is valid wherever a ray can be
+        int first = 0, count = 0;    // Range in indices (count ≤ max_leaf_size marks a leaf)
+        int split_axis = 0;
+    };
+
+    static constexpr int max_leaf_size = 4;
+    static constexpr int batch_stack_capacity = 64;   // Conventional fixed stack of a batched ray
+
+    // Per-ray constants of one query: inverse direction for the slab test, LOD rule coefficients
+    struct RayQuery {
+        Ray ray;
+        Vector3 inverse_direction;
+        Vector3 origin;
+        bool use_lod;
+        float lod_scale, lod_offset;
+
+        RayQuery(const Ray& query_ray, const RayCone& cone, float error_threshold_pixels)
+            : ray(query_ray),
+              inverse_direction(1.0f / query_ray.direction.x, 1.0f / query_ray.direction.y, 1.0f / query_ray.direction.z),
+              origin(query_ray.origin.x, query_ray.origin.y, query_ray.origin.z),
+              use_lod(error_threshold_pixels > 0.0f && cone.spread_angle > 0.0f),
+              lod_scale(use_lod ? 1.0f / (error_threshold_pixels * cone.spread_angle) : 0.0f),
+              lod_offset(use_lod ? cone.width / cone.spread_angle : 0.0f) {}
+    };
+
+    enum class Visit { Skip, Descend };
+
+    struct StackCursor {
+        int size = 1;
+        int entries[batch_stack_capacity] = {0};   // Root pending
+    };
+
+    // Stackless traversal (Hapala et al., "Efficient Stack-less BVH Traversal for Ray Tracing", 2011)
+    //   from_parent:  entered as the near child → on skip go to the sibling (far child)
+    //   from_sibling: entered as the far child  → on skip go back up to the parent
+    //   from_child:   returning upwards → if we came from the near child go to its sibling,
+    //                 otherwise keep climbing; reaching the root ends the traversal
+    // Children are ordered per ray exactly like the stack traversal, so both visit the same nodes
+    // in the same order and find the same closest hit.
+    enum From : int { from_parent, from_sibling, from_child };
+
+    struct StacklessCursor {
+        int node = 0;
+        int from = from_sibling;   // The root has no sibling: skipping it climbs past the root and ends
+    };
+    static constexpr unsigned char unexpanded = 0, expanding = 1, expanded = 2;
+
+    // Mutable: lazy expansion fills preallocated slots during const traversal (see expand())
+    mutable std::vector<Node> nodes;
+    mutable std::vector<int> indices;
+    mutable std::vector<LambertMaterial> proxy_materials;
+    std::unique_ptr<std::atomic<unsigned char>[]> node_states;
+    mutable std::atomic<int> expanded_nodes{0};
+    mutable std::atomic<long long> expansion_nanoseconds{0};
+    bool lazy_build = false;
+    int max_depth = 0;
+
+    static float axis_value(const Vector3& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    // Bounds, aggregate proxy and split axis of the node covering indices [first, first + count)
+    // Runs before the node becomes reachable: by the constructor (root) or the parent's expansion
+    void compute_bounds(int node_index, int parent, int first, int count,
+                        const std::vector<Sphere>& primitives, const std::vector<std::unique_ptr<Material>>& materials) const {
+        float inf = std::numeric_limits<float>::max();
+        Vector3 box_min(inf, inf, inf), box_max(-inf, -inf, -inf);
+        Vector3 centroid_min = box_min, centroid_max = box_max;
+        Vector3 color_sum(0, 0, 0);
+        float area_sum = 0.0f;
+        for (int i = first; i < first + count; i++) {
+            const Sphere& sphere = primitives[indices[i]];
+            Vector3 c(sphere.center.x, sphere.center.y, sphere.center.z);
+            Vector3 r(sphere.radius, sphere.radius, sphere.radius);
+            box_min = component_min(box_min, c - r);
+            box_max = component_max(box_max, c + r);
+            centroid_min = component_min(centroid_min, c);
+            centroid_max = component_max(centroid_max, c);
+            float area = sphere.radius * sphere.radius;
+            if (sphere.material_index >= 0 && sphere.material_index < static_cast<int>(materials.size())) {
+                color_sum += materials[sphere.material_index]->base_color * area;
+                area_sum += area;
+            }
+        }
+
+        // Bounding sphere around the box center enclosing every member sphere
+        Vector3 center = (box_min + box_max) * 0.5f;
+        float radius = 0.0f;
+        for (int i = first; i < first + count; i++) {
+            const Sphere& sphere = primitives[indices[i]];
+            Vector3 c(sphere.center.x, sphere.center.y, sphere.center.z);
+            radius = std::max(radius, (c - center).length() + sphere.radius);
+        }
+
+        Node& node = nodes[node_index];
+        node.box_min = box_min;
+        node.box_max = box_max;
+        node.sphere_center = center;
+        node.sphere_radius = radius;
+        node.average_color = area_sum > 0.0f ? color_sum * (1.0f / area_sum) : Vector3(0.5f, 0.5f, 0.5f);
+        node.first = first;
+        node.count = count;
+        node.parent = parent;
+        node.proxy_material = node_index;
+        proxy_materials[node_index] = LambertMaterial(node.average_color);
+
+        // Split along the widest centroid axis
+        Vector3 extent = centroid_max - centroid_min;
+        node.split_axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        if (count <= max_leaf_size) {
+            node_states[node_index].store(expanded, std::memory_order_relaxed);   // Leaves need no split
+        }
+    }
+
+    // One-time split of an interior node; concurrent callers wait for the elected builder
+    void expand(int node_index, const std::vector<Sphere>& primitives,
+                const std::vector<std::unique_ptr<Material>>& materials) const {
+        unsigned char state = unexpanded;
+        if (node_states[node_index].compare_exchange_strong(state, expanding, std::memory_order_acquire)) {
+            auto start = std::chrono::steady_clock::now();
+            Node& node = nodes[node_index];
+            int axis = node.split_axis;
+            int middle = node.first + node.count / 2;
+            std::nth_element(indices.begin() + node.first, indices.begin() + middle, indices.begin() + node.first + node.count,
+                             [&](int a, int b) {
+                                 const Point3& ca = primitives[a].center;
+                                 const Point3& cb = primitives[b].center;
+                                 return axis_value(Vector3(ca.x, ca.y, ca.z), axis) < axis_value(Vector3(cb.x, cb.y, cb.z), axis);
+                             });
+            std::map<int, int> size_cache;
+            int left = node_index + 1;
+            int right = left + subtree_size(middle - node.first, size_cache);
+            compute_bounds(left, node_index, node.first, middle - node.first, primitives, materials);
+            compute_bounds(right, node_index, middle, node.first + node.count - middle, primitives, materials);
+            node.left = left;
+            node.right = right;
+            expanded_nodes.fetch_add(1, std::memory_order_relaxed);
+            expansion_nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+            node_states[node_index].store(expanded, std::memory_order_release);
+            return;
+        }
+        while (node_states[node_index].load(std::memory_order_acquire) != expanded) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Split every interior node in levels 1..max_expand_depth (root depth = 1)
+    void expand_recursive(int node_index, int depth, int max_expand_depth, const std::vector<Sphere>& primitives,
+                          const std::vector<std::unique_ptr<Material>>& materials) {
+        if (depth > max_expand_depth || nodes[node_index].count <= max_leaf_size) return;
+        expand(node_index, primitives, materials);
+        expand_recursive(nodes[node_index].left, depth + 1, max_expand_depth, primitives, materials);
+        expand_recursive(nodes[node_index].right, depth + 1, max_expand_depth, primitives, materials);
+    }
+
+    // Node count of a median-split subtree over `count` spheres (≤ 2 distinct counts per level)
+    static int subtree_size(int count, std::map<int, int>& cache) {
+        if (count <= max_leaf_size) return 1;
+        auto cached = cache.find(count);
+        if (cached != cache.end()) return cached->second;
+        int size = 1 + subtree_size(count / 2, cache) + subtree_size(count - count / 2, cache);
+        cache[count] = size;
+        return size;
+    }
+
+    static int tree_depth(int count) {
+        return count <= max_leaf_size ? 1 : 1 + tree_depth(count - count / 2);
+    }
+
+    static Vector3 component_min(const Vector3& a, const Vector3& b) {
+        return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    }
+
+    static Vector3 component_max(const Vector3& a, const Vector3& b) {
+        return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    }
+
+    // Children in the ray's visiting order along the split axis (same rule for every traversal)
+    static int near_child(const Node& node, const Ray& ray) {
+        return axis_value(ray.direction, node.split_axis) < 0.0f ? node.right : node.left;
+    }
+
+    static int far_child(const Node& node, const Ray& ray) {
+        return axis_value(ray.direction, node.split_axis) < 0.0f ? node.left : node.right;
+    }
+
+    // Test one node: culled, replaced by its proxy, or a leaf all end here (Skip); an interior
+    // node is split on first visit (lazy build) and its children should be visited (Descend)
+    Visit visit(int node_index, const RayQuery& query, const std::vector<Sphere>& primitives,
+                const std::vector<std::unique_ptr<Material>>& materials, Hit& closest, int& primitive_tests,
+                long long& proxies) const {
+        const Node& node = nodes[node_index];
+        const Ray& ray = query.ray;
+        if (!hit_box(node, ray, query.inverse_direction, closest.t)) return Visit::Skip;
+
+        // Level of detail: node smaller than the error threshold at its nearest distance
+        // Rearranged to avoid a square root: 2R ≤ ε (w + s t_near)  ⇔  t_near ≥ (2R/ε - w) / s
+        if (query.use_lod && node.count != 1) {
+            Vector3 to_center = node.sphere_center - query.origin;
+            float required_t = 2.0f * node.sphere_radius * query.lod_scale - query.lod_offset;
+            float required_distance = std::max(required_t, 0.0f) + node.sphere_radius;
+            if (to_center.length_squared() >= required_distance * required_distance) {
+                Sphere proxy(Point3(node.sphere_center.x, node.sphere_center.y, node.sphere_center.z), node.sphere_radius, -1);
+                Sphere::Intersection proxy_hit = proxy.intersect(ray, false);
+                if (proxy_hit.hit && proxy_hit.t > 0.001f && proxy_hit.t < closest.t) {
+                    closest.hit = true;
+                    closest.t = proxy_hit.t;
+                    closest.point = proxy_hit.point;
+                    closest.normal = proxy_hit.normal;
+                    closest.material = &proxy_materials[node.proxy_material];
+                    closest.primitive_index = -1;
+                    proxies++;
+                }
+                return Visit::Skip;
+            }
+        }
+
+        if (node.count <= max_leaf_size) {
+            // Leaf: exact tests with the same acceptance rule as Scene::intersect
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const Sphere& sphere = primitives[indices[i]];
+                primitive_tests++;
+                Sphere::Intersection sphere_hit = sphere.intersect(ray, false);
+                if (sphere_hit.hit && sphere_hit.t > 0.001f && sphere_hit.t < closest.t &&
+                    sphere.material_index >= 0 && sphere.material_index < static_cast<int>(materials.size())) {
+                    closest.hit = true;
+                    closest.t = sphere_hit.t;
+                    closest.point = sphere_hit.point;
+                    closest.normal = sphere_hit.normal;
+                    closest.material = materials[sphere.material_index].get();
+                    closest.primitive_index = indices[i];
+                }
+            }
+            return Visit::Skip;
+        }
+
+        if (node_states[node_index].load(std::memory_order_acquire) != expanded) {
+            expand(node_index, primitives, materials);
+        }
+        return Visit::Descend;
+    }
+
+    // One node visit of a stack traversal; false once the stack is empty
+    bool stack_step(StackCursor& cursor, const RayQuery& query, const std::vector<Sphere>& primitives,
+                    const std::vector<std::unique_ptr<Material>>& materials, Hit& closest, int& primitive_tests,
+                    long long& proxies) const {
+        if (cursor.size == 0) return false;
+        int node_index = cursor.entries[--cursor.size];
+        if (visit(node_index, query, primitives, materials, closest, primitive_tests, proxies) == Visit::Descend) {
+            const Node& node = nodes[node_index];
+            cursor.entries[cursor.size++] = far_child(node, query.ray);
+            cursor.entries[cursor.size++] = near_child(node, query.ray);
+        }
+        return true;
+    }
+
+    // One node visit of a stackless traversal; false once the traversal climbed back past the root
+    bool stackless_step(StacklessCursor& cursor, const RayQuery& query, const std::vector<Sphere>& primitives,
+                        const std::vector<std::unique_ptr<Material>>& materials, Hit& closest, int& primitive_tests,
+                        long long& proxies) const {
+        // Climb without visiting until a far sibling is due
+        while (cursor.from == from_child) {
+            if (cursor.node <= 0) return false;
+            const Node& parent = nodes[nodes[cursor.node].parent];
+            if (cursor.node == near_child(parent, query.ray)) {
+                cursor.node = far_child(parent, query.ray);
+                cursor.from = from_sibling;
+            } else {
+                cursor.node = nodes[cursor.node].parent;
+            }
+        }
+
+        if (visit(cursor.node, query, primitives, materials, closest, primitive_tests, proxies) == Visit::Descend) {
+            cursor.node = near_child(nodes[cursor.node], query.ray);
+            cursor.from = from_parent;
+        } else if (cursor.from == from_parent) {
+            cursor.node = far_child(nodes[nodes[cursor.node].parent], query.ray);
+            cursor.from = from_sibling;
+        } else {
+            cursor.node = nodes[cursor.node].parent;
+            cursor.from = from_child;
+        }
+        return true;
+    }
+
+    // Slab test: ray enters the node box before t_max
+    static bool hit_box(const Node& node, const Ray& ray, const Vector3& inverse_direction, float t_max) {
+        float t0 = 0.0f, t1 = t_max;
+        for (int axis = 0; axis < 3; axis++) {
+            float origin = axis == 0 ? ray.origin.x : (axis == 1 ? ray.origin.y : ray.origin.z);
+            float inverse = axis_value(inverse_direction, axis);
+            float t_low = (axis_value(node.box_min, axis) - origin) * inverse;
+            float t_high = (axis_value(node.box_max, axis) - origin) * inverse;
+            if (t_low > t_high) std::swap(t_low, t_high);
+            t0 = std::max(t0, t_low);
+            t1 = std::min(t1, t_high);
+            if (t0 > t1) return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,240 @@
+#pragma once
+#include "vector3.hpp"
+#include "lod_bvh.hpp"
+#include "cpu_budget.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// MemoryPlanner chooses render representations that fit a memory budget before anything is allocated
+// Educational focus: estimate first, then trade memory for speed instead of running out of it
+//
+// The budget comes from --memory-budget or, inside a container, from the cgroup v2 memory.max limit
+// (smallest over the process's cgroup and its ancestors, like CpuBudget's cpu.max). The planner
+// estimates every large allocation of the requested render:
+//   scene               Scene::calculate_scene_memory_usage()
+//   BVH                 LodBVH::estimate_memory_bytes() (exact: the node layout is fixed up front)
+//   visibility buffer   sphere index + depth per pixel, plus the tile bins (PrimaryRasterizer)
+//   float framebuffer   one Vector3 per pixel (path tracing accumulates in place in the same buffer)
+//   rows in flight      8-bit rows of the QOI bands being converted at the same time
+//   output encoding     PNG: 8-bit image, stb's filtered copy, deflate output and file buffer, each
+//                       at most the raw size; QOI: band streams and the joined file, 4 bytes per
+//                       pixel each in the worst case (every pixel a literal)
+//   runtime reserve     executable, C++ runtime and thread stacks
+// Encoded sizes use worst cases, so a plan that fits cannot be broken by an incompressible image.
+//
+// If the total exceeds the budget, representations change one at a time, cheapest first, until it fits:
+//   1. primary rays traced instead of the rasterized visibility buffer (as without --raster-primary)
+//   2. more, smaller QOI bands (down to 16 rows): fewer rows in flight, a few bytes of output per band
+//   3. streamed output: rows are rendered straight into the encoder (Image::save_streamed), so no
+//      float framebuffer exists (same file; direct lighting of scene files only, without the
+//      progress, cache and monitoring features of the scanline loop)
+//   4. linear intersection instead of the BVH (exact, much slower for large scenes)
+// A plan that still does not fit is reported as an error before rendering instead of failing midway.
+class MemoryPlanner {
+public:
+    // The render the command line asked for
+    struct Request {
+        int width = 0, height = 0;
+        size_t scene_bytes = 0;
+        size_t sphere_count = 0;
+        bool path_tracing = false;
+        bool bvh = false;
+        bool raster_primary = false;
+        bool qoi_output = false;
+        int qoi_bands = 0;                 // 0 = one per thread
+        int threads = 0;                   // 0 = CpuBudget::default_thread_count()
+        bool streaming_allowed = false;    // Direct lighting of a scene file, single image, no cache or monitoring
+    };
+
+    struct Component {
+        std::string name;
+        size_t bytes = 0;
+    };
+
+    struct Plan {
+        size_t budget_bytes = 0;
+        std::string budget_source;
+        size_t requested_bytes = 0;        // Estimate of the render as requested
+        bool fits = false;
+        // Chosen representations
+        bool bvh = false;
+        bool raster_primary = false;
+        bool streamed_output = false;
+        int qoi_bands = 0;
+        std::vector<Component> components;
+        std::vector<std::string> changes;  // Representation changes against the request, in order
+
+        size_t total_bytes() const {
+            size_t total = 0;
+            for (const Component& component : components) total += component.bytes;
+            return total;
+        }
+
+        void print() const {
+            std::cout << "\n=== Memory Plan ===" << std::endl;
+            std::cout << "Budget: " << megabytes(budget_bytes) << " MB (" << budget_source << ")" << std::endl;
+            for (const Component& component : components) {
+                if (component.bytes == 0) continue;
+                std::cout << "  " << component.name << ": " << megabytes(component.bytes) << " MB" << std::endl;
+            }
+            std::cout << "Estimated peak: " << megabytes(total_bytes()) << " MB of " << megabytes(budget_bytes) << " MB";
+            if (requested_bytes != total_bytes()) {
+                std::cout << " (as requested: " << megabytes(requested_bytes) << " MB)";
+            }
+            std::cout << std::endl;
+            if (changes.empty()) {
+                std::cout << "Representations: as requested" << std::endl;
+            }
+            for (const std::string& change : changes) {
+                std::cout << "Plan: " << change << std::endl;
+            }
+            if (!fits) {
+                std::cout << "Plan: does not fit even with every fallback" << std::endl;
+            }
+        }
+    };
+
+    static constexpr size_t runtime_reserve_bytes = 16u << 20;
+    static constexpr int raster_tile_size = 16;            // PrimaryRasterizer::Settings default, also the
+                                                           // smallest QOI band height the planner chooses
+    static constexpr size_t raster_tiles_per_sphere = 4;   // A sphere smaller than a tile overlaps up to 4
+
+    // Parse a size such as "1048576", "512M", "1.5G" or "2GiB" (binary units)
+    static bool parse_size(const std::string& text, size_t& bytes) {
+        char* end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || value <= 0.0) {
+            return false;
+        }
+        std::string unit(end);
+        for (char& c : unit) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (unit.size() > 1 && (unit.substr(1) == "B" || unit.substr(1) == "IB")) unit = unit.substr(0, 1);
+        double scale = 1.0;
+        if (unit == "K") scale = 1024.0;
+        else if (unit == "M") scale = 1024.0 * 1024.0;
+        else if (unit == "G") scale = 1024.0 * 1024.0 * 1024.0;
+        else if (unit == "T") scale = 1024.0 * 1024.0 * 1024.0 * 1024.0;
+        else if (!unit.empty() && unit != "B") return false;
+        bytes = static_cast<size_t>(value * scale);
+        return bytes > 0;
+    }
+
+    // Smallest cgroup v2 memory.max over the process's cgroup and its ancestors, 0 without a limit
+    static size_t cgroup_memory_limit(std::string& source, const std::string& cgroup_mount = "/sys/fs/cgroup",
+                                      const std::string& proc_cgroup_file = "/proc/self/cgroup") {
+        std::string cgroup_path = CpuBudget::cgroup_v2_path(proc_cgroup_file);
+        if (cgroup_path.empty()) return 0;
+        size_t smallest = 0;
+        for (const std::string& directory : CpuBudget::cgroup_directories(cgroup_mount, cgroup_path)) {
+            std::ifstream memory_max(directory + "memory.max");
+            std::string line;
+            if (!std::getline(memory_max, line) || line.empty() || !std::isdigit(static_cast<unsigned char>(line[0]))) {
+                continue;   // Missing, or "max"
+            }
+            size_t limit = std::strtoull(line.c_str(), nullptr, 10);
+            if (limit > 0 && (smallest == 0 || limit < smallest)) {
+                smallest = limit;
+                source = directory + "memory.max";
+            }
+        }
+        return smallest;
+    }
+
+    // Footprint of the request with the representations chosen in plan
+    static std::vector<Component> estimate(const Request& request, const Plan& plan) {
+        size_t pixels = static_cast<size_t>(request.width) * request.height;
+        size_t raw_rgb = pixels * 3;
+        std::vector<Component> components;
+        components.push_back({"scene", request.scene_bytes});
+        components.push_back({"BVH", plan.bvh ? LodBVH::estimate_memory_bytes(request.sphere_count) : 0});
+        size_t visibility = 0;
+        if (plan.raster_primary) {
+            size_t tiles = static_cast<size_t>((request.width + raster_tile_size - 1) / raster_tile_size) *
+                           ((request.height + raster_tile_size - 1) / raster_tile_size);
+            visibility = pixels * (sizeof(int) + sizeof(float)) + tiles * sizeof(std::vector<int>) +
+                         request.sphere_count * raster_tiles_per_sphere * sizeof(int);
+        }
+        components.push_back({"visibility buffer", visibility});
+        components.push_back({"float framebuffer", plan.streamed_output ? 0 : pixels * sizeof(Vector3)});
+        if (request.qoi_output) {
+            int threads = request.threads > 0 ? request.threads : CpuBudget::default_thread_count();
+            int bands = std::max(1, std::min(plan.qoi_bands > 0 ? plan.qoi_bands : threads, request.height));
+            size_t band_rows = static_cast<size_t>((request.height + bands - 1) / bands);
+            size_t in_flight = static_cast<size_t>(std::max(1, std::min(threads, bands)));
+            components.push_back({"rows in flight", in_flight * band_rows * request.width * 3 +
+                                                    (plan.streamed_output ? in_flight * request.width * sizeof(Vector3) : 0)});
+            components.push_back({"output encoding (QOI, worst case)", 2 * (pixels * 4 + static_cast<size_t>(bands) * 5 + 22)});
+        } else {
+            components.push_back({"output encoding (PNG, worst case)", 4 * raw_rgb});
+        }
+        components.push_back({"runtime reserve", runtime_reserve_bytes});
+        return components;
+    }
+
+    // Choose representations for the request that fit budget_bytes
+    static Plan plan(const Request& request, size_t budget_bytes, const std::string& budget_source) {
+        Plan plan;
+        plan.budget_bytes = budget_bytes;
+        plan.budget_source = budget_source;
+        plan.bvh = request.bvh;
+        plan.raster_primary = request.raster_primary && !request.path_tracing;
+        plan.qoi_bands = request.qoi_bands;
+        auto total = [&]() {
+            plan.components = estimate(request, plan);
+            return plan.total_bytes();
+        };
+        plan.requested_bytes = total();
+
+        auto change = [&](const std::string& description, size_t before) {
+            plan.changes.push_back(description + " (saves " + megabytes(before - total()) + " MB)");
+        };
+        if (total() > budget_bytes && plan.raster_primary) {
+            size_t before = plan.total_bytes();
+            plan.raster_primary = false;
+            change("traced primary rays instead of the rasterized visibility buffer", before);
+        }
+        if (total() > budget_bytes && request.qoi_output) {
+            size_t before = plan.total_bytes();
+            int threads = request.threads > 0 ? request.threads : CpuBudget::default_thread_count();
+            int bands = std::max(1, plan.qoi_bands > 0 ? plan.qoi_bands : threads);
+            // Double the bands until the total fits or bands are a tile high (smaller bands save little)
+            while (total() > budget_bytes && (request.height + bands - 1) / bands > raster_tile_size) {
+                bands = std::min(request.height, bands * 2);
+                plan.qoi_bands = bands;
+            }
+            if (plan.total_bytes() < before) {
+                change(std::to_string(plan.qoi_bands) + " QOI bands: fewer rows in flight", before);
+            } else {
+                plan.qoi_bands = request.qoi_bands;
+                total();
+            }
+        }
+        if (total() > budget_bytes && request.streaming_allowed && !request.path_tracing) {
+            size_t before = plan.total_bytes();
+            plan.streamed_output = true;
+            change("rows streamed into the encoder instead of a float framebuffer", before);
+        }
+        if (total() > budget_bytes && plan.bvh) {
+            size_t before = plan.total_bytes();
+            plan.bvh = false;
+            change("linear intersection instead of the BVH", before);
+        }
+        plan.fits = total() <= budget_bytes;
+        return plan;
+    }
+
+    // "12.3" for 12.3 MB (binary megabytes)
+    static std::string megabytes(size_t bytes) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / (1024.0 * 1024.0);
+        return text.str();
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// MetricsExporter writes live render metrics for the Prometheus node_exporter textfile collector
+// Educational focus: observing a long-running job from outside the process
+//
+// node_exporter --collector.textfile.directory=DIR scrapes every *.prom file in DIR. The exporter
+// rewrites its file every `interval_seconds` while rendering:
+//   1. write the complete exposition text to "<file>.tmp" (ignored by the collector: not *.prom)
+//   2. rename() it over "<file>": atomic on POSIX, so a scrape never sees a half-written file
+//
+// Metrics (gauges unless noted):
+//   raytracer_rays_total{type}             counter: rays traced so far (primary, indirect)
+//   raytracer_rays_per_second{type}        ray throughput over the last export interval
+//   raytracer_intersection_tests_total     counter: ray-primitive tests
+//   raytracer_tiles_done / _remaining / _total   work units (scanlines; scanlines × passes when progressive)
+//   raytracer_eta_seconds                  estimated time to completion
+//   raytracer_resident_memory_bytes        process resident set size
+//   raytracer_thread_utilization_ratio{thread}  busy time / wall time per render thread
+//   raytracer_samples_per_pixel            configured samples per pixel
+//   raytracer_samples_per_pixel_done       completed samples per pixel (progressive passes)
+//   raytracer_render_active                1 while rendering, 0 after the final write
+class MetricsExporter {
+public:
+    // Everything the exporter needs from one render loop, filled by the caller at each update
+    struct Snapshot {
+        std::map<std::string, long long> rays;   // Ray counts by type ("primary", "indirect", ...)
+        long long intersection_tests = 0;
+        int tiles_done = 0;
+        int tiles_total = 0;
+        double eta_seconds = 0.0;
+        int samples_per_pixel = 1;
+        int samples_per_pixel_done = 0;
+        std::vector<double> thread_utilization;  // One entry per render thread, 0..1
+    };
+
+    MetricsExporter(const std::string& output_path, double interval_seconds = 10.0)
+        : path(output_path), interval(interval_seconds) {
+        start_time = std::chrono::steady_clock::now();
+        last_write_time = start_time;
+    }
+
+    const std::string& output_path() const { return path; }
+    int writes() const { return write_count; }
+
+    // Rewrite the file if the export interval has elapsed; cheap to call once per scanline
+    bool due() const {
+        auto now = std::chrono::steady_clock::now();
+        return write_count == 0 || std::chrono::duration<double>(now - last_write_time).count() >= interval;
+    }
+
+    void update(const Snapshot& snapshot) {
+        if (!write_failed && due()) {
+            write(snapshot, true);
+        }
+    }
+
+    // Final write after rendering: render_active 0, ETA 0
+    void finish(const Snapshot& snapshot) {
+        if (!write_failed) {
+            write(snapshot, false);
+        }
+    }
+
+    // Write the exposition text atomically; failures are reported once and rendering continues
+    bool write(const Snapshot& snapshot, bool active) {
+        auto now = std::chrono::steady_clock::now();
+        double since_last = std::chrono::duration<double>(now - last_write_time).count();
+
+        std::string temporary_path = path + ".tmp";
+        std::ofstream file(temporary_path, std::ios::trunc);
+        if (file) {
+            file << format(snapshot, active, since_last);
+            file.close();
+        }
+        if (!file || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+            if (!write_failed) {
+                std::cout << "WARNING: Could not write metrics file " << path << " (metrics export disabled)" << std::endl;
+            }
+            write_failed = true;
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+
+        previous_rays = snapshot.rays;
+        last_write_time = now;
+        write_count++;
+        return true;
+    }
+
+    // Prometheus text exposition format (version 0.0.4)
+    std::string format(const Snapshot& snapshot, bool active, double interval_seconds) const {
+        std::ostringstream out;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+        out << "# HELP raytracer_rays_total Rays traced since the render started.\n";
+        out << "# TYPE raytracer_rays_total counter\n";
+        for (const auto& entry : snapshot.rays) {
+            out << "raytracer_rays_total{type=\"" << entry.first << "\"} " << entry.second << "\n";
+        }
+        out << "# HELP raytracer_rays_per_second Ray throughput over the last export interval.\n";
+        out << "# TYPE raytracer_rays_per_second gauge\n";
+        for (const auto& entry : snapshot.rays) {
+            auto previous = previous_rays.find(entry.first);
+            long long delta = entry.second - (previous != previous_rays.end() ? previous->second : 0);
+            double window = write_count == 0 ? elapsed : interval_seconds;
+            out << "raytracer_rays_per_second{type=\"" << entry.first << "\"} "
+                << (window > 0.0 ? delta / window : 0.0) << "\n";
+        }
+        out << "# HELP raytracer_intersection_tests_total Ray-primitive intersection tests.\n";
+        out << "# TYPE raytracer_intersection_tests_total counter\n";
+        out << "raytracer_intersection_tests_total " << snapshot.intersection_tests << "\n";
+
+        out << "# HELP raytracer_tiles_done Work units (scanlines) completed.\n";
+        out << "# TYPE raytracer_tiles_done gauge\n";
+        out << "raytracer_tiles_done " << snapshot.tiles_done << "\n";
+        out << "# HELP raytracer_tiles_remaining Work units (scanlines) still to render.\n";
+        out << "# TYPE raytracer_tiles_remaining gauge\n";
+        out << "raytracer_tiles_remaining " << std::max(0, snapshot.tiles_total - snapshot.tiles_done) << "\n";
+        out << "# HELP raytracer_tiles_total Work units (scanlines) in this render.\n";
+        out << "# TYPE raytracer_tiles_total gauge\n";
+        out << "raytracer_tiles_total " << snapshot.tiles_total << "\n";
+
+        out << "# HELP raytracer_eta_seconds Estimated time until the render completes.\n";
+        out << "# TYPE raytracer_eta_seconds gauge\n";
+        out << "raytracer_eta_seconds " << (active ? std::max(0.0, snapshot.eta_seconds) : 0.0) << "\n";
+        out << "# HELP raytracer_elapsed_seconds Time since the render started.\n";
+        out << "# TYPE raytracer_elapsed_seconds gauge\n";
+        out << "raytracer_elapsed_seconds " << elapsed << "\n";
+
+        out << "# HELP raytracer_resident_memory_bytes Resident set size of the renderer process.\n";
+        out << "# TYPE raytracer_resident_memory_bytes gauge\n";
+        out << "raytracer_resident_memory_bytes " << resident_memory_bytes() << "\n";
+
+        out << "# HELP raytracer_thread_utilization_ratio Busy time divided by wall time per render thread.\n";
+        out << "# TYPE raytracer_thread_utilization_ratio gauge\n";
+        for (size_t t = 0; t < snapshot.thread_utilization.size(); t++) {
+            out << "raytracer_thread_utilization_ratio{thread=\"" << t << "\"} "
+                << std::min(1.0, std::max(0.0, snapshot.thread_utilization[t])) << "\n";
+        }
+
+        out << "# HELP raytracer_samples_per_pixel Configured samples per pixel.\n";
+        out << "# TYPE raytracer_samples_per_pixel gauge\n";
+        out << "raytracer_samples_per_pixel " << snapshot.samples_per_pixel << "\n";
+        out << "# HELP raytracer_samples_per_pixel_done Samples per pixel completed in every pixel.\n";
+        out << "# TYPE raytracer_samples_per_pixel_done gauge\n";
+        out << "raytracer_samples_per_pixel_done " << snapshot.samples_per_pixel_done << "\n";
+
+        out << "# HELP raytracer_render_active 1 while a render is in progress.\n";
+        out << "# TYPE raytracer_render_active gauge\n";
+        out << "raytracer_render_active " << (active ? 1 : 0) << "\n";
+        return out.str();
+    }
+
+    // Current resident set size (Linux: /proc/self/statm; elsewhere: peak RSS from getrusage)
+    static size_t resident_memory_bytes() {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        size_t total_pages = 0, resident_pages = 0;
+        if (statm >> total_pages >> resident_pages) {
+            return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+        return 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss);          // bytes on macOS
+#else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;   // kilobytes elsewhere
+#endif
+#endif
+    }
+
+private:
+    std::string path;
+    double interval;
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point last_write_time;
+    std::map<std::string, long long> previous_rays;
+    int write_count = 0;
+    bool write_failed = false;
+};
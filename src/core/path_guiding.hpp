@@ -0,0 +1,318 @@
+#pragma once
+#include "vector3.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Path guiding with a spatial-directional tree (SD-tree, after Müller et al. 2017)
+// Educational focus: learning where indirect light comes from and sampling bounces accordingly
+//
+// Structure:
+//   - Spatial binary tree over the scene bounds (midpoint splits, cycling x → y → z)
+//   - Each spatial leaf holds two directional quadtrees over the sphere of directions:
+//       sampling tree: distribution learned in the previous training iteration (read-only while rendering)
+//       building tree: accumulates new radiance records during the current iteration
+//
+// Direction parameterization: cylindrical equal-area mapping of the sphere to [0,1]²
+//   u = (cos θ + 1) / 2,  v = φ / 2π     (Jacobian is constant: p_sphere(ω) = p_square(u, v) / 4π)
+//
+// Training loop (iterations double in length):
+//   1. Render a pass; each thread appends radiance records to its own GuidingRecorder (no locking)
+//   2. After the pass, merge all recorders into the building trees (single-threaded)
+//   3. At the end of an iteration: split spatial leaves with many records, then the building tree
+//      becomes the sampling tree and a refined, empty copy becomes the new building tree
+namespace PathGuiding {
+
+    // Sphere direction → equal-area unit square
+    inline void direction_to_canonical(const Vector3& direction, float& u, float& v) {
+        u = std::clamp((direction.z + 1.0f) * 0.5f, 0.0f, 1.0f);
+        float phi = std::atan2(direction.y, direction.x);
+        if (phi < 0.0f) phi += 2.0f * static_cast<float>(M_PI);
+        v = std::min(phi / (2.0f * static_cast<float>(M_PI)), 0.99999994f);
+    }
+
+    // Equal-area unit square → sphere direction
+    inline Vector3 canonical_to_direction(float u, float v) {
+        float cos_theta = 2.0f * u - 1.0f;
+        float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+        float phi = 2.0f * static_cast<float>(M_PI) * v;
+        return Vector3(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+    }
+
+    // Radiance sample deposited into the tree: incident radiance estimate L_i / pdf along direction
+    struct Record {
+        Vector3 position;
+        Vector3 direction;
+        float value;
+    };
+
+    // Per-thread record buffer; merged into the SD-tree between passes
+    class GuidingRecorder {
+    public:
+        std::vector<Record> records;
+
+        void record(const Vector3& position, const Vector3& direction, float value) {
+            if (value > 0.0f && std::isfinite(value)) {
+                records.push_back({position, direction, value});
+            }
+        }
+    };
+
+    // Quadtree over the unit square of directions
+    // Each node stores the energy of its four quadrants; child index -1 marks a leaf quadrant
+    // Quadrant q = (u >= 0.5) + 2 * (v >= 0.5)
+    class DirectionalQuadtree {
+    public:
+        struct Node {
+            float energy[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            int child[4] = {-1, -1, -1, -1};
+
+            float total() const { return energy[0] + energy[1] + energy[2] + energy[3]; }
+        };
+
+        DirectionalQuadtree() : nodes(1) {}
+
+        // Deposit energy along the path from the root to the leaf containing (u, v)
+        void record(float u, float v, float value) {
+            int node = 0;
+            while (true) {
+                int q = quadrant(u, v);
+                nodes[node].energy[q] += value;
+                if (nodes[node].child[q] < 0) break;
+                node = nodes[node].child[q];
+            }
+        }
+
+        float total_energy() const { return nodes[0].total(); }
+        int node_count() const { return static_cast<int>(nodes.size()); }
+
+        // Probability density on the unit square (uniform if the tree holds no energy)
+        float pdf(float u, float v) const {
+            float density = 1.0f;
+            int node = 0;
+            while (node >= 0) {
+                float total = nodes[node].total();
+                if (total <= 0.0f) break;
+                int q = quadrant(u, v);
+                density *= 4.0f * nodes[node].energy[q] / total;
+                node = nodes[node].child[q];
+            }
+            return density;
+        }
+
+        // Sample (u, v) proportionally to the stored energy by descending the tree
+        void sample(std::mt19937& rng, float& u, float& v) const {
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+            float origin_u = 0.0f, origin_v = 0.0f, size = 1.0f;
+            int node = 0;
+            while (node >= 0) {
+                float total = nodes[node].total();
+                int q = 3;
+                if (total > 0.0f) {
+                    float target = uniform(rng) * total;
+                    for (int i = 0; i < 3; i++) {
+                        if (target < nodes[node].energy[i]) { q = i; break; }
+                        target -= nodes[node].energy[i];
+                    }
+                    // Rounding may leave target past the last non-empty quadrant
+                    while (nodes[node].energy[q] <= 0.0f) q--;
+                } else {
+                    q = std::min(3, static_cast<int>(uniform(rng) * 4.0f));
+                }
+                size *= 0.5f;
+                origin_u += (q & 1) ? size : 0.0f;
+                origin_v += (q & 2) ? size : 0.0f;
+                node = total > 0.0f ? nodes[node].child[q] : -1;
+            }
+            // Keep the point strictly inside the chosen cell (rounding could land on its upper edge)
+            u = std::min(origin_u + uniform(rng) * size, std::nextafter(origin_u + size, origin_u));
+            v = std::min(origin_v + uniform(rng) * size, std::nextafter(origin_v + size, origin_v));
+        }
+
+        // Build an empty tree whose structure follows this tree's energy distribution
+        // Quadrants holding more than subdivision_threshold of the total energy are subdivided,
+        // quadrants below it are collapsed; max_depth bounds the resolution (4^-depth of the square)
+        DirectionalQuadtree refined(float subdivision_threshold, int max_depth) const {
+            DirectionalQuadtree result;
+            float total = total_energy();
+            if (total <= 0.0f) {
+                return result;
+            }
+            refine_node(result, 0, 0, total, subdivision_threshold * total, 1, max_depth);
+            return result;
+        }
+
+    private:
+        std::vector<Node> nodes;
+
+        static int quadrant(float& u, float& v) {
+            int q = 0;
+            if (u >= 0.5f) { q |= 1; u = u * 2.0f - 1.0f; } else { u *= 2.0f; }
+            if (v >= 0.5f) { q |= 2; v = v * 2.0f - 1.0f; } else { v *= 2.0f; }
+            return q;
+        }
+
+        // source: node in this tree (or -1 when subdividing beyond the old structure, energy spread evenly)
+        void refine_node(DirectionalQuadtree& result, int result_node, int source, float node_energy,
+                         float threshold, int depth, int max_depth) const {
+            for (int q = 0; q < 4; q++) {
+                float energy = source >= 0 ? nodes[source].energy[q] : node_energy * 0.25f;
+                if (depth < max_depth && energy > threshold) {
+                    int child = static_cast<int>(result.nodes.size());
+                    result.nodes.push_back(Node());
+                    result.nodes[result_node].child[q] = child;
+                    int source_child = source >= 0 ? nodes[source].child[q] : -1;
+                    refine_node(result, child, source_child, energy, threshold, depth + 1, max_depth);
+                }
+            }
+        }
+    };
+
+    // Spatial binary tree with directional quadtrees in its leaves
+    class SDTree {
+    public:
+        struct Settings {
+            int spatial_threshold = 1000;        // Records before a leaf splits (scaled by sqrt(2^iteration))
+            float directional_threshold = 0.01f; // Energy fraction that triggers quadtree subdivision
+            int max_directional_depth = 12;
+            int max_spatial_depth = 24;
+        };
+
+        SDTree(const Vector3& bounds_min, const Vector3& bounds_max, const Settings& tree_settings)
+            : settings(tree_settings), bounds_min(bounds_min), bounds_max(bounds_max), iteration(0) {
+            nodes.push_back(SpatialNode());
+            leaves.push_back(Leaf());
+        }
+
+        // Guided sampling is only used where a leaf has learned a distribution
+        bool is_trained(const Vector3& position) const {
+            return leaves[find_leaf(position)].sampling.total_energy() > 0.0f;
+        }
+
+        // Sample a direction from the learned distribution at position; pdf is per solid angle
+        Vector3 sample(const Vector3& position, std::mt19937& rng, float& pdf) const {
+            const DirectionalQuadtree& tree = leaves[find_leaf(position)].sampling;
+            float u, v;
+            tree.sample(rng, u, v);
+            pdf = tree.pdf(u, v) / (4.0f * static_cast<float>(M_PI));
+            return canonical_to_direction(u, v);
+        }
+
+        // Solid-angle density of direction at position under the learned distribution
+        float pdf(const Vector3& position, const Vector3& direction) const {
+            float u, v;
+            direction_to_canonical(direction, u, v);
+            return leaves[find_leaf(position)].sampling.pdf(u, v) / (4.0f * static_cast<float>(M_PI));
+        }
+
+        // Merge per-thread records into the building trees (call between passes, single-threaded)
+        void merge(const GuidingRecorder& recorder) {
+            for (const Record& record : recorder.records) {
+                Leaf& leaf = leaves[find_leaf(record.position)];
+                float u, v;
+                direction_to_canonical(record.direction, u, v);
+                leaf.building.record(u, v, record.value);
+                leaf.record_count++;
+            }
+        }
+
+        // End of a training iteration: adapt spatial and directional resolution to the recorded data
+        void refine() {
+            uint64_t spatial_threshold = static_cast<uint64_t>(settings.spatial_threshold * std::sqrt(std::pow(2.0, iteration)));
+            subdivide_spatially(0, 0, spatial_threshold);
+
+            for (Leaf& leaf : leaves) {
+                leaf.sampling = leaf.building;
+                leaf.building = leaf.building.refined(settings.directional_threshold, settings.max_directional_depth);
+                leaf.record_count = 0;
+            }
+            iteration++;
+        }
+
+        int iteration_count() const { return iteration; }
+        int spatial_leaf_count() const { return static_cast<int>(leaves.size()); }
+
+        int directional_node_count() const {
+            int count = 0;
+            for (const Leaf& leaf : leaves) count += leaf.sampling.node_count();
+            return count;
+        }
+
+        void print_statistics() const {
+            std::cout << "SD-tree: " << iteration << " training iterations, " << spatial_leaf_count()
+                      << " spatial leaves, " << directional_node_count() << " directional nodes" << std::endl;
+        }
+
+    private:
+        // Interior node: split axis and children; leaf node: index into leaves
+        struct SpatialNode {
+            int axis = 0;
+            int child[2] = {-1, -1};
+            int leaf = 0;
+        };
+
+        struct Leaf {
+            DirectionalQuadtree sampling;
+            DirectionalQuadtree building;
+            uint64_t record_count = 0;
+        };
+
+        Settings settings;
+        Vector3 bounds_min;
+        Vector3 bounds_max;
+        int iteration;
+        std::vector<SpatialNode> nodes;
+        std::vector<Leaf> leaves;
+
+        static float axis_value(const Vector3& v, int axis) {
+            return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+        }
+
+        int find_leaf(const Vector3& position) const {
+            Vector3 low = bounds_min, high = bounds_max;
+            int node = 0;
+            while (nodes[node].child[0] >= 0) {
+                int axis = nodes[node].axis;
+                float mid = 0.5f * (axis_value(low, axis) + axis_value(high, axis));
+                bool upper = axis_value(position, axis) >= mid;
+                if (axis == 0) (upper ? low.x : high.x) = mid;
+                else if (axis == 1) (upper ? low.y : high.y) = mid;
+                else (upper ? low.z : high.z) = mid;
+                node = nodes[node].child[upper ? 1 : 0];
+            }
+            return nodes[node].leaf;
+        }
+
+        void subdivide_spatially(int node, int depth, uint64_t threshold) {
+            if (nodes[node].child[0] >= 0) {
+                subdivide_spatially(nodes[node].child[0], depth + 1, threshold);
+                subdivide_spatially(nodes[node].child[1], depth + 1, threshold);
+                return;
+            }
+            int leaf = nodes[node].leaf;
+            if (leaves[leaf].record_count <= threshold || depth >= settings.max_spatial_depth) return;
+
+            // Both halves inherit the parent's directional knowledge and half its record count
+            Leaf copy = leaves[leaf];
+            copy.record_count /= 2;
+            leaves[leaf].record_count /= 2;
+            int new_leaf = static_cast<int>(leaves.size());
+            leaves.push_back(copy);
+
+            int lower = static_cast<int>(nodes.size());
+            nodes.push_back(SpatialNode());
+            nodes.push_back(SpatialNode());
+            nodes[lower].axis = nodes[lower + 1].axis = (nodes[node].axis + 1) % 3;
+            nodes[lower].leaf = leaf;
+            nodes[lower + 1].leaf = new_leaf;
+            nodes[node].child[0] = lower;
+            nodes[node].child[1] = lower + 1;
+
+            subdivide_spatially(lower, depth + 1, threshold);
+            subdivide_spatially(lower + 1, depth + 1, threshold);
+        }
+    };
+}
@@ -0,0 +1,363 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "renderer.hpp"
+#include "path_guiding.hpp"
+#include "cpu_budget.hpp"
+#include "cost_attribution.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// PathTracer adds indirect lighting to the direct-lighting Renderer
+// Educational focus: Monte Carlo estimation of the rendering equation with importance sampling
+//
+// Estimator per path vertex x with outgoing direction wo:
+//   L(x, wo) = L_direct(x, wo) + f_r(wi, wo) * L(x', -wi) * cos(θi) / p(wi)
+// where L_direct uses Renderer::shade_direct_lighting (shadow rays to every light) and wi is the
+// sampled bounce direction. Rays escaping the scene receive the background color as environment light.
+//
+// Bounce sampling (one-sample multiple importance sampling):
+//   p(wi) = α * p_guide(wi) + (1 - α) * p_brdf(wi)
+// with α = guiding probability where the SD-tree has learned a distribution, 0 elsewhere.
+// Both strategies are evaluated for every sample, so the estimator remains unbiased while the
+// guided distribution concentrates samples toward bright indirect light.
+//
+// Rendering runs one sample per pixel per pass on all threads (rows handed out atomically, in
+// Settings::scanline_order when given, e.g. costliest first from a CostPredictor pre-pass).
+// With path guiding each thread records radiance into its own GuidingRecorder; recorders are merged
+// into the SD-tree after every pass and the tree is refined after passes 1, 2, 4, 8, ...
+// The tree spans the bounding box of the path vertices recorded in the first pass, so room-sized
+// regions get spatial resolution even when walls are modelled as huge spheres.
+// The final image averages all passes.
+class PathTracer {
+public:
+    struct Settings {
+        int samples_per_pixel = 16;
+        int max_bounces = 4;
+        bool path_guiding = false;
+        float guiding_probability = 0.5f;   // α: share of bounces drawn from the guided distribution
+        int thread_count = 0;               // 0 = effective CPU count (CpuBudget)
+        unsigned int seed = 1;
+        PathGuiding::SDTree::Settings guiding;
+        std::vector<int> scanline_order;    // Order rows are handed out (empty = top to bottom), see CostPredictor
+        bool cost_attribution = false;      // Count shading cost per material and light (Statistics::costs)
+    };
+
+    struct Statistics {
+        long long paths = 0;
+        long long bounces = 0;
+        long long guided_samples = 0;
+        long long brdf_samples = 0;
+        long long lobe_selections = 0;      // Shading events on layered materials (one lobe evaluated each)
+        int passes = 0;
+        int threads = 0;
+        int effective_cpus = 0;             // CpuBudget limit the thread count is compared against
+        double render_ms = 0.0;
+        CostAttribution::Counters costs;    // Merged from every thread (Settings::cost_attribution)
+
+        void print() const {
+            std::cout << "\n=== Path Tracing Statistics ===" << std::endl;
+            std::cout << "Passes: " << passes << " (1 sample per pixel each), threads: " << threads
+                      << " (effective CPUs: " << effective_cpus << ")" << std::endl;
+            std::cout << "Paths traced: " << paths << ", bounces: " << bounces
+                      << " (" << (paths > 0 ? static_cast<double>(bounces) / paths : 0.0) << " per path)" << std::endl;
+            std::cout << "Bounce sampling: " << guided_samples << " guided, " << brdf_samples << " BRDF" << std::endl;
+            if (lobe_selections > 0) {
+                std::cout << "Layered material lobe selections: " << lobe_selections << std::endl;
+            }
+            std::cout << "Render time: " << render_ms << " ms" << std::endl;
+        }
+    };
+
+    // Live progress for external monitoring (e.g. MetricsExporter), reported from the calling thread
+    struct Progress {
+        int rows_done = 0;                      // Scanlines finished over all passes
+        int rows_total = 0;                     // height × samples_per_pixel
+        int passes_done = 0;
+        long long paths = 0;
+        long long bounces = 0;
+        double elapsed_seconds = 0.0;
+        std::vector<double> thread_utilization; // Time spent rendering rows / elapsed time, per thread
+    };
+
+    PathTracer(const Scene& render_scene, const Settings& tracer_settings)
+        : scene(render_scene), settings(tracer_settings) {}
+
+    // Called after every scanline finished by the calling thread and after every pass
+    void set_progress_callback(std::function<void(const Progress&)> callback) {
+        progress_callback = std::move(callback);
+    }
+
+    // Render a progressive image into a row-major clamped RGB buffer
+    Statistics render(const Camera& camera, int width, int height, std::vector<Vector3>& pixels) {
+        Statistics stats;
+        int thread_count = settings.thread_count > 0 ? settings.thread_count : CpuBudget::default_thread_count();
+        stats.threads = thread_count;
+        stats.effective_cpus = CpuBudget::process_limits().effective_cpus;
+        // Samples accumulate in the output buffer itself and are averaged in place after the last pass,
+        // so a progressive render needs one float framebuffer, not two (see MemoryPlanner)
+        std::vector<Vector3>& accumulation = pixels;
+        accumulation.assign(static_cast<size_t>(width) * height, Vector3(0, 0, 0));
+        std::vector<PathGuiding::GuidingRecorder> recorders(thread_count);
+        std::vector<CostAttribution::Counters> thread_costs(settings.cost_attribution ? thread_count : 0,
+                                                            CostAttribution::Counters(scene));
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // Live counters shared with the progress callback (per-thread counters are merged after each pass)
+        std::atomic<int> rows_done{0};
+        std::atomic<long long> live_paths{0}, live_bounces{0};
+        std::unique_ptr<std::atomic<long long>[]> busy_microseconds(new std::atomic<long long>[thread_count]);
+        for (int t = 0; t < thread_count; t++) busy_microseconds[t] = 0;
+
+        auto report_progress = [&](int passes_done) {
+            Progress progress;
+            progress.rows_done = rows_done.load();
+            progress.rows_total = height * settings.samples_per_pixel;
+            progress.passes_done = passes_done;
+            progress.paths = live_paths.load();
+            progress.bounces = live_bounces.load();
+            progress.elapsed_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            for (int t = 0; t < thread_count; t++) {
+                progress.thread_utilization.push_back(progress.elapsed_seconds > 0.0
+                    ? busy_microseconds[t].load() * 1e-6 / progress.elapsed_seconds : 0.0);
+            }
+            progress_callback(progress);
+        };
+
+        bool scheduled = static_cast<int>(settings.scanline_order.size()) == height;
+        for (int pass = 0; pass < settings.samples_per_pixel; pass++) {
+            std::atomic<int> next_row{0};
+            std::vector<ThreadCounters> counters(thread_count);
+            for (int t = 0; t < static_cast<int>(thread_costs.size()); t++) counters[t].costs = &thread_costs[t];
+
+            auto worker = [&](int thread_index) {
+                PathGuiding::GuidingRecorder* recorder = settings.path_guiding ? &recorders[thread_index] : nullptr;
+                for (int row = next_row.fetch_add(1); row < height; row = next_row.fetch_add(1)) {
+                    int y = scheduled ? settings.scanline_order[row] : row;
+                    auto row_start = std::chrono::high_resolution_clock::now();
+                    long long paths_before = counters[thread_index].paths, bounces_before = counters[thread_index].bounces;
+                    // Seed per (pass, row): results do not depend on which thread renders the row
+                    std::mt19937 rng(settings.seed * 1000003u + static_cast<unsigned int>(pass) * 65537u + y);
+                    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+                    for (int x = 0; x < width; x++) {
+                        Ray ray = camera.generate_ray(x + jitter(rng), y + jitter(rng), width, height);
+                        accumulation[static_cast<size_t>(y) * width + x] +=
+                            trace_path(ray, rng, recorder, counters[thread_index]);
+                    }
+                    if (progress_callback) {
+                        auto row_end = std::chrono::high_resolution_clock::now();
+                        busy_microseconds[thread_index] += std::chrono::duration_cast<std::chrono::microseconds>(row_end - row_start).count();
+                        live_paths += counters[thread_index].paths - paths_before;
+                        live_bounces += counters[thread_index].bounces - bounces_before;
+                        rows_done++;
+                        if (thread_index == 0) report_progress(pass);
+                    }
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (int t = 1; t < thread_count; t++) threads.emplace_back(worker, t);
+            worker(0);
+            for (auto& thread : threads) thread.join();
+
+            for (const ThreadCounters& c : counters) {
+                stats.paths += c.paths;
+                stats.bounces += c.bounces;
+                stats.guided_samples += c.guided;
+                stats.brdf_samples += c.brdf;
+                stats.lobe_selections += c.lobe_selections;
+            }
+
+            // Periodic merge of per-thread training data; refine at iteration boundaries (1, 2, 4, ...)
+            if (settings.path_guiding) {
+                if (!guiding_tree) {
+                    create_guiding_tree(recorders);
+                }
+                for (auto& recorder : recorders) {
+                    guiding_tree->merge(recorder);
+                    recorder.records.clear();
+                }
+                int completed = pass + 1;
+                if ((completed & (completed - 1)) == 0) {
+                    guiding_tree->refine();
+                }
+            }
+            stats.passes++;
+            if (progress_callback) report_progress(stats.passes);
+        }
+
+        for (const CostAttribution::Counters& costs : thread_costs) {
+            stats.costs.merge(costs);
+        }
+
+        float inverse_passes = 1.0f / std::max(1, stats.passes);
+        for (Vector3& pixel : pixels) {
+            pixel = Renderer::clamp_color(pixel * inverse_passes);
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        stats.render_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        return stats;
+    }
+
+    const PathGuiding::SDTree* guiding() const { return guiding_tree.get(); }
+
+    // One unguided path sample through pixel (x, y), e.g. for cost pre-sampling
+    Vector3 sample_pixel(const Camera& camera, int x, int y, int width, int height, std::mt19937& rng) const {
+        std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+        ThreadCounters counters;
+        Ray ray = camera.generate_ray(x + jitter(rng), y + jitter(rng), width, height);
+        return trace_path(ray, rng, nullptr, counters);
+    }
+
+private:
+    struct ThreadCounters {
+        long long paths = 0;
+        long long bounces = 0;
+        long long guided = 0;
+        long long brdf = 0;
+        long long lobe_selections = 0;
+        CostAttribution::Counters* costs = nullptr;   // This thread's attribution, nullptr = off
+    };
+
+    // Path vertex kept for guiding training: radiance arriving along the sampled direction
+    // is the sum of later contributions divided by the throughput after this bounce
+    struct Vertex {
+        Vector3 position;
+        Vector3 direction;
+        Vector3 throughput_after;
+        Vector3 radiance_after;
+        float pdf;
+    };
+
+    const Scene& scene;
+    Settings settings;
+    std::function<void(const Progress&)> progress_callback;
+    std::unique_ptr<PathGuiding::SDTree> guiding_tree;
+
+    static Vector3 multiply(const Vector3& a, const Vector3& b) {
+        return Vector3(a.x * b.x, a.y * b.y, a.z * b.z);
+    }
+
+    static float luminance(const Vector3& c) {
+        return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+    }
+
+    Vector3 trace_path(Ray ray, std::mt19937& rng, PathGuiding::GuidingRecorder* recorder, ThreadCounters& counters) const {
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        Vector3 radiance(0, 0, 0);
+        Vector3 throughput(1, 1, 1);
+        Vertex vertices[16];
+        int vertex_count = 0;
+        counters.paths++;
+
+        auto add_contribution = [&](const Vector3& contribution) {
+            radiance += contribution;
+            for (int i = 0; i < vertex_count; i++) vertices[i].radiance_after += contribution;
+        };
+
+        for (int depth = 0; ; depth++) {
+            Scene::Intersection hit = scene.intersect(ray, false);
+            if (!hit.hit) {
+                add_contribution(multiply(throughput, Renderer::background_color()));
+                break;
+            }
+
+            // Two-sided shading: orient the normal toward the incoming ray
+            Vector3 wo = (ray.direction * -1.0f).normalize();
+            if (hit.normal.dot(wo) < 0.0f) hit.normal = hit.normal * -1.0f;
+            Vector3 position(hit.point.x, hit.point.y, hit.point.z);
+
+            // Layered materials shade through one stochastically chosen lobe per vertex, shared by
+            // direct lighting and the bounce; single-lobe materials consume no random number here
+            int lobe = 0;
+            float lobe_probability = 1.0f;
+            if (hit.material->lobe_count() > 1) {
+                lobe = hit.material->select_lobe(wo, hit.normal, uniform(rng), lobe_probability);
+                counters.lobe_selections++;
+            }
+
+            Vector3 direct = Renderer::shade_direct_lighting(scene, hit, ray.origin, lobe, lobe_probability, counters.costs);
+            add_contribution(multiply(throughput, direct));
+            if (depth >= settings.max_bounces || depth >= 16) break;
+
+            // One-sample MIS between the learned distribution and BRDF importance sampling
+            bool guided_available = guiding_tree && guiding_tree->is_trained(position);
+            float alpha = guided_available ? settings.guiding_probability : 0.0f;
+            Vector3 wi;
+            float guide_pdf = 0.0f, brdf_pdf = 0.0f;
+            if (uniform(rng) < alpha) {
+                wi = guiding_tree->sample(position, rng, guide_pdf);
+                brdf_pdf = hit.material->lobe_pdf(lobe, wi, wo, hit.normal);
+                counters.guided++;
+            } else {
+                wi = hit.material->sample_lobe(lobe, wo, hit.normal, uniform(rng), uniform(rng), brdf_pdf);
+                if (guided_available) guide_pdf = guiding_tree->pdf(position, wi);
+                counters.brdf++;
+            }
+            float pdf = alpha * guide_pdf + (1.0f - alpha) * brdf_pdf;
+            float cos_theta = hit.normal.dot(wi);
+            if (pdf <= 0.0f || cos_theta <= 0.0f || !std::isfinite(pdf)) break;
+
+            Vector3 brdf = hit.material->evaluate_lobe(lobe, wi, wo, hit.normal);
+            if (counters.costs) counters.costs->record_brdf_evaluation(CostAttribution::material_index(hit));
+            throughput = multiply(throughput, brdf * (cos_theta / (pdf * lobe_probability)));
+            if (!throughput.is_finite() || luminance(throughput) <= 0.0f) break;
+
+            if (recorder) {
+                vertices[vertex_count++] = {position, wi, throughput, Vector3(0, 0, 0), pdf};
+            }
+            counters.bounces++;
+
+            // Russian roulette after three bounces keeps long paths unbiased but cheap
+            if (depth >= 3) {
+                float survival = std::min(0.95f, std::max({throughput.x, throughput.y, throughput.z}));
+                if (uniform(rng) >= survival) break;
+                throughput = throughput * (1.0f / survival);
+            }
+
+            ray = Ray(hit.point + wi * 0.001f, wi);
+        }
+
+        // Training data: incident radiance estimate along each sampled direction, weighted by 1/pdf
+        for (int i = 0; i < vertex_count; i++) {
+            const Vertex& v = vertices[i];
+            Vector3 incident(v.throughput_after.x > 0.0f ? v.radiance_after.x / v.throughput_after.x : 0.0f,
+                             v.throughput_after.y > 0.0f ? v.radiance_after.y / v.throughput_after.y : 0.0f,
+                             v.throughput_after.z > 0.0f ? v.radiance_after.z / v.throughput_after.z : 0.0f);
+            recorder->record(v.position, v.direction, luminance(incident) / v.pdf);
+        }
+        return radiance;
+    }
+
+    // Bound the SD-tree by the first pass's path vertices (padded by 1% to include boundary hits)
+    void create_guiding_tree(const std::vector<PathGuiding::GuidingRecorder>& recorders) {
+        float inf = std::numeric_limits<float>::max();
+        Vector3 bounds_min(inf, inf, inf), bounds_max(-inf, -inf, -inf);
+        for (const auto& recorder : recorders) {
+            for (const PathGuiding::Record& record : recorder.records) {
+                const Vector3& p = record.position;
+                bounds_min = Vector3(std::min(bounds_min.x, p.x), std::min(bounds_min.y, p.y), std::min(bounds_min.z, p.z));
+                bounds_max = Vector3(std::max(bounds_max.x, p.x), std::max(bounds_max.y, p.y), std::max(bounds_max.z, p.z));
+            }
+        }
+        if (bounds_min.x > bounds_max.x) {
+            bounds_min = Vector3(-1, -1, -1);
+            bounds_max = Vector3(1, 1, 1);
+        }
+        Vector3 padding = (bounds_max - bounds_min) * 0.01f + Vector3(1e-3f, 1e-3f, 1e-3f);
+        guiding_tree = std::make_unique<PathGuiding::SDTree>(bounds_min - padding, bounds_max + padding, settings.guiding);
+    }
+};
@@ -93,6 +93,11 @@ public:
         phase_counters[phase] += count;
     }
     
+    // Raw counter access for external reporting (metrics export)
+    int get_counter(Phase phase) const {
+        return phase_counters.at(phase);
+    }
+    
     // Educational reporting methods
     void print_performance_breakdown() const {
         std::cout << "\n=== Educational Performance Analysis ===" << std::endl;
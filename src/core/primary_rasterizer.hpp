@@ -0,0 +1,233 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "cpu_budget.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// PrimaryRasterizer resolves primary visibility by rasterizing sphere bounds into a visibility buffer
+// Educational focus: primary rays all start at the eye, so "which sphere does pixel (x, y) see?" can be
+// answered object-order, like a GPU, instead of ray-order through Scene::intersect or the BVH
+//
+// 1. Bounds: in camera space (x right, y up, z forward) a sphere with center c and radius r, fully in
+//    front of the eye (c.z > r), projects to an ellipse. Its screen-space extent along x is bounded by
+//    the two planes x = m z through the eye tangent to the sphere:
+//      m = (c.x c.z ± r sqrt(c.x² + c.z² - r²)) / (c.z² - r²)
+//    and likewise along y. Spheres entirely behind the eye are culled; spheres straddling the eye
+//    plane (c.z <= r) conservatively cover the whole screen.
+// 2. Binning: each sphere index is appended to every tile (tile_size² pixels) its bounds overlap, in
+//    scene order.
+// 3. Rasterization: threads take tiles from an atomic counter. For each pixel the exact primary ray
+//    (Camera::generate_ray) is tested against the tile's spheres only. The discriminant test in
+//    Sphere::intersect is exactly "pixel inside the projected ellipse"; the closest hit with
+//    t > 0.001 wins, first in scene order on ties, exactly as the linear Scene::intersect decides.
+// 4. The visibility buffer stores one sphere index (-1 = background) and depth t per pixel.
+//    intersection() rebuilds the full Scene::Intersection for shading, so the existing shading and
+//    shadow-ray path (Renderer::shade_direct_lighting) runs unchanged on the result.
+class PrimaryRasterizer {
+public:
+    struct Settings {
+        int tile_size = 16;        // Tile edge in pixels
+        int thread_count = 0;      // 0 = effective CPU count (CpuBudget)
+    };
+
+    struct Statistics {
+        int spheres = 0;
+        int culled_spheres = 0;        // Behind the eye, outside the image or without a valid material
+        int full_screen_spheres = 0;   // Straddle the eye plane: binned into every tile
+        int tiles = 0;
+        long long bin_entries = 0;     // Sphere references over all tiles
+        long long ray_sphere_tests = 0;
+        int covered_pixels = 0;
+        int threads = 0;
+        double bin_ms = 0.0;
+        double raster_ms = 0.0;
+
+        void print() const {
+            std::cout << "\n=== Rasterized Primary Visibility ===" << std::endl;
+            std::cout << "Spheres: " << spheres << " (" << culled_spheres << " culled, " << full_screen_spheres
+                      << " full-screen)" << std::endl;
+            std::cout << "Tiles: " << tiles << ", " << (tiles > 0 ? static_cast<double>(bin_entries) / tiles : 0.0)
+                      << " spheres per tile on average" << std::endl;
+            std::cout << "Ray-sphere tests: " << ray_sphere_tests << ", covered pixels: " << covered_pixels << std::endl;
+            std::cout << "Binning: " << bin_ms << " ms, rasterization: " << raster_ms << " ms on " << threads
+                      << " thread(s)" << std::endl;
+        }
+    };
+
+    PrimaryRasterizer() = default;
+    explicit PrimaryRasterizer(const Settings& rasterizer_settings) : settings(rasterizer_settings) {
+        settings.tile_size = std::max(1, settings.tile_size);
+    }
+
+    // Screen-space bounds of a sphere in (fractional) pixel coordinates, as Camera::generate_ray maps them
+    // Returns false if the sphere lies entirely behind the eye; full_screen is set when it straddles the
+    // eye plane and no finite bound exists
+    static bool screen_bounds(const Camera& camera, const Sphere& sphere, int width, int height,
+                              float& min_x, float& max_x, float& min_y, float& max_y, bool& full_screen) {
+        Vector3 d = sphere.center - camera.position;
+        double cx = d.dot(camera.right), cy = d.dot(camera.camera_up), cz = d.dot(camera.forward);
+        double r = sphere.radius;
+        full_screen = false;
+        if (cz + r <= 0.0) {
+            return false;
+        }
+        if (cz <= r) {
+            full_screen = true;
+            min_x = min_y = -std::numeric_limits<float>::max();
+            max_x = max_y = std::numeric_limits<float>::max();
+            return true;
+        }
+
+        // Tangent slopes m = x/z (and y/z) of the silhouette, then screen plane → pixels
+        auto tangent_slopes = [&](double c, double& low, double& high) {
+            double denominator = cz * cz - r * r;
+            double root = r * std::sqrt(std::max(0.0, c * c + denominator));
+            low = (c * cz - root) / denominator;
+            high = (c * cz + root) / denominator;
+        };
+        double fov_scale = std::tan(camera.field_of_view_degrees * M_PI / 180.0 * 0.5);
+        double low, high;
+        tangent_slopes(cx, low, high);
+        min_x = static_cast<float>((low / (camera.aspect_ratio * fov_scale) + 1.0) * 0.5 * width);
+        max_x = static_cast<float>((high / (camera.aspect_ratio * fov_scale) + 1.0) * 0.5 * width);
+        tangent_slopes(cy, low, high);
+        min_y = static_cast<float>((1.0 - high / fov_scale) * 0.5 * height);
+        max_y = static_cast<float>((1.0 - low / fov_scale) * 0.5 * height);
+        return true;
+    }
+
+    // Bin spheres into tiles and resolve the closest sphere for every pixel
+    void rasterize(const Scene& scene, const Camera& camera, int width, int height) {
+        image_width = width;
+        image_height = height;
+        stats = Statistics();
+        stats.spheres = static_cast<int>(scene.primitives.size());
+        int tile_size = settings.tile_size;
+        tiles_x = (width + tile_size - 1) / tile_size;
+        tiles_y = (height + tile_size - 1) / tile_size;
+        stats.tiles = tiles_x * tiles_y;
+
+        // Binning (serial: one pass over the spheres)
+        auto bin_start = std::chrono::high_resolution_clock::now();
+        bins.assign(stats.tiles, std::vector<int>());
+        for (size_t i = 0; i < scene.primitives.size(); i++) {
+            const Sphere& sphere = scene.primitives[i];
+            float min_x, max_x, min_y, max_y;
+            bool full_screen;
+            bool valid_material = sphere.material_index >= 0 && sphere.material_index < static_cast<int>(scene.materials.size());
+            if (!valid_material || !screen_bounds(camera, sphere, width, height, min_x, max_x, min_y, max_y, full_screen)) {
+                stats.culled_spheres++;
+                continue;
+            }
+            // One pixel of margin absorbs float differences between the bound and generate_ray
+            int first_x = 0, last_x = width - 1, first_y = 0, last_y = height - 1;
+            if (full_screen) {
+                stats.full_screen_spheres++;
+            } else {
+                if (max_x < -1.0f || min_x > width + 1.0f || max_y < -1.0f || min_y > height + 1.0f) {
+                    stats.culled_spheres++;
+                    continue;
+                }
+                first_x = std::max(0, static_cast<int>(std::floor(std::max(min_x, -2.0f))) - 1);
+                last_x = std::min(width - 1, static_cast<int>(std::ceil(std::min(max_x, width + 2.0f))) + 1);
+                first_y = std::max(0, static_cast<int>(std::floor(std::max(min_y, -2.0f))) - 1);
+                last_y = std::min(height - 1, static_cast<int>(std::ceil(std::min(max_y, height + 2.0f))) + 1);
+            }
+            for (int ty = first_y / tile_size; ty <= last_y / tile_size; ty++) {
+                for (int tx = first_x / tile_size; tx <= last_x / tile_size; tx++) {
+                    bins[ty * tiles_x + tx].push_back(static_cast<int>(i));
+                    stats.bin_entries++;
+                }
+            }
+        }
+        auto bin_end = std::chrono::high_resolution_clock::now();
+        stats.bin_ms = std::chrono::duration<double, std::milli>(bin_end - bin_start).count();
+
+        // Rasterization: tiles handed out atomically, each pixel tested against its tile's spheres
+        primitive_ids.assign(static_cast<size_t>(width) * height, -1);
+        depths.assign(static_cast<size_t>(width) * height, std::numeric_limits<float>::max());
+        int thread_count = settings.thread_count > 0 ? settings.thread_count : CpuBudget::default_thread_count();
+        thread_count = std::max(1, std::min(thread_count, stats.tiles));
+        stats.threads = thread_count;
+        std::atomic<int> next_tile{0};
+        std::atomic<long long> tests{0};
+        std::atomic<int> covered{0};
+        auto worker = [&]() {
+            long long local_tests = 0;
+            int local_covered = 0;
+            for (int tile = next_tile++; tile < stats.tiles; tile = next_tile++) {
+                const std::vector<int>& bin = bins[tile];
+                if (bin.empty()) continue;
+                int x0 = (tile % tiles_x) * tile_size, y0 = (tile / tiles_x) * tile_size;
+                int x1 = std::min(width, x0 + tile_size), y1 = std::min(height, y0 + tile_size);
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) {
+                        Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                        size_t pixel = static_cast<size_t>(y) * width + x;
+                        for (int index : bin) {
+                            local_tests++;
+                            Sphere::Intersection hit = scene.primitives[index].intersect(ray, false);
+                            if (hit.hit && hit.t > 0.001f && hit.t < depths[pixel]) {
+                                depths[pixel] = hit.t;
+                                primitive_ids[pixel] = index;
+                            }
+                        }
+                        if (primitive_ids[pixel] >= 0) local_covered++;
+                    }
+                }
+            }
+            tests += local_tests;
+            covered += local_covered;
+        };
+        auto raster_start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 1; t < thread_count; t++) threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads) thread.join();
+        auto raster_end = std::chrono::high_resolution_clock::now();
+        stats.raster_ms = std::chrono::duration<double, std::milli>(raster_end - raster_start).count();
+        stats.ray_sphere_tests = tests.load();
+        stats.covered_pixels = covered.load();
+        scene.total_intersection_tests.fetch_add(static_cast<int>(std::min<long long>(stats.ray_sphere_tests, INT32_MAX)),
+                                                 std::memory_order_relaxed);
+    }
+
+    // Sphere index visible at pixel (x, y), or -1 for background
+    int primitive_at(int x, int y) const {
+        return primitive_ids[static_cast<size_t>(y) * image_width + x];
+    }
+
+    // Full intersection record for pixel (x, y) and its primary ray, as Scene::intersect would return it
+    Scene::Intersection intersection(const Scene& scene, const Ray& ray, int x, int y) const {
+        int index = primitive_at(x, y);
+        if (index < 0) {
+            return Scene::Intersection();
+        }
+        const Sphere& sphere = scene.primitives[index];
+        Sphere::Intersection hit = sphere.intersect(ray, false);
+        return Scene::Intersection(hit.t, hit.point, hit.normal, scene.materials[sphere.material_index].get(), &sphere);
+    }
+
+    const Statistics& statistics() const { return stats; }
+
+private:
+    Settings settings;
+    Statistics stats;
+    int image_width = 0, image_height = 0;
+    int tiles_x = 0, tiles_y = 0;
+    std::vector<std::vector<int>> bins;    // Sphere indices per tile, in scene order
+    std::vector<int> primitive_ids;        // Visibility buffer: sphere index per pixel (-1 = background)
+    std::vector<float> depths;             // Ray parameter t of the visible sphere
+};
@@ -273,6 +273,15 @@ public:
         return (static_cast<float>(completed_pixels) / total_pixels) * 100.0f;
     }
     
+    int get_completed_pixels() const { return completed_pixels; }
+    int get_total_pixels() const { return total_pixels; }
+    
+    // Estimated seconds until completion from the average rate so far (0 before the first pixel)
+    float get_estimated_remaining_seconds() const {
+        float rate = get_pixels_per_second();
+        return rate > 0.0f ? (total_pixels - completed_pixels) / rate : 0.0f;
+    }
+    
     // Get pixels rendered per second
     float get_pixels_per_second() const {
         auto current_time = std::chrono::steady_clock::now();
@@ -0,0 +1,318 @@
+#pragma once
+#include "cpu_budget.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+// QoiEncoder writes and reads "Quite OK Image" files (qoiformat.org): lossless 8-bit RGB/RGBA
+// Educational focus: a byte-oriented format that compresses in one linear pass, with no entropy coder
+//
+// Each pixel becomes the first matching operation, compared with the previous pixel p and a 64-entry
+// table of recently seen colors indexed by hash(c) = (3r + 5g + 7b + 11a) mod 64:
+//   RUN   (1 byte)  c = p, repeated 1..62 times
+//   INDEX (1 byte)  c = table[hash(c)]
+//   DIFF  (1 byte)  r, g, b each differ from p by -2..1
+//   LUMA  (2 bytes) g differs by -32..31, r - g and b - g differ by -8..7 more than g did
+//   RGB   (4 bytes) / RGBA (5 bytes) literal
+// PNG spends most of its time in deflate's match search and Huffman coding; QOI does a handful of
+// compares per pixel, so encoding runs close to memory bandwidth at a PNG-like ratio on renders.
+//
+// Parallel row bands: the image is cut into horizontal bands, encoded by independent threads, each
+// starting from the initial state (p = (0,0,0,255), empty table). The streams are concatenated into
+// ONE standard QOI file that any decoder reads serially. Two rules keep that valid:
+//   1. The first pixel of every band is a literal (RGB, or RGBA for 4 channels), so nothing in the
+//      band depends on the previous band's last pixel. A run never crosses a band boundary.
+//   2. INDEX is only emitted for table slots written within the same band; a serial decoder still
+//      holds the previous band's colors in untouched slots, while the band encoder assumed zeros.
+// The cost is one literal per band: a few bytes on a multi-megabyte frame.
+class QoiEncoder {
+public:
+    struct Settings {
+        int bands = 0;          // Row bands encoded independently; 0 = one per thread
+        int thread_count = 0;   // 0 = effective CPU count (CpuBudget)
+        bool linear = false;    // Colorspace byte: false = sRGB (gamma corrected), true = linear
+    };
+
+    struct Statistics {
+        int bands = 0;
+        int threads = 0;
+        size_t raw_bytes = 0;       // width × height × channels
+        size_t encoded_bytes = 0;   // Header, operations and end marker
+        double encode_ms = 0.0;     // Row conversion and encoding, all bands
+
+        double compression_ratio() const {
+            return encoded_bytes > 0 ? static_cast<double>(raw_bytes) / encoded_bytes : 0.0;
+        }
+    };
+
+    static constexpr size_t header_size = 14;
+    static constexpr size_t end_marker_size = 8;
+
+    // Encode an image whose rows are produced on demand by fill_rows(first_row, last_row, destination),
+    // which writes rows [first_row, last_row) as packed 8-bit pixels with `channels` bytes each
+    // Converting rows inside the band threads keeps the float → 8-bit conversion parallel too
+    template <typename RowSource>
+    static std::vector<unsigned char> encode(int width, int height, int channels, RowSource fill_rows,
+                                             const Settings& settings, Statistics* statistics = nullptr) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<unsigned char> output;
+        if (width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
+            return output;
+        }
+
+        int thread_count = settings.thread_count > 0 ? settings.thread_count : CpuBudget::default_thread_count();
+        int band_count = settings.bands > 0 ? settings.bands : thread_count;
+        band_count = std::max(1, std::min(band_count, height));
+        thread_count = std::max(1, std::min(thread_count, band_count));
+
+        // Band b covers rows [b·height/bands, (b+1)·height/bands)
+        std::vector<std::vector<unsigned char>> streams(band_count);
+        std::atomic<int> next_band{0};
+        auto worker = [&]() {
+            std::vector<unsigned char> rows;
+            for (int band = next_band++; band < band_count; band = next_band++) {
+                int first_row = static_cast<int>(static_cast<long long>(band) * height / band_count);
+                int last_row = static_cast<int>(static_cast<long long>(band + 1) * height / band_count);
+                size_t pixel_count = static_cast<size_t>(last_row - first_row) * width;
+                rows.resize(pixel_count * channels);
+                fill_rows(first_row, last_row, rows.data());
+                encode_band(rows.data(), pixel_count, channels, streams[band]);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int t = 1; t < thread_count; t++) threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads) thread.join();
+
+        size_t total = header_size + end_marker_size;
+        for (const auto& stream : streams) total += stream.size();
+        output.resize(total);
+        unsigned char* out = output.data();
+        std::memcpy(out, "qoif", 4);
+        write_u32(out + 4, static_cast<uint32_t>(width));
+        write_u32(out + 8, static_cast<uint32_t>(height));
+        out[12] = static_cast<unsigned char>(channels);
+        out[13] = settings.linear ? 1 : 0;
+        size_t position = header_size;
+        for (const auto& stream : streams) {
+            std::memcpy(out + position, stream.data(), stream.size());
+            position += stream.size();
+        }
+        std::memset(out + position, 0, end_marker_size - 1);
+        out[position + end_marker_size - 1] = 1;
+
+        if (statistics) {
+            auto end = std::chrono::high_resolution_clock::now();
+            statistics->bands = band_count;
+            statistics->threads = thread_count;
+            statistics->raw_bytes = static_cast<size_t>(width) * height * channels;
+            statistics->encoded_bytes = output.size();
+            statistics->encode_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        return output;
+    }
+
+    // Encode packed 8-bit pixels (row-major, `channels` bytes per pixel)
+    static std::vector<unsigned char> encode(const unsigned char* pixels, int width, int height, int channels,
+                                             const Settings& settings, Statistics* statistics = nullptr) {
+        size_t row_bytes = static_cast<size_t>(width) * channels;
+        return encode(width, height, channels, [&](int first_row, int last_row, unsigned char* destination) {
+            std::memcpy(destination, pixels + first_row * row_bytes, (last_row - first_row) * row_bytes);
+        }, settings, statistics);
+    }
+
+    // Decode a QOI file (serially, as any reader would); pixels receive the file's channel count
+    // Returns false for a malformed header or truncated data
+    static bool decode(const std::vector<unsigned char>& data, int& width, int& height, int& channels,
+                       std::vector<unsigned char>& pixels) {
+        if (data.size() < header_size + end_marker_size || std::memcmp(data.data(), "qoif", 4) != 0) {
+            return false;
+        }
+        width = static_cast<int>(read_u32(data.data() + 4));
+        height = static_cast<int>(read_u32(data.data() + 8));
+        channels = data[12];
+        if (width <= 0 || height <= 0 || (channels != 3 && channels != 4) ||
+            static_cast<long long>(width) * height > 400000000LL) {
+            return false;
+        }
+
+        size_t pixel_count = static_cast<size_t>(width) * height;
+        pixels.resize(pixel_count * channels);
+        Pixel table[64] = {};
+        Pixel previous{0, 0, 0, 255};
+        size_t position = header_size;
+        size_t chunks_end = data.size() - end_marker_size;
+        int run = 0;
+        for (size_t i = 0; i < pixel_count; i++) {
+            if (run > 0) {
+                run--;
+            } else {
+                if (position >= chunks_end) {
+                    return false;
+                }
+                unsigned char tag = data[position++];
+                if (tag == op_rgb || tag == op_rgba) {
+                    size_t bytes = tag == op_rgb ? 3 : 4;
+                    if (position + bytes > chunks_end) return false;
+                    previous.r = data[position];
+                    previous.g = data[position + 1];
+                    previous.b = data[position + 2];
+                    if (tag == op_rgba) previous.a = data[position + 3];
+                    position += bytes;
+                } else if ((tag & mask_2) == op_index) {
+                    previous = table[tag];
+                } else if ((tag & mask_2) == op_diff) {
+                    previous.r += ((tag >> 4) & 0x03) - 2;
+                    previous.g += ((tag >> 2) & 0x03) - 2;
+                    previous.b += (tag & 0x03) - 2;
+                } else if ((tag & mask_2) == op_luma) {
+                    if (position >= chunks_end) return false;
+                    unsigned char second = data[position++];
+                    int green_difference = (tag & 0x3f) - 32;
+                    previous.r += green_difference - 8 + ((second >> 4) & 0x0f);
+                    previous.g += green_difference;
+                    previous.b += green_difference - 8 + (second & 0x0f);
+                } else {
+                    run = tag & 0x3f;
+                }
+                table[previous.hash()] = previous;
+            }
+            unsigned char* out = &pixels[i * channels];
+            out[0] = previous.r;
+            out[1] = previous.g;
+            out[2] = previous.b;
+            if (channels == 4) out[3] = previous.a;
+        }
+        return true;
+    }
+
+    // Write encoded bytes to disk; returns false on I/O failure
+    static bool write_file(const std::string& filename, const std::vector<unsigned char>& data) {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(file);
+    }
+
+    static bool read_file(const std::string& filename, std::vector<unsigned char>& data) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+private:
+    static constexpr unsigned char op_index = 0x00;
+    static constexpr unsigned char op_diff = 0x40;
+    static constexpr unsigned char op_luma = 0x80;
+    static constexpr unsigned char op_run = 0xc0;
+    static constexpr unsigned char op_rgb = 0xfe;
+    static constexpr unsigned char op_rgba = 0xff;
+    static constexpr unsigned char mask_2 = 0xc0;
+    static constexpr int max_run = 62;
+
+    struct Pixel {
+        unsigned char r, g, b, a;
+
+        bool operator==(const Pixel& other) const {
+            return r == other.r && g == other.g && b == other.b && a == other.a;
+        }
+        int hash() const { return (r * 3 + g * 5 + b * 7 + a * 11) % 64; }
+    };
+
+    // Encode one band from the initial state into `stream` (sized for the worst case, then trimmed)
+    static void encode_band(const unsigned char* pixels, size_t pixel_count, int channels,
+                            std::vector<unsigned char>& stream) {
+        stream.resize(pixel_count * (channels + 1));
+        unsigned char* out = stream.data();
+        size_t position = 0;
+        Pixel table[64] = {};
+        uint64_t written = 0;   // Table slots assigned within this band (rule 2)
+        Pixel previous{0, 0, 0, 255};
+        int run = 0;
+
+        for (size_t i = 0; i < pixel_count; i++) {
+            const unsigned char* source = pixels + i * channels;
+            Pixel pixel{source[0], source[1], source[2], channels == 4 ? source[3] : static_cast<unsigned char>(255)};
+
+            if (i > 0 && pixel == previous) {
+                run++;
+                if (run == max_run) {
+                    out[position++] = op_run | (run - 1);
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                out[position++] = op_run | (run - 1);
+                run = 0;
+            }
+
+            int slot = pixel.hash();
+            if (i > 0 && (written >> slot & 1) && table[slot] == pixel) {
+                out[position++] = op_index | slot;
+            } else {
+                table[slot] = pixel;
+                written |= uint64_t(1) << slot;
+                int dr = static_cast<signed char>(pixel.r - previous.r);
+                int dg = static_cast<signed char>(pixel.g - previous.g);
+                int db = static_cast<signed char>(pixel.b - previous.b);
+                int dr_dg = dr - dg, db_dg = db - dg;
+                if (i == 0 || pixel.a != previous.a) {
+                    // Rule 1: the band's first pixel is a literal
+                    if (channels == 4) {
+                        out[position++] = op_rgba;
+                        out[position++] = pixel.r;
+                        out[position++] = pixel.g;
+                        out[position++] = pixel.b;
+                        out[position++] = pixel.a;
+                    } else {
+                        out[position++] = op_rgb;
+                        out[position++] = pixel.r;
+                        out[position++] = pixel.g;
+                        out[position++] = pixel.b;
+                    }
+                } else if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    out[position++] = op_diff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+                    out[position++] = op_luma | (dg + 32);
+                    out[position++] = (dr_dg + 8) << 4 | (db_dg + 8);
+                } else {
+                    out[position++] = op_rgb;
+                    out[position++] = pixel.r;
+                    out[position++] = pixel.g;
+                    out[position++] = pixel.b;
+                }
+            }
+            previous = pixel;
+        }
+        if (run > 0) {
+            out[position++] = op_run | (run - 1);
+        }
+        stream.resize(position);
+    }
+
+    static void write_u32(unsigned char* out, uint32_t value) {
+        out[0] = static_cast<unsigned char>(value >> 24);
+        out[1] = static_cast<unsigned char>(value >> 16);
+        out[2] = static_cast<unsigned char>(value >> 8);
+        out[3] = static_cast<unsigned char>(value);
+    }
+
+    static uint32_t read_u32(const unsigned char* in) {
+        return static_cast<uint32_t>(in[0]) << 24 | static_cast<uint32_t>(in[1]) << 16 |
+               static_cast<uint32_t>(in[2]) << 8 | static_cast<uint32_t>(in[3]);
+    }
+};
@@ -0,0 +1,509 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "../lights/point_light.hpp"
+#include "../lights/directional_light.hpp"
+#include "../lights/area_light.hpp"
+#include "../lights/sphere_light.hpp"
+#include "../materials/cook_torrance.hpp"
+#include "../materials/openpbr.hpp"
+#include "../materials/material_graph.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// RenderCache stores finished images and tiles on disk, addressed by a hash of everything that produced them
+// Educational focus: content addressing and provable cache validity
+//
+// Content address: key = H(canonical scene + camera + resolution + render options)
+//   The canonical text prints every float as a hexfloat, so equal text ⇔ bit-identical inputs,
+//   whatever the scene file's formatting, comments or material names were. H is 128-bit FNV-1a
+//   (128-bit state and prime): fast and well mixed for cache addressing, but not cryptographic,
+//   so keys are only as collision resistant as FNV, not a guarantee against crafted inputs.
+//
+// Only deterministic renders are cached: area and sphere lights draw their samples from
+// per-thread generators seeded by std::random_device, so every render of such a scene is a
+// different noise realization and none of them is "the" image for the key (see deterministic()).
+//
+// Tile reuse for partially changed scenes (direct lighting, exact traversal):
+//   Pixel color at a tile depends only on
+//     1. spheres intersecting the tile's view frustum (primary hits, their materials)
+//     2. spheres that can block a shadow ray from a tile hit point to a light
+//     3. the lights, camera, resolution and options
+//   Tile key = H(3 + tile rectangle + canonical text of every sphere passing the frustum test).
+//   If it matches, the primary hits are unchanged, so the stored bounding ball B of the hit points
+//   is still valid. Every shadow segment from p ∈ B to a light at L lies in the capsule of radius
+//   r_B around the segment c_B→L, so the stored entry is reused only if the set of spheres touching
+//   those capsules is unchanged too. Both tests are conservative: an extra sphere can only cost a
+//   reuse, never return a stale tile.
+//
+// Eviction: least recently used by file modification time (touched on every hit) until the
+// directory is below max_bytes.
+class RenderCache {
+public:
+    struct Settings {
+        std::string directory = "render_cache";
+        size_t max_bytes = 512ull * 1024 * 1024;
+        int tile_size = 32;
+    };
+
+    struct Statistics {
+        bool image_hit = false;
+        int tiles_total = 0;
+        int tiles_reused = 0;
+        int tiles_stored = 0;
+        int files_evicted = 0;
+        size_t directory_bytes = 0;
+
+        void print() const {
+            std::cout << "\n=== Render Cache Statistics ===" << std::endl;
+            std::cout << "Image: " << (image_hit ? "hit" : "miss") << std::endl;
+            if (tiles_total > 0) {
+                std::cout << "Tiles reused: " << tiles_reused << " of " << tiles_total << " ("
+                          << 100.0 * tiles_reused / tiles_total << "%), stored: " << tiles_stored << std::endl;
+            }
+            std::cout << "Cache size: " << directory_bytes / 1024 << " KB, " << files_evicted << " files evicted" << std::endl;
+        }
+    };
+
+    explicit RenderCache(const Settings& cache_settings) : settings(cache_settings) {
+        std::error_code error;
+        std::filesystem::create_directories(settings.directory, error);
+        if (error) {
+            std::cout << "WARNING: Could not create render cache directory " << settings.directory
+                      << " (caching disabled)" << std::endl;
+            usable = false;
+        }
+    }
+
+    bool enabled() const { return usable; }
+    const Statistics& statistics() const { return stats; }
+
+    // 128-bit FNV-1a as 32 hex digits
+    // State (high, low) is multiplied by the FNV-128 prime 2^88 + 0x13B modulo 2^128 using 64-bit halves:
+    //   (high·2^64 + low)·0x13B  plus  low·2^88 (high·2^88 overflows out of 128 bits)
+    static std::string hash_hex(const std::string& text) {
+        uint64_t high = 0x6c62272e07bb0142ull;   // Offset basis 0x6c62272e07bb014262b821756295c58d
+        uint64_t low = 0x62b821756295c58dull;
+        const uint64_t prime_low = 0x13Bull;
+        for (unsigned char c : text) {
+            low ^= c;
+            uint64_t carry = ((low >> 32) * prime_low + (((low & 0xffffffffull) * prime_low) >> 32)) >> 32;
+            uint64_t next_high = high * prime_low + carry + (low << 24);
+            low *= prime_low;
+            high = next_high;
+        }
+        char digits[33];
+        std::snprintf(digits, sizeof(digits), "%016llx%016llx", static_cast<unsigned long long>(high),
+                      static_cast<unsigned long long>(low));
+        return digits;
+    }
+
+    // True if rendering the scene twice gives the same pixels (no randomly sampled lights)
+    static bool deterministic(const Scene& scene) {
+        for (const auto& light : scene.lights) {
+            if (light->type == LightType::Area || light->type == LightType::Sphere) return false;
+        }
+        return true;
+    }
+
+    static std::string canonical_material(const Material& material) {
+        std::ostringstream out;
+        out << std::hexfloat << "material " << static_cast<int>(material.type) << " " << material.base_color.x << " "
+            << material.base_color.y << " " << material.base_color.z;
+        if (const auto* cook_torrance = dynamic_cast<const CookTorranceMaterial*>(&material)) {
+            out << " " << cook_torrance->roughness << " " << cook_torrance->metallic << " " << cook_torrance->specular;
+        } else if (const auto* layered = dynamic_cast<const OpenPBRMaterial*>(&material)) {
+            out << " " << layered->base_metalness << " " << layered->specular_weight << " " << layered->specular_roughness
+                << " " << layered->specular_ior << " " << layered->coat_weight << " " << layered->coat_roughness << " "
+                << layered->coat_ior;
+        } else if (const auto* graph = dynamic_cast<const GraphMaterial*>(&material)) {
+            out << " " << graph->program.canonical();
+        }
+        return out.str();
+    }
+
+    static std::string canonical_light(const Light& light) {
+        std::ostringstream out;
+        out << std::hexfloat << "light " << static_cast<int>(light.type) << " " << light.color.x << " " << light.color.y
+            << " " << light.color.z << " " << light.intensity;
+        if (const auto* point = dynamic_cast<const PointLight*>(&light)) {
+            out << " " << point->position.x << " " << point->position.y << " " << point->position.z;
+        } else if (const auto* directional = dynamic_cast<const DirectionalLight*>(&light)) {
+            out << " " << directional->direction.x << " " << directional->direction.y << " " << directional->direction.z;
+        } else if (const auto* area = dynamic_cast<const AreaLight*>(&light)) {
+            out << " " << area->center.x << " " << area->center.y << " " << area->center.z << " " << area->normal.x << " "
+                << area->normal.y << " " << area->normal.z << " " << area->width << " " << area->height << " "
+                << static_cast<int>(area->sampling);
+        } else if (const auto* sphere = dynamic_cast<const SphereLight*>(&light)) {
+            out << " " << sphere->center.x << " " << sphere->center.y << " " << sphere->center.z << " " << sphere->radius;
+        }
+        return out.str();
+    }
+
+    // Sphere geometry plus its resolved material (indices and names do not matter, contents do)
+    static std::string canonical_sphere(const Scene& scene, const Sphere& sphere) {
+        std::ostringstream out;
+        out << std::hexfloat << "sphere " << sphere.center.x << " " << sphere.center.y << " " << sphere.center.z << " "
+            << sphere.radius << " ";
+        if (sphere.material_index >= 0 && sphere.material_index < static_cast<int>(scene.materials.size())) {
+            out << canonical_material(*scene.materials[sphere.material_index]);
+        } else {
+            out << "no-material";
+        }
+        return out.str();
+    }
+
+    static std::string canonical_lights(const Scene& scene) {
+        std::string text;
+        for (const auto& light : scene.lights) text += canonical_light(*light) + "\n";
+        return text.empty() ? "no-lights (renderer fallback light)\n" : text;
+    }
+
+    static std::string canonical_scene(const Scene& scene) {
+        std::string text = canonical_lights(scene);
+        for (const Sphere& sphere : scene.primitives) text += canonical_sphere(scene, sphere) + "\n";
+        return text;
+    }
+
+    static std::string canonical_camera(const Camera& camera) {
+        std::ostringstream out;
+        out << std::hexfloat << "camera " << camera.position.x << " " << camera.position.y << " " << camera.position.z << " "
+            << camera.target.x << " " << camera.target.y << " " << camera.target.z << " " << camera.up.x << " " << camera.up.y
+            << " " << camera.up.z << " " << camera.field_of_view_degrees << " " << camera.aspect_ratio;
+        return out.str();
+    }
+
+    // Key of a whole image; options lists every render setting that changes pixels
+    static std::string image_key(const Scene& scene, const Camera& camera, int width, int height, const std::string& options) {
+        return hash_hex(canonical_scene(scene) + canonical_camera(camera) + " " + std::to_string(width) + "x" +
+                        std::to_string(height) + " " + options);
+    }
+
+    // Copy a stored image into pixels; a hit also marks the entry as recently used
+    bool load_image(const std::string& key, int width, int height, std::vector<Vector3>& pixels) {
+        if (!usable) return false;
+        std::string path = entry_path(key, ".img");
+        std::ifstream file(path, std::ios::binary);
+        int stored_width = 0, stored_height = 0;
+        if (!file || !read_header(file, image_magic) || !read_value(file, stored_width) || !read_value(file, stored_height) ||
+            stored_width != width || stored_height != height) {
+            return false;
+        }
+        std::vector<Vector3> stored(static_cast<size_t>(width) * height);
+        if (!read_pixels(file, stored)) return false;
+        pixels = std::move(stored);
+        touch(path);
+        stats.image_hit = true;
+        return true;
+    }
+
+    bool store_image(const std::string& key, int width, int height, const std::vector<Vector3>& pixels) {
+        if (!usable) return false;
+        return write_entry(entry_path(key, ".img"), [&](std::ofstream& file) {
+            file.write(image_magic, 4);
+            write_value(file, width);
+            write_value(file, height);
+            write_pixels(file, pixels);
+        });
+    }
+
+    // Split the image into tiles, compute each tile's key and copy every provably valid stored tile
+    // into pixels (row-major, width × height); returns the number of reused tiles
+    int prepare_tiles(const Scene& scene, const Camera& camera, int width, int height, const std::string& options,
+                      std::vector<Vector3>& pixels) {
+        image_width = width;
+        image_height = height;
+        tiles_x = (width + settings.tile_size - 1) / settings.tile_size;
+        tiles_y = (height + settings.tile_size - 1) / settings.tile_size;
+        tiles.assign(static_cast<size_t>(tiles_x) * tiles_y, Tile());
+        std::string shared = canonical_lights(scene) + canonical_camera(camera) + " " + std::to_string(width) + "x" +
+                             std::to_string(height) + " " + options;
+
+        for (int ty = 0; ty < tiles_y; ty++) {
+            for (int tx = 0; tx < tiles_x; tx++) {
+                Tile& tile = tiles[static_cast<size_t>(ty) * tiles_x + tx];
+                tile.x0 = tx * settings.tile_size;
+                tile.y0 = ty * settings.tile_size;
+                tile.x1 = std::min(width, tile.x0 + settings.tile_size);
+                tile.y1 = std::min(height, tile.y0 + settings.tile_size);
+
+                std::string footprint = shared + " tile " + std::to_string(tile.x0) + "," + std::to_string(tile.y0) + "\n";
+                Frustum frustum = tile_frustum(camera, tile, width, height);
+                for (const Sphere& sphere : scene.primitives) {
+                    if (frustum.touches(sphere)) footprint += canonical_sphere(scene, sphere) + "\n";
+                }
+                tile.key = hash_hex(footprint);
+                tile.reused = usable && load_tile(scene, tile, pixels);
+            }
+        }
+        stats.tiles_total = static_cast<int>(tiles.size());
+        stats.tiles_reused = static_cast<int>(std::count_if(tiles.begin(), tiles.end(), [](const Tile& t) { return t.reused; }));
+        return stats.tiles_reused;
+    }
+
+    bool tile_reused(int x, int y) const {
+        return !tiles.empty() && tiles[tile_index(x, y)].reused;
+    }
+
+    // Record a primary hit point of pixel (x, y); builds the tile's shadow footprint
+    void record_hit(int x, int y, const Point3& point) {
+        if (tiles.empty()) return;
+        Tile& tile = tiles[tile_index(x, y)];
+        Vector3 p(point.x, point.y, point.z);
+        if (!tile.any_hit) {
+            tile.hit_min = tile.hit_max = p;
+            tile.any_hit = true;
+        } else {
+            tile.hit_min = Vector3(std::min(tile.hit_min.x, p.x), std::min(tile.hit_min.y, p.y), std::min(tile.hit_min.z, p.z));
+            tile.hit_max = Vector3(std::max(tile.hit_max.x, p.x), std::max(tile.hit_max.y, p.y), std::max(tile.hit_max.z, p.z));
+        }
+    }
+
+    // Store every freshly rendered tile; returns the number written
+    int store_tiles(const Scene& scene, const std::vector<Vector3>& pixels) {
+        if (!usable) return 0;
+        for (Tile& tile : tiles) {
+            if (tile.reused) continue;
+            Vector3 center = tile.any_hit ? (tile.hit_min + tile.hit_max) * 0.5f : Vector3(0, 0, 0);
+            float radius = tile.any_hit ? (tile.hit_max - tile.hit_min).length() * 0.5f + shadow_margin : 0.0f;
+            std::string shadow = shadow_footprint(scene, tile.any_hit, center, radius);
+            bool written = write_entry(entry_path(tile.key, ".tile"), [&](std::ofstream& file) {
+                file.write(tile_magic, 4);
+                file.write(shadow.data(), static_cast<std::streamsize>(shadow.size()));
+                write_value(file, static_cast<int>(tile.any_hit));
+                write_value(file, center.x);
+                write_value(file, center.y);
+                write_value(file, center.z);
+                write_value(file, radius);
+                for (int y = tile.y0; y < tile.y1; y++) {
+                    file.write(reinterpret_cast<const char*>(&pixels[static_cast<size_t>(y) * image_width + tile.x0]),
+                               static_cast<std::streamsize>((tile.x1 - tile.x0) * sizeof(Vector3)));
+                }
+            });
+            if (written) stats.tiles_stored++;
+        }
+        return stats.tiles_stored;
+    }
+
+    // Remove least recently used entries until the directory fits in max_bytes
+    void evict() {
+        if (!usable) return;
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type time;
+            size_t bytes;
+        };
+        std::vector<Entry> entries;
+        size_t total = 0;
+        std::error_code error;
+        for (const auto& item : std::filesystem::directory_iterator(settings.directory, error)) {
+            if (!item.is_regular_file(error)) continue;
+            std::string extension = item.path().extension().string();
+            if (extension != ".img" && extension != ".tile") continue;
+            size_t bytes = static_cast<size_t>(item.file_size(error));
+            entries.push_back({item.path(), item.last_write_time(error), bytes});
+            total += bytes;
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+        for (const Entry& entry : entries) {
+            if (total <= settings.max_bytes) break;
+            if (std::filesystem::remove(entry.path, error)) {
+                total -= entry.bytes;
+                stats.files_evicted++;
+            }
+        }
+        stats.directory_bytes = total;
+    }
+
+private:
+    struct Tile {
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        std::string key;
+        bool reused = false;
+        bool any_hit = false;
+        Vector3 hit_min, hit_max;
+    };
+
+    // Four planes through the eye bounding every primary ray of a tile (inward normals)
+    struct Frustum {
+        Vector3 eye;
+        Vector3 normals[4];
+
+        bool touches(const Sphere& sphere) const {
+            Vector3 to_center = Vector3(sphere.center.x, sphere.center.y, sphere.center.z) - eye;
+            for (const Vector3& normal : normals) {
+                if (normal.dot(to_center) < -sphere.radius - frustum_margin) return false;
+            }
+            return true;
+        }
+    };
+
+    Settings settings;
+    Statistics stats;
+    bool usable = true;
+    std::vector<Tile> tiles;
+    int tiles_x = 0, tiles_y = 0;
+    int image_width = 0, image_height = 0;
+
+    static constexpr const char* image_magic = "RCI1";
+    static constexpr const char* tile_magic = "RCT1";
+    static constexpr float frustum_margin = 1e-3f;
+    static constexpr float shadow_margin = 2e-3f;   // Covers the shadow-ray origin offset (ε = 0.001)
+
+    size_t tile_index(int x, int y) const {
+        return static_cast<size_t>(y / settings.tile_size) * tiles_x + x / settings.tile_size;
+    }
+
+    // Rays are generated at integer pixel coordinates and are affine in (x, y), so the corner rays
+    // (widened by half a pixel against rounding) span every ray of the tile
+    static Frustum tile_frustum(const Camera& camera, const Tile& tile, int width, int height) {
+        float left = tile.x0 - 0.5f, right = tile.x1 - 0.5f, top = tile.y0 - 0.5f, bottom = tile.y1 - 0.5f;
+        Vector3 corners[4] = {
+            camera.generate_ray(left, top, width, height).direction,
+            camera.generate_ray(right, top, width, height).direction,
+            camera.generate_ray(right, bottom, width, height).direction,
+            camera.generate_ray(left, bottom, width, height).direction,
+        };
+        Frustum frustum;
+        frustum.eye = Vector3(camera.position.x, camera.position.y, camera.position.z);
+        Vector3 center_direction = corners[0] + corners[1] + corners[2] + corners[3];
+        for (int i = 0; i < 4; i++) {
+            Vector3 normal = corners[i].cross(corners[(i + 1) % 4]).normalize();
+            frustum.normals[i] = normal.dot(center_direction) >= 0.0f ? normal : normal * -1.0f;
+        }
+        return frustum;
+    }
+
+    // Spheres that can block a shadow ray from the hit ball (center, radius) to any light
+    static std::string shadow_footprint(const Scene& scene, bool any_hit, const Vector3& center, float radius) {
+        if (!any_hit) return hash_hex("no-hits");
+        std::string text;
+        for (const auto& light : scene.lights) {
+            Vector3 target = center;
+            float light_radius = 0.0f;
+            bool infinite = false;
+            if (const auto* point = dynamic_cast<const PointLight*>(light.get())) {
+                target = point->position;
+            } else if (const auto* directional = dynamic_cast<const DirectionalLight*>(light.get())) {
+                target = center - directional->direction;
+                infinite = true;
+            } else if (const auto* area = dynamic_cast<const AreaLight*>(light.get())) {
+                target = area->center;
+                light_radius = 0.5f * std::sqrt(area->width * area->width + area->height * area->height);
+            } else if (const auto* sphere = dynamic_cast<const SphereLight*>(light.get())) {
+                target = sphere->center;
+                light_radius = sphere->radius;
+            }
+            for (const Sphere& sphere : scene.primitives) {
+                Vector3 p(sphere.center.x, sphere.center.y, sphere.center.z);
+                if (segment_distance(p, center, target, infinite) <= radius + light_radius + sphere.radius + shadow_margin) {
+                    bool valid = sphere.material_index >= 0 && sphere.material_index < static_cast<int>(scene.materials.size());
+                    std::ostringstream out;
+                    out << std::hexfloat << sphere.center.x << " " << sphere.center.y << " " << sphere.center.z << " "
+                        << sphere.radius << (valid ? "\n" : " no-material\n");
+                    text += out.str();
+                }
+            }
+            text += "|\n";
+        }
+        return hash_hex(text);
+    }
+
+    // Distance from p to segment a→b (or the ray from a through b when infinite)
+    static float segment_distance(const Vector3& p, const Vector3& a, const Vector3& b, bool infinite) {
+        Vector3 ab = b - a;
+        float length_squared = ab.dot(ab);
+        float s = length_squared > 0.0f ? (p - a).dot(ab) / length_squared : 0.0f;
+        s = infinite ? std::max(0.0f, s) : std::max(0.0f, std::min(1.0f, s));
+        return (p - (a + ab * s)).length();
+    }
+
+    bool load_tile(const Scene& scene, const Tile& tile, std::vector<Vector3>& pixels) {
+        std::string path = entry_path(tile.key, ".tile");
+        std::ifstream file(path, std::ios::binary);
+        if (!file || !read_header(file, tile_magic)) return false;
+        std::string stored_shadow(32, ' ');
+        int any_hit = 0;
+        Vector3 center;
+        float radius = 0.0f;
+        if (!file.read(&stored_shadow[0], 32) || !read_value(file, any_hit) || !read_value(file, center.x) ||
+            !read_value(file, center.y) || !read_value(file, center.z) || !read_value(file, radius)) {
+            return false;
+        }
+        if (shadow_footprint(scene, any_hit != 0, center, radius) != stored_shadow) return false;
+
+        int tile_width = tile.x1 - tile.x0;
+        std::vector<Vector3> stored(static_cast<size_t>(tile_width) * (tile.y1 - tile.y0));
+        if (!read_pixels(file, stored)) return false;
+        for (int y = tile.y0; y < tile.y1; y++) {
+            std::copy(stored.begin() + static_cast<size_t>(y - tile.y0) * tile_width,
+                      stored.begin() + static_cast<size_t>(y - tile.y0 + 1) * tile_width,
+                      pixels.begin() + static_cast<size_t>(y) * image_width + tile.x0);
+        }
+        touch(path);
+        return true;
+    }
+
+    std::string entry_path(const std::string& key, const char* extension) const {
+        return (std::filesystem::path(settings.directory) / (key + extension)).string();
+    }
+
+    // Write to "<path>.tmp" and rename, so a concurrent reader never sees a partial entry
+    template<typename Writer>
+    bool write_entry(const std::string& path, Writer writer) {
+        std::string temporary_path = path + ".tmp";
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            writer(file);
+            if (!file) return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+        if (error) {
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+        return true;
+    }
+
+    static void touch(const std::string& path) {
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    }
+
+    static bool read_header(std::ifstream& file, const char* magic) {
+        char header[4];
+        return file.read(header, 4) && std::equal(header, header + 4, magic);
+    }
+
+    template<typename T>
+    static bool read_value(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template<typename T>
+    static void write_value(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool read_pixels(std::ifstream& file, std::vector<Vector3>& pixels) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(pixels.data()),
+                                           static_cast<std::streamsize>(pixels.size() * sizeof(Vector3))));
+    }
+
+    static void write_pixels(std::ofstream& file, const std::vector<Vector3>& pixels) {
+        file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size() * sizeof(Vector3)));
+    }
+};
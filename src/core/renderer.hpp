@@ -0,0 +1,160 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "primary_rasterizer.hpp"
+#include "cost_attribution.hpp"
+#include "../lights/light_base.hpp"
+#include <vector>
+
+// Renderer collects the generic per-pixel shading path used by the Scene-based renderer
+// Educational focus: one reference implementation of direct lighting that main.cpp, tools
+// and tests share, so that optimized paths (compiled scenes, approximations) can be compared
+// against exactly the same mathematics
+//
+// Shading model (direct lighting only):
+//   L_o = Σ_lights f_r(wi, wo) * L_i * max(0, n·wi) * V(p, light)
+// where V is the binary shadow-ray visibility term
+class Renderer {
+public:
+    // Background color returned for rays that miss every primitive (dark blue)
+    static Vector3 background_color() {
+        return Vector3(0.1f, 0.1f, 0.15f);
+    }
+
+    // Direct lighting at a surface hit: accumulate every scene light with shadow testing
+    // Parameters:
+    //   scene: scene providing lights and occlusion queries
+    //   hit: closest intersection returned by Scene::intersect (must have hit == true)
+    //   eye: ray origin used to compute the view direction (camera position for primary rays)
+    //   costs: optional per-thread cost attribution (see CostAttribution), nullptr = off
+    static Vector3 shade_direct_lighting(const Scene& scene, const Scene::Intersection& hit, const Point3& eye,
+                                         CostAttribution::Counters* costs = nullptr) {
+        auto shading_start = CostAttribution::start(costs);
+        int material = CostAttribution::material_index(hit);
+        Vector3 color(0, 0, 0);
+        Vector3 surface_point(hit.point.x, hit.point.y, hit.point.z);
+        Vector3 view_direction = (eye - hit.point).normalize();
+
+        for (size_t l = 0; l < scene.lights.size(); l++) {
+            const auto& light = scene.lights[l];
+            auto light_start = CostAttribution::start(costs);
+            Vector3 light_direction;
+            float light_distance;
+            Vector3 light_contribution = light->illuminate(surface_point, light_direction, light_distance);
+
+            // Shadow ray testing: only unoccluded lights contribute
+            bool occluded = light->is_occluded(surface_point, light_direction, light_distance, scene);
+            if (costs) costs->record_shadow_ray(l, occluded, light_start);
+            if (!occluded) {
+                color += hit.material->scatter_light(light_direction, view_direction, hit.normal,
+                                                     light_contribution, false);
+                if (costs) costs->record_brdf_evaluation(material);
+            }
+        }
+        if (costs) costs->record_shading(material, shading_start);
+        return color;
+    }
+
+    // Direct lighting through one stochastically selected lobe (Material::select_lobe)
+    // Every light evaluates only lobe k, weighted by 1/p_k so the expectation over k equals
+    // shade_direct_lighting(); identical to it for single-lobe materials
+    static Vector3 shade_direct_lighting(const Scene& scene, const Scene::Intersection& hit, const Point3& eye,
+                                         int lobe, float lobe_probability,
+                                         CostAttribution::Counters* costs = nullptr) {
+        auto shading_start = CostAttribution::start(costs);
+        int material = CostAttribution::material_index(hit);
+        Vector3 color(0, 0, 0);
+        Vector3 surface_point(hit.point.x, hit.point.y, hit.point.z);
+        Vector3 view_direction = (eye - hit.point).normalize();
+        float inverse_probability = 1.0f / lobe_probability;
+
+        for (size_t l = 0; l < scene.lights.size(); l++) {
+            const auto& light = scene.lights[l];
+            auto light_start = CostAttribution::start(costs);
+            Vector3 light_direction;
+            float light_distance;
+            Vector3 light_contribution = light->illuminate(surface_point, light_direction, light_distance);
+            float cos_theta = hit.normal.dot(light_direction);
+            if (cos_theta <= 0.0f) continue;   // No shadow ray for lights behind the surface
+
+            bool occluded = light->is_occluded(surface_point, light_direction, light_distance, scene);
+            if (costs) costs->record_shadow_ray(l, occluded, light_start);
+            if (!occluded) {
+                Vector3 brdf = hit.material->evaluate_lobe(lobe, light_direction, view_direction, hit.normal);
+                float scale = cos_theta * inverse_probability;
+                color += Vector3(brdf.x * light_contribution.x, brdf.y * light_contribution.y,
+                                 brdf.z * light_contribution.z) * scale;
+                if (costs) costs->record_brdf_evaluation(material);
+            }
+        }
+        if (costs) costs->record_shading(material, shading_start);
+        return color;
+    }
+
+    // Trace a single primary ray through the generic Scene path
+    // Returns background color on miss, direct lighting on hit
+    static Vector3 trace_primary(const Scene& scene, const Ray& ray, const Point3& eye) {
+        Scene::Intersection hit = scene.intersect(ray, false);
+        if (!hit.hit) {
+            return background_color();
+        }
+        return shade_direct_lighting(scene, hit, eye);
+    }
+
+    // Primary ray with level of detail: distant clusters may resolve to BVH proxies (Scene::build_bvh)
+    // cone: pixel footprint of the primary ray; lod_error_pixels: screen-space error threshold
+    static Vector3 trace_primary(const Scene& scene, const Ray& ray, const Point3& eye,
+                                 const RayCone& cone, float lod_error_pixels) {
+        Scene::Intersection hit = scene.intersect(ray, cone, lod_error_pixels);
+        if (!hit.hit) {
+            return background_color();
+        }
+        return shade_direct_lighting(scene, hit, eye);
+    }
+
+    // Render a full frame into a row-major linear RGB buffer (width * height entries)
+    // Colors are clamped to [0,1] exactly like Image::set_pixel for direct comparison
+    // lod_error_pixels > 0 enables BVH level of detail for primary rays (requires Scene::build_bvh)
+    static void render_frame(const Scene& scene, const Camera& camera, int width, int height,
+                             std::vector<Vector3>& pixels, float lod_error_pixels = 0.0f) {
+        pixels.assign(static_cast<size_t>(width) * height, Vector3(0, 0, 0));
+        RayCone pixel_cone(0.0f, camera.pixel_spread_angle(height));
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                Vector3 color = lod_error_pixels > 0.0f
+                    ? trace_primary(scene, ray, camera.position, pixel_cone, lod_error_pixels)
+                    : trace_primary(scene, ray, camera.position);
+                pixels[static_cast<size_t>(y) * width + x] = clamp_color(color);
+            }
+        }
+    }
+
+    // Render a full frame with rasterized primary visibility (see PrimaryRasterizer)
+    // Identical to the exact render_frame(): only the order in which primary hits are found changes
+    static void render_frame(const Scene& scene, const Camera& camera, int width, int height,
+                             std::vector<Vector3>& pixels, PrimaryRasterizer& rasterizer) {
+        rasterizer.rasterize(scene, camera, width, height);
+        pixels.assign(static_cast<size_t>(width) * height, Vector3(0, 0, 0));
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                Scene::Intersection hit = rasterizer.intersection(scene, ray, x, y);
+                Vector3 color = hit.hit ? shade_direct_lighting(scene, hit, camera.position) : background_color();
+                pixels[static_cast<size_t>(y) * width + x] = clamp_color(color);
+            }
+        }
+    }
+
+    // Clamp linear RGB to display range [0,1] (matches Image::clamp_color)
+    static Vector3 clamp_color(const Vector3& color) {
+        return Vector3(
+            std::max(0.0f, std::min(color.x, 1.0f)),
+            std::max(0.0f, std::min(color.y, 1.0f)),
+            std::max(0.0f, std::min(color.z, 1.0f))
+        );
+    }
+};
@@ -5,13 +5,18 @@
 #include "sphere.hpp"
 #include "../materials/lambert.hpp"
 #include "../materials/cook_torrance.hpp"
+#include "../materials/openpbr.hpp"
+#include "../materials/material_graph.hpp"
 #include "../materials/material_base.hpp"
 #include "../lights/light_base.hpp"
+#include "lod_bvh.hpp"
+#include "huge_pages.hpp"
 #include <vector>
 #include <memory>
 #include <iostream>
 #include <chrono>
 #include <limits>
+#include <atomic>
 
 // Scene class manages multiple primitive objects and materials for ray tracing
 // Educational focus: demonstrates ray-scene intersection algorithms and performance monitoring
@@ -30,13 +35,37 @@ public:
     std::vector<std::unique_ptr<Light>> lights;
     
     // Educational performance monitoring for intersection statistics
-    mutable int total_intersection_tests = 0;
-    mutable int successful_intersections = 0;
-    mutable float total_intersection_time_ms = 0.0f;
+    // Atomic (relaxed) so multithreaded renderers can share one Scene without data races
+    mutable std::atomic<int> total_intersection_tests{0};
+    mutable std::atomic<int> successful_intersections{0};
+    mutable std::atomic<float> total_intersection_time_ms{0.0f};
+
+    // Optional acceleration structure (build_bvh); discarded whenever a sphere is added
+    std::unique_ptr<LodBVH> bvh;
 
     // Default constructor creates empty scene
     Scene() = default;
 
+    // Move operations (atomics are not movable, so statistics are transferred by value)
+    Scene(Scene&& other) noexcept
+        : primitives(std::move(other.primitives)), materials(std::move(other.materials)),
+          lights(std::move(other.lights)),
+          total_intersection_tests(other.total_intersection_tests.load()),
+          successful_intersections(other.successful_intersections.load()),
+          total_intersection_time_ms(other.total_intersection_time_ms.load()),
+          bvh(std::move(other.bvh)) {}
+
+    Scene& operator=(Scene&& other) noexcept {
+        primitives = std::move(other.primitives);
+        materials = std::move(other.materials);
+        lights = std::move(other.lights);
+        bvh = std::move(other.bvh);
+        total_intersection_tests = other.total_intersection_tests.load();
+        successful_intersections = other.successful_intersections.load();
+        total_intersection_time_ms = other.total_intersection_time_ms.load();
+        return *this;
+    }
+
     // Intersection result structure containing complete hit information
     // Provides all necessary data for rendering: geometry, material, and surface properties
     struct Intersection {
@@ -63,7 +92,11 @@ public:
     // Algorithm: iterate through all primitives, track closest intersection with t-value comparison
     // Educational features: performance statistics, detailed console output for learning
     // Returns: complete intersection information including material and primitive references
+    // With a BVH built, non-verbose queries (render and shadow rays) use exact BVH traversal instead
     Intersection intersect(const Ray& ray, bool verbose = true) const {
+        if (bvh && !verbose) {
+            return intersect(ray, RayCone(), 0.0f);
+        }
         if (verbose) {
             std::cout << "\n=== Ray-Scene Intersection Testing ===" << std::endl;
             std::cout << "Ray origin: (" << ray.origin.x << ", " << ray.origin.y << ", " << ray.origin.z << ")" << std::endl;
@@ -86,7 +119,7 @@ public:
         for (size_t i = 0; i < primitives.size(); ++i) {
             const Sphere& sphere = primitives[i];
             current_test_count++;
-            total_intersection_tests++;
+            total_intersection_tests.fetch_add(1, std::memory_order_relaxed);
             
             if (verbose) {
                 std::cout << "\nTesting sphere " << i << ":" << std::endl;
@@ -106,7 +139,7 @@ public:
                 
                 // Check if this is the closest intersection so far
                 if (sphere_hit.t > 0.001f && sphere_hit.t < closest_hit.t) {
-                    successful_intersections++;
+                    successful_intersections.fetch_add(1, std::memory_order_relaxed);
                     if (verbose) {
                         std::cout << "  NEW CLOSEST HIT (previous closest t = " << closest_hit.t << ")" << std::endl;
                     }
@@ -149,7 +182,7 @@ public:
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         float intersection_time = duration.count() / 1000.0f; // Convert to milliseconds
-        total_intersection_time_ms += intersection_time;
+        total_intersection_time_ms.fetch_add(intersection_time, std::memory_order_relaxed);
 
         // Educational performance statistics output
         if (verbose) {
@@ -188,6 +221,50 @@ public:
         return closest_hit;
     }
 
+    // Level-of-detail ray-scene intersection through the BVH
+    // cone: pixel footprint of the ray (see RayCone); lod_error_pixels: screen-space error threshold
+    // Nodes projecting to at most lod_error_pixels pixels are replaced by their aggregate proxy
+    // (bounding sphere + averaged Lambert material, primitive == nullptr); 0 gives the exact closest hit.
+    // Falls back to the linear test when no BVH has been built. Per-ray timing is not recorded here.
+    Intersection intersect(const Ray& ray, const RayCone& cone, float lod_error_pixels) const {
+        if (!bvh) {
+            return intersect(ray, false);
+        }
+        int primitive_tests = 0;
+        LodBVH::Hit hit = bvh->intersect(ray, cone, lod_error_pixels, primitives, materials, primitive_tests);
+        total_intersection_tests.fetch_add(primitive_tests, std::memory_order_relaxed);
+        if (!hit.hit) {
+            return Intersection();
+        }
+        successful_intersections.fetch_add(1, std::memory_order_relaxed);
+        const Sphere* primitive = hit.primitive_index >= 0 ? &primitives[hit.primitive_index] : nullptr;
+        return Intersection(hit.t, hit.point, hit.normal, hit.material, primitive);
+    }
+
+    // Build the BVH over current primitives (call after the scene is fully loaded)
+    // lazy = true splits only the top levels now and the rest on first ray contact (see lod_bvh.hpp)
+    void build_bvh(bool lazy = false) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        bvh = std::make_unique<LodBVH>(primitives, materials, lazy);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::cout << (lazy ? "Lazy BVH built: " : "BVH built: ") << primitives.size() << " spheres, " << bvh->node_count()
+                  << " nodes, depth " << bvh->depth();
+        if (lazy) {
+            std::cout << ", " << bvh->expanded_node_count() << "/" << bvh->interior_node_count() << " interior nodes expanded";
+        }
+        std::cout << " ("
+                  << std::chrono::duration<double, std::milli>(end_time - start_time).count() << " ms)" << std::endl;
+    }
+
+    // Move the sphere array (and BVH, if built) into huge-page advised memory
+    // Call after loading and build_bvh(): later add_sphere() calls reallocate into 4 KB pages again
+    void use_huge_pages(HugePages::Statistics& stats) {
+        HugePages::rehome(primitives, "Scene spheres", stats);
+        if (bvh) {
+            bvh->use_huge_pages(stats);
+        }
+    }
+
     // Add polymorphic material to scene and return its index for primitive referencing
     // Educational transparency: reports material assignment and validates parameters
     // Supports both Lambert and Cook-Torrance materials through Material base class polymorphism
@@ -276,6 +353,9 @@ public:
             case LightType::Area:
                 light_type_name = "Area Light";
                 break;
+            case LightType::Sphere:
+                light_type_name = "Sphere Light";
+                break;
         }
         std::cout << "Light Type: " << light_type_name << std::endl;
         
@@ -308,6 +388,7 @@ public:
         }
         
         primitives.push_back(sphere);
+        bvh.reset();  // Indices changed: BVH must be rebuilt
         int sphere_index = static_cast<int>(primitives.size() - 1);
         
         std::cout << "Sphere added at index: " << sphere_index << std::endl;
@@ -380,6 +461,15 @@ public:
                     std::cout << "    Roughness: " << ct_material->roughness 
                              << ", Metallic: " << ct_material->metallic 
                              << ", Specular: " << ct_material->specular << std::endl;
+                } else if (material->type == MaterialType::OpenPBR) {
+                    const OpenPBRMaterial* pbr_material = static_cast<const OpenPBRMaterial*>(material);
+                    std::cout << "    Metalness: " << pbr_material->base_metalness
+                             << ", Roughness: " << pbr_material->specular_roughness
+                             << ", IOR: " << pbr_material->specular_ior
+                             << ", Coat: " << pbr_material->coat_weight << std::endl;
+                } else if (material->type == MaterialType::Graph) {
+                    std::cout << "    ";
+                    static_cast<const GraphMaterial*>(material)->program.statistics.print();
                 }
             }
         }
@@ -410,6 +500,12 @@ public:
                 total_bytes += sizeof(LambertMaterial);
             } else if (material->type == MaterialType::CookTorrance) {
                 total_bytes += sizeof(CookTorranceMaterial);
+            } else if (material->type == MaterialType::OpenPBR) {
+                total_bytes += sizeof(OpenPBRMaterial);
+            } else if (material->type == MaterialType::Graph) {
+                const MaterialProgram& program = static_cast<const GraphMaterial*>(material.get())->program;
+                total_bytes += sizeof(GraphMaterial) + program.instructions.capacity() * sizeof(MaterialProgram::Instruction) +
+                               program.constants.capacity() * sizeof(Vector3);
             } else {
                 // Default to base Material size for unknown types
                 total_bytes += sizeof(Material);
@@ -443,6 +539,10 @@ public:
             } else if (material->type == MaterialType::CookTorrance) {
                 material_memory += sizeof(CookTorranceMaterial);
                 cook_torrance_count++;
+            } else if (material->type == MaterialType::OpenPBR) {
+                material_memory += sizeof(OpenPBRMaterial);
+            } else if (material->type == MaterialType::Graph) {
+                material_memory += sizeof(GraphMaterial);
             } else {
                 material_memory += sizeof(Material);
             }
@@ -3,25 +3,56 @@
 #include "sphere.hpp"
 #include "../materials/lambert.hpp"
 #include "../materials/cook_torrance.hpp"
+#include "../materials/openpbr.hpp"
+#include "../materials/material_graph.hpp"
 #include "../lights/light_base.hpp"
 #include "../lights/point_light.hpp"
 #include "../lights/directional_light.hpp"
 #include "../lights/area_light.hpp"
+#include "../lights/sphere_light.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <map>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 // SceneLoader handles parsing of simple scene files for educational multi-primitive scenes
 // File format: Simple key-value pairs with educational transparency and error handling
 // Educational focus: demonstrates scene data management and file I/O integration
 class SceneLoader {
 public:
+    // Optional sphere filter: spheres for which it returns false are parsed but not kept
+    // Called once per valid sphere, in file order, so a caller can count file-order indices
+    // (sort-last workers load only their spatial chunk this way, see sort_last_renderer.hpp)
+    using SphereFilter = std::function<bool(const Sphere&)>;
+
+    // A parsed include file, shared by every scene that includes it (see the include cache below)
+    // Materials, lights and spheres appear in file order; nested includes are already merged in
+    struct SceneAsset {
+        Scene fragment;
+        std::map<std::string, int> material_names;        // Name -> fragment material index at end of file
+        std::vector<std::string> unresolved_materials;    // Per fragment sphere: material name the including
+                                                          // scene resolves ("" = uses fragment material_index)
+        std::vector<std::pair<std::string, std::filesystem::file_time_type>> dependencies;  // This file and its includes
+                                                          // (missing includes with file_time_type{})
+    };
+
+    struct IncludeCacheStatistics {
+        int parses = 0;   // Include files read and parsed
+        int hits = 0;     // Includes served from an already parsed asset
+    };
+
     // Load scene from file with comprehensive error handling and educational output
     // Returns: Complete Scene object with primitives and materials loaded from file
-    static Scene load_from_file(const std::string& filename, const std::string& material_type = "lambert") {
+    static Scene load_from_file(const std::string& filename, const std::string& material_type = "lambert",
+                                const SphereFilter& keep_sphere = nullptr) {
         std::cout << "\n=== Loading Scene from File ===" << std::endl;
         std::cout << "File: " << filename << std::endl;
         
@@ -36,23 +67,109 @@ public:
         file.close();
         
         std::cout << "File loaded successfully, size: " << content.size() << " bytes" << std::endl;
-        return load_from_string(content, material_type);
+        return load_from_string(content, material_type, keep_sphere, filename);
     }
     
     // Parse scene from string content with educational debugging output
     // Algorithm: line-by-line parsing with material and sphere registration
-    static Scene load_from_string(const std::string& content, const std::string& material_type = "lambert") {
+    // source_file (optional): file the content came from; relative includes resolve against its
+    // directory (the working directory otherwise) and it may not include itself
+    static Scene load_from_string(const std::string& content, const std::string& material_type = "lambert",
+                                  const SphereFilter& keep_sphere = nullptr,
+                                  const std::string& source_file = "") {
         std::cout << "\n=== Parsing Scene Content ===" << std::endl;
         
         Scene scene;
         std::map<std::string, int> material_name_to_index;
+        ParseState state{scene, material_name_to_index, keep_sphere};
+        if (!source_file.empty()) {
+            std::error_code error;
+            std::filesystem::path source = std::filesystem::weakly_canonical(source_file, error);
+            if (!error) {
+                state.directory = source.parent_path().string();
+                state.include_stack.push_back(source.string());
+            }
+        }
         
-        std::istringstream stream(content);
-        std::string line;
-        int line_number = 0;
+        int line_number = parse_content(content, state);
+        
+        std::cout << "\n=== Scene Loading Summary ===" << std::endl;
+        std::cout << "Lines processed: " << line_number << std::endl;
+        std::cout << "Materials loaded: " << state.materials_loaded << std::endl;
+        std::cout << "Spheres loaded: " << state.spheres_loaded << std::endl;
+        std::cout << "Lights loaded: " << state.lights_loaded << std::endl;
+        if (state.includes > 0) {
+            std::cout << "Includes: " << state.includes << " (" << state.includes_cached
+                      << " from the include cache)" << std::endl;
+        }
+        std::cout << "=== Scene loading complete ===" << std::endl;
+        
+        return scene;
+    }
+
+    // Include cache: every included file is parsed once per process and merged from the parsed asset
+    // afterwards, so multi-view and sequence jobs that load many scenes sharing a material library or
+    // a large asset pay for parsing it once. Keyed by canonical path; an asset is parsed again when
+    // the modification time of the file or of anything it includes has changed.
+    static IncludeCacheStatistics include_cache_statistics() {
+        std::lock_guard<std::mutex> lock(include_cache_mutex());
+        return include_cache_stats();
+    }
+
+    static void clear_include_cache() {
+        std::lock_guard<std::mutex> lock(include_cache_mutex());
+        include_cache().clear();
+        include_cache_stats() = IncludeCacheStatistics();
+    }
+    
+private:
+    // Parser state of one file: the top-level scene, or the asset of an include being parsed
+    struct ParseState {
+        Scene& scene;
+        std::map<std::string, int>& material_map;
+        const SphereFilter& keep_sphere;
+        std::string directory;                        // Relative includes resolve against it
+        std::vector<std::string> include_stack;       // Canonical paths being parsed (cycle detection)
+        SceneAsset* asset = nullptr;                  // Parsing an include: unknown sphere materials are deferred
+        bool cacheable = true;                        // False after an include cycle (result depends on the includer)
         int materials_loaded = 0;
         int spheres_loaded = 0;
         int lights_loaded = 0;
+        int includes = 0;
+        int includes_cached = 0;
+
+        ParseState(Scene& target_scene, std::map<std::string, int>& materials, const SphereFilter& filter)
+            : scene(target_scene), material_map(materials), keep_sphere(filter) {}
+    };
+
+    struct CachedAsset {
+        std::shared_ptr<const SceneAsset> asset;
+    };
+
+    static std::mutex& include_cache_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::map<std::string, CachedAsset>& include_cache() {
+        static std::map<std::string, CachedAsset> cache;
+        return cache;
+    }
+
+    static IncludeCacheStatistics& include_cache_stats() {
+        static IncludeCacheStatistics stats;
+        return stats;
+    }
+
+    // Parse scene lines into state; returns the number of lines processed
+    static int parse_content(const std::string& content, ParseState& state) {
+        Scene& scene = state.scene;
+        std::map<std::string, int>& material_name_to_index = state.material_map;
+        std::map<std::string, MaterialGraph> pending_graphs;   // graph_node lines awaiting material_graph
+        
+        std::istringstream stream(content);
+        std::string line;
+        int line_number = 0;
         
         while (std::getline(stream, line)) {
             line_number++;
@@ -68,10 +185,16 @@ public:
             std::string command;
             line_stream >> command;
             
-            if (command == "material") {
+            if (command == "include") {
+                // Another scene file, merged here as if its lines were pasted in
+                if (!parse_include(line_stream, state)) {
+                    std::cout << "WARNING: Failed to include file on line " << line_number << std::endl;
+                }
+            }
+            else if (command == "material") {
                 // Legacy Lambert material format for backward compatibility
                 if (parse_lambert_material_legacy(line_stream, scene, material_name_to_index)) {
-                    materials_loaded++;
+                    state.materials_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse legacy material on line " << line_number << std::endl;
                 }
@@ -79,7 +202,7 @@ public:
             else if (command == "material_lambert") {
                 // Explicit Lambert material format  
                 if (parse_lambert_material(line_stream, scene, material_name_to_index)) {
-                    materials_loaded++;
+                    state.materials_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse Lambert material on line " << line_number << std::endl;
                 }
@@ -87,39 +210,67 @@ public:
             else if (command == "material_cook_torrance") {
                 // Cook-Torrance material format
                 if (parse_cook_torrance_material(line_stream, scene, material_name_to_index)) {
-                    materials_loaded++;
+                    state.materials_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse Cook-Torrance material on line " << line_number << std::endl;
                 }
             }
+            else if (command == "material_openpbr") {
+                // Layered OpenPBR-style material format
+                if (parse_openpbr_material(line_stream, scene, material_name_to_index)) {
+                    state.materials_loaded++;
+                } else {
+                    std::cout << "WARNING: Failed to parse OpenPBR material on line " << line_number << std::endl;
+                }
+            }
+            else if (command == "graph_node") {
+                // One node of a material graph, compiled when its material_graph line commits it
+                if (!parse_graph_node(line_stream, pending_graphs)) {
+                    std::cout << "WARNING: Failed to parse material graph node on line " << line_number << std::endl;
+                }
+            }
+            else if (command == "material_graph") {
+                if (parse_material_graph(line_stream, scene, material_name_to_index, pending_graphs)) {
+                    state.materials_loaded++;
+                } else {
+                    std::cout << "WARNING: Failed to compile material graph on line " << line_number << std::endl;
+                }
+            }
             else if (command == "sphere") {
-                if (parse_sphere(line_stream, scene, material_name_to_index)) {
-                    spheres_loaded++;
+                if (parse_sphere(line_stream, scene, material_name_to_index, state.keep_sphere, state.asset)) {
+                    state.spheres_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse sphere on line " << line_number << std::endl;
                 }
             }
             else if (command == "light_point") {
                 if (parse_point_light(line_stream, scene)) {
-                    lights_loaded++;
+                    state.lights_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse point light on line " << line_number << std::endl;
                 }
             }
             else if (command == "light_directional") {
                 if (parse_directional_light(line_stream, scene)) {
-                    lights_loaded++;
+                    state.lights_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse directional light on line " << line_number << std::endl;
                 }
             }
             else if (command == "light_area") {
                 if (parse_area_light(line_stream, scene)) {
-                    lights_loaded++;
+                    state.lights_loaded++;
                 } else {
                     std::cout << "WARNING: Failed to parse area light on line " << line_number << std::endl;
                 }
             }
+            else if (command == "light_sphere") {
+                if (parse_sphere_light(line_stream, scene)) {
+                    state.lights_loaded++;
+                } else {
+                    std::cout << "WARNING: Failed to parse sphere light on line " << line_number << std::endl;
+                }
+            }
             else if (command == "scene_name" || command == "description") {
                 // Skip metadata for now
                 std::cout << "Metadata: " << command << std::endl;
@@ -129,17 +280,175 @@ public:
             }
         }
         
-        std::cout << "\n=== Scene Loading Summary ===" << std::endl;
-        std::cout << "Lines processed: " << line_number << std::endl;
-        std::cout << "Materials loaded: " << materials_loaded << std::endl;
-        std::cout << "Spheres loaded: " << spheres_loaded << std::endl;
-        std::cout << "Lights loaded: " << lights_loaded << std::endl;
-        std::cout << "=== Scene loading complete ===" << std::endl;
+        return line_number;
+    }
+
+    // Parse an include line and merge the included file into state
+    // Format: include path (relative to the including file; quote paths containing spaces)
+    static bool parse_include(std::istringstream& stream, ParseState& state) {
+        std::string path;
+        if (!(stream >> std::quoted(path)) || path.empty()) {
+            std::cout << "ERROR: Invalid include format. Expected: include path" << std::endl;
+            std::cout << "Example: include materials/metals.scene" << std::endl;
+            return false;
+        }
         
-        return scene;
+        std::filesystem::path resolved(path);
+        if (resolved.is_relative() && !state.directory.empty()) {
+            resolved = std::filesystem::path(state.directory) / resolved;
+        }
+        std::error_code error;
+        std::string key = std::filesystem::weakly_canonical(resolved, error).string();
+        if (error || !std::filesystem::is_regular_file(key, error)) {
+            std::cout << "ERROR: Cannot open included file: " << resolved.string() << std::endl;
+            if (state.asset) {
+                // Creating the file later must invalidate the asset that skipped it
+                state.asset->dependencies.push_back({key.empty() ? resolved.string() : key,
+                                                     std::filesystem::file_time_type{}});
+            }
+            return false;
+        }
+        if (std::find(state.include_stack.begin(), state.include_stack.end(), key) != state.include_stack.end()) {
+            std::cout << "ERROR: Include cycle: " << key << " is already being parsed" << std::endl;
+            state.cacheable = false;
+            return false;
+        }
+        
+        std::shared_ptr<const SceneAsset> asset = cached_asset(key);
+        bool from_cache = asset != nullptr;
+        if (!from_cache) {
+            asset = parse_asset(key, state);
+            if (!asset) {
+                return false;
+            }
+        }
+        
+        std::cout << "Including " << key << (from_cache ? " (from the include cache)" : " (parsed)") << ": "
+                  << asset->fragment.materials.size() << " materials, " << asset->fragment.primitives.size()
+                  << " spheres, " << asset->fragment.lights.size() << " lights" << std::endl;
+        merge_asset(*asset, state);
+        state.includes++;
+        if (from_cache) {
+            state.includes_cached++;
+        }
+        return true;
+    }
+
+    // Cached asset for a canonical path, or nullptr if it was never parsed or a dependency changed since
+    static std::shared_ptr<const SceneAsset> cached_asset(const std::string& key) {
+        std::lock_guard<std::mutex> lock(include_cache_mutex());
+        auto cached = include_cache().find(key);
+        if (cached == include_cache().end()) {
+            return nullptr;
+        }
+        for (const auto& [file, modified] : cached->second.asset->dependencies) {
+            std::error_code error;
+            auto current = std::filesystem::last_write_time(file, error);
+            if (error) {
+                current = std::filesystem::file_time_type{};   // Missing: still valid if it was missing at parse time
+            }
+            if (current != modified) {
+                std::cout << "Include cache: " << file << " changed, parsing " << key << " again" << std::endl;
+                include_cache().erase(cached);
+                return nullptr;
+            }
+        }
+        include_cache_stats().hits++;
+        return cached->second.asset;
+    }
+
+    // Read and parse an included file into a new asset (stored in the include cache)
+    static std::shared_ptr<const SceneAsset> parse_asset(const std::string& key, ParseState& includer) {
+        std::error_code error;
+        auto modified = std::filesystem::last_write_time(key, error);
+        std::ifstream file(key);
+        if (error || !file.is_open()) {
+            std::cout << "ERROR: Cannot open included file: " << key << std::endl;
+            return nullptr;
+        }
+        std::string content((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+        
+        std::cout << "\n=== Parsing Included File: " << key << " ===" << std::endl;
+        auto asset = std::make_shared<SceneAsset>();
+        asset->dependencies.push_back({key, modified});
+        SphereFilter keep_all;   // Filters apply when the asset is merged into a top-level scene
+        ParseState state{asset->fragment, asset->material_names, keep_all};
+        state.directory = std::filesystem::path(key).parent_path().string();
+        state.include_stack = includer.include_stack;
+        state.include_stack.push_back(key);
+        state.asset = asset.get();
+        parse_content(content, state);
+        std::cout << "=== Included file parsed ===" << std::endl;
+        
+        if (!state.cacheable) {
+            includer.cacheable = false;   // Part of the cycle: what it contains depends on who includes it
+            return asset;
+        }
+        std::lock_guard<std::mutex> lock(include_cache_mutex());
+        include_cache()[key] = CachedAsset{asset};
+        include_cache_stats().parses++;
+        return asset;
+    }
+
+    // Append an asset to the scene being parsed: what pasting the included lines in would have produced
+    static void merge_asset(const SceneAsset& asset, ParseState& state) {
+        Scene& scene = state.scene;
+        int material_offset = static_cast<int>(scene.materials.size());
+        for (const auto& material : asset.fragment.materials) {
+            scene.materials.push_back(material->clone());
+        }
+        for (const auto& light : asset.fragment.lights) {
+            scene.lights.push_back(light->clone());
+        }
+        
+        // Names the asset left open refer to materials the includer defined before the include line,
+        // so they resolve before the asset's own names are merged
+        int unresolved = 0;
+        int filtered = 0;
+        for (size_t i = 0; i < asset.fragment.primitives.size(); i++) {
+            Sphere sphere = asset.fragment.primitives[i];
+            std::string material_name = asset.unresolved_materials[i];
+            if (material_name.empty()) {
+                sphere.material_index += material_offset;
+            } else {
+                auto material_it = state.material_map.find(material_name);
+                if (material_it != state.material_map.end()) {
+                    sphere.material_index = material_it->second;
+                    material_name.clear();
+                } else if (!state.asset) {
+                    std::cout << "ERROR: Unknown material '" << material_name << "' for included sphere "
+                              << i << ", skipping it" << std::endl;
+                    unresolved++;
+                    continue;
+                }
+            }
+            if (state.asset) {
+                state.asset->unresolved_materials.push_back(material_name);   // Still open: the next includer's
+            } else if (state.keep_sphere && !state.keep_sphere(sphere)) {
+                filtered++;
+                continue;
+            }
+            scene.primitives.push_back(sphere);
+            state.spheres_loaded++;
+        }
+        scene.bvh.reset();  // Indices changed: BVH must be rebuilt
+        
+        for (const auto& [name, index] : asset.material_names) {
+            state.material_map[name] = material_offset + index;
+        }
+        if (state.asset) {
+            state.asset->dependencies.insert(state.asset->dependencies.end(),
+                                             asset.dependencies.begin(), asset.dependencies.end());
+        }
+        state.materials_loaded += static_cast<int>(asset.fragment.materials.size());
+        state.lights_loaded += static_cast<int>(asset.fragment.lights.size());
+        if (unresolved > 0 || filtered > 0) {
+            std::cout << "Included spheres skipped: " << unresolved << " with unknown materials, "
+                      << filtered << " filtered out" << std::endl;
+        }
     }
     
-private:
     // Parse legacy Lambert material for backward compatibility
     // Format: material name red green blue
     static bool parse_lambert_material_legacy(std::istringstream& stream, Scene& scene, 
@@ -268,10 +577,96 @@ private:
         return true;
     }
     
+    // Parse layered OpenPBR-style material
+    // Format: material_openpbr name base_r base_g base_b metalness roughness ior coat_weight coat_roughness
+    static bool parse_openpbr_material(std::istringstream& stream, Scene& scene,
+                                       std::map<std::string, int>& material_map) {
+        std::string name;
+        float r, g, b, metalness, roughness, ior, coat_weight, coat_roughness;
+
+        if (!(stream >> name >> r >> g >> b >> metalness >> roughness >> ior >> coat_weight >> coat_roughness)) {
+            std::cout << "ERROR: Invalid OpenPBR material format" << std::endl;
+            std::cout << "Expected: material_openpbr name r g b metalness roughness ior coat_weight coat_roughness" << std::endl;
+            std::cout << "Example: material_openpbr car_paint 0.6 0.05 0.05 0.0 0.4 1.5 1.0 0.05" << std::endl;
+            std::cout << "Parameters:" << std::endl;
+            std::cout << "  metalness: [0.0, 1.0] (0.0=dielectric base, 1.0=metal base)" << std::endl;
+            std::cout << "  roughness: [0.01, 1.0] (specular and metal lobes)" << std::endl;
+            std::cout << "  ior: [1.0, 3.0] (base dielectric, typical 1.5)" << std::endl;
+            std::cout << "  coat_weight, coat_roughness: [0.0, 1.0] clear coat on top (coat IOR 1.6)" << std::endl;
+            return false;
+        }
+
+        std::cout << "Parsing OpenPBR material: " << name << std::endl;
+        auto material = std::make_unique<OpenPBRMaterial>(Vector3(r, g, b), metalness, roughness, ior,
+                                                          coat_weight, coat_roughness, 1.6f, 1.0f, true);
+
+        // The constructor clamps; compare against the file values to report what changed
+        bool clamped = material->base_color.x != r || material->base_color.y != g || material->base_color.z != b ||
+                       material->base_metalness != metalness || material->specular_roughness != roughness ||
+                       material->specular_ior != ior || material->coat_weight != coat_weight ||
+                       (coat_weight > 0.0f && material->coat_roughness != coat_roughness);
+        if (clamped) {
+            std::cout << "WARNING: OpenPBR material parameters outside valid ranges were clamped" << std::endl;
+        }
+
+        int material_index = scene.add_material(std::move(material));
+        material_map[name] = material_index;
+
+        std::cout << "OpenPBR material '" << name << "' registered at index " << material_index
+                  << " (Type: Layered BRDF, stochastic lobe selection)" << std::endl;
+        return true;
+    }
+
+    // Parse one material graph node
+    // Format: graph_node graph_name node_name operation input...
+    // Inputs are node names, the built-ins N V L H, or numbers; constants take 1 or 3 numbers
+    static bool parse_graph_node(std::istringstream& stream, std::map<std::string, MaterialGraph>& graphs) {
+        std::string graph_name, node_name, operation;
+        if (!(stream >> graph_name >> node_name >> operation)) {
+            std::cout << "ERROR: Invalid graph node format" << std::endl;
+            std::cout << "Expected: graph_node graph node operation input..." << std::endl;
+            std::cout << "Example: graph_node plastic ndotl dot N L" << std::endl;
+            return false;
+        }
+        std::vector<std::string> inputs;
+        std::string input;
+        while (stream >> input && input[0] != '#') inputs.push_back(input);
+        return graphs[graph_name].add_node(node_name, operation, inputs);
+    }
+
+    // Compile a material graph and register it as a material
+    // Format: material_graph name output_node
+    static bool parse_material_graph(std::istringstream& stream, Scene& scene, std::map<std::string, int>& material_map,
+                                     std::map<std::string, MaterialGraph>& graphs) {
+        std::string name, output;
+        if (!(stream >> name >> output)) {
+            std::cout << "ERROR: Invalid material graph format. Expected: material_graph name output_node" << std::endl;
+            return false;
+        }
+        auto graph = graphs.find(name);
+        if (graph == graphs.end()) {
+            std::cout << "ERROR: Material graph '" << name << "' has no graph_node lines" << std::endl;
+            return false;
+        }
+        graph->second.set_output(output);
+        MaterialProgram program;
+        if (!graph->second.compile(program)) {
+            return false;
+        }
+        graphs.erase(graph);
+
+        int material_index = scene.add_material(std::make_unique<GraphMaterial>(program, true));
+        material_map[name] = material_index;
+        std::cout << "Material graph '" << name << "' registered at index " << material_index
+                  << " (Type: Compiled node graph)" << std::endl;
+        return true;
+    }
+
     // Parse sphere definition with material name resolution
     // Format: sphere center_x center_y center_z radius material_name
     static bool parse_sphere(std::istringstream& stream, Scene& scene,
-                            const std::map<std::string, int>& material_map) {
+                            const std::map<std::string, int>& material_map,
+                            const SphereFilter& keep_sphere = nullptr, SceneAsset* asset = nullptr) {
         float x, y, z, radius;
         std::string material_name;
         
@@ -296,6 +691,19 @@ private:
         
         // Look up material index
         auto material_it = material_map.find(material_name);
+        if (material_it == material_map.end() && asset) {
+            // Included file: the name may refer to a material of the including scene (resolved on merge)
+            Sphere sphere(Point3(x, y, z), radius, 0);
+            if (!sphere.validate_geometry()) {
+                std::cout << "ERROR: Failed to add sphere to scene" << std::endl;
+                return false;
+            }
+            scene.primitives.push_back(sphere);
+            asset->unresolved_materials.push_back(material_name);
+            std::cout << "Sphere added at index " << scene.primitives.size() - 1
+                      << ", material '" << material_name << "' resolved by the including scene" << std::endl;
+            return true;
+        }
         if (material_it == material_map.end()) {
             std::cout << "ERROR: Unknown material '" << material_name << "'" << std::endl;
             std::cout << "Available materials:";
@@ -310,9 +718,16 @@ private:
         
         // Create sphere and add to scene
         Sphere sphere(Point3(x, y, z), radius, material_index);
+        if (keep_sphere && sphere.validate_geometry() && !keep_sphere(sphere)) {
+            std::cout << "Sphere filtered out (not kept by this loader)" << std::endl;
+            return true;
+        }
         int sphere_index = scene.add_sphere(sphere);
         
         if (sphere_index >= 0) {
+            if (asset) {
+                asset->unresolved_materials.push_back("");
+            }
             std::cout << "Sphere added at index " << sphere_index 
                      << " with material index " << material_index << std::endl;
             return true;
@@ -422,7 +837,7 @@ private:
     }
     
     // Parse area light definition
-    // Format: light_area center_x center_y center_z normal_x normal_y normal_z width height color_r color_g color_b intensity
+    // Format: light_area center_x center_y center_z normal_x normal_y normal_z width height color_r color_g color_b intensity [area|solid_angle]
     static bool parse_area_light(std::istringstream& stream, Scene& scene) {
         float cx, cy, cz, nx, ny, nz, width, height, r, g, b, intensity;
         
@@ -436,12 +851,27 @@ private:
             std::cout << "  width, height: rectangular dimensions" << std::endl;
             std::cout << "  color: RGB components [0.0, 1.0]" << std::endl;
             std::cout << "  intensity: dimensionless multiplier (typical: 0.1-2.0)" << std::endl;
+            std::cout << "  sampling (optional): area (default) or solid_angle" << std::endl;
             return false;
         }
+
+        // Optional sampling strategy (area or solid_angle), may be followed by a # comment
+        AreaLightSampling sampling = AreaLightSampling::Area;
+        std::string sampling_name;
+        if (stream >> sampling_name && sampling_name[0] != '#') {
+            if (sampling_name == "solid_angle") {
+                sampling = AreaLightSampling::SolidAngle;
+            } else if (sampling_name != "area") {
+                std::cout << "ERROR: Unknown area light sampling '" << sampling_name << "'" << std::endl;
+                std::cout << "Expected: area or solid_angle (after the intensity)" << std::endl;
+                return false;
+            }
+        }
         
         std::cout << "Parsing area light: center(" << cx << ", " << cy << ", " << cz << ")" << std::endl;
         std::cout << "  Normal: (" << nx << ", " << ny << ", " << nz << ")" << std::endl;
         std::cout << "  Dimensions: " << width << " x " << height << std::endl;
+        std::cout << "  Sampling: " << (sampling == AreaLightSampling::SolidAngle ? "solid angle" : "area") << std::endl;
         std::cout << "  Color: (" << r << ", " << g << ", " << b << "), Intensity: " << intensity << std::endl;
         
         // Validate parameters
@@ -473,7 +903,8 @@ private:
             width,                  // width
             height,                 // height
             Vector3(r, g, b),       // color
-            intensity               // intensity
+            intensity,              // intensity
+            sampling                // sample placement
         );
         
         // Validate and clamp parameters if needed
@@ -485,7 +916,61 @@ private:
         // Add light to scene
         int light_index = scene.add_light(std::move(area_light));
         std::cout << "Area light added at index " << light_index << std::endl;
-        
+
+        return true;
+    }
+
+    // Parse sphere light definition
+    // Format: light_sphere center_x center_y center_z radius color_r color_g color_b intensity
+    static bool parse_sphere_light(std::istringstream& stream, Scene& scene) {
+        float cx, cy, cz, radius, r, g, b, intensity;
+
+        if (!(stream >> cx >> cy >> cz >> radius >> r >> g >> b >> intensity)) {
+            std::cout << "ERROR: Invalid sphere light format" << std::endl;
+            std::cout << "Expected: light_sphere cx cy cz radius r g b intensity" << std::endl;
+            std::cout << "Example: light_sphere 0.0 2.0 -4.0 0.25 1.0 0.9 0.7 40.0" << std::endl;
+            std::cout << "Parameters:" << std::endl;
+            std::cout << "  center: center position of the emitting sphere (x,y,z)" << std::endl;
+            std::cout << "  radius: sphere radius (> 0)" << std::endl;
+            std::cout << "  color: RGB components [0.0, 1.0]" << std::endl;
+            std::cout << "  intensity: emitted radiance (point light equivalent: intensity * pi * radius^2)" << std::endl;
+            return false;
+        }
+
+        std::cout << "Parsing sphere light: center(" << cx << ", " << cy << ", " << cz << ")" << std::endl;
+        std::cout << "  Radius: " << radius << std::endl;
+        std::cout << "  Color: (" << r << ", " << g << ", " << b << "), Intensity: " << intensity << std::endl;
+
+        // Validate parameters
+        if (!validate_light_parameters(r, g, b, intensity)) {
+            return false;
+        }
+
+        // Validate radius
+        if (!(radius > 0.0f)) {
+            std::cout << "ERROR: Invalid sphere light radius (" << radius << ")" << std::endl;
+            std::cout << "Radius must be > 0" << std::endl;
+            return false;
+        }
+
+        // Create sphere light
+        auto sphere_light = std::make_unique<SphereLight>(
+            Vector3(cx, cy, cz),    // center
+            radius,                 // radius
+            Vector3(r, g, b),       // color
+            intensity               // intensity
+        );
+
+        // Validate and clamp parameters if needed
+        if (!sphere_light->validate_parameters()) {
+            std::cout << "WARNING: Sphere light parameters outside valid range, clamping" << std::endl;
+            sphere_light->clamp_parameters();
+        }
+
+        // Add light to scene
+        int light_index = scene.add_light(std::move(sphere_light));
+        std::cout << "Sphere light added at index " << light_index << std::endl;
+
         return true;
     }
     
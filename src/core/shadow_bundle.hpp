@@ -0,0 +1,330 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "lod_bvh.hpp"
+#include "renderer.hpp"
+#include "../lights/light_base.hpp"
+#include "../lights/point_light.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+// ShadowBundleTracer traces the shadow rays of a point light toward a tile of shading points as one bundle
+// Educational focus: rays that share an endpoint can be culled against the BVH together, so a node is
+// tested once per bundle instead of once per ray
+//
+// Every shadow ray toward a PointLight ends at the light position L. Seen from the light, a tile's
+// shadow rays are segments L + t e_i, t ∈ [0, 1], with e_i = (shadow ray origin) - L: one shared origin
+// and a narrow spread of directions. One traversal of Scene::bvh serves the whole bundle. A node
+// (AABB, padded by a small margin for rounding) is skipped for all rays at once if any of these holds:
+//   1. box test:       it misses the bounding box of the segments (L and every shadow ray origin)
+//   2. interval slabs: the slab test evaluated with interval arithmetic, using per-axis direction
+//                      intervals [min e_a, max e_a], gives a lower bound on t_enter above an upper
+//                      bound on t_exit for every ray (axes whose interval contains 0 give no bound)
+//   3. frustum:        it lies outside one of the four planes through L bounding the bundle's slopes
+//                      e_a / e_k and e_b / e_k along the dominant axis k (when every e_i points the
+//                      same way along k)
+// Rays are tested individually only at leaves: each ray still unoccluded is tested against the leaf's
+// spheres with exactly the ray and acceptance rule of PointLight::is_occluded. Occluded rays leave the
+// bundle, and the traversal ends once every ray is occluded. The result matches per-ray shadow testing
+// bit for bit, because culling only skips spheres that no ray of the bundle can reach.
+//
+// render_frame() shades a frame tile by tile: primary hits of the tile, then for each light either one
+// bundle (point lights) or per-ray is_occluded (other light types). Colors are summed per pixel in
+// light order, so the image equals Renderer::render_frame.
+class ShadowBundleTracer {
+public:
+    struct Settings {
+        int tile_size = 8;             // Tile edge in pixels: up to tile_size² rays per bundle
+    };
+
+    struct Statistics {
+        long long bundles = 0;
+        long long bundle_rays = 0;     // Shadow rays traced in bundles
+        long long occluded_rays = 0;
+        long long node_visits = 0;     // BVH nodes visited by bundles
+        long long nodes_culled = 0;    // Nodes skipped for a whole bundle
+        long long leaf_ray_tests = 0;  // Individual ray-sphere tests at leaves
+        long long single_rays = 0;     // Shadow rays of other light types, traced one by one
+        double render_ms = 0.0;
+
+        void print() const {
+            std::cout << "\n=== Shadow Bundle Statistics ===" << std::endl;
+            std::cout << "Bundles: " << bundles << ", rays: " << bundle_rays << " ("
+                      << (bundles > 0 ? static_cast<double>(bundle_rays) / bundles : 0.0) << " per bundle), occluded: "
+                      << occluded_rays << std::endl;
+            std::cout << "Node visits: " << node_visits << " (" << nodes_culled << " culled for the whole bundle), "
+                      << (bundle_rays > 0 ? static_cast<double>(node_visits) / bundle_rays : 0.0) << " per ray" << std::endl;
+            std::cout << "Leaf ray-sphere tests: " << leaf_ray_tests << " ("
+                      << (bundle_rays > 0 ? static_cast<double>(leaf_ray_tests) / bundle_rays : 0.0) << " per ray)" << std::endl;
+            if (single_rays > 0) {
+                std::cout << "Shadow rays of non-point lights (traced individually): " << single_rays << std::endl;
+            }
+            std::cout << "Render time: " << render_ms << " ms" << std::endl;
+        }
+    };
+
+    // One shadow ray: the exact ray PointLight::is_occluded traces, occluded by a hit with 0.001 < t < t_max
+    struct ShadowRay {
+        Ray ray;
+        float t_max;
+    };
+
+    ShadowBundleTracer() = default;
+    explicit ShadowBundleTracer(const Settings& tracer_settings) : settings(tracer_settings) {
+        settings.tile_size = std::max(1, settings.tile_size);
+    }
+
+    // Shadow ray from a surface point toward a point light (direction and distance from illuminate())
+    static ShadowRay shadow_ray(const Vector3& point, const Vector3& light_direction, float distance) {
+        const float epsilon = 0.001f;   // Same offset as PointLight::is_occluded
+        Vector3 offset_point = point + light_direction * epsilon;
+        return {Ray(Point3(offset_point.x, offset_point.y, offset_point.z), light_direction), distance - epsilon};
+    }
+
+    // Occlusion of shadow rays that all end at light_position: occluded[i] = 1 if rays[i] is blocked
+    // Without a BVH every ray falls back to Scene::intersect
+    static void trace_bundle(const Scene& scene, const Vector3& light_position, const std::vector<ShadowRay>& rays,
+                             std::vector<unsigned char>& occluded, Statistics& stats) {
+        occluded.assign(rays.size(), 0);
+        if (rays.empty()) return;
+        stats.bundles++;
+        stats.bundle_rays += static_cast<long long>(rays.size());
+        if (!scene.bvh) {
+            for (size_t i = 0; i < rays.size(); i++) {
+                Scene::Intersection hit = scene.intersect(rays[i].ray, false);
+                occluded[i] = hit.hit && hit.t < rays[i].t_max;
+                stats.occluded_rays += occluded[i];
+            }
+            return;
+        }
+
+        BundleBounds bounds(light_position, rays);
+        std::vector<int> active(rays.size());
+        for (size_t i = 0; i < rays.size(); i++) active[i] = static_cast<int>(i);
+
+        long long culled = 0, leaf_tests = 0;
+        auto enter = [&](const Vector3& box_min, const Vector3& box_max) {
+            if (bounds.culls(box_min, box_max)) {
+                culled++;
+                return false;
+            }
+            return true;
+        };
+        auto leaf = [&](int primitive_index) {
+            const Sphere& sphere = scene.primitives[primitive_index];
+            if (sphere.material_index < 0 || sphere.material_index >= static_cast<int>(scene.materials.size())) {
+                return true;   // Scene::intersect ignores spheres without a valid material
+            }
+            size_t still_active = 0;
+            for (int i : active) {
+                leaf_tests++;
+                Sphere::Intersection hit = sphere.intersect(rays[i].ray, false);
+                if (hit.hit && hit.t > 0.001f && hit.t < rays[i].t_max) {
+                    occluded[i] = 1;
+                } else {
+                    active[still_active++] = i;
+                }
+            }
+            active.resize(still_active);
+            return !active.empty();
+        };
+        stats.node_visits += scene.bvh->traverse(enter, leaf, scene.primitives, scene.materials);
+        stats.nodes_culled += culled;
+        stats.leaf_ray_tests += leaf_tests;
+        stats.occluded_rays += static_cast<long long>(rays.size() - active.size());
+    }
+
+    // Render a frame into a row-major clamped RGB buffer, identical to Renderer::render_frame
+    // Uses scene.bvh when built (bundles fall back to per-ray Scene::intersect without one)
+    void render_frame(const Scene& scene, const Camera& camera, int width, int height, std::vector<Vector3>& pixels) {
+        auto start = std::chrono::high_resolution_clock::now();
+        pixels.assign(static_cast<size_t>(width) * height, Vector3(0, 0, 0));
+        int tile = settings.tile_size;
+        std::vector<Scene::Intersection> hits;
+        std::vector<size_t> hit_pixels;
+        std::vector<Vector3> colors, contributions, directions;
+        std::vector<float> distances;
+        std::vector<ShadowRay> rays;
+        std::vector<unsigned char> occluded;
+
+        for (int tile_y = 0; tile_y < height; tile_y += tile) {
+            for (int tile_x = 0; tile_x < width; tile_x += tile) {
+                // Primary hits of the tile
+                hits.clear();
+                hit_pixels.clear();
+                for (int y = tile_y; y < std::min(tile_y + tile, height); y++) {
+                    for (int x = tile_x; x < std::min(tile_x + tile, width); x++) {
+                        Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                        Scene::Intersection hit = scene.intersect(ray, false);
+                        size_t pixel = static_cast<size_t>(y) * width + x;
+                        if (hit.hit) {
+                            hits.push_back(hit);
+                            hit_pixels.push_back(pixel);
+                        } else {
+                            pixels[pixel] = Renderer::clamp_color(Renderer::background_color());
+                        }
+                    }
+                }
+                size_t count = hits.size();
+                colors.assign(count, Vector3(0, 0, 0));
+                contributions.resize(count);
+                directions.resize(count);
+                distances.resize(count);
+
+                // Lights in scene order, as Renderer::shade_direct_lighting sums them
+                for (const auto& light : scene.lights) {
+                    for (size_t i = 0; i < count; i++) {
+                        Vector3 surface_point(hits[i].point.x, hits[i].point.y, hits[i].point.z);
+                        contributions[i] = light->illuminate(surface_point, directions[i], distances[i]);
+                    }
+                    if (light->type == LightType::Point) {
+                        rays.clear();
+                        for (size_t i = 0; i < count; i++) {
+                            Vector3 surface_point(hits[i].point.x, hits[i].point.y, hits[i].point.z);
+                            rays.push_back(shadow_ray(surface_point, directions[i], distances[i]));
+                        }
+                        trace_bundle(scene, static_cast<const PointLight&>(*light).position, rays, occluded, stats);
+                    } else {
+                        occluded.assign(count, 0);
+                        for (size_t i = 0; i < count; i++) {
+                            Vector3 surface_point(hits[i].point.x, hits[i].point.y, hits[i].point.z);
+                            occluded[i] = light->is_occluded(surface_point, directions[i], distances[i], scene);
+                        }
+                        stats.single_rays += static_cast<long long>(count);
+                    }
+                    for (size_t i = 0; i < count; i++) {
+                        if (occluded[i]) continue;
+                        Vector3 view_direction = (camera.position - hits[i].point).normalize();
+                        colors[i] += hits[i].material->scatter_light(directions[i], view_direction, hits[i].normal,
+                                                                     contributions[i], false);
+                    }
+                }
+                for (size_t i = 0; i < count; i++) {
+                    pixels[hit_pixels[i]] = Renderer::clamp_color(colors[i]);
+                }
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        stats.render_ms += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    const Statistics& statistics() const { return stats; }
+
+private:
+    // Conservative bounds of a bundle of segments L + t e_i, t ∈ [0, 1], used to cull BVH nodes
+    struct BundleBounds {
+        Vector3 origin;
+        Vector3 segment_min, segment_max;    // Box around L and every segment end
+        float direction_min[3], direction_max[3];
+        float margin;                        // Box padding covering rounding of the exact shadow rays
+        bool frustum = false;
+        int axis_k = 0, axis_a = 1, axis_b = 2;
+        float sign = 1.0f;
+        float u_min = 0.0f, u_max = 0.0f, v_min = 0.0f, v_max = 0.0f;
+
+        BundleBounds(const Vector3& light_position, const std::vector<ShadowRay>& rays) : origin(light_position) {
+            float inf = std::numeric_limits<float>::max();
+            segment_min = segment_max = light_position;
+            for (int axis = 0; axis < 3; axis++) {
+                direction_min[axis] = inf;
+                direction_max[axis] = -inf;
+            }
+            Vector3 direction_sum(0, 0, 0);
+            float scale = std::max({std::abs(light_position.x), std::abs(light_position.y), std::abs(light_position.z)});
+            for (const ShadowRay& shadow : rays) {
+                Vector3 end(shadow.ray.origin.x, shadow.ray.origin.y, shadow.ray.origin.z);
+                Vector3 e = end - origin;
+                segment_min = Vector3(std::min(segment_min.x, end.x), std::min(segment_min.y, end.y), std::min(segment_min.z, end.z));
+                segment_max = Vector3(std::max(segment_max.x, end.x), std::max(segment_max.y, end.y), std::max(segment_max.z, end.z));
+                for (int axis = 0; axis < 3; axis++) {
+                    direction_min[axis] = std::min(direction_min[axis], component(e, axis));
+                    direction_max[axis] = std::max(direction_max[axis], component(e, axis));
+                }
+                direction_sum += e;
+                scale = std::max({scale, std::abs(end.x), std::abs(end.y), std::abs(end.z)});
+            }
+            margin = 1e-4f * (1.0f + scale);
+
+            // Frustum along the dominant axis of the bundle, if every segment points the same way along it
+            float ax = std::abs(direction_sum.x), ay = std::abs(direction_sum.y), az = std::abs(direction_sum.z);
+            axis_k = (ax >= ay && ax >= az) ? 0 : (ay >= az ? 1 : 2);
+            axis_a = (axis_k + 1) % 3;
+            axis_b = (axis_k + 2) % 3;
+            sign = component(direction_sum, axis_k) >= 0.0f ? 1.0f : -1.0f;
+            frustum = sign > 0.0f ? direction_min[axis_k] > 0.0f : direction_max[axis_k] < 0.0f;
+            if (frustum) {
+                u_min = v_min = inf;
+                u_max = v_max = -inf;
+                for (const ShadowRay& shadow : rays) {
+                    Vector3 e = Vector3(shadow.ray.origin.x, shadow.ray.origin.y, shadow.ray.origin.z) - origin;
+                    float u = component(e, axis_a) / component(e, axis_k);
+                    float v = component(e, axis_b) / component(e, axis_k);
+                    u_min = std::min(u_min, u);
+                    u_max = std::max(u_max, u);
+                    v_min = std::min(v_min, v);
+                    v_max = std::max(v_max, v);
+                }
+            }
+        }
+
+        // True if no segment of the bundle can reach the box (padded by margin)
+        bool culls(const Vector3& box_min, const Vector3& box_max) const {
+            Vector3 lo = box_min - Vector3(margin, margin, margin);
+            Vector3 hi = box_max + Vector3(margin, margin, margin);
+
+            // 1. Box around all segments
+            if (lo.x > segment_max.x || hi.x < segment_min.x || lo.y > segment_max.y || hi.y < segment_min.y ||
+                lo.z > segment_max.z || hi.z < segment_min.z) {
+                return true;
+            }
+
+            // 2. Slab test with interval arithmetic over the bundle's direction intervals
+            float enter_low = 0.0f, exit_high = 1.0f;
+            for (int axis = 0; axis < 3; axis++) {
+                float d_min = direction_min[axis], d_max = direction_max[axis];
+                if (d_min <= 0.0f && d_max >= 0.0f) continue;   // Interval contains 0: no bound on this axis
+                float inverse_low = 1.0f / d_max, inverse_high = 1.0f / d_min;   // Same sign: 1/d is monotonic
+                float near_plane = component(lo, axis) - component(origin, axis);
+                float far_plane = component(hi, axis) - component(origin, axis);
+                float a0 = near_plane * inverse_low, a1 = near_plane * inverse_high;
+                float b0 = far_plane * inverse_low, b1 = far_plane * inverse_high;
+                // Entry = min of the two slab distances, exit = max: bound both over the interval
+                enter_low = std::max(enter_low, std::min({a0, a1, b0, b1}));
+                exit_high = std::min(exit_high, std::max({a0, a1, b0, b1}));
+                if (enter_low > exit_high) return true;
+            }
+
+            // 3. Frustum planes through the light: s (w_a - u_min w_k) ≥ 0, s (u_max w_k - w_a) ≥ 0, same for v
+            if (frustum) {
+                Vector3 w_lo = lo - origin, w_hi = hi - origin;
+                auto max_over_box = [&](float coefficient_k, float coefficient_other, int other_axis) {
+                    float k_term = std::max(coefficient_k * component(w_lo, axis_k), coefficient_k * component(w_hi, axis_k));
+                    float other_term = std::max(coefficient_other * component(w_lo, other_axis),
+                                                coefficient_other * component(w_hi, other_axis));
+                    return k_term + other_term;
+                };
+                if (max_over_box(-sign * u_min, sign, axis_a) < 0.0f) return true;
+                if (max_over_box(sign * u_max, -sign, axis_a) < 0.0f) return true;
+                if (max_over_box(-sign * v_min, sign, axis_b) < 0.0f) return true;
+                if (max_over_box(sign * v_max, -sign, axis_b) < 0.0f) return true;
+            }
+            return false;
+        }
+
+        static float component(const Vector3& v, int axis) {
+            return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+        }
+    };
+
+    Settings settings;
+    Statistics stats;
+};
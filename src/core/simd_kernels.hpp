@@ -0,0 +1,335 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "camera.hpp"
+#include "../materials/cook_torrance.hpp"
+#include "../materials/lambert.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// SimdKernels: SIMD variants of the innermost scalar kernels, several samples per instruction
+// Educational focus: structure-of-arrays batches and lane masks instead of one Vector3 at a time
+//   intersect_spheres      Sphere::intersect, one ray against a batch of spheres
+//   cook_torrance_brdf     CookTorranceMaterial::evaluate_brdf, a batch of direction triples
+//   lambert_scatter        LambertMaterial::scatter_light, a batch of lights/normals
+//   camera_ray_directions  Camera::generate_ray directions, a batch of pixel positions
+//
+// Branches of the scalar code become masks: both sides are computed for every lane and
+// Lanes::select keeps the side the scalar code would have taken. Comparisons are ordered (false for
+// NaN) and min/max follow the x86 rule (a > b ? a : b), which is what std::max(0.0f, x) does with a
+// NaN x, so NaN and Inf lanes end up where the scalar code sends them.
+//
+// Every kernel body is written once (simd_kernels_impl.hpp) against a small Lanes interface and
+// compiled for each instruction set: scalar (1 lane), SSE (4), AVX2 (8), AVX-512 (16). On x86-64 with
+// GCC or Clang the vector variants are compiled with per-region target options and chosen at run
+// time with __builtin_cpu_supports, so a build without -march flags still carries all of them;
+// elsewhere only the scalar variant exists. Lane code avoids FMA so it rounds like the scalar code
+// compiled without FP contraction; where the compiler contracts the scalar code into FMA
+// (GCC at -march=native) the two differ in the last bits, most where terms cancel.
+// tests/simd_differential_test.cpp compares every variant with the scalar implementations.
+namespace SimdKernels {
+
+enum class Isa { Scalar, SSE, AVX2, AVX512 };
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::SSE: return "SSE";
+        case Isa::AVX2: return "AVX2";
+        case Isa::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+// Whether this build contains the variant and this CPU can run it
+inline bool isa_supported(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return true;
+#ifdef SIMD_KERNELS_X86
+        case Isa::SSE: return __builtin_cpu_supports("sse2");
+        case Isa::AVX2: return __builtin_cpu_supports("avx2");
+        case Isa::AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+    }
+}
+
+inline std::vector<Isa> supported_isas() {
+    std::vector<Isa> isas;
+    for (Isa isa : {Isa::Scalar, Isa::SSE, Isa::AVX2, Isa::AVX512}) {
+        if (isa_supported(isa)) isas.push_back(isa);
+    }
+    return isas;
+}
+
+// Widest variant this CPU runs
+inline Isa best_isa() {
+    return supported_isas().back();
+}
+
+// Structure-of-arrays batches: one array per component, so a group of lanes is one load
+struct Vector3Batch {
+    std::vector<float> x, y, z;
+
+    size_t size() const { return x.size(); }
+
+    void resize(size_t count) {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+    }
+
+    void add(const Vector3& v) {
+        x.push_back(v.x);
+        y.push_back(v.y);
+        z.push_back(v.z);
+    }
+
+    Vector3 operator[](size_t i) const { return Vector3(x[i], y[i], z[i]); }
+};
+
+struct SphereBatch {
+    std::vector<float> center_x, center_y, center_z, radius;
+
+    size_t size() const { return radius.size(); }
+
+    void add(const Sphere& sphere) {
+        center_x.push_back(sphere.center.x);
+        center_y.push_back(sphere.center.y);
+        center_z.push_back(sphere.center.z);
+        radius.push_back(sphere.radius);
+    }
+};
+
+// Lane types: the interface simd_kernels_impl.hpp is written against
+//   width, Mask, set1, load, store, add, sub, mul, div, sqrt, min, max (a < b ? a : b, a > b ? a : b),
+//   gt, lt, le (ordered), mask_and, mask_or, select(mask, if_true, if_false)
+namespace scalar {
+struct Lanes {
+    static constexpr int width = 1;
+    using Mask = bool;
+    float v;
+
+    static Lanes set1(float value) { return {value}; }
+    static Lanes load(const float* source) { return {*source}; }
+    static void store(float* destination, Lanes a) { *destination = a.v; }
+    static Lanes add(Lanes a, Lanes b) { return {a.v + b.v}; }
+    static Lanes sub(Lanes a, Lanes b) { return {a.v - b.v}; }
+    static Lanes mul(Lanes a, Lanes b) { return {a.v * b.v}; }
+    static Lanes div(Lanes a, Lanes b) { return {a.v / b.v}; }
+    static Lanes sqrt(Lanes a) { return {std::sqrt(a.v)}; }
+    static Lanes min(Lanes a, Lanes b) { return {a.v < b.v ? a.v : b.v}; }
+    static Lanes max(Lanes a, Lanes b) { return {a.v > b.v ? a.v : b.v}; }
+    static Mask gt(Lanes a, Lanes b) { return a.v > b.v; }
+    static Mask lt(Lanes a, Lanes b) { return a.v < b.v; }
+    static Mask le(Lanes a, Lanes b) { return a.v <= b.v; }
+    static Mask mask_and(Mask a, Mask b) { return a && b; }
+    static Mask mask_or(Mask a, Mask b) { return a || b; }
+    static Lanes select(Mask mask, Lanes if_true, Lanes if_false) { return mask ? if_true : if_false; }
+};
+#include "simd_kernels_impl.hpp"
+} // namespace scalar
+
+#ifdef SIMD_KERNELS_X86
+// Each region enables its instruction set for the functions defined inside it only
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+namespace sse {
+struct Lanes {
+    static constexpr int width = 4;
+    using Mask = __m128;
+    __m128 v;
+
+    static Lanes set1(float value) { return {_mm_set1_ps(value)}; }
+    static Lanes load(const float* source) { return {_mm_loadu_ps(source)}; }
+    static void store(float* destination, Lanes a) { _mm_storeu_ps(destination, a.v); }
+    static Lanes add(Lanes a, Lanes b) { return {_mm_add_ps(a.v, b.v)}; }
+    static Lanes sub(Lanes a, Lanes b) { return {_mm_sub_ps(a.v, b.v)}; }
+    static Lanes mul(Lanes a, Lanes b) { return {_mm_mul_ps(a.v, b.v)}; }
+    static Lanes div(Lanes a, Lanes b) { return {_mm_div_ps(a.v, b.v)}; }
+    static Lanes sqrt(Lanes a) { return {_mm_sqrt_ps(a.v)}; }
+    static Lanes min(Lanes a, Lanes b) { return {_mm_min_ps(a.v, b.v)}; }
+    static Lanes max(Lanes a, Lanes b) { return {_mm_max_ps(a.v, b.v)}; }
+    static Mask gt(Lanes a, Lanes b) { return _mm_cmpgt_ps(a.v, b.v); }
+    static Mask lt(Lanes a, Lanes b) { return _mm_cmplt_ps(a.v, b.v); }
+    static Mask le(Lanes a, Lanes b) { return _mm_cmple_ps(a.v, b.v); }
+    static Mask mask_and(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static Mask mask_or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+    static Lanes select(Mask mask, Lanes if_true, Lanes if_false) {
+        return {_mm_or_ps(_mm_and_ps(mask, if_true.v), _mm_andnot_ps(mask, if_false.v))};
+    }
+};
+#include "simd_kernels_impl.hpp"
+} // namespace sse
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2 {
+struct Lanes {
+    static constexpr int width = 8;
+    using Mask = __m256;
+    __m256 v;
+
+    static Lanes set1(float value) { return {_mm256_set1_ps(value)}; }
+    static Lanes load(const float* source) { return {_mm256_loadu_ps(source)}; }
+    static void store(float* destination, Lanes a) { _mm256_storeu_ps(destination, a.v); }
+    static Lanes add(Lanes a, Lanes b) { return {_mm256_add_ps(a.v, b.v)}; }
+    static Lanes sub(Lanes a, Lanes b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    static Lanes mul(Lanes a, Lanes b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    static Lanes div(Lanes a, Lanes b) { return {_mm256_div_ps(a.v, b.v)}; }
+    static Lanes sqrt(Lanes a) { return {_mm256_sqrt_ps(a.v)}; }
+    static Lanes min(Lanes a, Lanes b) { return {_mm256_min_ps(a.v, b.v)}; }
+    static Lanes max(Lanes a, Lanes b) { return {_mm256_max_ps(a.v, b.v)}; }
+    static Mask gt(Lanes a, Lanes b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+    static Mask lt(Lanes a, Lanes b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    static Mask le(Lanes a, Lanes b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+    static Mask mask_and(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static Mask mask_or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+    static Lanes select(Mask mask, Lanes if_true, Lanes if_false) {
+        return {_mm256_blendv_ps(if_false.v, if_true.v, mask)};
+    }
+};
+#include "simd_kernels_impl.hpp"
+} // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+namespace avx512 {
+struct Lanes {
+    static constexpr int width = 16;
+    using Mask = __mmask16;
+    __m512 v;
+
+    static Lanes set1(float value) { return {_mm512_set1_ps(value)}; }
+    static Lanes load(const float* source) { return {_mm512_loadu_ps(source)}; }
+    static void store(float* destination, Lanes a) { _mm512_storeu_ps(destination, a.v); }
+    static Lanes add(Lanes a, Lanes b) { return {_mm512_add_ps(a.v, b.v)}; }
+    static Lanes sub(Lanes a, Lanes b) { return {_mm512_sub_ps(a.v, b.v)}; }
+    static Lanes mul(Lanes a, Lanes b) { return {_mm512_mul_ps(a.v, b.v)}; }
+    static Lanes div(Lanes a, Lanes b) { return {_mm512_div_ps(a.v, b.v)}; }
+    // Zero-masked forms with every lane enabled: the same instructions, but GCC's unmasked wrappers pass an
+    // undefined pass-through operand that -Wmaybe-uninitialized reports
+    static constexpr Mask all_lanes = 0xFFFF;
+    static Lanes sqrt(Lanes a) { return {_mm512_maskz_sqrt_ps(all_lanes, a.v)}; }
+    static Lanes min(Lanes a, Lanes b) { return {_mm512_maskz_min_ps(all_lanes, a.v, b.v)}; }
+    static Lanes max(Lanes a, Lanes b) { return {_mm512_maskz_max_ps(all_lanes, a.v, b.v)}; }
+    static Mask gt(Lanes a, Lanes b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+    static Mask lt(Lanes a, Lanes b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+    static Mask le(Lanes a, Lanes b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ); }
+    static Mask mask_and(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+    static Mask mask_or(Mask a, Mask b) { return static_cast<Mask>(a | b); }
+    static Lanes select(Mask mask, Lanes if_true, Lanes if_false) {
+        return {_mm512_mask_blend_ps(mask, if_false.v, if_true.v)};
+    }
+};
+#include "simd_kernels_impl.hpp"
+} // namespace avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // SIMD_KERNELS_X86
+
+// Call visit(Kernels) with the kernels of isa; variants this CPU cannot run fall back to scalar
+template <typename Visitor>
+inline void dispatch(Isa isa, Visitor visit) {
+    switch (isa_supported(isa) ? isa : Isa::Scalar) {
+#ifdef SIMD_KERNELS_X86
+        case Isa::SSE: visit(sse::Kernels{}); return;
+        case Isa::AVX2: visit(avx2::Kernels{}); return;
+        case Isa::AVX512: visit(avx512::Kernels{}); return;
+#endif
+        default: visit(scalar::Kernels{}); return;
+    }
+}
+
+// t[i] = Sphere::intersect(ray) distance for spheres[i], +inf where it reports no hit
+// (a scalar hit at t = +inf, from overflowing coefficients, is indistinguishable from a miss)
+inline void intersect_spheres(Isa isa, const Ray& ray, const SphereBatch& spheres, std::vector<float>& t) {
+    t.resize(spheres.size());
+    const float origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    const float direction[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+    dispatch(isa, [&](auto kernels) {
+        kernels.intersect_spheres(origin, direction, spheres.center_x.data(), spheres.center_y.data(),
+                                  spheres.center_z.data(), spheres.radius.data(), spheres.size(), t.data());
+    });
+}
+
+// result[i] = material.evaluate_brdf(wi[i], wo[i], normal[i])
+inline void cook_torrance_brdf(Isa isa, const CookTorranceMaterial& material, const Vector3Batch& wi,
+                               const Vector3Batch& wo, const Vector3Batch& normal, Vector3Batch& result) {
+    result.resize(wi.size());
+    const float base_color[3] = {material.base_color.x, material.base_color.y, material.base_color.z};
+    dispatch(isa, [&](auto kernels) {
+        kernels.cook_torrance_brdf(base_color, material.roughness, material.metallic, material.specular,
+                                   wi.x.data(), wi.y.data(), wi.z.data(), wo.x.data(), wo.y.data(), wo.z.data(),
+                                   normal.x.data(), normal.y.data(), normal.z.data(), wi.size(),
+                                   result.x.data(), result.y.data(), result.z.data());
+    });
+}
+
+// result[i] = material.scatter_light(light_direction[i], any view, normal[i], radiance[i])
+inline void lambert_scatter(Isa isa, const LambertMaterial& material, const Vector3Batch& light_direction,
+                            const Vector3Batch& normal, const Vector3Batch& radiance, Vector3Batch& result) {
+    result.resize(light_direction.size());
+    const float base_color[3] = {material.base_color.x, material.base_color.y, material.base_color.z};
+    dispatch(isa, [&](auto kernels) {
+        kernels.lambert_scatter(base_color, light_direction.x.data(), light_direction.y.data(), light_direction.z.data(),
+                                normal.x.data(), normal.y.data(), normal.z.data(),
+                                radiance.x.data(), radiance.y.data(), radiance.z.data(), light_direction.size(),
+                                result.x.data(), result.y.data(), result.z.data());
+    });
+}
+
+// directions[i] = camera.generate_ray(pixel_x[i], pixel_y[i], width, height).direction
+inline void camera_ray_directions(Isa isa, const Camera& camera, const std::vector<float>& pixel_x,
+                                  const std::vector<float>& pixel_y, int image_width, int image_height,
+                                  Vector3Batch& directions) {
+    directions.resize(pixel_x.size());
+    const float right[3] = {camera.right.x, camera.right.y, camera.right.z};
+    const float up[3] = {camera.camera_up.x, camera.camera_up.y, camera.camera_up.z};
+    const float forward[3] = {camera.forward.x, camera.forward.y, camera.forward.z};
+    // Same expressions as Camera::generate_ray, so the scale rounds identically
+    float fov_radians = camera.field_of_view_degrees * M_PI / 180.0f;
+    float fov_scale = std::tan(fov_radians * 0.5f);
+    dispatch(isa, [&](auto kernels) {
+        kernels.camera_ray_directions(right, up, forward, camera.aspect_ratio, fov_scale, image_width, image_height,
+                                      pixel_x.data(), pixel_y.data(), pixel_x.size(),
+                                      directions.x.data(), directions.y.data(), directions.z.data());
+    });
+}
+
+} // namespace SimdKernels
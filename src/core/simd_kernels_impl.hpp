@@ -0,0 +1,193 @@
+// Kernel bodies shared by every SimdKernels instruction set
+// No include guard on purpose: simd_kernels.hpp includes this file once per instruction set, inside a
+// namespace that defines `Lanes` and (on x86) inside a target region for that instruction set, so the
+// same source compiles to scalar, SSE, AVX2 and AVX-512 code. Each kernel repeats the arithmetic of
+// the scalar implementation it replaces operation for operation, in the same order, so that lanes
+// round like the scalar code; see the comments next to each kernel for where it cannot.
+// A scalar early return `if (x <= 0) return r;` becomes select(le(x, 0), r, value), never
+// select(gt(x, 0), value, r): the two differ for NaN lanes, which must take the scalar path.
+
+struct Kernels {
+    // Load/store n <= width floats; a partial group is padded with zeros and its extra lanes discarded
+    static Lanes load_n(const float* source, size_t n) {
+        if (n == static_cast<size_t>(Lanes::width)) return Lanes::load(source);
+        float padded[Lanes::width] = {};
+        std::memcpy(padded, source, n * sizeof(float));
+        return Lanes::load(padded);
+    }
+
+    static void store_n(float* destination, size_t n, Lanes value) {
+        if (n == static_cast<size_t>(Lanes::width)) {
+            Lanes::store(destination, value);
+            return;
+        }
+        float padded[Lanes::width];
+        Lanes::store(padded, value);
+        std::memcpy(destination, padded, n * sizeof(float));
+    }
+
+    // Vector3::dot: x * x' + y * y' + z * z', left to right
+    static Lanes dot(Lanes ax, Lanes ay, Lanes az, Lanes bx, Lanes by, Lanes bz) {
+        return Lanes::add(Lanes::add(Lanes::mul(ax, bx), Lanes::mul(ay, by)), Lanes::mul(az, bz));
+    }
+
+    // Vector3::normalize: scale by 1 / length, or the zero vector if length <= 1e-6
+    static void normalize(Lanes& x, Lanes& y, Lanes& z) {
+        Lanes zero = Lanes::set1(0.0f);
+        Lanes length = Lanes::sqrt(dot(x, y, z, x, y, z));
+        typename Lanes::Mask valid = Lanes::gt(length, Lanes::set1(1e-6f));
+        Lanes inv_length = Lanes::div(Lanes::set1(1.0f), length);
+        x = Lanes::select(valid, Lanes::mul(x, inv_length), zero);
+        y = Lanes::select(valid, Lanes::mul(y, inv_length), zero);
+        z = Lanes::select(valid, Lanes::mul(z, inv_length), zero);
+    }
+
+    // Sphere::intersect of one ray against `count` spheres: t of the nearest hit beyond 1e-6, +inf on a miss
+    static void intersect_spheres(const float origin[3], const float direction[3],
+                                  const float* center_x, const float* center_y, const float* center_z,
+                                  const float* radius, size_t count, float* t) {
+        const float a = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+        const Lanes two_a = Lanes::set1(2 * a);
+        const Lanes four_a = Lanes::set1(4 * a);
+        const Lanes zero = Lanes::set1(0.0f);
+        const Lanes epsilon = Lanes::set1(1e-6f);
+        const Lanes miss = Lanes::set1(std::numeric_limits<float>::infinity());
+        const Lanes ox = Lanes::set1(origin[0]), oy = Lanes::set1(origin[1]), oz = Lanes::set1(origin[2]);
+        const Lanes dx = Lanes::set1(direction[0]), dy = Lanes::set1(direction[1]), dz = Lanes::set1(direction[2]);
+        for (size_t i = 0; i < count; i += Lanes::width) {
+            size_t n = std::min(count - i, static_cast<size_t>(Lanes::width));
+            Lanes ocx = Lanes::sub(ox, load_n(center_x + i, n));
+            Lanes ocy = Lanes::sub(oy, load_n(center_y + i, n));
+            Lanes ocz = Lanes::sub(oz, load_n(center_z + i, n));
+            Lanes r = load_n(radius + i, n);
+            Lanes b = Lanes::mul(Lanes::set1(2.0f), dot(ocx, ocy, ocz, dx, dy, dz));
+            Lanes c = Lanes::sub(dot(ocx, ocy, ocz, ocx, ocy, ocz), Lanes::mul(r, r));
+            Lanes discriminant = Lanes::sub(Lanes::mul(b, b), Lanes::mul(four_a, c));
+            // Negative discriminants give NaN roots, which fail every comparison below like a miss
+            Lanes sqrt_discriminant = Lanes::sqrt(discriminant);
+            Lanes minus_b = Lanes::mul(b, Lanes::set1(-1.0f));
+            Lanes t1 = Lanes::div(Lanes::sub(minus_b, sqrt_discriminant), two_a);
+            Lanes t2 = Lanes::div(Lanes::add(minus_b, sqrt_discriminant), two_a);
+            Lanes t_hit = Lanes::select(Lanes::gt(t1, epsilon), t1, Lanes::select(Lanes::gt(t2, epsilon), t2, miss));
+            store_n(t + i, n, Lanes::select(Lanes::lt(discriminant, zero), miss, t_hit));
+        }
+    }
+
+    // Smith G1 as CookTorrance::GeometryFunction::smith_g1 (alpha2 = α²)
+    static Lanes smith_g1(Lanes cos_theta, Lanes alpha2) {
+        Lanes zero = Lanes::set1(0.0f), one = Lanes::set1(1.0f);
+        Lanes cos2_theta = Lanes::mul(cos_theta, cos_theta);
+        Lanes sin2_theta = Lanes::sub(one, cos2_theta);
+        Lanes tan2_theta = Lanes::div(sin2_theta, cos2_theta);
+        Lanes g1 = Lanes::div(Lanes::set1(2.0f), Lanes::add(one, Lanes::sqrt(Lanes::add(one, Lanes::mul(alpha2, tan2_theta)))));
+        g1 = Lanes::select(Lanes::le(sin2_theta, zero), one, g1);
+        return Lanes::select(Lanes::le(cos_theta, zero), zero, g1);
+    }
+
+    // CookTorranceMaterial::evaluate_brdf for `count` direction triples of one material
+    // Differs from the scalar code by rounding only: GGX multiplies by π in float (scalar: double),
+    // Schlick's (1 - cos θ)^5 is four multiplies (scalar: pow)
+    static void cook_torrance_brdf(const float base_color[3], float roughness, float metallic, float specular,
+                                   const float* wi_x, const float* wi_y, const float* wi_z,
+                                   const float* wo_x, const float* wo_y, const float* wo_z,
+                                   const float* n_x, const float* n_y, const float* n_z,
+                                   size_t count, float* out_r, float* out_g, float* out_b) {
+        const float alpha = roughness * roughness;
+        const float alpha2 = alpha * alpha;
+        const Lanes zero = Lanes::set1(0.0f), one = Lanes::set1(1.0f);
+        const Lanes alpha2_lanes = Lanes::set1(alpha2);
+        const Lanes alpha2_minus_one = Lanes::set1(alpha2 - 1.0f);
+        const Lanes pi = Lanes::set1(static_cast<float>(M_PI));
+        Lanes f0[3], one_minus_f0[3];
+        for (int channel = 0; channel < 3; channel++) {
+            float f0_channel = specular * (1.0f - metallic) + base_color[channel] * metallic;
+            f0[channel] = Lanes::set1(f0_channel);
+            one_minus_f0[channel] = Lanes::set1(1.0f - f0_channel);
+        }
+        for (size_t i = 0; i < count; i += Lanes::width) {
+            size_t n = std::min(count - i, static_cast<size_t>(Lanes::width));
+            Lanes wix = load_n(wi_x + i, n), wiy = load_n(wi_y + i, n), wiz = load_n(wi_z + i, n);
+            Lanes wox = load_n(wo_x + i, n), woy = load_n(wo_y + i, n), woz = load_n(wo_z + i, n);
+            Lanes nx = load_n(n_x + i, n), ny = load_n(n_y + i, n), nz = load_n(n_z + i, n);
+            Lanes hx = Lanes::add(wix, wox), hy = Lanes::add(wiy, woy), hz = Lanes::add(wiz, woz);
+            normalize(hx, hy, hz);
+            // std::max(0.0f, x) maps NaN to 0 like Lanes::max(x, 0)
+            Lanes ndotl = Lanes::max(dot(nx, ny, nz, wix, wiy, wiz), zero);
+            Lanes ndotv = Lanes::max(dot(nx, ny, nz, wox, woy, woz), zero);
+            Lanes ndoth = Lanes::max(dot(nx, ny, nz, hx, hy, hz), zero);
+            Lanes vdoth = Lanes::max(dot(wox, woy, woz, hx, hy, hz), zero);
+
+            Lanes denom_inner = Lanes::add(Lanes::mul(Lanes::mul(ndoth, ndoth), alpha2_minus_one), one);
+            Lanes D = Lanes::div(alpha2_lanes, Lanes::mul(Lanes::mul(pi, denom_inner), denom_inner));
+            D = Lanes::select(Lanes::mask_or(Lanes::le(ndoth, zero), Lanes::le(denom_inner, zero)), zero, D);
+
+            Lanes G = Lanes::mul(smith_g1(ndotl, alpha2_lanes), smith_g1(ndotv, alpha2_lanes));
+
+            Lanes one_minus_cos = Lanes::sub(one, Lanes::max(Lanes::min(vdoth, one), zero));
+            Lanes squared = Lanes::mul(one_minus_cos, one_minus_cos);
+            Lanes fresnel_term = Lanes::mul(Lanes::mul(squared, squared), one_minus_cos);
+
+            Lanes denominator = Lanes::mul(Lanes::mul(Lanes::set1(4.0f), ndotl), ndotv);
+            typename Lanes::Mask zero_brdf = Lanes::mask_or(Lanes::mask_or(Lanes::le(ndotl, zero), Lanes::le(ndotv, zero)),
+                                                            Lanes::le(denominator, zero));
+            Lanes DG = Lanes::mul(D, G);
+            float* outputs[3] = {out_r, out_g, out_b};
+            for (int channel = 0; channel < 3; channel++) {
+                Lanes F = Lanes::add(f0[channel], Lanes::mul(one_minus_f0[channel], fresnel_term));
+                store_n(outputs[channel] + i, n, Lanes::select(zero_brdf, zero, Lanes::div(Lanes::mul(DG, F), denominator)));
+            }
+        }
+    }
+
+    // LambertMaterial::scatter_light for `count` (light direction, normal, radiance) triples of one albedo
+    static void lambert_scatter(const float base_color[3],
+                                const float* l_x, const float* l_y, const float* l_z,
+                                const float* n_x, const float* n_y, const float* n_z,
+                                const float* radiance_r, const float* radiance_g, const float* radiance_b,
+                                size_t count, float* out_r, float* out_g, float* out_b) {
+        const float inv_pi = static_cast<float>(1.0f / M_PI);
+        const Lanes brdf[3] = {Lanes::set1(base_color[0] * inv_pi), Lanes::set1(base_color[1] * inv_pi),
+                               Lanes::set1(base_color[2] * inv_pi)};
+        const Lanes zero = Lanes::set1(0.0f);
+        const float* radiance[3] = {radiance_r, radiance_g, radiance_b};
+        float* outputs[3] = {out_r, out_g, out_b};
+        for (size_t i = 0; i < count; i += Lanes::width) {
+            size_t n = std::min(count - i, static_cast<size_t>(Lanes::width));
+            Lanes cos_theta = Lanes::max(dot(load_n(n_x + i, n), load_n(n_y + i, n), load_n(n_z + i, n),
+                                             load_n(l_x + i, n), load_n(l_y + i, n), load_n(l_z + i, n)), zero);
+            for (int channel = 0; channel < 3; channel++) {
+                Lanes incident = load_n(radiance[channel] + i, n);
+                store_n(outputs[channel] + i, n, Lanes::mul(Lanes::mul(brdf[channel], incident), cos_theta));
+            }
+        }
+    }
+
+    // Camera::generate_ray directions for `count` pixel positions; fov_scale = tan(fov / 2) as the camera computes it
+    static void camera_ray_directions(const float right[3], const float up[3], const float forward[3],
+                                      float aspect_ratio, float fov_scale, int image_width, int image_height,
+                                      const float* pixel_x, const float* pixel_y, size_t count,
+                                      float* dir_x, float* dir_y, float* dir_z) {
+        const Lanes two = Lanes::set1(2.0f), one = Lanes::set1(1.0f);
+        const Lanes width = Lanes::set1(static_cast<float>(image_width));
+        const Lanes height = Lanes::set1(static_cast<float>(image_height));
+        const Lanes aspect = Lanes::set1(aspect_ratio), scale = Lanes::set1(fov_scale);
+        for (size_t i = 0; i < count; i += Lanes::width) {
+            size_t n = std::min(count - i, static_cast<size_t>(Lanes::width));
+            Lanes ndc_x = Lanes::sub(Lanes::div(Lanes::mul(two, load_n(pixel_x + i, n)), width), one);
+            Lanes ndc_y = Lanes::sub(one, Lanes::div(Lanes::mul(two, load_n(pixel_y + i, n)), height));
+            Lanes camera_x = Lanes::mul(Lanes::mul(ndc_x, aspect), scale);
+            Lanes camera_y = Lanes::mul(ndc_y, scale);
+            // camera_z = 1, so its term is forward itself
+            Lanes x = Lanes::add(Lanes::add(Lanes::mul(Lanes::set1(right[0]), camera_x), Lanes::mul(Lanes::set1(up[0]), camera_y)),
+                                 Lanes::set1(forward[0]));
+            Lanes y = Lanes::add(Lanes::add(Lanes::mul(Lanes::set1(right[1]), camera_x), Lanes::mul(Lanes::set1(up[1]), camera_y)),
+                                 Lanes::set1(forward[1]));
+            Lanes z = Lanes::add(Lanes::add(Lanes::mul(Lanes::set1(right[2]), camera_x), Lanes::mul(Lanes::set1(up[2]), camera_y)),
+                                 Lanes::set1(forward[2]));
+            normalize(x, y, z);
+            store_n(dir_x + i, n, x);
+            store_n(dir_y + i, n, y);
+            store_n(dir_z + i, n, z);
+        }
+    }
+};
@@ -0,0 +1,615 @@
+#pragma once
+#include "vector3.hpp"
+#include "point3.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "scene.hpp"
+#include "scene_loader.hpp"
+#include "camera.hpp"
+#include "renderer.hpp"
+#include "../lights/light_base.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// SortLastRenderer renders one scene with several local worker processes that each hold only a
+// spatial chunk of it
+// Educational focus: sort-first vs sort-last distribution
+//
+// Tile-based ("sort-first") distribution gives every worker the whole scene and a part of the image,
+// so the scene must fit in every worker. Sort-last distribution splits the DATA instead:
+// 1. Partition: the coordinator reads only sphere bounds and splits the centers with a k-d tree
+//    (median cut along the longest axis) into one chunk per worker. Chunk boxes cover the spheres'
+//    full extents, so neighboring boxes may overlap.
+// 2. Workers: fork()ed processes that re-read the scene file, keep only the spheres whose center
+//    falls into their k-d cell (SceneLoader::SphereFilter) and build a BVH over them. No process
+//    ever holds the whole sphere set; the coordinator keeps materials and lights for shading.
+// 3. Ray forwarding: each ray visits the chunk boxes it crosses front to back (slab test entry
+//    distance). In every round the coordinator sends each worker the batch of rays currently at its
+//    chunk over a pipe; a ray moves on to its next chunk only while that chunk's entry distance is
+//    not beyond its closest hit so far, so most primary rays stop in the first chunk they hit.
+// 4. Compositing: the closest hit over the visited chunks wins; equal distances go to the smaller
+//    file-order sphere index, the order Scene::intersect would have preferred.
+// 5. Shading: the coordinator evaluates every light at the composited hit, sends shadow rays through
+//    the same forwarding (stopping at the first occluder) and shades exactly like
+//    Renderer::shade_direct_lighting, so the image matches the single-process render.
+// Rays are routed through the coordinator rather than worker to worker, which keeps each worker
+// to a single request/reply pipe pair; a batch still reaches all workers before any reply is read,
+// so the chunks are traced concurrently.
+class SortLastRenderer {
+public:
+    struct Settings {
+        int workers = 4;   // Worker processes = spatial chunks
+    };
+
+    // Worker-side counters, fetched from each process after a frame
+    struct WorkerStatistics {
+        long long spheres = 0;              // Spheres held by the worker
+        long long scene_bytes = 0;          // Sphere array plus BVH
+        long long rays = 0;                 // Ray queries answered
+        double busy_ms = 0.0;               // Time spent tracing
+        Vector3 bounds_min, bounds_max;     // Chunk box
+    };
+
+    struct Statistics {
+        int total_spheres = 0;
+        int workers = 0;
+        std::vector<WorkerStatistics> worker;
+        long long coordinator_bytes = 0;    // Sphere bounds kept for partitioning
+        long long primary_rays = 0;
+        long long shadow_rays = 0;
+        long long chunk_visits = 0;         // Ray deliveries to workers
+        long long forwarded_rays = 0;       // Deliveries beyond a ray's first chunk
+        int rounds = 0;
+        double partition_ms = 0.0;
+        double startup_ms = 0.0;            // Worker scene loading and BVH builds
+        double render_ms = 0.0;
+
+        void print() const {
+            std::cout << "\n=== Sort-Last Distributed Rendering ===" << std::endl;
+            std::cout << "Scene: " << total_spheres << " spheres in " << workers << " spatial chunks (partition "
+                      << partition_ms << " ms, worker startup " << startup_ms << " ms)" << std::endl;
+            long long largest = 0;
+            for (size_t i = 0; i < worker.size(); i++) {
+                const WorkerStatistics& w = worker[i];
+                largest = std::max(largest, w.spheres);
+                std::cout << "  Worker " << i << ": " << w.spheres << " spheres, " << w.scene_bytes / 1024.0
+                          << " KB scene + BVH, " << w.rays << " rays, " << w.busy_ms << " ms busy" << std::endl;
+            }
+            if (total_spheres > 0) {
+                std::cout << "Largest chunk: " << largest << " spheres (" << 100.0 * largest / total_spheres
+                          << "% of the scene); coordinator keeps " << coordinator_bytes / 1024.0 << " KB of bounds"
+                          << std::endl;
+            }
+            std::cout << "Rays: " << primary_rays << " primary, " << shadow_rays << " shadow; " << chunk_visits
+                      << " chunk visits (" << forwarded_rays << " forwarded) in " << rounds << " rounds" << std::endl;
+            std::cout << "Render time: " << render_ms << " ms" << std::endl;
+        }
+    };
+
+    // Partition the scene file and start the workers (check ready() afterwards)
+    SortLastRenderer(const std::string& scene_filename, const std::string& material_type, const Settings& sort_settings)
+        : settings(sort_settings), filename(scene_filename), material(material_type) {
+        settings.workers = std::max(1, settings.workers);
+        auto partition_start = std::chrono::high_resolution_clock::now();
+
+        // Bounds-only pass: materials and lights are kept for shading, spheres are not
+        std::vector<Point3> centers;
+        std::vector<float> radii;
+        shading = SceneLoader::load_from_file(filename, material, [&](const Sphere& sphere) {
+            centers.push_back(sphere.center);
+            radii.push_back(sphere.radius);
+            return false;
+        });
+        stats.total_spheres = static_cast<int>(centers.size());
+        stats.workers = settings.workers;
+        stats.coordinator_bytes = static_cast<long long>(centers.size() * (sizeof(Point3) + sizeof(float)));
+        if (centers.empty()) {
+            std::cout << "ERROR: Sort-last rendering needs a scene with spheres (" << filename << ")" << std::endl;
+            return;
+        }
+
+        std::vector<Point3> split_centers = centers;
+        int next_chunk = 0;
+        build_partition(split_centers, 0, static_cast<int>(split_centers.size()), settings.workers, next_chunk);
+        chunk_min.assign(settings.workers, Vector3(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                                                   std::numeric_limits<float>::max()));
+        chunk_max.assign(settings.workers, Vector3(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                                                   -std::numeric_limits<float>::max()));
+        chunk_spheres.assign(settings.workers, 0);
+        for (size_t i = 0; i < centers.size(); i++) {
+            int chunk = chunk_of(centers[i]);
+            Vector3 center(centers[i].x, centers[i].y, centers[i].z);
+            Vector3 extent(radii[i], radii[i], radii[i]);
+            chunk_min[chunk] = component_min(chunk_min[chunk], center - extent);
+            chunk_max[chunk] = component_max(chunk_max[chunk], center + extent);
+            chunk_spheres[chunk]++;
+        }
+        // Pad the boxes so float error in the slab test never skips a grazing hit
+        for (int chunk = 0; chunk < settings.workers; chunk++) {
+            if (chunk_spheres[chunk] == 0) continue;
+            Vector3 size = chunk_max[chunk] - chunk_min[chunk];
+            float pad = 1e-4f * std::max(size.x, std::max(size.y, size.z)) + 1e-4f;
+            chunk_min[chunk] = chunk_min[chunk] - Vector3(pad, pad, pad);
+            chunk_max[chunk] = chunk_max[chunk] + Vector3(pad, pad, pad);
+        }
+        centers.clear();
+        centers.shrink_to_fit();
+        radii.clear();
+        radii.shrink_to_fit();
+        stats.partition_ms = elapsed_ms(partition_start);
+
+        auto startup_start = std::chrono::high_resolution_clock::now();
+        start_workers();
+        stats.startup_ms = elapsed_ms(startup_start);
+    }
+
+    ~SortLastRenderer() {
+        for (Worker& worker : workers) {
+            if (worker.pid <= 0) continue;
+            MessageHeader quit{message_quit, 0};
+            write_all(worker.request_fd, &quit, sizeof(quit));
+            close(worker.request_fd);
+            close(worker.reply_fd);
+            waitpid(worker.pid, nullptr, 0);
+        }
+    }
+
+    SortLastRenderer(const SortLastRenderer&) = delete;
+    SortLastRenderer& operator=(const SortLastRenderer&) = delete;
+
+    bool ready() const { return !failed && static_cast<int>(workers.size()) == settings.workers; }
+
+    // Render a frame with direct lighting into a row-major linear RGB buffer, clamped like
+    // Renderer::render_frame; returns false if a worker failed
+    bool render_frame(const Camera& camera, int width, int height, std::vector<Vector3>& pixels) {
+        if (!ready()) return false;
+        auto render_start = std::chrono::high_resolution_clock::now();
+        size_t pixel_count = static_cast<size_t>(width) * height;
+        pixels.assign(pixel_count, Renderer::background_color());
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        // Primary visibility: closest hit over the chunks
+        std::vector<RayRecord> rays(pixel_count);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                rays[static_cast<size_t>(y) * width + x] = to_record(ray);
+            }
+        }
+        std::vector<HitRecord> hits;
+        if (!trace(rays, std::vector<float>(pixel_count, infinity), false, hits)) return false;
+        stats.primary_rays += static_cast<long long>(pixel_count);
+
+        // Light samples at every hit, exactly as Renderer::shade_direct_lighting draws them
+        struct LightSample {
+            size_t pixel;
+            Vector3 direction;
+            Vector3 contribution;
+        };
+        std::vector<LightSample> samples;
+        std::vector<RayRecord> shadow_rays;
+        std::vector<float> shadow_limits;
+        for (size_t pixel = 0; pixel < pixel_count; pixel++) {
+            if (hits[pixel].sphere < 0) continue;
+            Vector3 surface_point(hits[pixel].point[0], hits[pixel].point[1], hits[pixel].point[2]);
+            for (const auto& light : shading.lights) {
+                Vector3 light_direction;
+                float light_distance;
+                Vector3 contribution = light->illuminate(surface_point, light_direction, light_distance);
+                samples.push_back({pixel, light_direction, contribution});
+                // Shadow ray as the lights' is_occluded() builds it: offset origin, blocked before the light
+                // (any hit at all for directional lights)
+                const float epsilon = 0.001f;
+                Vector3 offset_point = surface_point + light_direction * epsilon;
+                shadow_rays.push_back(to_record(Ray(Point3(offset_point.x, offset_point.y, offset_point.z), light_direction)));
+                shadow_limits.push_back(light->type == LightType::Directional ? infinity : light_distance - epsilon);
+            }
+        }
+        std::vector<HitRecord> occluders;
+        if (!trace(shadow_rays, shadow_limits, true, occluders)) return false;
+        stats.shadow_rays += static_cast<long long>(shadow_rays.size());
+
+        // Shade unoccluded samples in light order, accumulating like shade_direct_lighting
+        std::vector<Vector3> colors(pixel_count, Vector3(0, 0, 0));
+        for (size_t i = 0; i < samples.size(); i++) {
+            const LightSample& sample = samples[i];
+            if (occluders[i].sphere >= 0 && occluders[i].t < shadow_limits[i]) continue;
+            const HitRecord& hit = hits[sample.pixel];
+            Point3 hit_point(hit.point[0], hit.point[1], hit.point[2]);
+            Vector3 normal(hit.normal[0], hit.normal[1], hit.normal[2]);
+            Vector3 view_direction = (camera.position - hit_point).normalize();
+            colors[sample.pixel] += shading.materials[hit.material]->scatter_light(sample.direction, view_direction, normal,
+                                                                                 sample.contribution, false);
+        }
+        for (size_t pixel = 0; pixel < pixel_count; pixel++) {
+            if (hits[pixel].sphere >= 0) {
+                pixels[pixel] = Renderer::clamp_color(colors[pixel]);
+            }
+        }
+
+        if (!collect_worker_statistics()) return false;
+        stats.render_ms += elapsed_ms(render_start);
+        return true;
+    }
+
+    // k-d cell (= worker) owning a sphere center
+    int chunk_of(const Point3& center) const {
+        int node = 0;
+        while (partition[node].chunk < 0) {
+            const PartitionNode& split = partition[node];
+            node = axis_value(center, split.axis) < split.split ? split.left : split.right;
+        }
+        return partition[node].chunk;
+    }
+
+    // Number of spheres in each chunk (from the bounds pass)
+    const std::vector<int>& chunk_sizes() const { return chunk_spheres; }
+    const Statistics& statistics() const { return stats; }
+
+private:
+    struct PartitionNode {
+        int axis = 0;
+        float split = 0.0f;
+        int left = -1, right = -1;
+        int chunk = -1;   // Leaf: chunk index
+    };
+
+    struct Worker {
+        pid_t pid = -1;
+        int request_fd = -1;   // Coordinator → worker
+        int reply_fd = -1;     // Worker → coordinator
+    };
+
+    // Pipe protocol: a header, then `count` fixed-size records
+    enum : uint32_t { message_trace = 1, message_report = 2, message_quit = 3 };
+    struct MessageHeader {
+        uint32_t type;
+        uint32_t count;
+    };
+    struct RayRecord {
+        float origin[3];
+        float direction[3];
+    };
+    struct HitRecord {
+        float t;
+        int32_t sphere;      // File-order sphere index, -1 = miss
+        int32_t material;
+        float point[3];
+        float normal[3];
+    };
+    struct WorkerReport {
+        int64_t spheres, scene_bytes, rays;
+        double busy_ms;
+    };
+
+    Settings settings;
+    std::string filename;
+    std::string material;
+    Scene shading;                          // Materials and lights only
+    std::vector<PartitionNode> partition;
+    std::vector<Vector3> chunk_min, chunk_max;
+    std::vector<int> chunk_spheres;
+    std::vector<Worker> workers;
+    Statistics stats;
+    bool failed = false;
+
+    static double elapsed_ms(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    static float axis_value(const Point3& p, int axis) { return axis == 0 ? p.x : (axis == 1 ? p.y : p.z); }
+    static Vector3 component_min(const Vector3& a, const Vector3& b) {
+        return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    }
+    static Vector3 component_max(const Vector3& a, const Vector3& b) {
+        return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    }
+
+    static RayRecord to_record(const Ray& ray) {
+        return RayRecord{{ray.origin.x, ray.origin.y, ray.origin.z}, {ray.direction.x, ray.direction.y, ray.direction.z}};
+    }
+
+    // Median cut of centers[first, last) into `chunks` cells; returns the node index
+    int build_partition(std::vector<Point3>& centers, int first, int last, int chunks, int& next_chunk) {
+        int node = static_cast<int>(partition.size());
+        partition.emplace_back();
+        if (chunks == 1) {
+            partition[node].chunk = next_chunk++;
+            return node;
+        }
+        Vector3 low(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+        Vector3 high = low * -1.0f;
+        for (int i = first; i < last; i++) {
+            Vector3 c(centers[i].x, centers[i].y, centers[i].z);
+            low = component_min(low, c);
+            high = component_max(high, c);
+        }
+        Vector3 size = high - low;
+        int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+        int left_chunks = chunks / 2;
+        int middle = first + static_cast<int>(static_cast<long long>(last - first) * left_chunks / chunks);
+        float split = 0.0f;
+        if (middle < last) {
+            std::nth_element(centers.begin() + first, centers.begin() + middle, centers.begin() + last,
+                             [axis](const Point3& a, const Point3& b) { return axis_value(a, axis) < axis_value(b, axis); });
+            split = axis_value(centers[middle], axis);
+        }
+        partition[node].axis = axis;
+        partition[node].split = split;
+        int left = build_partition(centers, first, middle, left_chunks, next_chunk);
+        int right = build_partition(centers, middle, last, chunks - left_chunks, next_chunk);
+        partition[node].left = left;
+        partition[node].right = right;
+        return node;
+    }
+
+    // Slab test against a chunk box: distance at which the ray enters it (0 if it starts inside)
+    bool enter_chunk(const RayRecord& ray, int chunk, float& entry) const {
+        float t_near = 0.0f, t_far = std::numeric_limits<float>::infinity();
+        const float box_min[3] = {chunk_min[chunk].x, chunk_min[chunk].y, chunk_min[chunk].z};
+        const float box_max[3] = {chunk_max[chunk].x, chunk_max[chunk].y, chunk_max[chunk].z};
+        for (int axis = 0; axis < 3; axis++) {
+            float inverse = 1.0f / ray.direction[axis];
+            float t0 = (box_min[axis] - ray.origin[axis]) * inverse;
+            float t1 = (box_max[axis] - ray.origin[axis]) * inverse;
+            if (t0 > t1) std::swap(t0, t1);
+            if (std::isnan(t0) || std::isnan(t1)) {
+                // Parallel to the slab with the origin on its boundary plane
+                if (ray.origin[axis] < box_min[axis] || ray.origin[axis] > box_max[axis]) return false;
+                continue;
+            }
+            t_near = std::max(t_near, t0);
+            t_far = std::min(t_far, t1);
+            if (t_near > t_far) return false;
+        }
+        entry = t_near;
+        return true;
+    }
+
+    // Forward rays through the chunks they cross, front to back, and composite the closest hits
+    // limits: a ray stops once it has a hit closer than its limit (any_hit) or once the next chunk
+    // starts beyond its closest hit / limit
+    bool trace(const std::vector<RayRecord>& rays, const std::vector<float>& limits, bool any_hit,
+               std::vector<HitRecord>& hits) {
+        size_t count = rays.size();
+        HitRecord miss{std::numeric_limits<float>::infinity(), -1, -1, {0, 0, 0}, {0, 0, 0}};
+        hits.assign(count, miss);
+
+        // Route of each ray: (entry distance, chunk) sorted by distance
+        std::vector<std::pair<float, int>> routes;
+        std::vector<size_t> route_begin(count + 1, 0);
+        for (size_t i = 0; i < count; i++) {
+            route_begin[i] = routes.size();
+            for (int chunk = 0; chunk < settings.workers; chunk++) {
+                float entry;
+                if (chunk_spheres[chunk] > 0 && enter_chunk(rays[i], chunk, entry) && entry <= limits[i]) {
+                    routes.emplace_back(entry, chunk);
+                }
+            }
+            std::sort(routes.begin() + route_begin[i], routes.end());
+        }
+        route_begin[count] = routes.size();
+        std::vector<size_t> cursor(route_begin.begin(), route_begin.end() - 1);
+        std::vector<bool> visited(count, false);
+
+        std::vector<std::vector<uint32_t>> batch_ids(settings.workers);
+        std::vector<RayRecord> batch;
+        std::vector<HitRecord> replies;
+        while (true) {
+            bool any = false;
+            for (auto& ids : batch_ids) ids.clear();
+            for (size_t i = 0; i < count; i++) {
+                if (cursor[i] == route_begin[i + 1]) continue;
+                const HitRecord& best = hits[i];
+                if (any_hit && best.sphere >= 0 && best.t < limits[i]) continue;
+                if (routes[cursor[i]].first > std::min(best.t, limits[i])) continue;
+                batch_ids[routes[cursor[i]].second].push_back(static_cast<uint32_t>(i));
+                cursor[i]++;
+                if (visited[i]) stats.forwarded_rays++;
+                visited[i] = true;
+                any = true;
+            }
+            if (!any) break;
+            stats.rounds++;
+
+            // Every worker receives its batch before any reply is read, so chunks trace concurrently
+            for (int w = 0; w < settings.workers; w++) {
+                if (batch_ids[w].empty()) continue;
+                batch.resize(batch_ids[w].size());
+                for (size_t k = 0; k < batch.size(); k++) batch[k] = rays[batch_ids[w][k]];
+                MessageHeader header{message_trace, static_cast<uint32_t>(batch.size())};
+                if (!write_all(workers[w].request_fd, &header, sizeof(header)) ||
+                    !write_all(workers[w].request_fd, batch.data(), batch.size() * sizeof(RayRecord))) {
+                    return worker_failed(w);
+                }
+                stats.chunk_visits += static_cast<long long>(batch.size());
+            }
+            for (int w = 0; w < settings.workers; w++) {
+                if (batch_ids[w].empty()) continue;
+                replies.resize(batch_ids[w].size());
+                if (!read_all(workers[w].reply_fd, replies.data(), replies.size() * sizeof(HitRecord))) {
+                    return worker_failed(w);
+                }
+                for (size_t k = 0; k < replies.size(); k++) {
+                    const HitRecord& reply = replies[k];
+                    HitRecord& best = hits[batch_ids[w][k]];
+                    if (reply.sphere >= 0 && (reply.t < best.t || (reply.t == best.t && reply.sphere < best.sphere))) {
+                        best = reply;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool collect_worker_statistics() {
+        stats.worker.assign(settings.workers, WorkerStatistics());
+        for (int w = 0; w < settings.workers; w++) {
+            MessageHeader header{message_report, 0};
+            WorkerReport report;
+            if (!write_all(workers[w].request_fd, &header, sizeof(header)) ||
+                !read_all(workers[w].reply_fd, &report, sizeof(report))) {
+                return worker_failed(w);
+            }
+            stats.worker[w].spheres = report.spheres;
+            stats.worker[w].scene_bytes = report.scene_bytes;
+            stats.worker[w].rays = report.rays;
+            stats.worker[w].busy_ms = report.busy_ms;
+            stats.worker[w].bounds_min = chunk_min[w];
+            stats.worker[w].bounds_max = chunk_max[w];
+        }
+        return true;
+    }
+
+    bool worker_failed(int w) {
+        std::cout << "ERROR: Sort-last worker " << w << " stopped responding" << std::endl;
+        failed = true;
+        return false;
+    }
+
+    void start_workers() {
+        // A worker that dies must surface as a failed write, not kill the coordinator with SIGPIPE
+        signal(SIGPIPE, SIG_IGN);
+        std::cout.flush();
+        std::fflush(stdout);
+        for (int w = 0; w < settings.workers; w++) {
+            int request_pipe[2], reply_pipe[2];
+            if (pipe(request_pipe) != 0 || pipe(reply_pipe) != 0) {
+                std::cout << "ERROR: Cannot create pipes for sort-last worker " << w << std::endl;
+                failed = true;
+                return;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                std::cout << "ERROR: Cannot start sort-last worker " << w << std::endl;
+                failed = true;
+                return;
+            }
+            if (pid == 0) {
+                close(request_pipe[1]);
+                close(reply_pipe[0]);
+                for (const Worker& other : workers) {
+                    close(other.request_fd);
+                    close(other.reply_fd);
+                }
+                _exit(worker_main(w, request_pipe[0], reply_pipe[1]));
+            }
+            close(request_pipe[0]);
+            close(reply_pipe[1]);
+            Worker worker;
+            worker.pid = pid;
+            worker.request_fd = request_pipe[1];
+            worker.reply_fd = reply_pipe[0];
+            workers.push_back(worker);
+        }
+
+        // Each worker reports once its chunk and BVH are ready (all load concurrently)
+        for (int w = 0; w < settings.workers; w++) {
+            WorkerReport report;
+            if (!read_all(workers[w].reply_fd, &report, sizeof(report))) {
+                worker_failed(w);
+                return;
+            }
+        }
+    }
+
+    // Worker process: load this chunk, build its BVH, answer ray batches until told to quit
+    int worker_main(int chunk, int request_fd, int reply_fd) {
+        // Scene loading is verbose; the coordinator's output stays readable
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            close(null_fd);
+        }
+        shading = Scene();
+
+        std::vector<int32_t> file_index;   // File-order index of each kept sphere
+        int32_t next_index = 0;
+        Scene scene = SceneLoader::load_from_file(filename, material, [&](const Sphere& sphere) {
+            int32_t index = next_index++;
+            if (chunk_of(sphere.center) != chunk) return false;
+            file_index.push_back(index);
+            return true;
+        });
+        if (file_index.size() != scene.primitives.size()) {
+            return 1;
+        }
+        if (!scene.primitives.empty()) {
+            scene.build_bvh();
+        }
+
+        WorkerReport report{static_cast<int64_t>(scene.primitives.size()),
+                            static_cast<int64_t>(scene.primitives.capacity() * sizeof(Sphere) +
+                                                 (scene.bvh ? scene.bvh->memory_usage_bytes() : 0)),
+                            0, 0.0};
+        if (!write_all(reply_fd, &report, sizeof(report))) return 1;
+        std::vector<RayRecord> batch;
+        std::vector<HitRecord> results;
+        MessageHeader header;
+        while (read_all(request_fd, &header, sizeof(header))) {
+            if (header.type == message_quit) break;
+            if (header.type == message_report) {
+                if (!write_all(reply_fd, &report, sizeof(report))) return 1;
+                continue;
+            }
+            batch.resize(header.count);
+            if (!read_all(request_fd, batch.data(), batch.size() * sizeof(RayRecord))) return 1;
+            auto start = std::chrono::high_resolution_clock::now();
+            results.resize(batch.size());
+            for (size_t i = 0; i < batch.size(); i++) {
+                const RayRecord& record = batch[i];
+                Ray ray(Point3(record.origin[0], record.origin[1], record.origin[2]),
+                        Vector3(record.direction[0], record.direction[1], record.direction[2]));
+                Scene::Intersection hit = scene.intersect(ray, false);
+                HitRecord& result = results[i];
+                if (hit.hit) {
+                    const Sphere* sphere = hit.primitive;
+                    result = HitRecord{hit.t, file_index[sphere - scene.primitives.data()], sphere->material_index,
+                                       {hit.point.x, hit.point.y, hit.point.z}, {hit.normal.x, hit.normal.y, hit.normal.z}};
+                } else {
+                    result = HitRecord{std::numeric_limits<float>::infinity(), -1, -1, {0, 0, 0}, {0, 0, 0}};
+                }
+            }
+            report.rays += static_cast<int64_t>(batch.size());
+            report.busy_ms += elapsed_ms(start);
+            if (!write_all(reply_fd, results.data(), results.size() * sizeof(HitRecord))) return 1;
+        }
+        return 0;
+    }
+
+    static bool write_all(int fd, const void* data, size_t bytes) {
+        const char* cursor = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t written = write(fd, cursor, bytes);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            cursor += written;
+            bytes -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    static bool read_all(int fd, void* data, size_t bytes) {
+        char* cursor = static_cast<char*>(data);
+        while (bytes > 0) {
+            ssize_t received = read(fd, cursor, bytes);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) return false;
+            cursor += received;
+            bytes -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+};
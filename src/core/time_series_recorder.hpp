@@ -0,0 +1,343 @@
+#pragma once
+#include "metrics_exporter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#ifdef __linux__
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// TimeSeriesRecorder samples render throughput and CPU utilization every N milliseconds
+// Educational focus: why an average hides the shape of a render
+//
+// Rays per second over a whole frame cannot distinguish a steady render from one that starts fast
+// and throttles, one whose last rows run on a single straggling thread, or one sharing its cores with
+// a noisy neighbour. A background thread wakes every `interval_ms` and records one Sample:
+//   rays and tiles completed    totals published by the render loop via report() (two atomics)
+//   rays per second             Δrays / Δt since the previous sample
+//   process CPU utilization     Δ(user + system time) / Δt from getrusage(RUSAGE_SELF); 2.0 = two busy cores
+//   per-thread busy fraction    Δ(utime + stime) / Δt of every thread in /proc/self/task (Linux), reported
+//                               as min / mean / max over the threads alive at the end of the interval
+//                               (threads that exited during it only show up in process utilization)
+//   resident memory             /proc/self/statm (MetricsExporter::resident_memory_bytes)
+//
+// Samples go into a buffer preallocated at construction. When it fills up, adjacent samples are merged
+// pairwise and the interval doubles, so a render of any length keeps a complete timeline in fixed memory
+// and the sample buffer never reallocates while the render runs. Per-thread times have clock-tick resolution
+// (usually 10 ms), so intervals below ~50 ms make the thread columns coarse.
+class TimeSeriesRecorder {
+public:
+    struct Sample {
+        double elapsed_seconds = 0.0;     // End of the sampled interval, since start()
+        double interval_seconds = 0.0;    // Length of the sampled interval
+        long long rays = 0;               // Rays completed so far
+        double rays_per_second = 0.0;     // Over this interval
+        int tiles_done = 0;               // Work units (scanlines, scanlines × passes, frames × scanlines)
+        size_t resident_bytes = 0;
+        double process_utilization = 0.0; // CPU seconds / wall seconds over all threads
+        int threads = 0;                  // Threads measured (the sampler itself excluded)
+        double thread_busy_min = 0.0;     // Per-thread busy fraction over this interval
+        double thread_busy_mean = 0.0;
+        double thread_busy_max = 0.0;
+    };
+
+    TimeSeriesRecorder(double interval_milliseconds = 100.0, size_t sample_capacity = 4096)
+        : interval_ms(std::max(1.0, interval_milliseconds)), capacity(std::max<size_t>(2, sample_capacity)) {
+        samples.reserve(capacity);
+    }
+
+    ~TimeSeriesRecorder() { stop(); }
+
+    // Start the sampling thread (clears previous samples)
+    void start() {
+        stop();
+        samples.clear();
+        rays_completed = 0;
+        tiles_completed = 0;
+        current_interval_ms = interval_ms;
+        previous = snapshot();
+        start_time = previous.time;
+        running = true;
+        sampler = std::thread([this]() { run(); });
+    }
+
+    // Stop sampling and record the final partial interval
+    void stop() {
+        if (!sampler.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        sampler.join();
+        record_sample();
+    }
+
+    // Called by the render loop: running totals, cheap enough to call once per scanline
+    void report(long long rays, int tiles) {
+        rays_completed.store(rays, std::memory_order_relaxed);
+        tiles_completed.store(tiles, std::memory_order_relaxed);
+    }
+
+    const std::vector<Sample>& get_samples() const { return samples; }
+    double sample_interval_ms() const { return current_interval_ms; }
+
+    // CSV: one header line, one row per sample
+    std::string to_csv() const {
+        std::ostringstream out;
+        out << "elapsed_s,interval_s,rays,rays_per_second,tiles_done,resident_bytes,process_utilization,"
+            << "threads,thread_busy_min,thread_busy_mean,thread_busy_max\n";
+        for (const Sample& sample : samples) {
+            out << sample.elapsed_seconds << "," << sample.interval_seconds << "," << sample.rays << ","
+                << sample.rays_per_second << "," << sample.tiles_done << "," << sample.resident_bytes << ","
+                << sample.process_utilization << "," << sample.threads << "," << sample.thread_busy_min << ","
+                << sample.thread_busy_mean << "," << sample.thread_busy_max << "\n";
+        }
+        return out.str();
+    }
+
+    // JSON: sampling interval plus an array of sample objects
+    std::string to_json() const {
+        std::ostringstream out;
+        out.precision(6);
+        out << "{\n";
+        out << "  \"interval_ms\": " << current_interval_ms << ",\n";
+        out << "  \"samples\": [";
+        for (size_t i = 0; i < samples.size(); i++) {
+            const Sample& sample = samples[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\"elapsed_s\": " << sample.elapsed_seconds << ", \"interval_s\": " << sample.interval_seconds
+                << ", \"rays\": " << sample.rays << ", \"rays_per_second\": " << sample.rays_per_second
+                << ", \"tiles_done\": " << sample.tiles_done << ", \"resident_bytes\": " << sample.resident_bytes
+                << ", \"process_utilization\": " << sample.process_utilization << ", \"threads\": " << sample.threads
+                << ", \"thread_busy\": {\"min\": " << sample.thread_busy_min << ", \"mean\": " << sample.thread_busy_mean
+                << ", \"max\": " << sample.thread_busy_max << "}}";
+        }
+        out << (samples.empty() ? "]\n" : "\n  ]\n");
+        out << "}\n";
+        return out.str();
+    }
+
+    // Write CSV, or JSON when the filename ends in ".json"; returns false when the file cannot be written
+    bool write(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file) {
+            std::cout << "ERROR: Could not write time series to " << filename << std::endl;
+            return false;
+        }
+        bool json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+        file << (json ? to_json() : to_csv());
+        return static_cast<bool>(file);
+    }
+
+    // ASCII chart of utilization over time: one column per time bucket, '#' up to the mean thread
+    // busy fraction, '.' up to the busiest thread (the gap between them shows stragglers)
+    std::string ascii_plot(int columns = 60, int rows = 10) const {
+        std::ostringstream out;
+        if (samples.empty()) return "(no samples)\n";
+        columns = std::max(1, columns);
+        rows = std::max(1, rows);
+        double duration = samples.back().elapsed_seconds;
+        std::vector<double> mean(columns, 0.0), peak(columns, 0.0), weight(columns, 0.0);
+        for (const Sample& sample : samples) {
+            double middle = sample.elapsed_seconds - 0.5 * sample.interval_seconds;
+            int column = duration > 0.0 ? std::min(columns - 1, static_cast<int>(middle / duration * columns)) : 0;
+            double busy_mean = sample.threads > 0 ? sample.thread_busy_mean : sample.process_utilization;
+            double busy_max = sample.threads > 0 ? sample.thread_busy_max : sample.process_utilization;
+            mean[column] += busy_mean * sample.interval_seconds;
+            peak[column] = std::max(peak[column], busy_max);
+            weight[column] += sample.interval_seconds;
+        }
+        // Fewer samples than columns: empty columns repeat their neighbour
+        int first = 0;
+        while (weight[first] == 0.0) first++;
+        for (int c = 0; c < columns; c++) {
+            if (weight[c] > 0.0) mean[c] /= weight[c];
+            else if (c > first) { mean[c] = mean[c - 1]; peak[c] = peak[c - 1]; }
+        }
+        for (int c = 0; c < first; c++) { mean[c] = mean[first]; peak[c] = peak[first]; }
+        for (int r = rows; r >= 1; r--) {
+            double level = (r - 0.5) / rows;
+            char label[16];
+            std::snprintf(label, sizeof(label), "%4.0f%% |", 100.0 * r / rows);
+            out << label;
+            for (int c = 0; c < columns; c++) {
+                out << (std::min(1.0, mean[c]) >= level ? '#' : std::min(1.0, peak[c]) >= level ? '.' : ' ');
+            }
+            out << "\n";
+        }
+        out << "      +" << std::string(columns, '-') << "\n";
+        char end_label[32];
+        std::snprintf(end_label, sizeof(end_label), "%.2f s", duration);
+        std::string end_text(end_label);
+        out << "       0 s" << std::string(std::max<int>(1, columns - 3 - static_cast<int>(end_text.size())), ' ') << end_text << "\n";
+        return out.str();
+    }
+
+    void print_report(bool plot) const {
+        std::cout << "\n=== Render Time Series ===" << std::endl;
+        if (samples.empty()) {
+            std::cout << "No samples recorded" << std::endl;
+            return;
+        }
+        double peak_rate = 0.0, low_rate = samples.front().rays_per_second;
+        size_t peak_resident = 0;
+        for (const Sample& sample : samples) {
+            peak_rate = std::max(peak_rate, sample.rays_per_second);
+            low_rate = std::min(low_rate, sample.rays_per_second);
+            peak_resident = std::max(peak_resident, sample.resident_bytes);
+        }
+        std::cout << samples.size() << " samples every " << current_interval_ms << " ms over "
+                  << samples.back().elapsed_seconds << " s" << std::endl;
+        std::cout << "Rays/sec: peak " << peak_rate << ", lowest " << low_rate << std::endl;
+        std::cout << "Peak resident memory: " << peak_resident / (1024.0 * 1024.0) << " MB" << std::endl;
+        if (plot) {
+            std::cout << "Thread utilization over time (# mean, . busiest thread):" << std::endl;
+            std::cout << ascii_plot();
+        }
+    }
+
+private:
+    // Cumulative counters at one instant
+    struct Snapshot {
+        std::chrono::steady_clock::time_point time;
+        long long rays = 0;
+        int tiles = 0;
+        double process_cpu_seconds = 0.0;
+        std::map<long, double> thread_cpu_seconds;   // By thread id
+    };
+
+    double interval_ms;
+    double current_interval_ms = 0.0;
+    size_t capacity;
+    std::vector<Sample> samples;
+    std::atomic<long long> rays_completed{0};
+    std::atomic<int> tiles_completed{0};
+    std::chrono::steady_clock::time_point start_time;
+    Snapshot previous;
+    long sampler_thread_id = -1;
+    bool running = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread sampler;
+
+    void run() {
+#ifdef __linux__
+        sampler_thread_id = static_cast<long>(syscall(SYS_gettid));
+#endif
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            auto wait = std::chrono::duration<double, std::milli>(current_interval_ms);
+            if (wake.wait_for(lock, wait, [this]() { return !running; })) break;
+            record_sample();
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot now;
+        now.time = std::chrono::steady_clock::now();
+        now.rays = rays_completed.load(std::memory_order_relaxed);
+        now.tiles = tiles_completed.load(std::memory_order_relaxed);
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        now.process_cpu_seconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+                                  usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#ifdef __linux__
+        // Field 14 (utime) and 15 (stime) of /proc/self/task/<tid>/stat, in clock ticks
+        static const double tick_seconds = 1.0 / static_cast<double>(sysconf(_SC_CLK_TCK));
+        if (DIR* tasks = opendir("/proc/self/task")) {
+            while (dirent* entry = readdir(tasks)) {
+                if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+                long thread_id = std::atol(entry->d_name);
+                if (thread_id == sampler_thread_id) continue;
+                std::ifstream stat(std::string("/proc/self/task/") + entry->d_name + "/stat");
+                std::string line;
+                if (!std::getline(stat, line)) continue;
+                size_t name_end = line.rfind(')');
+                if (name_end == std::string::npos) continue;
+                std::istringstream fields(line.substr(name_end + 2));
+                std::string field;
+                long long user_ticks = 0, system_ticks = 0;
+                for (int index = 3; index <= 15 && fields >> field; index++) {
+                    if (index == 14) user_ticks = std::atoll(field.c_str());
+                    if (index == 15) system_ticks = std::atoll(field.c_str());
+                }
+                now.thread_cpu_seconds[thread_id] = (user_ticks + system_ticks) * tick_seconds;
+            }
+            closedir(tasks);
+        }
+#endif
+        return now;
+    }
+
+    void record_sample() {
+        Snapshot now = snapshot();
+        double wall = std::chrono::duration<double>(now.time - previous.time).count();
+        if (wall <= 0.0) return;
+
+        Sample sample;
+        sample.elapsed_seconds = std::chrono::duration<double>(now.time - start_time).count();
+        sample.interval_seconds = wall;
+        sample.rays = now.rays;
+        sample.rays_per_second = (now.rays - previous.rays) / wall;
+        sample.tiles_done = now.tiles;
+        sample.resident_bytes = MetricsExporter::resident_memory_bytes();
+        sample.process_utilization = (now.process_cpu_seconds - previous.process_cpu_seconds) / wall;
+        double busy_sum = 0.0;
+        for (const auto& entry : now.thread_cpu_seconds) {
+            // A thread started during the interval accrued all of its CPU time within it
+            auto before = previous.thread_cpu_seconds.find(entry.first);
+            double cpu_before = before != previous.thread_cpu_seconds.end() ? before->second : 0.0;
+            double busy = std::min(1.0, std::max(0.0, (entry.second - cpu_before) / wall));
+            sample.thread_busy_min = sample.threads == 0 ? busy : std::min(sample.thread_busy_min, busy);
+            sample.thread_busy_max = std::max(sample.thread_busy_max, busy);
+            busy_sum += busy;
+            sample.threads++;
+        }
+        sample.thread_busy_mean = sample.threads > 0 ? busy_sum / sample.threads : 0.0;
+        previous = std::move(now);
+
+        if (samples.size() == capacity) {
+            compact();
+        }
+        samples.push_back(sample);
+    }
+
+    // Merge adjacent sample pairs in place (time-weighted) and double the sampling interval
+    void compact() {
+        size_t merged = 0;
+        for (size_t i = 0; i + 1 < samples.size(); i += 2) {
+            const Sample& a = samples[i];
+            const Sample& b = samples[i + 1];
+            double total = a.interval_seconds + b.interval_seconds;
+            auto blend = [&](double x, double y) { return total > 0.0 ? (x * a.interval_seconds + y * b.interval_seconds) / total : y; };
+            Sample combined = b;   // Totals and end time come from the later sample
+            combined.interval_seconds = total;
+            combined.rays_per_second = total > 0.0 ? (b.rays - a.rays + a.rays_per_second * a.interval_seconds) / total : 0.0;
+            combined.resident_bytes = std::max(a.resident_bytes, b.resident_bytes);
+            combined.process_utilization = blend(a.process_utilization, b.process_utilization);
+            combined.threads = std::max(a.threads, b.threads);
+            combined.thread_busy_min = std::min(a.thread_busy_min, b.thread_busy_min);
+            combined.thread_busy_mean = blend(a.thread_busy_mean, b.thread_busy_mean);
+            combined.thread_busy_max = std::max(a.thread_busy_max, b.thread_busy_max);
+            samples[merged++] = combined;
+        }
+        if (samples.size() % 2 == 1) samples[merged++] = samples.back();
+        samples.resize(merged);
+        current_interval_ms *= 2.0;
+    }
+};
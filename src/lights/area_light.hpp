@@ -6,10 +6,95 @@
 #include <iostream>
 #include <cmath>
 #include <random>
+#include <algorithm>
 
 // Forward declaration for Scene to avoid circular dependency
 class Scene;
 
+// How an area light picks its sample points
+//   Area:       uniform over the rectangle, converted to solid angle with pdf_ω = d² / (A cos θl)
+//   SolidAngle: uniform over the solid angle the rectangle subtends (spherical rectangle sampling)
+enum class AreaLightSampling {
+    Area,
+    SolidAngle
+};
+
+// Spherical rectangle: the projection of the light rectangle onto the unit sphere around a point
+//
+// Educational focus: uniform area sampling puts d²/cos θl into every sample, which blows up for points
+// close to a large light or seeing it at a grazing angle: a few samples near the rectangle's closest
+// edge carry huge weights. Sampling the subtended solid angle directly gives every sample the same
+// weight L·Ω, leaving only visibility and the receiver's cosine as sources of noise.
+// Following Ureña, Fajardo and King (2013): in a local frame (x, y along the rectangle edges, z towards
+// the point) the projected rectangle is a spherical quad with interior angles g0..g3 and area
+//   Ω = g0 + g1 + g2 + g3 - 2π
+// The first random number picks the angle of a plane through the z axis, splitting Ω proportionally
+// (solved for the x coordinate xu); the second picks a height along the resulting great-circle segment.
+// Computed in double precision: the spherical excess is a difference of angles near π.
+struct SphericalRectangle {
+    Vector3 origin;
+    Vector3 x_axis, y_axis, z_axis;
+    double x0 = 0.0, y0 = 0.0, z0 = 0.0, x1 = 0.0, y1 = 0.0;
+    double b0 = 0.0, b1 = 0.0, k = 0.0;
+    double solid_angle = 0.0;
+
+    // corner: one rectangle corner; edge_x, edge_y: the two perpendicular edges leaving it
+    SphericalRectangle(const Vector3& corner, const Vector3& edge_x, const Vector3& edge_y, const Vector3& point)
+        : origin(point) {
+        double length_x = edge_x.length();
+        double length_y = edge_y.length();
+        x_axis = edge_x * static_cast<float>(1.0 / length_x);
+        y_axis = edge_y * static_cast<float>(1.0 / length_y);
+        z_axis = x_axis.cross(y_axis);
+
+        Vector3 d = corner - point;
+        x0 = d.dot(x_axis);
+        y0 = d.dot(y_axis);
+        z0 = d.dot(z_axis);
+        if (z0 > 0.0) {
+            z0 = -z0;
+            z_axis = z_axis * -1.0f;
+        }
+        x1 = x0 + length_x;
+        y1 = y0 + length_y;
+        if (z0 > -1e-9) {
+            return;   // Point lies in the light's plane: zero solid angle
+        }
+
+        // Normals of the four great-circle edges (only their z components and products are needed)
+        double n0z = -y0 / std::sqrt(z0 * z0 + y0 * y0);
+        double n1z = x1 / std::sqrt(z0 * z0 + x1 * x1);
+        double n2z = y1 / std::sqrt(z0 * z0 + y1 * y1);
+        double n3z = -x0 / std::sqrt(z0 * z0 + x0 * x0);
+
+        double g0 = std::acos(std::clamp(-n0z * n1z, -1.0, 1.0));
+        double g1 = std::acos(std::clamp(-n1z * n2z, -1.0, 1.0));
+        double g2 = std::acos(std::clamp(-n2z * n3z, -1.0, 1.0));
+        double g3 = std::acos(std::clamp(-n3z * n0z, -1.0, 1.0));
+        b0 = n0z;
+        b1 = n2z;
+        k = 2.0 * M_PI - g2 - g3;
+        solid_angle = std::max(0.0, g0 + g1 - k);
+    }
+
+    // Point on the rectangle for the uniform numbers (u, v) in [0, 1); its solid-angle pdf is 1/Ω
+    Vector3 sample(float u, float v) const {
+        double au = u * solid_angle + k;
+        double fu = (std::cos(au) * b0 - b1) / std::sin(au);
+        double cu = std::clamp((fu > 0.0 ? 1.0 : -1.0) / std::sqrt(fu * fu + b0 * b0), -1.0, 1.0);
+        double xu = std::clamp(-(cu * z0) / std::sqrt(std::max(1e-12, 1.0 - cu * cu)), x0, x1);
+
+        double d = std::sqrt(xu * xu + z0 * z0);
+        double h0 = y0 / std::sqrt(d * d + y0 * y0);
+        double h1 = y1 / std::sqrt(d * d + y1 * y1);
+        double hv = h0 + v * (h1 - h0);
+        double hv2 = hv * hv;
+        double yv = hv2 < 1.0 - 1e-9 ? std::clamp((hv * d) / std::sqrt(1.0 - hv2), y0, y1) : y1;
+
+        return origin + x_axis * static_cast<float>(xu) + y_axis * static_cast<float>(yv) + z_axis * static_cast<float>(z0);
+    }
+};
+
 class AreaLight : public Light {
 public:
     Vector3 center;     // Center position of the rectangular area light
@@ -18,16 +103,14 @@ public:
     float height;       // Height of the rectangular light
     Vector3 u_axis;     // Local U axis (width direction, normalized)
     Vector3 v_axis;     // Local V axis (height direction, normalized)
-    
-    // Random number generator for Monte Carlo sampling
-    mutable std::mt19937 rng{std::random_device{}()};
-    mutable std::uniform_real_distribution<float> uniform_dist{0.0f, 1.0f};
-    
+    AreaLightSampling sampling;   // Area (default) or solid-angle sample placement
+
     AreaLight(const Vector3& light_center, const Vector3& surface_normal, 
               float light_width, float light_height,
-              const Vector3& light_color, float light_intensity)
+              const Vector3& light_color, float light_intensity,
+              AreaLightSampling sample_mode = AreaLightSampling::Area)
         : Light(light_color, light_intensity, LightType::Area), 
-          center(light_center), width(light_width), height(light_height) {
+          center(light_center), width(light_width), height(light_height), sampling(sample_mode) {
         
         // Normalize the normal vector
         float normal_length = surface_normal.length();
@@ -46,6 +129,20 @@ public:
     
     // Core light evaluation interface implementation
     Vector3 illuminate(const Vector3& point, Vector3& light_direction, float& distance) const override {
+        if (sampling == AreaLightSampling::SolidAngle) {
+            // Every sample has the same weight L / pdf = L Ω
+            float pdf = 0.0f;
+            Vector3 sample_point = sample_solid_angle(point, random_unit(), random_unit(), pdf);
+            Vector3 light_vector = sample_point - point;
+            distance = light_vector.length();
+            if (pdf <= 0.0f || distance < 1e-6f) {
+                light_direction = Vector3(0, 0, 1);
+                return Vector3(0, 0, 0);
+            }
+            light_direction = light_vector * (1.0f / distance);
+            return color * intensity * (1.0f / pdf);
+        }
+
         // For area lights, we sample a random point on the light surface
         // This provides Monte Carlo integration for soft shadows
         Vector3 sample_point = sample_point_on_surface();
@@ -88,6 +185,16 @@ public:
     }
     
     Vector3 sample_direction(const Vector3& point, float& pdf) const override {
+        if (sampling == AreaLightSampling::SolidAngle) {
+            Vector3 light_vector = sample_solid_angle(point, random_unit(), random_unit(), pdf) - point;
+            float distance = light_vector.length();
+            if (pdf <= 0.0f || distance < 1e-6f) {
+                pdf = 0.0f;
+                return Vector3(0, 0, 1);
+            }
+            return light_vector * (1.0f / distance);
+        }
+
         // Sample a random point on the area light surface
         Vector3 sample_point = sample_point_on_surface();
         Vector3 light_vector = sample_point - point;
@@ -114,8 +221,54 @@ public:
         return direction;
     }
     
+    // Projection of the light onto the unit sphere around `point` (front side only)
+    SphericalRectangle spherical_rectangle(const Vector3& point) const {
+        Vector3 corner = center - u_axis * (0.5f * width) - v_axis * (0.5f * height);
+        return SphericalRectangle(corner, u_axis * width, v_axis * height, point);
+    }
+
+    // Solid angle the emitting (front) side subtends from `point`; zero behind the light
+    float solid_angle(const Vector3& point) const {
+        if (normal.dot(point - center) <= 0.0f) {
+            return 0.0f;
+        }
+        return static_cast<float>(spherical_rectangle(point).solid_angle);
+    }
+
+    // Deterministic spherical rectangle sample for the uniform numbers (u, v) in [0, 1)
+    // Returns the point on the light; pdf is the solid-angle density 1/Ω (0 if the light faces away)
+    Vector3 sample_solid_angle(const Vector3& point, float u, float v, float& pdf) const {
+        if (normal.dot(point - center) <= 0.0f) {
+            pdf = 0.0f;
+            return center;
+        }
+        SphericalRectangle rectangle = spherical_rectangle(point);
+        if (rectangle.solid_angle < 1e-9) {
+            pdf = 0.0f;
+            return center;
+        }
+        pdf = static_cast<float>(1.0 / rectangle.solid_angle);
+        return rectangle.sample(u, v);
+    }
+
+    // Deterministic uniform area sample for (u, v) in [0, 1), the mapping sample_point_on_surface() uses
+    Vector3 sample_area(float u, float v) const {
+        return center + u_axis * ((u - 0.5f) * width) + v_axis * ((v - 0.5f) * height);
+    }
+
+    // Uniform random number for Monte Carlo sampling (one generator per thread for parallel rendering)
+    static float random_unit() {
+        static thread_local std::mt19937 rng{std::random_device{}()};
+        std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
+        return uniform_dist(rng);
+    }
+
     // Sample a random point on the area light surface
     Vector3 sample_point_on_surface() const {
+        // Random number generator for Monte Carlo sampling (one per thread for parallel rendering)
+        static thread_local std::mt19937 rng{std::random_device{}()};
+        std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
+        
         // Generate random coordinates in [-0.5, 0.5] range
         float u = uniform_dist(rng) - 0.5f;  // [-0.5, 0.5]
         float v = uniform_dist(rng) - 0.5f;  // [-0.5, 0.5]
@@ -133,6 +286,8 @@ public:
         std::cout << "Light Normal: (" << normal.x << ", " << normal.y << ", " << normal.z << ")" << std::endl;
         std::cout << "Light Dimensions: " << width << " x " << height << " units" << std::endl;
         std::cout << "Light Area: " << (width * height) << " square units" << std::endl;
+        std::cout << "Sampling: " << (sampling == AreaLightSampling::SolidAngle ? "solid angle (spherical rectangle)" : "uniform area") << std::endl;
+        std::cout << "Subtended Solid Angle: " << solid_angle(point) << " sr" << std::endl;
         
         Vector3 sample_point = sample_point_on_surface();
         Vector3 light_vector = sample_point - point;
@@ -165,9 +320,12 @@ public:
         return "Area Light at (" + std::to_string(center.x) + ", " + 
                std::to_string(center.y) + ", " + std::to_string(center.z) + 
                ") size " + std::to_string(width) + "x" + std::to_string(height) +
-               " with intensity " + std::to_string(intensity);
+               " with intensity " + std::to_string(intensity) +
+               (sampling == AreaLightSampling::SolidAngle ? " (solid-angle sampling)" : "");
     }
     
+    std::unique_ptr<Light> clone() const override { return std::make_unique<AreaLight>(*this); }
+
     // Additional validation for area light specific parameters
     bool validate_parameters() const override {
         if (!Light::validate_parameters()) {
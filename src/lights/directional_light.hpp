@@ -82,6 +82,8 @@ public:
                ") with intensity " + std::to_string(intensity);
     }
     
+    std::unique_ptr<Light> clone() const override { return std::make_unique<DirectionalLight>(*this); }
+
     // Additional validation for directional light specific parameters
     bool validate_parameters() const override {
         if (!Light::validate_parameters()) {
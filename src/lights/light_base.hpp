@@ -4,6 +4,7 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <memory>
 
 // Forward declaration for Scene to avoid circular dependency
 class Scene;
@@ -11,7 +12,8 @@ class Scene;
 enum class LightType {
     Point,
     Directional,
-    Area
+    Area,
+    Sphere
 };
 
 class Light {
@@ -41,6 +43,9 @@ public:
     
     virtual std::string get_light_info() const = 0;
 
+    // Independent copy of the light (SceneLoader merges one parsed include into many scenes)
+    virtual std::unique_ptr<Light> clone() const = 0;
+
     // Utility method to validate light parameters
     virtual bool validate_parameters() const {
         // Check color components are in valid range [0.0, 1.0]
@@ -100,6 +100,8 @@ public:
                ") with intensity " + std::to_string(intensity);
     }
     
+    std::unique_ptr<Light> clone() const override { return std::make_unique<PointLight>(*this); }
+
     // Additional validation for point light specific parameters
     bool validate_parameters() const override {
         if (!Light::validate_parameters()) {
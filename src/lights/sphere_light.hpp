@@ -0,0 +1,213 @@
+#pragma once
+
+#include "light_base.hpp"
+#include "../core/vector3.hpp"
+#include "../core/ray.hpp"
+#include <iostream>
+#include <cmath>
+#include <random>
+
+// Forward declaration for Scene to avoid circular dependency
+class Scene;
+
+// Spherical emitter (light bulb) sampled by solid angle
+//
+// Educational focus: seen from a point p outside the sphere, a sphere of radius r at distance d
+// covers a cone of directions with half-angle θmax, where sin θmax = r/d. Every direction inside that
+// cone hits the front of the sphere, so sampling the cone uniformly wastes no samples on the back
+// side (which uniform area sampling does half the time). The cone's solid angle is
+//   Ω = 2π (1 - cos θmax)
+// and the uniform cone pdf is exactly 1/Ω. With cos θ = 1 - u1 (1 - cos θmax), φ = 2π u2 the
+// direction is uniform in the cone; the sampled ray reaches the sphere at
+//   t = d cos θ - sqrt(r² - d² sin² θ)
+// The Monte Carlo estimate of incident radiance is L/pdf = L Ω, returned by illuminate() exactly like
+// AreaLight returns L cos A / d². intensity is therefore the emitted radiance; the equivalent
+// point light intensity for a distant viewer is intensity · π r².
+class SphereLight : public Light {
+public:
+    Vector3 center;     // Center of the emitting sphere
+    float radius;       // Radius of the emitting sphere
+
+    SphereLight(const Vector3& light_center, float light_radius,
+                const Vector3& light_color, float light_intensity)
+        : Light(light_color, light_intensity, LightType::Sphere),
+          center(light_center), radius(light_radius) {}
+
+    // Deterministic cone sample for the uniform numbers (u1, u2) in [0, 1)
+    // Returns the direction towards the sphere, its solid-angle pdf and the distance to the surface
+    // If the point lies inside the sphere the whole sphere of directions is sampled (pdf 1/4π)
+    Vector3 sample_cone(const Vector3& point, float u1, float u2, float& pdf, float& distance) const {
+        Vector3 to_center = center - point;
+        float center_distance_squared = to_center.length_squared();
+        float center_distance = std::sqrt(center_distance_squared);
+        float radius_squared = radius * radius;
+        const float pi = static_cast<float>(M_PI);
+
+        float phi = 2.0f * pi * u2;
+        if (center_distance <= radius || center_distance < 1e-6f) {
+            // Inside the light: every direction reaches the surface from within
+            float cos_theta = 1.0f - 2.0f * u1;
+            float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+            Vector3 direction(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+            float projection = to_center.dot(direction);
+            distance = projection + std::sqrt(std::max(0.0f, projection * projection - center_distance_squared + radius_squared));
+            pdf = 1.0f / (4.0f * pi);
+            return direction;
+        }
+
+        Vector3 w = to_center * (1.0f / center_distance);
+        Vector3 arbitrary = (std::abs(w.x) < 0.9f) ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+        Vector3 u = w.cross(arbitrary).normalize();
+        Vector3 v = w.cross(u);
+
+        // 1 - cos θmax written as sin²/(1 + cos) so that small, distant bulbs keep their precision
+        float sin_squared_max = radius_squared / center_distance_squared;
+        float cos_theta_max = std::sqrt(std::max(0.0f, 1.0f - sin_squared_max));
+        float one_minus_cos_max = sin_squared_max / (1.0f + cos_theta_max);
+
+        float one_minus_cos = u1 * one_minus_cos_max;
+        float cos_theta = 1.0f - one_minus_cos;
+        float sin_squared = one_minus_cos * (2.0f - one_minus_cos);
+        float sin_theta = std::sqrt(std::max(0.0f, sin_squared));
+
+        Vector3 direction = u * (sin_theta * std::cos(phi)) + v * (sin_theta * std::sin(phi)) + w * cos_theta;
+        distance = center_distance * cos_theta - std::sqrt(std::max(0.0f, radius_squared - center_distance_squared * sin_squared));
+        pdf = 1.0f / (2.0f * pi * one_minus_cos_max);
+        return direction;
+    }
+
+    // Solid-angle pdf of sample_cone() producing `direction` from `point` (0 outside the cone)
+    float pdf(const Vector3& point, const Vector3& direction) const {
+        Vector3 to_center = center - point;
+        float center_distance_squared = to_center.length_squared();
+        float radius_squared = radius * radius;
+        const float pi = static_cast<float>(M_PI);
+        if (center_distance_squared <= radius_squared || center_distance_squared < 1e-12f) {
+            return 1.0f / (4.0f * pi);
+        }
+
+        float center_distance = std::sqrt(center_distance_squared);
+        float sin_squared_max = radius_squared / center_distance_squared;
+        float cos_theta_max = std::sqrt(std::max(0.0f, 1.0f - sin_squared_max));
+        float cos_theta = to_center.dot(direction) / (center_distance * direction.length());
+        if (cos_theta < cos_theta_max) {
+            return 0.0f;
+        }
+        return 1.0f / (2.0f * pi * sin_squared_max / (1.0f + cos_theta_max));
+    }
+
+    // Solid angle subtended by the sphere from `point`
+    float solid_angle(const Vector3& point) const {
+        float pdf_value = pdf(point, center - point);
+        return pdf_value > 0.0f ? 1.0f / pdf_value : 0.0f;
+    }
+
+    // Core light evaluation interface implementation
+    Vector3 illuminate(const Vector3& point, Vector3& light_direction, float& distance) const override {
+        float u1, u2;
+        random_pair(u1, u2);
+        float sample_pdf;
+        light_direction = sample_cone(point, u1, u2, sample_pdf, distance);
+        if (sample_pdf <= 0.0f || distance < 1e-6f) {
+            return Vector3(0, 0, 0);
+        }
+
+        // Uniform radiance over the visible cap: L / pdf
+        return color * intensity * (1.0f / sample_pdf);
+    }
+
+    bool is_occluded(const Vector3& point, const Vector3& light_direction, float distance, const Scene& scene) const override {
+        // Create shadow ray with small epsilon offset to avoid self-intersection
+        const float epsilon = 0.001f;
+        Vector3 offset_point = point + light_direction * epsilon;
+        Ray shadow_ray(Point3(offset_point.x, offset_point.y, offset_point.z), light_direction);
+
+        // Test intersection with scene
+        Scene::Intersection hit = scene.intersect(shadow_ray, false);  // Disable verbose output
+
+        // Check if intersection occurs before reaching the light surface
+        return hit.hit && hit.t < (distance - epsilon);
+    }
+
+    Vector3 sample_direction(const Vector3& point, float& pdf) const override {
+        float u1, u2, distance;
+        random_pair(u1, u2);
+        return sample_cone(point, u1, u2, pdf, distance);
+    }
+
+    // Educational debugging methods
+    void explain_light_calculation(const Vector3& point) const override {
+        Light::explain_light_calculation(point);  // Call base class method
+
+        std::cout << "=== Sphere Light Specific Calculation ===" << std::endl;
+        std::cout << "Light Center: (" << center.x << ", " << center.y << ", " << center.z << ")" << std::endl;
+        std::cout << "Light Radius: " << radius << " units" << std::endl;
+
+        float center_distance = (center - point).length();
+        std::cout << "Distance to Center: " << center_distance << std::endl;
+        if (center_distance > radius) {
+            float sin_theta_max = radius / center_distance;
+            std::cout << "Cone Half-Angle (sin θmax): " << sin_theta_max << std::endl;
+            std::cout << "Subtended Solid Angle: " << solid_angle(point) << " sr" << std::endl;
+            std::cout << "Sample PDF: " << pdf(point, center - point) << " (uniform in the cone)" << std::endl;
+        } else {
+            std::cout << "Point lies inside the light: sampling the full sphere of directions" << std::endl;
+        }
+
+        std::cout << "Physical Model: Spherical surface emitting uniform radiance" << std::endl;
+        std::cout << "Key Property: Cone sampling never picks the hidden back side of the bulb" << std::endl;
+        std::cout << "Usage: Light bulbs, lamps, small round fixtures" << std::endl;
+        std::cout << "====================================" << std::endl;
+    }
+
+    std::string get_light_info() const override {
+        return "Sphere Light at (" + std::to_string(center.x) + ", " +
+               std::to_string(center.y) + ", " + std::to_string(center.z) +
+               ") radius " + std::to_string(radius) +
+               " with intensity " + std::to_string(intensity);
+    }
+
+    std::unique_ptr<Light> clone() const override { return std::make_unique<SphereLight>(*this); }
+
+    // Additional validation for sphere light specific parameters
+    bool validate_parameters() const override {
+        if (!Light::validate_parameters()) {
+            return false;
+        }
+
+        // Check center position is finite
+        if (!std::isfinite(center.x) || !std::isfinite(center.y) || !std::isfinite(center.z)) {
+            return false;
+        }
+
+        // Check radius is positive and finite
+        if (radius <= 0.0f || !std::isfinite(radius)) {
+            return false;
+        }
+
+        return true;
+    }
+
+    // Clamp sphere light parameters
+    void clamp_parameters() override {
+        Light::clamp_parameters();
+
+        // Clamp center to reasonable bounds
+        const float max_coord = 1000.0f;
+        center.x = std::max(-max_coord, std::min(max_coord, center.x));
+        center.y = std::max(-max_coord, std::min(max_coord, center.y));
+        center.z = std::max(-max_coord, std::min(max_coord, center.z));
+
+        // Clamp radius to reasonable range
+        radius = std::max(0.001f, std::min(100.0f, radius));
+    }
+
+private:
+    // Random numbers for Monte Carlo sampling (one generator per thread for parallel rendering)
+    static void random_pair(float& u1, float& u2) {
+        static thread_local std::mt19937 rng{std::random_device{}()};
+        std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
+        u1 = uniform_dist(rng);
+        u2 = uniform_dist(rng);
+    }
+};
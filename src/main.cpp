@@ -13,7 +13,27 @@
 #include "core/image.hpp"
 #include "core/performance_timer.hpp"
 #include "core/progress_reporter.hpp"
+#include "core/renderer.hpp"
+#include "core/checkerboard_renderer.hpp"
+#include "core/path_tracer.hpp"
+#include "core/huge_pages.hpp"
+#include "core/metrics_exporter.hpp"
+#include "core/time_series_recorder.hpp"
+#include "core/cost_predictor.hpp"
+#include "core/cost_attribution.hpp"
+#include "core/render_cache.hpp"
+#include "core/cpu_budget.hpp"
+#include "core/memory_planner.hpp"
+#include "core/sort_last_renderer.hpp"
+#include "core/shadow_bundle.hpp"
+#include <cstdio>
+#include <ctime>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <random>
+#include <thread>
 
 // Cross-platform preprocessor directives
 #ifdef PLATFORM_APPLE
@@ -48,6 +68,58 @@ int main(int argc, char* argv[]) {
             std::cout << "\nDebug and verbosity parameters:" << std::endl;
             std::cout << "--quiet               Minimal output (no educational breakdowns, errors only)" << std::endl;
             std::cout << "--verbose             Full educational output (default behavior)" << std::endl;
+            std::cout << "\nSequence rendering (preview animation):" << std::endl;
+            std::cout << "--sequence <frames>   Render an animation sequence (sequence_frame_NNN.png)" << std::endl;
+            std::cout << "--camera-step x,y,z   Camera translation per frame (default: 0.05,0,0)" << std::endl;
+            std::cout << "--checkerboard        Trace half the pixels per frame, reconstruct the rest" << std::endl;
+            std::cout << "                      from the reprojected previous frame (~50% rays)" << std::endl;
+            std::cout << "\nOutput format:" << std::endl;
+            std::cout << "--output-format <fmt> png (default) or qoi: lossless, encoded in parallel row bands," << std::endl;
+            std::cout << "                      much faster than PNG for intermediate frames (raytracer_output.qoi)" << std::endl;
+            std::cout << "--qoi-bands <n>       Independently encoded row bands for QOI (default: one per thread)" << std::endl;
+            std::cout << "\nPath tracing (indirect lighting):" << std::endl;
+            std::cout << "--path-trace          Monte Carlo path tracing with indirect bounces" << std::endl;
+            std::cout << "--spp <samples>       Samples per pixel for path tracing (default: 16)" << std::endl;
+            std::cout << "--max-bounces <n>     Maximum indirect bounces per path (default: 4)" << std::endl;
+            std::cout << "--path-guiding        Learn an SD-tree of incident light and guide bounce sampling" << std::endl;
+            std::cout << "--threads <n>         Render threads for path tracing (default: effective CPUs, i.e." << std::endl;
+            std::cout << "                      cores limited by the affinity mask and cgroup cpu.max quota)" << std::endl;
+            std::cout << "\nAcceleration and level of detail:" << std::endl;
+            std::cout << "--bvh                 Build a BVH over the scene spheres (exact, faster intersection)" << std::endl;
+            std::cout << "--lod-error <pixels>  Screen-space error threshold: BVH nodes smaller than this many" << std::endl;
+            std::cout << "                      pixels are rendered as one proxy sphere (implies --bvh, e.g. 1.0)" << std::endl;
+            std::cout << "--lazy-bvh            Build only the top BVH levels up front; deeper subtrees are built" << std::endl;
+            std::cout << "                      the first time a ray enters them (implies --bvh)" << std::endl;
+            std::cout << "--huge-pages          Back spheres, BVH and framebuffer with 2 MB pages (Linux THP)" << std::endl;
+            std::cout << "--memory-budget <size> Choose representations that fit <size> (e.g. 512M, 2G; default:" << std::endl;
+            std::cout << "                      cgroup memory.max if set); the plan is printed before rendering" << std::endl;
+            std::cout << "--raster-primary      Resolve primary visibility by rasterizing sphere bounds into a" << std::endl;
+            std::cout << "                      tile-binned visibility buffer (uses --threads); shading unchanged" << std::endl;
+            std::cout << "--shadow-bundles      Trace each tile's point-light shadow rays as one bundle through the" << std::endl;
+            std::cout << "                      BVH (implies --bvh); image identical to per-ray shadow rays" << std::endl;
+            std::cout << "--sort-last <n>       Split the scene spatially over n worker processes that each load only" << std::endl;
+            std::cout << "                      their chunk; rays are forwarded between chunks, hits composited" << std::endl;
+            std::cout << "\nRender cost prediction:" << std::endl;
+            std::cout << "--predict             Pre-sample ~1% of pixels, write predicted time/memory as JSON," << std::endl;
+            std::cout << "                      then render with the costliest scanlines scheduled first" << std::endl;
+            std::cout << "--predict-only        Write the prediction and exit without rendering" << std::endl;
+            std::cout << "--predict-fraction <f> Share of pixels pre-sampled (default: 0.01)" << std::endl;
+            std::cout << "--predict-output <file> Prediction JSON file (default: render_prediction.json)" << std::endl;
+            std::cout << "\nMonitoring:" << std::endl;
+            std::cout << "--metrics-file <path>  Write Prometheus metrics while rendering (node_exporter textfile" << std::endl;
+            std::cout << "                       collector, e.g. /var/lib/node_exporter/raytracer.prom)" << std::endl;
+            std::cout << "--metrics-interval <s> Seconds between metrics file updates (default: 10)" << std::endl;
+            std::cout << "--timeseries <file>    Record rays/sec, thread busy time, RSS and tiles over time" << std::endl;
+            std::cout << "                       (CSV, or JSON when the file ends in .json)" << std::endl;
+            std::cout << "--timeseries-interval <ms> Milliseconds between time series samples (default: 100)" << std::endl;
+            std::cout << "--timeseries-plot      Plot thread utilization over time as ASCII in the final report" << std::endl;
+            std::cout << "--cost-attribution     Report shading time, BRDF evaluations and shadow rays per material" << std::endl;
+            std::cout << "                       and per light, most expensive first (single images)" << std::endl;
+            std::cout << "\nRender cache:" << std::endl;
+            std::cout << "--cache-dir <dir>     Return identical renders from an on-disk cache and reuse unchanged" << std::endl;
+            std::cout << "                      tiles of partially changed scenes (e.g. render_cache)" << std::endl;
+            std::cout << "--cache-max-mb <n>    Cache size bound; least recently used entries are evicted (default: 512)" << std::endl;
+            std::cout << "--no-tile-cache       Cache whole images only" << std::endl;
             std::cout << "\nQuick presets:" << std::endl;
             std::cout << "--preset showcase     Epic 2 showcase (1024x768, complex scene, optimal camera)" << std::endl;
             std::cout << "--showcase            Shorthand for --preset showcase" << std::endl;
@@ -81,6 +153,48 @@ int main(int argc, char* argv[]) {
     // Debug and verbosity control parameters
     bool quiet_mode = false;               // Minimal output mode
     
+    // Sequence rendering parameters (preview animation with optional checkerboard reconstruction)
+    int sequence_frames = 0;               // 0 = single still image
+    Vector3 camera_step(0.05f, 0.0f, 0.0f); // Camera translation per frame
+    bool checkerboard_mode = false;        // Trace alternating pixel halves per frame
+    
+    // Output format parameters (PNG, or QOI for fast intermediate frames)
+    bool qoi_output = false;               // Write .qoi instead of .png
+    QoiEncoder::Settings qoi_settings;     // Row bands; threads follow --threads
+    
+    // Path tracing parameters (indirect lighting with optional path guiding)
+    bool path_trace_mode = false;          // Direct lighting only by default
+    PathTracer::Settings path_settings;    // spp, bounces, guiding, threads
+    
+    // Acceleration parameters (BVH with level-of-detail proxies for distant clusters)
+    bool use_bvh = false;                  // Linear intersection by default
+    bool lazy_bvh = false;                 // Build BVH subtrees on first ray contact
+    bool raster_primary = false;           // Rasterized primary visibility (PrimaryRasterizer)
+    bool shadow_bundles = false;           // Bundled point-light shadow rays (ShadowBundleTracer)
+    int sort_last_workers = 0;             // > 0: sort-last rendering with this many chunk workers
+    float lod_error_pixels = 0.0f;         // 0 = exact; > 0 = proxies below this projected size
+    HugePages::Statistics huge_page_stats; // Huge-page coverage and render dTLB misses (--huge-pages)
+    size_t memory_budget_bytes = 0;        // 0 = cgroup memory.max, if any (MemoryPlanner)
+    
+    // Monitoring parameters (Prometheus textfile collector export)
+    std::string metrics_file;              // Empty = no metrics export
+    double metrics_interval = 10.0;        // Seconds between file rewrites
+    std::string time_series_file;          // Empty = no time series recording
+    double time_series_interval = 100.0;   // Milliseconds between samples
+    bool time_series_plot = false;         // ASCII utilization chart in the final report
+    bool cost_attribution = false;         // Shading cost per material and light (CostAttribution)
+    
+    // Cost prediction parameters (sparse pre-sampling before the render)
+    bool predict_mode = false;             // Pre-sample and write prediction JSON
+    bool predict_only = false;             // Exit after the prediction
+    CostPredictor::Settings predictor_settings;
+    std::string prediction_filename = "render_prediction.json";
+    
+    // Render cache parameters (content-addressed images and tiles on disk)
+    std::string cache_directory;           // Empty = no caching
+    RenderCache::Settings cache_settings;
+    bool tile_cache = true;                // Reuse unchanged tiles when the whole image misses
+    
     for (int i = 1; i < argc; i++) {
         if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
             scene_filename = argv[i + 1];
@@ -186,6 +300,164 @@ int main(int argc, char* argv[]) {
         } else if (std::strcmp(argv[i], "--verbose") == 0) {
             quiet_mode = false;
             std::cout << "Verbose mode enabled - full educational output" << std::endl;
+        } else if (std::strcmp(argv[i], "--sequence") == 0 && i + 1 < argc) {
+            sequence_frames = std::max(1, std::atoi(argv[i + 1]));
+            std::cout << "Sequence rendering: " << sequence_frames << " frames" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--camera-step") == 0 && i + 1 < argc) {
+            float dx, dy, dz;
+            if (std::sscanf(argv[i + 1], "%f,%f,%f", &dx, &dy, &dz) != 3) {
+                std::cout << "ERROR: Invalid camera step '" << argv[i + 1] << "' (expected x,y,z)" << std::endl;
+                return 1;
+            }
+            camera_step = Vector3(dx, dy, dz);
+            std::cout << "Camera step per frame: (" << dx << ", " << dy << ", " << dz << ")" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--checkerboard") == 0) {
+            checkerboard_mode = true;
+            std::cout << "Checkerboard rendering enabled - half the primary rays per frame" << std::endl;
+        } else if (std::strcmp(argv[i], "--path-trace") == 0) {
+            path_trace_mode = true;
+            std::cout << "Path tracing enabled - indirect lighting" << std::endl;
+        } else if (std::strcmp(argv[i], "--spp") == 0 && i + 1 < argc) {
+            path_settings.samples_per_pixel = std::max(1, std::atoi(argv[i + 1]));
+            std::cout << "Samples per pixel: " << path_settings.samples_per_pixel << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--max-bounces") == 0 && i + 1 < argc) {
+            path_settings.max_bounces = std::max(0, std::atoi(argv[i + 1]));
+            std::cout << "Maximum bounces: " << path_settings.max_bounces << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--path-guiding") == 0) {
+            path_trace_mode = true;
+            path_settings.path_guiding = true;
+            std::cout << "Path guiding enabled - SD-tree bounce sampling" << std::endl;
+        } else if (std::strcmp(argv[i], "--bvh") == 0) {
+            use_bvh = true;
+            std::cout << "BVH acceleration enabled" << std::endl;
+        } else if (std::strcmp(argv[i], "--lazy-bvh") == 0) {
+            use_bvh = true;
+            lazy_bvh = true;
+            std::cout << "Lazy BVH enabled - subtrees built on first ray contact" << std::endl;
+        } else if (std::strcmp(argv[i], "--lod-error") == 0 && i + 1 < argc) {
+            use_bvh = true;
+            lod_error_pixels = std::max(0.0f, std::stof(argv[i + 1]));
+            std::cout << "Level of detail: screen-space error threshold " << lod_error_pixels << " pixels" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--raster-primary") == 0) {
+            raster_primary = true;
+            std::cout << "Rasterized primary visibility enabled - tile-binned visibility buffer" << std::endl;
+        } else if (std::strcmp(argv[i], "--shadow-bundles") == 0) {
+            use_bvh = true;
+            shadow_bundles = true;
+            std::cout << "Shadow ray bundles enabled - point-light shadow rays traced per tile" << std::endl;
+        } else if (std::strcmp(argv[i], "--huge-pages") == 0) {
+            huge_page_stats.enabled = true;
+            std::cout << "Huge pages enabled - large buffers advised for 2 MB pages" << std::endl;
+        } else if (std::strcmp(argv[i], "--predict") == 0) {
+            predict_mode = true;
+            std::cout << "Cost prediction enabled - sparse pre-sampling before rendering" << std::endl;
+        } else if (std::strcmp(argv[i], "--predict-only") == 0) {
+            predict_mode = true;
+            predict_only = true;
+            std::cout << "Cost prediction only - no full render" << std::endl;
+        } else if (std::strcmp(argv[i], "--predict-fraction") == 0 && i + 1 < argc) {
+            predictor_settings.sample_fraction = std::atof(argv[i + 1]);
+            if (predictor_settings.sample_fraction <= 0.0f || predictor_settings.sample_fraction > 1.0f) {
+                std::cout << "ERROR: Prediction fraction must be in (0, 1] (got '" << argv[i + 1] << "')" << std::endl;
+                return 1;
+            }
+            std::cout << "Prediction pre-sampling fraction: " << predictor_settings.sample_fraction << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--predict-output") == 0 && i + 1 < argc) {
+            prediction_filename = argv[i + 1];
+            std::cout << "Prediction output: " << prediction_filename << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metrics_file = argv[i + 1];
+            std::cout << "Metrics export: " << metrics_file << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+            metrics_interval = std::atof(argv[i + 1]);
+            if (metrics_interval <= 0.0) {
+                std::cout << "ERROR: Metrics interval must be positive (got '" << argv[i + 1] << "')" << std::endl;
+                return 1;
+            }
+            std::cout << "Metrics interval: " << metrics_interval << " s" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--timeseries") == 0 && i + 1 < argc) {
+            time_series_file = argv[i + 1];
+            std::cout << "Time series recording: " << time_series_file << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--timeseries-interval") == 0 && i + 1 < argc) {
+            time_series_interval = std::atof(argv[i + 1]);
+            if (time_series_interval <= 0.0) {
+                std::cout << "ERROR: Time series interval must be positive (got '" << argv[i + 1] << "')" << std::endl;
+                return 1;
+            }
+            std::cout << "Time series interval: " << time_series_interval << " ms" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--timeseries-plot") == 0) {
+            time_series_plot = true;
+            std::cout << "Time series utilization plot enabled" << std::endl;
+        } else if (std::strcmp(argv[i], "--cost-attribution") == 0) {
+            cost_attribution = true;
+            std::cout << "Cost attribution enabled - shading cost per material and light" << std::endl;
+        } else if (std::strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            cache_directory = argv[i + 1];
+            std::cout << "Render cache: " << cache_directory << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--cache-max-mb") == 0 && i + 1 < argc) {
+            double megabytes = std::atof(argv[i + 1]);
+            if (megabytes <= 0.0) {
+                std::cout << "ERROR: Cache size must be positive (got '" << argv[i + 1] << "')" << std::endl;
+                return 1;
+            }
+            cache_settings.max_bytes = static_cast<size_t>(megabytes * 1024.0 * 1024.0);
+            std::cout << "Render cache size bound: " << megabytes << " MB" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--no-tile-cache") == 0) {
+            tile_cache = false;
+            std::cout << "Tile cache disabled - whole images only" << std::endl;
+        } else if (std::strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc) {
+            if (!MemoryPlanner::parse_size(argv[i + 1], memory_budget_bytes)) {
+                std::cout << "ERROR: Invalid memory budget '" << argv[i + 1] << "' (expected e.g. 512M, 2G or bytes)" << std::endl;
+                return 1;
+            }
+            std::cout << "Memory budget: " << MemoryPlanner::megabytes(memory_budget_bytes) << " MB" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--sort-last") == 0 && i + 1 < argc) {
+            sort_last_workers = std::atoi(argv[i + 1]);
+            if (sort_last_workers <= 0) {
+                std::cout << "ERROR: Sort-last worker count must be positive (got '" << argv[i + 1] << "')" << std::endl;
+                return 1;
+            }
+            std::cout << "Sort-last rendering: " << sort_last_workers << " worker processes" << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--output-format") == 0 && i + 1 < argc) {
+            std::string format = argv[i + 1];
+            if (format != "png" && format != "qoi") {
+                std::cout << "ERROR: Unknown output format '" << format << "' (expected png or qoi)" << std::endl;
+                return 1;
+            }
+            qoi_output = format == "qoi";
+            std::cout << "Output format: " << format << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--qoi-bands") == 0 && i + 1 < argc) {
+            qoi_settings.bands = std::atoi(argv[i + 1]);
+            if (qoi_settings.bands <= 0) {
+                std::cout << "ERROR: QOI band count must be positive (got '" << argv[i + 1] << "')" << std::endl;
+                return 1;
+            }
+            std::cout << "QOI row bands: " << qoi_settings.bands << std::endl;
+            i++;  // Skip next argument since we consumed it
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            path_settings.thread_count = std::max(1, std::atoi(argv[i + 1]));
+            std::cout << "Render threads: " << path_settings.thread_count << std::endl;
+            if (path_settings.thread_count > CpuBudget::default_thread_count()) {
+                std::cout << "WARNING: " << path_settings.thread_count << " threads exceed the " << CpuBudget::default_thread_count()
+                          << " effective CPU(s) of this process; threads will time-slice or be throttled" << std::endl;
+            }
+            i++;  // Skip next argument since we consumed it
         } else if (strncmp(argv[i], "--", 2) == 0) {
             // Check if it's a known camera argument (handled later by camera.set_from_command_line_args)
             if (std::strcmp(argv[i], "--camera-pos") == 0 || 
@@ -688,6 +960,38 @@ int main(int argc, char* argv[]) {
     render_camera.explain_fov_calculation();
     render_camera.print_camera_mathematics();
     
+    // Output files: PNG by default; QOI (qoi_encoder.hpp) encodes row bands on the render threads
+    qoi_settings.thread_count = path_settings.thread_count;
+    const std::string output_extension = qoi_output ? ".qoi" : ".png";
+    auto save_output = [&](const Image& image, const std::string& filename) {
+        return qoi_output ? image.save_to_qoi(filename, true, qoi_settings) : image.save_to_png(filename, true);
+    };
+    
+    // Sort-last distributed rendering: worker processes each load one spatial chunk of the scene file,
+    // so this process never holds the full sphere set (see sort_last_renderer.hpp)
+    if (sort_last_workers > 0) {
+        if (!use_scene_file || path_trace_mode || sequence_frames > 0 || predict_mode) {
+            std::cout << "ERROR: --sort-last renders single direct-lighting images of scene files "
+                      << "(not path tracing, sequences, --predict or --no-scene)" << std::endl;
+            return 1;
+        }
+        if (use_bvh || lod_error_pixels > 0.0f || raster_primary || huge_page_stats.enabled || !cache_directory.empty() ||
+            !metrics_file.empty() || !time_series_file.empty() || time_series_plot || cost_attribution) {
+            std::cout << "WARNING: acceleration, cache and monitoring options are ignored with --sort-last "
+                      << "(every worker builds a BVH over its chunk)" << std::endl;
+        }
+        SortLastRenderer::Settings sort_last_settings;
+        sort_last_settings.workers = sort_last_workers;
+        SortLastRenderer sort_last(scene_filename, material_type, sort_last_settings);
+        Image sort_last_image(image_width, image_height);
+        if (!sort_last.ready() || !sort_last.render_frame(render_camera, image_width, image_height, sort_last_image.pixels)) {
+            return 1;
+        }
+        if (!quiet_mode) sort_last.statistics().print();
+        bool saved = save_output(sort_last_image, "raytracer_output" + output_extension);
+        return saved ? 0 : 1;
+    }
+    
     // Scene setup: load from file or create default scene
     Scene render_scene;
     PointLight image_light(Vector3(2, 2, -3), Vector3(1.0f, 1.0f, 1.0f), 10.0f);
@@ -730,9 +1034,394 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Memory planning: with a budget (--memory-budget or cgroup memory.max), pick the representations
+    // that fit before anything large is allocated (see memory_planner.hpp)
+    bool streamed_output = false;
+    std::string memory_budget_source = "--memory-budget";
+    if (memory_budget_bytes == 0) {
+        memory_budget_bytes = MemoryPlanner::cgroup_memory_limit(memory_budget_source);
+    }
+    if (memory_budget_bytes > 0) {
+        MemoryPlanner::Request memory_request;
+        memory_request.width = image_width;
+        memory_request.height = image_height;
+        memory_request.scene_bytes = render_scene.calculate_scene_memory_usage();
+        memory_request.sphere_count = render_scene.primitives.size();
+        memory_request.path_tracing = path_trace_mode;
+        memory_request.bvh = use_bvh && !render_scene.primitives.empty();
+        memory_request.raster_primary = raster_primary && !(path_trace_mode || lod_error_pixels > 0.0f ||
+                                                            material_type == "cook-torrance" || checkerboard_mode);
+        memory_request.qoi_output = qoi_output;
+        memory_request.qoi_bands = qoi_settings.bands;
+        memory_request.threads = path_settings.thread_count;
+        memory_request.streaming_allowed = use_scene_file && material_type != "cook-torrance" && !path_trace_mode &&
+                                           sequence_frames == 0 && cache_directory.empty() && metrics_file.empty() &&
+                                           time_series_file.empty() && !time_series_plot && !cost_attribution &&
+                                           !shadow_bundles;
+        MemoryPlanner::Plan memory_plan = MemoryPlanner::plan(memory_request, memory_budget_bytes, memory_budget_source);
+        memory_plan.print();
+        if (!memory_plan.fits) {
+            std::cout << "ERROR: The render does not fit the memory budget of " << MemoryPlanner::megabytes(memory_budget_bytes)
+                      << " MB (lower --resolution or raise the budget)" << std::endl;
+            return 1;
+        }
+        use_bvh = memory_plan.bvh;
+        raster_primary = raster_primary && memory_plan.raster_primary;
+        qoi_settings.bands = memory_plan.qoi_bands;
+        streamed_output = memory_plan.streamed_output;
+    }
+    
+    // BVH acceleration: built once after scene loading, used by every Scene query from here on
+    if (use_bvh && !render_scene.primitives.empty()) {
+        render_scene.build_bvh(lazy_bvh);
+    }
+    
+    // Rasterized primary visibility: exact primary hits, so only direct-lighting Scene renders use it
+    std::unique_ptr<PrimaryRasterizer> primary_rasterizer;
+    if (raster_primary) {
+        if (path_trace_mode || lod_error_pixels > 0.0f || (material_type == "cook-torrance" && !use_scene_file) || checkerboard_mode) {
+            std::cout << "WARNING: --raster-primary is ignored for path tracing, --lod-error, checkerboard sequences "
+                      << "and the Cook-Torrance single sphere" << std::endl;
+        } else {
+            PrimaryRasterizer::Settings rasterizer_settings;
+            rasterizer_settings.thread_count = path_settings.thread_count;
+            primary_rasterizer = std::make_unique<PrimaryRasterizer>(rasterizer_settings);
+        }
+    }
+    
+    // Huge pages: re-home the finished sphere array and BVH into 2 MB-page advised memory
+    if (huge_page_stats.enabled) {
+        render_scene.use_huge_pages(huge_page_stats);
+    }
+    
+    // Cost prediction: time a stratified ~1% pixel subset with the same kernel as the real render,
+    // extrapolate time and memory, and keep the cost map to schedule costly scanlines first
+    if (predict_mode) {
+        if ((material_type == "cook-torrance" && !use_scene_file) || sequence_frames > 0) {
+            std::cout << "ERROR: --predict supports single-image Scene renders and path tracing (not sequences or the Cook-Torrance single sphere)" << std::endl;
+            return 1;
+        }
+        
+        CostPredictor predictor(image_width, image_height, predictor_settings);
+        int predicted_threads = 1;
+        int predicted_spp = 1;
+        std::map<std::string, size_t> predicted_memory;
+        predicted_memory["framebuffer"] = static_cast<size_t>(image_width) * image_height * sizeof(Vector3);
+        predicted_memory["scene"] = render_scene.calculate_scene_memory_usage();
+        if (render_scene.bvh) {
+            predicted_memory["bvh"] = render_scene.bvh->memory_usage_bytes();
+        }
+        
+        if (path_trace_mode) {
+            PathTracer sampler(render_scene, path_settings);
+            std::mt19937 rng(path_settings.seed);
+            predictor.sample([&](int x, int y) { sampler.sample_pixel(render_camera, x, y, image_width, image_height, rng); });
+            predicted_threads = path_settings.thread_count > 0 ? path_settings.thread_count : CpuBudget::default_thread_count();
+            predicted_spp = path_settings.samples_per_pixel;
+            predicted_memory["accumulation"] = predicted_memory["framebuffer"];
+        } else {
+            RayCone cone(0.0f, render_camera.pixel_spread_angle(image_height));
+            Point3 eye = render_camera.position;
+            predictor.sample([&](int x, int y) {
+                Ray ray = render_camera.generate_ray(static_cast<float>(x), static_cast<float>(y), image_width, image_height);
+                Renderer::trace_primary(render_scene, ray, eye, cone, lod_error_pixels);
+            });
+        }
+        render_scene.reset_statistics();
+        
+        CostPredictor::Prediction prediction = predictor.predict(predicted_spp, predicted_threads, predicted_memory);
+        prediction.print();
+        if (!CostPredictor::write_json(prediction, prediction_filename)) {
+            return 1;
+        }
+        std::cout << "Prediction written to " << prediction_filename << std::endl;
+        if (predict_only) {
+            return 0;
+        }
+        path_settings.scanline_order = predictor.scanline_order();
+    }
+    
+    // Metrics export: rewritten atomically every metrics_interval seconds by whichever render loop runs
+    std::unique_ptr<MetricsExporter> metrics_exporter;
+    if (!metrics_file.empty()) {
+        metrics_exporter = std::make_unique<MetricsExporter>(metrics_file, metrics_interval);
+    }
+    
+    // Time series: a background thread samples the totals each render loop reports (see report())
+    std::unique_ptr<TimeSeriesRecorder> time_series;
+    if (!time_series_file.empty() || time_series_plot) {
+        time_series = std::make_unique<TimeSeriesRecorder>(time_series_interval);
+    }
+    auto finish_time_series = [&]() {
+        if (!time_series) return;
+        time_series->stop();
+        if (!time_series_file.empty() && time_series->write(time_series_file)) {
+            std::cout << "Time series written to " << time_series_file << std::endl;
+        }
+        time_series->print_report(time_series_plot);
+    };
+    
+    // Render cache: the key covers the loaded scene, camera, resolution and every option that changes
+    // pixels (BVH and huge pages do not); an identical earlier render is returned without tracing
+    std::unique_ptr<RenderCache> render_cache;
+    std::string cache_key;
+    std::string cache_options;
+    if (!cache_directory.empty() && sequence_frames > 0) {
+        std::cout << "WARNING: --cache-dir is ignored for sequence rendering" << std::endl;
+    } else if (!cache_directory.empty() && !RenderCache::deterministic(render_scene)) {
+        std::cout << "WARNING: --cache-dir is ignored for scenes with area or sphere lights "
+                  << "(randomly sampled, so every render differs)" << std::endl;
+    } else if (!cache_directory.empty()) {
+        cache_settings.directory = cache_directory;
+        render_cache = std::make_unique<RenderCache>(cache_settings);
+        std::ostringstream options;
+        options << std::hexfloat;
+        if (path_trace_mode) {
+            options << "path spp=" << path_settings.samples_per_pixel << " bounces=" << path_settings.max_bounces
+                    << " seed=" << path_settings.seed << " guiding=" << path_settings.path_guiding;
+            if (path_settings.path_guiding) {
+                options << " alpha=" << path_settings.guiding_probability << " sd=" << path_settings.guiding.spatial_threshold
+                        << "," << path_settings.guiding.directional_threshold << "," << path_settings.guiding.max_directional_depth
+                        << "," << path_settings.guiding.max_spatial_depth;
+            }
+        } else {
+            options << "direct material=" << material_type << " lod=" << lod_error_pixels;
+            if (material_type == "cook-torrance") {
+                options << " roughness=" << roughness_param << " metallic=" << metallic_param << " specular=" << specular_param;
+            }
+        }
+        cache_options = options.str();
+        cache_key = RenderCache::image_key(render_scene, render_camera, image_width, image_height, cache_options);
+        
+        std::vector<Vector3> cached_pixels;
+        if (render_cache->load_image(cache_key, image_width, image_height, cached_pixels)) {
+            Image cached_image(image_width, image_height);
+            cached_image.pixels = cached_pixels;
+            save_output(cached_image, "raytracer_output" + output_extension);
+            std::cout << "Render cache hit (" << cache_key << "): raytracer_output" << output_extension
+                      << " written without rendering" << std::endl;
+            render_cache->evict();
+            render_cache->statistics().print();
+            return 0;
+        }
+        std::cout << "Render cache miss (" << cache_key << ")" << std::endl;
+    }
+    
+    // Sequence rendering: animate the camera and write one image (PNG or QOI) per frame
+    // Checkerboard mode traces half the pixels per frame and reconstructs the rest temporally
+    if (sequence_frames > 0) {
+        if (material_type == "cook-torrance" && !use_scene_file) {
+            std::cout << "ERROR: Sequence rendering requires the Scene rendering path (not the Cook-Torrance single sphere)" << std::endl;
+            return 1;
+        }
+        if (cost_attribution) {
+            std::cout << "WARNING: --cost-attribution covers single images and is ignored for sequences" << std::endl;
+        }
+        if (shadow_bundles) {
+            std::cout << "WARNING: --shadow-bundles covers single direct-lighting images and is ignored for sequences" << std::endl;
+        }
+        
+        std::cout << "\n=== Sequence Rendering ===" << std::endl;
+        std::cout << "Frames: " << sequence_frames << ", mode: " << (checkerboard_mode ? "checkerboard (temporal reconstruction)" : "full") << std::endl;
+        
+        Image frame_image(image_width, image_height);
+        if (huge_page_stats.enabled) {
+            frame_image.use_huge_pages(huge_page_stats);
+        }
+        CheckerboardRenderer checkerboard(image_width, image_height);
+        Camera frame_camera = render_camera;
+        long long total_traced_rays = 0;
+        auto sequence_start = std::chrono::high_resolution_clock::now();
+        if (time_series) time_series->start();
+        
+        for (int frame = 0; frame < sequence_frames; frame++) {
+            if (checkerboard_mode) {
+                CheckerboardRenderer::FrameStatistics frame_stats = checkerboard.render_frame(render_scene, frame_camera, frame_image.pixels);
+                total_traced_rays += frame_stats.traced_rays;
+                if (!quiet_mode) {
+                    frame_stats.print();
+                }
+            } else if (primary_rasterizer) {
+                Renderer::render_frame(render_scene, frame_camera, image_width, image_height, frame_image.pixels, *primary_rasterizer);
+                total_traced_rays += static_cast<long long>(image_width) * image_height;
+            } else {
+                Renderer::render_frame(render_scene, frame_camera, image_width, image_height, frame_image.pixels, lod_error_pixels);
+                total_traced_rays += static_cast<long long>(image_width) * image_height;
+            }
+            
+            char frame_filename[64];
+            std::snprintf(frame_filename, sizeof(frame_filename), "sequence_frame_%03d%s", frame, output_extension.c_str());
+            save_output(frame_image, frame_filename);
+            frame_camera.translate(camera_step);
+            if (time_series) time_series->report(total_traced_rays, (frame + 1) * image_height);
+            
+            if (metrics_exporter) {
+                double elapsed_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - sequence_start).count();
+                MetricsExporter::Snapshot snapshot;
+                snapshot.rays["primary"] = total_traced_rays;
+                snapshot.intersection_tests = render_scene.total_intersection_tests.load();
+                snapshot.tiles_done = (frame + 1) * image_height;
+                snapshot.tiles_total = sequence_frames * image_height;
+                snapshot.eta_seconds = elapsed_seconds / (frame + 1) * (sequence_frames - frame - 1);
+                snapshot.samples_per_pixel_done = 1;
+                snapshot.thread_utilization = {1.0};
+                if (frame + 1 < sequence_frames) {
+                    metrics_exporter->update(snapshot);
+                } else {
+                    metrics_exporter->finish(snapshot);
+                }
+            }
+        }
+        
+        auto sequence_end = std::chrono::high_resolution_clock::now();
+        finish_time_series();
+        double sequence_ms = std::chrono::duration<double, std::milli>(sequence_end - sequence_start).count();
+        long long full_rays = static_cast<long long>(image_width) * image_height * sequence_frames;
+        std::cout << "\n=== Sequence Rendering Complete ===" << std::endl;
+        std::cout << "Primary rays traced: " << total_traced_rays << " of " << full_rays
+                  << " (" << (100.0 * total_traced_rays / full_rays) << "%)" << std::endl;
+        std::cout << "Total time: " << sequence_ms << " ms (" << (sequence_ms / sequence_frames) << " ms/frame)" << std::endl;
+        if (huge_page_stats.enabled) {
+            huge_page_stats.print();
+        }
+        return 0;
+    }
+    
+    // Path tracing: progressive passes with indirect bounces, optionally guided by a learned SD-tree
+    if (path_trace_mode) {
+        if (material_type == "cook-torrance" && !use_scene_file) {
+            std::cout << "ERROR: Path tracing requires the Scene rendering path (not the Cook-Torrance single sphere)" << std::endl;
+            return 1;
+        }
+        if (shadow_bundles) {
+            std::cout << "WARNING: --shadow-bundles covers direct lighting and is ignored for path tracing" << std::endl;
+        }
+        
+        std::cout << "\n=== Path Tracing ===" << std::endl;
+        std::cout << "Samples per pixel: " << path_settings.samples_per_pixel << ", max bounces: " << path_settings.max_bounces
+                  << ", guiding: " << (path_settings.path_guiding ? "SD-tree" : "off (BRDF sampling)") << std::endl;
+        
+        Image path_image(image_width, image_height);
+        if (huge_page_stats.enabled) {
+            path_image.use_huge_pages(huge_page_stats);
+        }
+        path_settings.cost_attribution = cost_attribution;
+        PathTracer path_tracer(render_scene, path_settings);
+        MetricsExporter::Snapshot path_snapshot;
+        if (metrics_exporter || time_series) {
+            path_tracer.set_progress_callback([&](const PathTracer::Progress& progress) {
+                if (time_series) time_series->report(progress.paths + progress.bounces, progress.rows_done);
+                if (!metrics_exporter) return;
+                path_snapshot.rays["primary"] = progress.paths;
+                path_snapshot.rays["indirect"] = progress.bounces;
+                path_snapshot.intersection_tests = render_scene.total_intersection_tests.load();
+                path_snapshot.tiles_done = progress.rows_done;
+                path_snapshot.tiles_total = progress.rows_total;
+                path_snapshot.eta_seconds = progress.rows_done > 0
+                    ? progress.elapsed_seconds / progress.rows_done * (progress.rows_total - progress.rows_done) : 0.0;
+                path_snapshot.samples_per_pixel = path_settings.samples_per_pixel;
+                path_snapshot.samples_per_pixel_done = progress.passes_done;
+                path_snapshot.thread_utilization = progress.thread_utilization;
+                metrics_exporter->update(path_snapshot);
+            });
+        }
+        HugePages::TlbMissCounter path_tlb_counter;
+        path_tlb_counter.start();
+        if (time_series) time_series->start();
+        PathTracer::Statistics path_stats = path_tracer.render(render_camera, image_width, image_height, path_image.pixels);
+        finish_time_series();
+        huge_page_stats.tlb_misses = path_tlb_counter.stop();
+        huge_page_stats.rays = static_cast<long long>(image_width) * image_height * path_settings.samples_per_pixel;
+        if (metrics_exporter) {
+            metrics_exporter->finish(path_snapshot);
+        }
+        if (render_cache) {
+            render_cache->store_image(cache_key, image_width, image_height, path_image.pixels);
+            render_cache->evict();
+            render_cache->statistics().print();
+        }
+        if (!quiet_mode) {
+            CpuBudget::process_limits().print();
+            path_stats.print();
+            if (path_tracer.guiding()) {
+                path_tracer.guiding()->print_statistics();
+            }
+        }
+        if (cost_attribution) {
+            CostAttribution::print(path_stats.costs, render_scene);
+        }
+        save_output(path_image, "raytracer_output" + output_extension);
+        std::cout << "\n=== Path Tracing Complete ===" << std::endl;
+        std::cout << "Total time: " << path_stats.render_ms << " ms" << std::endl;
+        huge_page_stats.print();
+        return 0;
+    }
+    
+    // Shadow ray bundles: direct lighting with each tile's point-light shadow rays traced as one bundle
+    if (shadow_bundles) {
+        if (material_type == "cook-torrance" && !use_scene_file) {
+            std::cout << "ERROR: --shadow-bundles requires the Scene rendering path (not the Cook-Torrance single sphere)" << std::endl;
+            return 1;
+        }
+        if (lod_error_pixels > 0.0f || primary_rasterizer || cost_attribution || metrics_exporter || time_series) {
+            std::cout << "WARNING: --lod-error, --raster-primary, cost attribution and monitoring are ignored "
+                      << "with --shadow-bundles" << std::endl;
+        }
+        if (!render_scene.bvh) {
+            std::cout << "WARNING: No BVH (memory plan or empty scene) - shadow rays are traced one by one" << std::endl;
+        }
+        
+        std::cout << "\n=== Shadow Ray Bundles ===" << std::endl;
+        Image bundle_image(image_width, image_height);
+        if (huge_page_stats.enabled) {
+            bundle_image.use_huge_pages(huge_page_stats);
+        }
+        ShadowBundleTracer bundle_tracer;
+        bundle_tracer.render_frame(render_scene, render_camera, image_width, image_height, bundle_image.pixels);
+        if (render_cache) {
+            render_cache->store_image(cache_key, image_width, image_height, bundle_image.pixels);
+            render_cache->evict();
+            render_cache->statistics().print();
+        }
+        if (!quiet_mode) {
+            bundle_tracer.statistics().print();
+            if (render_scene.bvh) {
+                render_scene.bvh->print_statistics();
+            }
+        }
+        save_output(bundle_image, "raytracer_output" + output_extension);
+        std::cout << "\n=== Shadow Ray Bundles Complete ===" << std::endl;
+        std::cout << "Total time: " << bundle_tracer.statistics().render_ms << " ms" << std::endl;
+        huge_page_stats.print();
+        return 0;
+    }
+    
+    // Streamed output (memory plan): rows go straight into the encoder, no float framebuffer exists
+    if (streamed_output) {
+        std::cout << "\n=== Streamed Rendering ===" << std::endl;
+        RayCone stream_cone(0.0f, render_camera.pixel_spread_angle(image_height));
+        auto stream_start = std::chrono::high_resolution_clock::now();
+        bool saved = Image::save_streamed("raytracer_output" + output_extension, image_width, image_height, qoi_output,
+                                          qoi_settings, [&](int y, Vector3* row) {
+            for (int x = 0; x < image_width; x++) {
+                Ray ray = render_camera.generate_ray(static_cast<float>(x), static_cast<float>(y), image_width, image_height);
+                row[x] = Renderer::clamp_color(Renderer::trace_primary(render_scene, ray, render_camera.position, stream_cone,
+                                                                       lod_error_pixels));
+            }
+        });
+        auto stream_end = std::chrono::high_resolution_clock::now();
+        std::cout << "Streamed render and output: " << std::chrono::duration<double, std::milli>(stream_end - stream_start).count()
+                  << " ms" << std::endl;
+        huge_page_stats.print();
+        return saved ? 0 : 1;
+    }
+    
     // Image buffer creation using Resolution with performance monitoring
     performance_timer.start_phase(PerformanceTimer::IMAGE_OUTPUT);
     Image output_image(image_resolution);
+    if (huge_page_stats.enabled) {
+        output_image.use_huge_pages(huge_page_stats);
+    }
     performance_timer.record_memory_usage(output_image.memory_usage_bytes());
     performance_timer.end_phase(PerformanceTimer::IMAGE_OUTPUT);
     
@@ -760,10 +1449,66 @@ int main(int argc, char* argv[]) {
     int total_pixels = image_width * image_height;
     ProgressReporter progress_reporter(total_pixels, &performance_timer, quiet_mode);
     
+    // Ray cone through one pixel: footprint used for level-of-detail selection (--lod-error)
+    RayCone primary_cone(0.0f, render_camera.pixel_spread_angle(image_height));
+    
+    // Metrics snapshot of the scanline loop: single render thread, utilization = CPU time / wall time
+    std::clock_t render_cpu_start = std::clock();
+    auto make_metrics_snapshot = [&](int rows_done) {
+        MetricsExporter::Snapshot snapshot;
+        snapshot.rays["primary"] = performance_timer.get_counter(PerformanceTimer::RAY_GENERATION);
+        snapshot.intersection_tests = material_type == "cook-torrance" ? intersection_tests
+                                                                       : render_scene.total_intersection_tests.load();
+        snapshot.tiles_done = rows_done;
+        snapshot.tiles_total = image_height;
+        snapshot.eta_seconds = progress_reporter.get_estimated_remaining_seconds();
+        snapshot.samples_per_pixel_done = rows_done == image_height ? 1 : 0;
+        double wall_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - ray_generation_start).count();
+        double cpu_seconds = static_cast<double>(std::clock() - render_cpu_start) / CLOCKS_PER_SEC;
+        snapshot.thread_utilization = {wall_seconds > 0.0 ? cpu_seconds / wall_seconds : 0.0};
+        return snapshot;
+    };
+    
+    // Tile cache (direct lighting, exact traversal): tiles whose view frustum and shadow footprint
+    // contain the same spheres as a stored tile are copied instead of traced
+    bool tile_caching = render_cache && tile_cache && material_type != "cook-torrance" && lod_error_pixels == 0.0f;
+    int cached_pixels = 0;
+    bool render_interrupted = false;
+    if (tile_caching) {
+        int reused_tiles = render_cache->prepare_tiles(render_scene, render_camera, image_width, image_height,
+                                                       cache_options, output_image.pixels);
+        std::cout << "Render cache: " << reused_tiles << " of " << render_cache->statistics().tiles_total
+                  << " tiles reused" << std::endl;
+    }
+    
+    // dTLB misses of the pixel loop: compare against a --huge-pages run to see the TLB-miss change
+    HugePages::TlbMissCounter tlb_counter;
+    tlb_counter.start();
+    if (time_series) time_series->start();
+    
+    // Primary visibility up front: the pixel loop below then only looks up each pixel's sphere
+    bool rasterized_primary = primary_rasterizer && material_type != "cook-torrance";
+    if (rasterized_primary) {
+        primary_rasterizer->rasterize(render_scene, render_camera, image_width, image_height);
+        if (!quiet_mode) {
+            CpuBudget::process_limits().print();
+            primary_rasterizer->statistics().print();
+        }
+    }
+    
+    // Cost attribution of the scene shading below (this loop is the only thread)
+    CostAttribution::Counters shading_costs(render_scene);
+    CostAttribution::Counters* shading_attribution = cost_attribution ? &shading_costs : nullptr;
+    
     // Multi-ray pixel sampling: one ray per pixel with comprehensive progress tracking
     for (int y = 0; y < image_height; y++) {
         
         for (int x = 0; x < image_width; x++) {
+            if (tile_caching && render_cache->tile_reused(x, y)) {
+                cached_pixels++;
+                continue;
+            }
+            
             // Phase 1: Ray Generation with precise timing
             performance_timer.start_phase(PerformanceTimer::RAY_GENERATION);
             Ray pixel_ray = render_camera.generate_ray(
@@ -853,7 +1598,11 @@ int main(int argc, char* argv[]) {
             } else {
                 // Lambert rendering path (use Scene system)
                 performance_timer.start_phase(PerformanceTimer::INTERSECTION_TESTING);
-                Scene::Intersection intersection = render_scene.intersect(pixel_ray, !quiet_mode);
+                Scene::Intersection intersection = rasterized_primary
+                    ? primary_rasterizer->intersection(render_scene, pixel_ray, x, y)
+                    : lod_error_pixels > 0.0f
+                    ? render_scene.intersect(pixel_ray, primary_cone, lod_error_pixels)
+                    : render_scene.intersect(pixel_ray, !quiet_mode);
                 performance_timer.end_phase(PerformanceTimer::INTERSECTION_TESTING);
                 performance_timer.increment_counter(PerformanceTimer::INTERSECTION_TESTING);
                 intersection_tests++;
@@ -862,6 +1611,9 @@ int main(int argc, char* argv[]) {
                     // Phase 3: Lambert Shading Calculation
                     performance_timer.start_phase(PerformanceTimer::SHADING_CALCULATION);
                     shading_calculations++;
+                    if (tile_caching) {
+                        render_cache->record_hit(x, y, intersection.point);
+                    }
                     
                     // Multi-light accumulation (AC2 - Story 3.2)
                     pixel_color = Vector3(0, 0, 0);  // Initialize accumulator
@@ -881,23 +1633,11 @@ int main(int argc, char* argv[]) {
                             incident_irradiance, !quiet_mode
                         );
                     } else {
-                        // Multi-light accumulation from scene
-                        for (const auto& light : render_scene.lights) {
-                            Vector3 light_direction;
-                            float light_distance;
-                            Vector3 light_contribution = light->illuminate(surface_point, light_direction, light_distance);
-                            
-                            // Shadow ray testing (AC3)
-                            if (!light->is_occluded(surface_point, light_direction, light_distance, render_scene)) {
-                                // BRDF evaluation for this light
-                                Vector3 brdf_contribution = intersection.material->scatter_light(
-                                    light_direction, view_direction, intersection.normal, 
-                                    light_contribution, false  // Disable verbose per-light to avoid spam
-                                );
-                                pixel_color += brdf_contribution;
-                            }
-                        }
-                        
+                        // Multi-light accumulation from scene with shadow ray testing (AC3)
+                        // Shared with tools and tests through Renderer so every path uses the same mathematics
+                        pixel_color = Renderer::shade_direct_lighting(render_scene, intersection, camera_position,
+                                                                      shading_attribution);
+
                         // Educational output for multi-light (if enabled and first few pixels)
                         if (!quiet_mode && (x + y * image_width) < 5) {
                             std::cout << "\n=== Multi-Light Accumulation (Pixel " << (x + y * image_width) << ") ===" << std::endl;
@@ -922,16 +1662,36 @@ int main(int argc, char* argv[]) {
         int completed_pixels = (y + 1) * image_width;
         size_t current_memory = output_image.memory_usage_bytes() + render_scene.calculate_scene_memory_usage();
         progress_reporter.update_progress(completed_pixels, current_memory);
+        if (metrics_exporter) {
+            metrics_exporter->update(make_metrics_snapshot(y + 1));
+        }
+        if (time_series) {
+            time_series->report(performance_timer.get_counter(PerformanceTimer::RAY_GENERATION), y + 1);
+        }
         
         // Check for interrupt capability (placeholder for user cancellation)
         if (progress_reporter.should_interrupt()) {
             std::cout << "\nRendering interrupted by user request." << std::endl;
+            render_interrupted = true;
             break;
         }
     }
     
     // End comprehensive timing
     performance_timer.end_phase(PerformanceTimer::TOTAL_RENDER);
+    huge_page_stats.tlb_misses = tlb_counter.stop();
+    finish_time_series();
+    if (metrics_exporter) {
+        metrics_exporter->finish(make_metrics_snapshot(image_height));
+        std::cout << "Metrics written to " << metrics_exporter->output_path() << " (" << metrics_exporter->writes() << " updates)" << std::endl;
+    }
+    if (render_cache && !render_interrupted) {
+        if (tile_caching) {
+            render_cache->store_tiles(render_scene, output_image.pixels);
+        }
+        render_cache->store_image(cache_key, image_width, image_height, output_image.pixels);
+        render_cache->evict();
+    }
     
     auto ray_generation_end = std::chrono::high_resolution_clock::now();
     auto total_end_time = std::chrono::high_resolution_clock::now();
@@ -949,7 +1709,10 @@ int main(int argc, char* argv[]) {
     std::cout << "Ray Generation Statistics:" << std::endl;
     std::cout << "  Total rays generated: " << rays_generated << std::endl;
     std::cout << "  Expected rays (width × height): " << (image_width * image_height) << std::endl;
-    std::cout << "  Ray generation accuracy: " << (rays_generated == (image_width * image_height) ? "PERFECT" : "ERROR") << std::endl;
+    if (cached_pixels > 0) {
+        std::cout << "  Pixels copied from render cache: " << cached_pixels << std::endl;
+    }
+    std::cout << "  Ray generation accuracy: " << (rays_generated + cached_pixels == (image_width * image_height) ? "PERFECT" : "ERROR") << std::endl;
     
     std::cout << "Intersection Testing Statistics:" << std::endl;
     std::cout << "  Total intersection tests: " << intersection_tests << std::endl;
@@ -1032,6 +1795,21 @@ int main(int argc, char* argv[]) {
         std::cout << "=== Scene statistics complete ===" << std::endl;
     } else {
         render_scene.print_scene_statistics();
+        if (render_scene.bvh) {
+            render_scene.bvh->print_statistics();
+        }
+        if (cost_attribution) {
+            if (material_type == "cook-torrance") {
+                std::cout << "\nCost attribution: the Cook-Torrance render path shades outside the Scene system" << std::endl;
+            } else {
+                CostAttribution::print(shading_costs, render_scene);
+            }
+        }
+    }
+    huge_page_stats.rays = rays_generated;
+    huge_page_stats.print();
+    if (render_cache) {
+        render_cache->statistics().print();
     }
     
     std::cout << "\n=== Image Generation and Pixel Sampling Complete ===" << std::endl;
@@ -1041,8 +1819,8 @@ int main(int argc, char* argv[]) {
     // PNG Output Implementation (AC 4) with performance monitoring
     std::cout << "\n=== PNG Output Generation (AC 4) ===" << std::endl;
     performance_timer.start_phase(PerformanceTimer::IMAGE_OUTPUT);
-    std::string png_filename = "raytracer_output.png";
-    bool png_success = output_image.save_to_png(png_filename, true);  // With gamma correction
+    std::string png_filename = "raytracer_output" + output_extension;
+    bool png_success = save_output(output_image, png_filename);  // With gamma correction
     performance_timer.end_phase(PerformanceTimer::IMAGE_OUTPUT);
     performance_timer.increment_counter(PerformanceTimer::IMAGE_OUTPUT);
     
@@ -489,6 +489,37 @@ public:
         return outgoing_radiance;
     }
 
+    // GGX importance sampling of the halfway vector, reflected about h to obtain wi
+    // Half-vector density: p(h) = D(h) * (n·h); change of variables to wi: p(wi) = p(h) / (4 * |wo·h|)
+    // Inversion of the GGX CDF: tan²(θh) = α² * u1 / (1 - u1), φh = 2π * u2
+    Vector3 sample_direction(const Vector3& wo, const Vector3& normal, float u1, float u2, float& pdf) const override {
+        float alpha = alpha_from_roughness(roughness);
+        float tan2_theta = alpha * alpha * u1 / std::max(1e-7f, 1.0f - u1);
+        float cos_theta = 1.0f / std::sqrt(1.0f + tan2_theta);
+        float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+        float phi = 2.0f * static_cast<float>(M_PI) * u2;
+
+        Vector3 tangent, bitangent;
+        build_orthonormal_basis(normal, tangent, bitangent);
+        Vector3 halfway = tangent * (sin_theta * std::cos(phi)) + bitangent * (sin_theta * std::sin(phi)) +
+                          normal * cos_theta;
+
+        // Mirror reflection of wo about the sampled microfacet normal
+        Vector3 wi = halfway * (2.0f * wo.dot(halfway)) - wo;
+        pdf = sample_pdf(wi, wo, normal);
+        return wi;
+    }
+
+    float sample_pdf(const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
+        if (normal.dot(wi) <= 0.0f || normal.dot(wo) <= 0.0f) return 0.0f;
+        Vector3 halfway = (wi + wo).normalize();
+        float ndoth = std::max(0.0f, normal.dot(halfway));
+        float vdoth = std::abs(wo.dot(halfway));
+        if (vdoth <= 1e-7f) return 0.0f;
+        float D = CookTorrance::NormalDistribution::ggx_distribution(ndoth, alpha_from_roughness(roughness));
+        return D * ndoth / (4.0f * vdoth);
+    }
+
     // Cook-Torrance-specific educational BRDF explanation override
     // Provides comprehensive mathematical breakdown of microfacet theory
     void explain_brdf_evaluation(const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
@@ -607,6 +638,8 @@ public:
         std::cout << "=== COMPONENT BREAKDOWN COMPLETE ===" << std::endl;
     }
 
+    std::unique_ptr<Material> clone() const override { return std::make_unique<CookTorranceMaterial>(*this); }
+
     // Cook-Torrance-specific parameter validation implementation
     // Validates roughness, metallic, specular, and base color within physically valid ranges
     bool validate_parameters() const override {
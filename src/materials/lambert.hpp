@@ -108,6 +108,8 @@ public:
         return brdf_value;
     }
 
+    std::unique_ptr<Material> clone() const override { return std::make_unique<LambertMaterial>(*this); }
+
     // Lambert-specific parameter validation implementation
     // Validates that albedo values are within physically valid [0,1] range for energy conservation
     bool validate_parameters() const override {
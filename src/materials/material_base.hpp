@@ -2,13 +2,15 @@
 #include "../core/vector3.hpp"
 #include <iostream>
 #include <algorithm>
+#include <memory>
 
 // Material Type enumeration for polymorphic material system
-// Supports current Lambert and Cook-Torrance materials with extensibility for future OpenPBR
+// Supports Lambert, Cook-Torrance, the layered OpenPBR-style material and compiled node graphs
 enum class MaterialType {
     Lambert,        // Perfectly diffuse material following Lambert's cosine law
     CookTorrance,   // Microfacet material using Cook-Torrance BRDF with D, G, F terms
-    OpenPBR         // Future: Complete OpenPBR material model (Epic 4)
+    OpenPBR,        // Layered OpenPBR-style model: coat, specular, diffuse and metal lobes
+    Graph           // Node graph compiled to a register program (MaterialX-style networks)
 };
 
 // Abstract Material base class for polymorphic material evaluation
@@ -37,7 +39,7 @@ public:
     // Each material type provides its own mathematical model:
     // - Lambert: f_r = ρ/π (constant diffuse reflection)
     // - Cook-Torrance: f_r = (D×G×F)/(4×cos(θl)×cos(θv)) (microfacet theory)
-    // - Future OpenPBR: Advanced layered material model
+    // - OpenPBR: weighted sum of coat, specular, diffuse and metal lobes (albedo-scaled layering)
     // Parameters:
     //   wi: incident light direction (pointing toward surface, normalized)
     //   wo: outgoing view direction (pointing toward camera, normalized)
@@ -57,6 +59,9 @@ public:
     // Prevents numerical instability and non-physical behavior
     // Educational output shows any clamping performed for learning purposes
     virtual void clamp_to_valid_ranges() = 0;
+
+    // Independent copy of the material (SceneLoader merges one parsed include into many scenes)
+    virtual std::unique_ptr<Material> clone() const = 0;
     
     // Virtual educational debugging method - optionally overridden by concrete materials
     // Provides comprehensive mathematical breakdown of BRDF evaluation process
@@ -119,7 +124,75 @@ public:
         
         return outgoing_radiance;
     }
-    
+
+    // Importance-sample an incident direction for indirect lighting (path tracing bounces)
+    // Default implementation: cosine-weighted hemisphere sampling, pdf(wi) = cos(θ)/π
+    // Exact importance sampling for Lambert; a safe fallback for any other BRDF
+    // Parameters:
+    //   wo: outgoing view direction (pointing away from surface, normalized)
+    //   normal: surface normal on the side of wo (normalized)
+    //   u1, u2: independent uniform random numbers in [0, 1)
+    //   pdf: output solid-angle probability density of the returned direction (0 = invalid sample)
+    virtual Vector3 sample_direction(const Vector3& wo, const Vector3& normal, float u1, float u2, float& pdf) const {
+        // Malley's method: uniform disk sample projected up onto the hemisphere
+        Vector3 tangent, bitangent;
+        build_orthonormal_basis(normal, tangent, bitangent);
+        float radius = std::sqrt(u1);
+        float phi = 2.0f * static_cast<float>(M_PI) * u2;
+        Vector3 wi = tangent * (radius * std::cos(phi)) + bitangent * (radius * std::sin(phi)) +
+                     normal * std::sqrt(std::max(0.0f, 1.0f - u1));
+        pdf = Material::sample_pdf(wi, wo, normal);
+        return wi;
+    }
+
+    // Solid-angle density with which sample_direction() generates wi
+    // Needed to combine BRDF sampling with other strategies (e.g. path guiding)
+    virtual float sample_pdf(const Vector3& wi, const Vector3& wo, const Vector3& normal) const {
+        (void)wo;
+        return std::max(0.0f, normal.dot(wi)) / static_cast<float>(M_PI);
+    }
+
+    // Stochastic lobe selection for layered materials
+    // A shading event picks lobe k with probability p_k and uses f_k / p_k in place of the full BRDF:
+    //   E[f_k / p_k] = Σ_k p_k * f_k / p_k = Σ_k f_k = f_r
+    // so every light and the bounce direction cost one lobe evaluation instead of all of them.
+    // Single-lobe materials (the defaults below) report one lobe that is the full BRDF.
+    virtual int lobe_count() const { return 1; }
+
+    // Choose a lobe for view direction wo with uniform random number u; probability receives p_k
+    virtual int select_lobe(const Vector3& wo, const Vector3& normal, float u, float& probability) const {
+        (void)wo; (void)normal; (void)u;
+        probability = 1.0f;
+        return 0;
+    }
+
+    // BRDF of one lobe (already including its layering weight), not divided by p_k
+    virtual Vector3 evaluate_lobe(int lobe, const Vector3& wi, const Vector3& wo, const Vector3& normal) const {
+        (void)lobe;
+        return evaluate_brdf(wi, wo, normal, false);
+    }
+
+    // Importance sampling restricted to one lobe, and the matching solid-angle density
+    virtual Vector3 sample_lobe(int lobe, const Vector3& wo, const Vector3& normal, float u1, float u2, float& pdf) const {
+        (void)lobe;
+        return sample_direction(wo, normal, u1, u2, pdf);
+    }
+
+    virtual float lobe_pdf(int lobe, const Vector3& wi, const Vector3& wo, const Vector3& normal) const {
+        (void)lobe;
+        return sample_pdf(wi, wo, normal);
+    }
+
+    // Build tangent and bitangent completing an orthonormal basis with normal
+    // Branchless construction (Duff et al. 2017), stable for all unit normals
+    static void build_orthonormal_basis(const Vector3& normal, Vector3& tangent, Vector3& bitangent) {
+        float sign = std::copysign(1.0f, normal.z);
+        float a = -1.0f / (sign + normal.z);
+        float b = normal.x * normal.y * a;
+        tangent = Vector3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+        bitangent = Vector3(b, sign + normal.y * normal.y * a, -normal.y);
+    }
+
     // Helper method to get human-readable material type name for educational output
     // Provides consistent naming across different material implementations
     const char* material_type_name() const {
@@ -127,6 +200,7 @@ public:
             case MaterialType::Lambert: return "Lambert (Diffuse)";
             case MaterialType::CookTorrance: return "Cook-Torrance (Microfacet)";
             case MaterialType::OpenPBR: return "OpenPBR (Advanced PBR)";
+            case MaterialType::Graph: return "Material Graph (Compiled)";
             default: return "Unknown Material Type";
         }
     }
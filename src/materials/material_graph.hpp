@@ -0,0 +1,642 @@
+#pragma once
+#include "../core/vector3.hpp"
+#include "material_base.hpp"
+#include "cook_torrance.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Material node graphs compiled to flat register programs
+// Educational focus: the compiler pipeline behind MaterialX-style shading networks
+//
+// A graph is a set of named nodes (constants, arithmetic, BRDF building blocks) wired by name,
+// plus the built-in shading inputs N (normal), V (view, wo), L (light, wi) and H (halfway).
+// Walking the graph per shading point costs a name lookup and a dispatch per node visit, and
+// shared subexpressions are re-evaluated for every consumer. MaterialGraph::compile() turns it
+// into a MaterialProgram once, when the scene is committed:
+//   1. Topological sort from the output node (depth-first, rejects cycles); unreachable nodes are dropped
+//   2. Constant folding: a node whose inputs are all uniform is evaluated at compile time
+//      (e.g. α = roughness², F0 = mix(0.04, base_color, metallic) never reach the shading loop)
+//   3. Register allocation: each remaining node writes one register, freed after its last use
+//      (linear scan), so a program needs far fewer registers than it has nodes
+// Every value is a Vector3; scalar nodes replicate their result in all three channels.
+//
+// Batch evaluation runs each instruction over a chunk of shading points before moving to the
+// next one: dispatch is paid once per instruction per chunk, and the inner loops are plain
+// arrays. Constant operands use stride 0, so they are never broadcast into registers.
+namespace MaterialGraphOps {
+    enum class Op : uint8_t {
+        Constant,
+        Normal, View, Light, Halfway,          // Built-in shading inputs N, V, L, H
+        Add, Subtract, Multiply, Divide, Mix,  // Component-wise; mix(a, b, t) = a (1 - t) + b t
+        Dot, Max, Min, Power,
+        GGX,                                   // ggx(n·h, α): GGX normal distribution D
+        SmithG,                                // smith_g(n·l, n·v, α): Smith masking-shadowing G
+        Schlick                                // schlick(cos θ, F0): Schlick Fresnel
+    };
+
+    struct OpInfo {
+        const char* name;
+        Op op;
+        int arity;
+    };
+
+    inline const std::array<OpInfo, 17>& op_table() {
+        static const std::array<OpInfo, 17> table = {{
+            {"constant", Op::Constant, 0}, {"N", Op::Normal, 0}, {"V", Op::View, 0}, {"L", Op::Light, 0},
+            {"H", Op::Halfway, 0}, {"add", Op::Add, 2}, {"subtract", Op::Subtract, 2},
+            {"multiply", Op::Multiply, 2}, {"divide", Op::Divide, 2}, {"mix", Op::Mix, 3},
+            {"dot", Op::Dot, 2}, {"max", Op::Max, 2}, {"min", Op::Min, 2}, {"power", Op::Power, 2},
+            {"ggx", Op::GGX, 2}, {"smith_g", Op::SmithG, 3}, {"schlick", Op::Schlick, 2},
+        }};
+        return table;
+    }
+
+    inline const OpInfo* find_op(const std::string& name) {
+        for (const OpInfo& info : op_table()) {
+            if (name == info.name) return &info;
+        }
+        return nullptr;
+    }
+
+    inline const char* op_name(Op op) {
+        for (const OpInfo& info : op_table()) {
+            if (info.op == op) return info.name;
+        }
+        return "?";
+    }
+
+    inline bool is_input(Op op) {
+        return op == Op::Normal || op == Op::View || op == Op::Light || op == Op::Halfway;
+    }
+
+    // One node evaluated on already computed operands; shared by folding, interpretation and execution
+    inline Vector3 apply(Op op, const Vector3& a, const Vector3& b, const Vector3& c) {
+        auto safe_divide = [](float x, float y) { return y != 0.0f ? x / y : 0.0f; };
+        switch (op) {
+            case Op::Add: return a + b;
+            case Op::Subtract: return a - b;
+            case Op::Multiply: return Vector3(a.x * b.x, a.y * b.y, a.z * b.z);
+            case Op::Divide: return Vector3(safe_divide(a.x, b.x), safe_divide(a.y, b.y), safe_divide(a.z, b.z));
+            case Op::Mix: return Vector3(a.x * (1.0f - c.x) + b.x * c.x, a.y * (1.0f - c.y) + b.y * c.y,
+                                         a.z * (1.0f - c.z) + b.z * c.z);
+            case Op::Dot: { float d = a.dot(b); return Vector3(d, d, d); }
+            case Op::Max: return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+            case Op::Min: return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+            case Op::Power: return Vector3(std::pow(std::max(0.0f, a.x), b.x), std::pow(std::max(0.0f, a.y), b.y),
+                                           std::pow(std::max(0.0f, a.z), b.z));
+            case Op::GGX: {
+                float d = CookTorrance::NormalDistribution::ggx_distribution(a.x, b.x);
+                return Vector3(d, d, d);
+            }
+            case Op::SmithG: {
+                float g = CookTorrance::GeometryFunction::smith_g(a.x, b.x, c.x);
+                return Vector3(g, g, g);
+            }
+            case Op::Schlick: return CookTorrance::FresnelFunction::schlick_fresnel(a.x, b);
+            default: return Vector3(0, 0, 0);
+        }
+    }
+}
+
+// Inputs of one shading event (same conventions as Material::evaluate_brdf)
+struct ShadingPoint {
+    Vector3 wi;       // Light direction, L
+    Vector3 wo;       // View direction, V
+    Vector3 normal;   // N
+};
+
+// Compiled program: flat instruction stream over a small register file
+class MaterialProgram {
+public:
+    using Op = MaterialGraphOps::Op;
+
+    static constexpr int max_registers = 32;
+    static constexpr int batch_chunk = 32;           // Shading points per register-file chunk
+    static constexpr uint16_t constant_bit = 0x8000; // Operand refers to the constant pool
+
+    struct Instruction {
+        Op op;
+        uint16_t destination;
+        uint16_t operands[3];
+    };
+
+    struct Statistics {
+        int graph_nodes = 0;       // Nodes declared in the graph (including inline constants)
+        int reachable_nodes = 0;   // Nodes the output depends on
+        int folded_nodes = 0;      // Non-constant nodes evaluated at compile time
+        int instructions = 0;
+        int registers = 0;
+        int constants = 0;
+
+        void print() const {
+            std::cout << "Material graph: " << graph_nodes << " nodes, " << reachable_nodes << " reachable, "
+                      << folded_nodes << " folded -> " << instructions << " instructions, " << registers
+                      << " registers, " << constants << " constants" << std::endl;
+        }
+    };
+
+    std::vector<Instruction> instructions;
+    std::vector<Vector3> constants;
+    uint16_t output = 0;
+    int register_count = 0;
+    Statistics statistics;
+
+    // Evaluate for one shading point (registers live on the stack, no allocation)
+    Vector3 evaluate(const ShadingPoint& point) const {
+        Vector3 registers[max_registers];
+        for (const Instruction& instruction : instructions) {
+            Vector3 value;
+            switch (instruction.op) {
+                case Op::Normal: value = point.normal; break;
+                case Op::View: value = point.wo; break;
+                case Op::Light: value = point.wi; break;
+                case Op::Halfway: value = (point.wi + point.wo).normalize(); break;
+                default:
+                    value = MaterialGraphOps::apply(instruction.op, fetch(registers, instruction.operands[0]),
+                                                    fetch(registers, instruction.operands[1]),
+                                                    fetch(registers, instruction.operands[2]));
+                    break;
+            }
+            registers[instruction.destination] = value;
+        }
+        return fetch(registers, output);
+    }
+
+    // Evaluate count shading points into results, one instruction at a time per chunk
+    void evaluate_batch(const ShadingPoint* points, size_t count, Vector3* results) const {
+        Vector3 registers[max_registers][batch_chunk];
+        for (size_t start = 0; start < count; start += batch_chunk) {
+            int n = static_cast<int>(std::min<size_t>(batch_chunk, count - start));
+            const ShadingPoint* chunk = points + start;
+            for (const Instruction& instruction : instructions) {
+                Vector3* destination = registers[instruction.destination];
+                switch (instruction.op) {
+                    case Op::Normal: for (int i = 0; i < n; i++) destination[i] = chunk[i].normal; break;
+                    case Op::View: for (int i = 0; i < n; i++) destination[i] = chunk[i].wo; break;
+                    case Op::Light: for (int i = 0; i < n; i++) destination[i] = chunk[i].wi; break;
+                    case Op::Halfway:
+                        for (int i = 0; i < n; i++) destination[i] = (chunk[i].wi + chunk[i].wo).normalize();
+                        break;
+                    default: {
+                        int sa, sb, sc;
+                        const Vector3* a = operand_array(registers, instruction.operands[0], sa);
+                        const Vector3* b = operand_array(registers, instruction.operands[1], sb);
+                        const Vector3* c = operand_array(registers, instruction.operands[2], sc);
+                        Op op = instruction.op;
+                        for (int i = 0; i < n; i++) {
+                            destination[i] = MaterialGraphOps::apply(op, a[i * sa], b[i * sb], c[i * sc]);
+                        }
+                        break;
+                    }
+                }
+            }
+            int so;
+            const Vector3* out = operand_array(registers, output, so);
+            for (int i = 0; i < n; i++) results[start + i] = out[i * so];
+        }
+    }
+
+    // Human-readable listing, e.g. "r2 = ggx r0 c1"
+    std::string disassemble() const {
+        std::ostringstream out;
+        for (const Instruction& instruction : instructions) {
+            out << "r" << instruction.destination << " = " << MaterialGraphOps::op_name(instruction.op);
+            if (!MaterialGraphOps::is_input(instruction.op)) {
+                for (uint16_t operand : instruction.operands) {
+                    if (operand != unused) out << " " << operand_name(operand);
+                }
+            }
+            out << "\n";
+        }
+        out << "return " << operand_name(output) << "\n";
+        for (size_t i = 0; i < constants.size(); i++) {
+            out << "c" << i << " = (" << constants[i].x << ", " << constants[i].y << ", " << constants[i].z << ")\n";
+        }
+        return out.str();
+    }
+
+    // Exact text form (hexfloat constants) for hashing, e.g. by RenderCache
+    std::string canonical() const {
+        std::ostringstream out;
+        out << std::hexfloat << "program " << instructions.size() << " " << output;
+        for (const Instruction& instruction : instructions) {
+            out << " " << static_cast<int>(instruction.op) << ":" << instruction.destination << ":"
+                << instruction.operands[0] << ":" << instruction.operands[1] << ":" << instruction.operands[2];
+        }
+        for (const Vector3& c : constants) out << " " << c.x << "," << c.y << "," << c.z;
+        return out.str();
+    }
+
+    static constexpr uint16_t unused = 0xFFFF;
+
+private:
+    Vector3 fetch(const Vector3* registers, uint16_t operand) const {
+        if (operand == unused) return Vector3(0, 0, 0);
+        if (operand & constant_bit) return constants[operand & ~constant_bit];
+        return registers[operand];
+    }
+
+    const Vector3* operand_array(const Vector3 (*registers)[batch_chunk], uint16_t operand, int& stride) const {
+        static const Vector3 zero(0, 0, 0);
+        if (operand == unused) { stride = 0; return &zero; }
+        if (operand & constant_bit) { stride = 0; return &constants[operand & ~constant_bit]; }
+        stride = 1;
+        return registers[operand];
+    }
+
+    static std::string operand_name(uint16_t operand) {
+        std::string name(1, (operand & constant_bit) ? 'c' : 'r');
+        name += std::to_string((operand & constant_bit) ? (operand & ~constant_bit) : operand);
+        return name;
+    }
+};
+
+// Graph under construction: nodes added by name (from code or scene files), compiled once
+class MaterialGraph {
+public:
+    using Op = MaterialGraphOps::Op;
+
+    struct Node {
+        std::string name;
+        Op op;
+        std::vector<std::string> inputs;   // Node names, built-ins N/V/L/H or numeric literals
+        Vector3 value;                     // Constant nodes only
+    };
+
+    // Add a node; inputs that parse as numbers become anonymous constants
+    // Returns false (with an ERROR message) for unknown operations, wrong arity or duplicate names
+    bool add_node(const std::string& name, const std::string& operation, const std::vector<std::string>& inputs) {
+        const MaterialGraphOps::OpInfo* info = MaterialGraphOps::find_op(operation);
+        if (!info || MaterialGraphOps::is_input(info->op)) {
+            std::cout << "ERROR: Unknown material graph operation '" << operation << "'" << std::endl;
+            return false;
+        }
+        if (find(name) >= 0 || is_builtin(name)) {
+            std::cout << "ERROR: Material graph node '" << name << "' defined twice" << std::endl;
+            return false;
+        }
+        if (info->op == Op::Constant) {
+            std::vector<float> values;
+            for (const std::string& input : inputs) {
+                float v;
+                if (!parse_number(input, v)) {
+                    std::cout << "ERROR: Constant '" << name << "' expects 1 or 3 numbers" << std::endl;
+                    return false;
+                }
+                values.push_back(v);
+            }
+            if (values.size() != 1 && values.size() != 3) {
+                std::cout << "ERROR: Constant '" << name << "' expects 1 or 3 numbers" << std::endl;
+                return false;
+            }
+            nodes.push_back({name, Op::Constant, {}, values.size() == 1 ? Vector3(values[0], values[0], values[0])
+                                                                          : Vector3(values[0], values[1], values[2])});
+            return true;
+        }
+        if (static_cast<int>(inputs.size()) != info->arity) {
+            std::cout << "ERROR: Material graph node '" << name << "' (" << operation << ") expects " << info->arity
+                      << " inputs, got " << inputs.size() << std::endl;
+            return false;
+        }
+        Node node{name, info->op, {}, Vector3(0, 0, 0)};
+        for (const std::string& input : inputs) {
+            float v;
+            if (parse_number(input, v)) {
+                std::string literal(1, '#');
+                literal += std::to_string(nodes.size());
+                literal += '_';
+                literal += input;
+                nodes.push_back({literal, Op::Constant, {}, Vector3(v, v, v)});
+                node.inputs.push_back(literal);
+            } else {
+                node.inputs.push_back(input);
+            }
+        }
+        nodes.push_back(node);
+        return true;
+    }
+
+    bool add_constant(const std::string& name, const Vector3& value) {
+        if (find(name) >= 0 || is_builtin(name)) {
+            std::cout << "ERROR: Material graph node '" << name << "' defined twice" << std::endl;
+            return false;
+        }
+        nodes.push_back({name, Op::Constant, {}, value});
+        return true;
+    }
+
+    // Graph form of CookTorranceMaterial(base, roughness, metallic, specular): same operations in the
+    // same order, so the compiled program reproduces evaluate_brdf; α and F0 fold to constants
+    static MaterialGraph cook_torrance(const Vector3& base, float roughness, float metallic, float specular) {
+        MaterialGraph graph;
+        graph.add_constant("base", base);
+        graph.add_constant("roughness", Vector3(roughness, roughness, roughness));
+        graph.add_constant("metallic", Vector3(metallic, metallic, metallic));
+        graph.add_constant("specular", Vector3(specular, specular, specular));
+        graph.add_node("alpha", "multiply", {"roughness", "roughness"});
+        graph.add_node("f0", "mix", {"specular", "base", "metallic"});
+        graph.add_node("ndotl", "dot", {"N", "L"});
+        graph.add_node("ndotv", "dot", {"N", "V"});
+        graph.add_node("ndoth", "dot", {"N", "H"});
+        graph.add_node("vdoth", "dot", {"V", "H"});
+        graph.add_node("d", "ggx", {"ndoth", "alpha"});
+        graph.add_node("g", "smith_g", {"ndotl", "ndotv", "alpha"});
+        graph.add_node("f", "schlick", {"vdoth", "f0"});
+        graph.add_node("dg", "multiply", {"d", "g"});
+        graph.add_node("dgf", "multiply", {"dg", "f"});
+        graph.add_node("denominator_l", "multiply", {"4", "ndotl"});
+        graph.add_node("denominator", "multiply", {"denominator_l", "ndotv"});
+        graph.add_node("brdf", "divide", {"dgf", "denominator"});
+        graph.set_output("brdf");
+        return graph;
+    }
+
+    void set_output(const std::string& name) { output_name = name; }
+    const std::string& output() const { return output_name; }
+    size_t node_count() const { return nodes.size(); }
+
+    // Compile to a register program; returns false (with an ERROR message) on undefined inputs,
+    // cycles or programs exceeding MaterialProgram::max_registers
+    bool compile(MaterialProgram& program) const {
+        program = MaterialProgram();
+        program.statistics.graph_nodes = static_cast<int>(nodes.size());
+
+        // Resolve names to indices; built-ins become extra pseudo-nodes after the declared ones
+        std::vector<Node> all = nodes;
+        for (const char* builtin : {"N", "V", "L", "H"}) {
+            all.push_back({builtin, MaterialGraphOps::find_op(builtin)->op, {}, Vector3(0, 0, 0)});
+        }
+        std::map<std::string, int> index;
+        for (size_t i = 0; i < all.size(); i++) index[all[i].name] = static_cast<int>(i);
+        auto output_it = index.find(output_name);
+        if (output_it == index.end()) {
+            std::cout << "ERROR: Material graph output '" << output_name << "' is not a node" << std::endl;
+            return false;
+        }
+        std::vector<std::vector<int>> arguments(all.size());
+        for (size_t i = 0; i < all.size(); i++) {
+            for (const std::string& input : all[i].inputs) {
+                auto it = index.find(input);
+                if (it == index.end()) {
+                    std::cout << "ERROR: Material graph node '" << all[i].name << "' reads undefined input '"
+                              << input << "'" << std::endl;
+                    return false;
+                }
+                arguments[i].push_back(it->second);
+            }
+        }
+
+        // 1. Depth-first topological order of the nodes the output depends on
+        std::vector<int> order;
+        std::vector<int> state(all.size(), 0);   // 0 = unvisited, 1 = on the stack, 2 = done
+        std::vector<std::pair<int, size_t>> stack = {{output_it->second, 0}};
+        state[output_it->second] = 1;
+        while (!stack.empty()) {
+            auto& [node, next] = stack.back();
+            if (next < arguments[node].size()) {
+                int child = arguments[node][next++];
+                if (state[child] == 1) {
+                    std::cout << "ERROR: Material graph has a cycle through node '" << all[child].name << "'" << std::endl;
+                    return false;
+                }
+                if (state[child] == 0) {
+                    state[child] = 1;
+                    stack.push_back({child, 0});
+                }
+            } else {
+                state[node] = 2;
+                order.push_back(node);
+                stack.pop_back();
+            }
+        }
+        for (int node : order) {
+            if (!MaterialGraphOps::is_input(all[node].op)) program.statistics.reachable_nodes++;
+        }
+
+        // 2. Constant folding in topological order: uniform inputs in, uniform value out
+        std::vector<bool> uniform(all.size(), false);
+        std::vector<Vector3> value(all.size(), Vector3(0, 0, 0));
+        for (int node : order) {
+            Op op = all[node].op;
+            if (op == Op::Constant) {
+                uniform[node] = true;
+                value[node] = all[node].value;
+                continue;
+            }
+            if (MaterialGraphOps::is_input(op)) continue;
+            bool all_uniform = true;
+            for (int argument : arguments[node]) all_uniform = all_uniform && uniform[argument];
+            if (!all_uniform) continue;
+            Vector3 operands[3] = {Vector3(0, 0, 0), Vector3(0, 0, 0), Vector3(0, 0, 0)};
+            for (size_t k = 0; k < arguments[node].size(); k++) operands[k] = value[arguments[node][k]];
+            value[node] = MaterialGraphOps::apply(op, operands[0], operands[1], operands[2]);
+            uniform[node] = true;
+            program.statistics.folded_nodes++;
+        }
+
+        // 3. Code generation with linear-scan register allocation
+        std::vector<int> position(all.size(), -1);
+        std::vector<int> last_use(all.size(), -1);
+        int emitted = 0;
+        for (int node : order) {
+            if (uniform[node]) continue;
+            position[node] = emitted;
+            for (int argument : arguments[node]) last_use[argument] = emitted;
+            emitted++;
+        }
+        last_use[output_it->second] = emitted;   // Output stays live to the end
+
+        std::vector<uint16_t> operand_of(all.size(), MaterialProgram::unused);
+        std::map<int, uint16_t> constant_slot;   // Deduplicate constants by node
+        auto constant_operand = [&](int node) {
+            auto it = constant_slot.find(node);
+            if (it != constant_slot.end()) return it->second;
+            for (size_t i = 0; i < program.constants.size(); i++) {
+                const Vector3& c = program.constants[i];
+                if (c.x == value[node].x && c.y == value[node].y && c.z == value[node].z) {
+                    return constant_slot[node] = static_cast<uint16_t>(i | MaterialProgram::constant_bit);
+                }
+            }
+            program.constants.push_back(value[node]);
+            return constant_slot[node] =
+                static_cast<uint16_t>((program.constants.size() - 1) | MaterialProgram::constant_bit);
+        };
+
+        std::vector<uint16_t> free_registers;
+        int next_register = 0;
+        for (int node : order) {
+            if (uniform[node]) continue;
+            MaterialProgram::Instruction instruction{all[node].op, 0,
+                {MaterialProgram::unused, MaterialProgram::unused, MaterialProgram::unused}};
+            for (size_t k = 0; k < arguments[node].size(); k++) {
+                int argument = arguments[node][k];
+                instruction.operands[k] = uniform[argument] ? constant_operand(argument) : operand_of[argument];
+            }
+            // Operands whose last use is this instruction release their registers first, so the
+            // destination may reuse one of them (every operand is read before the write)
+            for (int argument : arguments[node]) {
+                if (!uniform[argument] && last_use[argument] == position[node] &&
+                    std::find(free_registers.begin(), free_registers.end(), operand_of[argument]) == free_registers.end()) {
+                    free_registers.push_back(operand_of[argument]);
+                }
+            }
+            uint16_t destination;
+            if (!free_registers.empty()) {
+                destination = free_registers.back();
+                free_registers.pop_back();
+            } else {
+                destination = static_cast<uint16_t>(next_register++);
+            }
+            if (next_register > MaterialProgram::max_registers) {
+                std::cout << "ERROR: Material graph needs more than " << MaterialProgram::max_registers
+                          << " registers" << std::endl;
+                return false;
+            }
+            instruction.destination = destination;
+            operand_of[node] = destination;
+            program.instructions.push_back(instruction);
+        }
+
+        int out = output_it->second;
+        program.output = uniform[out] ? constant_operand(out) : operand_of[out];
+        program.register_count = next_register;
+        program.statistics.instructions = static_cast<int>(program.instructions.size());
+        program.statistics.registers = next_register;
+        program.statistics.constants = static_cast<int>(program.constants.size());
+        return true;
+    }
+
+    // Reference interpreter: walks the graph from the output for every shading point, looking nodes
+    // up by name and re-evaluating shared subexpressions (what compilation removes)
+    Vector3 evaluate_interpreted(const ShadingPoint& point) const {
+        return evaluate_node(output_name, point, 0);
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::string output_name;
+
+    int find(const std::string& name) const {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (nodes[i].name == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    static bool is_builtin(const std::string& name) {
+        return name == "N" || name == "V" || name == "L" || name == "H";
+    }
+
+    static bool parse_number(const std::string& text, float& value) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        value = std::strtof(text.c_str(), &end);
+        return end == text.c_str() + text.size();
+    }
+
+    Vector3 evaluate_node(const std::string& name, const ShadingPoint& point, int depth) const {
+        if (name == "N") return point.normal;
+        if (name == "V") return point.wo;
+        if (name == "L") return point.wi;
+        if (name == "H") return (point.wi + point.wo).normalize();
+        int index = find(name);
+        if (index < 0 || depth > 256) return Vector3(0, 0, 0);
+        const Node& node = nodes[index];
+        if (node.op == Op::Constant) return node.value;
+        Vector3 operands[3] = {Vector3(0, 0, 0), Vector3(0, 0, 0), Vector3(0, 0, 0)};
+        for (size_t k = 0; k < node.inputs.size(); k++) operands[k] = evaluate_node(node.inputs[k], point, depth + 1);
+        return MaterialGraphOps::apply(node.op, operands[0], operands[1], operands[2]);
+    }
+};
+
+// Material whose BRDF is a compiled graph program, usable anywhere a Material is
+// base_color is the program's directional albedo at normal incidence (used by BVH proxies and statistics)
+class GraphMaterial : public Material {
+public:
+    MaterialProgram program;
+
+    explicit GraphMaterial(const MaterialProgram& compiled, bool verbose = false)
+        : Material(Vector3(0, 0, 0), MaterialType::Graph), program(compiled) {
+        base_color = estimate_albedo();
+        clamp_to_valid_ranges();
+        if (verbose) {
+            std::cout << "=== Material Graph Compiled ===" << std::endl;
+            program.statistics.print();
+            std::cout << program.disassemble();
+            std::cout << "Directional albedo (normal incidence): (" << base_color.x << ", " << base_color.y << ", "
+                      << base_color.z << ")" << std::endl;
+        }
+    }
+
+    Vector3 evaluate_brdf(const Vector3& wi, const Vector3& wo, const Vector3& normal, bool verbose = true) const override {
+        if (normal.dot(wi) <= 0.0f || normal.dot(wo) <= 0.0f) return Vector3(0, 0, 0);
+        Vector3 result = program.evaluate({wi, wo, normal});
+        if (verbose) {
+            std::cout << "\n=== Material Graph BRDF Evaluation ===" << std::endl;
+            std::cout << program.statistics.instructions << " instructions -> (" << result.x << ", " << result.y
+                      << ", " << result.z << ")" << std::endl;
+        }
+        return result;
+    }
+
+    // Batched evaluate_brdf over many shading points (same results, dispatch amortised per chunk)
+    // Not used by the renderers, which shade one hit at a time: only estimate_albedo(), the tests
+    // and material_graph_benchmark call it
+    void evaluate_brdf_batch(const ShadingPoint* points, size_t count, Vector3* results) const {
+        program.evaluate_batch(points, count, results);
+        for (size_t i = 0; i < count; i++) {
+            if (points[i].normal.dot(points[i].wi) <= 0.0f || points[i].normal.dot(points[i].wo) <= 0.0f) {
+                results[i] = Vector3(0, 0, 0);
+            }
+        }
+    }
+
+    void explain_brdf_evaluation(const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
+        std::cout << "\n=== Compiled Material Graph ===" << std::endl;
+        program.statistics.print();
+        std::cout << program.disassemble();
+        Vector3 result = evaluate_brdf(wi, wo, normal, false);
+        std::cout << "BRDF: (" << result.x << ", " << result.y << ", " << result.z << ")" << std::endl;
+    }
+
+    std::unique_ptr<Material> clone() const override { return std::make_unique<GraphMaterial>(*this); }
+
+    bool validate_parameters() const override {
+        return !program.instructions.empty() || !program.constants.empty();
+    }
+
+    // Graph parameters are baked into the program; only the derived base color is clamped
+    void clamp_to_valid_ranges() override {
+        base_color.x = std::max(0.0f, std::min(1.0f, base_color.x));
+        base_color.y = std::max(0.0f, std::min(1.0f, base_color.y));
+        base_color.z = std::max(0.0f, std::min(1.0f, base_color.z));
+    }
+
+private:
+    // ∫ f cos(θi) dwi at wo = n with 16×16 stratified cosine samples: E ≈ π/N Σ f
+    Vector3 estimate_albedo() const {
+        const int strata = 16;
+        Vector3 normal(0, 0, 1);
+        std::vector<ShadingPoint> points;
+        for (int sy = 0; sy < strata; sy++) {
+            for (int sx = 0; sx < strata; sx++) {
+                float pdf;
+                Vector3 wi = Material::sample_direction(normal, normal, (sx + 0.5f) / strata, (sy + 0.5f) / strata, pdf);
+                points.push_back({wi, normal, normal});
+            }
+        }
+        std::vector<Vector3> values(points.size());
+        evaluate_brdf_batch(points.data(), points.size(), values.data());
+        Vector3 sum(0, 0, 0);
+        for (const Vector3& v : values) sum += v;
+        return sum * (static_cast<float>(M_PI) / points.size());
+    }
+};
@@ -0,0 +1,337 @@
+#pragma once
+#include "../core/vector3.hpp"
+#include "material_base.hpp"
+#include "cook_torrance.hpp"
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+// OpenPBR-style layered material with stochastic lobe selection
+// Mathematical foundation: a stack of layers approximated by albedo scaling
+// Physical principle: energy reflected by an upper layer never reaches the layers below it
+//
+// LAYER STACK (top to bottom):
+//   coat      clear dielectric GGX lobe (coat_weight, coat_roughness, coat_ior)
+//   specular  dielectric GGX lobe of the base (specular_weight, specular_roughness, specular_ior)
+//   diffuse   Lambert lobe ρ/π under the specular layer (base_color)
+//   metal     conductor GGX lobe with F0 = base_color, mixed in by base_metalness
+//
+// ALBEDO SCALING (μo = n·wo, E_k(μo) = directional albedo ∫ f_k cos(θi) dwi of lobe k):
+//   f_r = c f_coat + (1 - c E_coat(μo)) [ m f_metal + (1 - m) ( s f_spec + (1 - s E_spec(μo)) f_diffuse ) ]
+// with c = coat_weight, m = base_metalness, s = specular_weight. Each bracket only receives the
+// energy the layer above did not reflect, so the directional albedo of the stack stays ≤ 1.
+//
+// PRECOMPUTED TABLES: E_k(μ) for every lobe is integrated once per material (stratified GGX
+// importance sampling) and looked up with linear interpolation, so layering costs a table read
+// instead of a hemisphere integral.
+//
+// STOCHASTIC LOBE SELECTION: writing f_r = Σ_k w_k(μo) f_k, the estimated contribution of lobe k
+// is w_k(μo) E_k(μo). A shading event picks lobe k with probability p_k ∝ that estimate and
+// uses w_k f_k / p_k (Material::select_lobe / evaluate_lobe), which is unbiased and costs one
+// lobe per light instead of four. evaluate_brdf() still sums every lobe as the reference.
+//
+// References:
+//   - Andersson et al. "OpenPBR Surface Specification" (Academy Software Foundation, 2024)
+//   - Kulla, Conty "Revisiting Physically Based Shading at Imageworks" SIGGRAPH Course 2017
+//   - Pharr, Jakob, Humphreys "Physically Based Rendering" 4th ed., ch. 14 (layered BSDFs)
+class OpenPBRMaterial : public Material {
+public:
+    enum Lobe { Coat = 0, Specular = 1, Diffuse = 2, Metal = 3, LobeCount = 4 };
+
+    float base_metalness;       // 0 = dielectric base, 1 = metal base
+    float specular_weight;      // Scale of the dielectric specular lobe
+    float specular_roughness;   // Shared by the specular and metal lobes
+    float specular_ior;         // Index of refraction of the base dielectric (F0 = ((n-1)/(n+1))²)
+    float coat_weight;          // Coverage of the clear coat, 0 = no coat
+    float coat_roughness;
+    float coat_ior;
+
+    // Constructor with OpenPBR's default parameter values (uncoated dielectric with IOR 1.5)
+    OpenPBRMaterial(const Vector3& color = Vector3(0.8f, 0.8f, 0.8f),
+                    float metalness = 0.0f,
+                    float roughness = 0.3f,
+                    float ior = 1.5f,
+                    float coat = 0.0f,
+                    float coat_rough = 0.0f,
+                    float coat_index = 1.6f,
+                    float specular = 1.0f,
+                    bool verbose = false)
+        : Material(color, MaterialType::OpenPBR), base_metalness(metalness), specular_weight(specular),
+          specular_roughness(roughness), specular_ior(ior), coat_weight(coat), coat_roughness(coat_rough),
+          coat_ior(coat_index) {
+        clamp_to_valid_ranges();
+
+        if (verbose) {
+            std::cout << "=== OpenPBR Layered Material Initialized ===" << std::endl;
+            std::cout << "Base Color: (" << base_color.x << ", " << base_color.y << ", " << base_color.z << ")" << std::endl;
+            std::cout << "Base metalness: " << base_metalness << ", specular weight: " << specular_weight
+                      << ", roughness: " << specular_roughness << ", IOR: " << specular_ior << std::endl;
+            std::cout << "Coat weight: " << coat_weight << ", roughness: " << coat_roughness
+                      << ", IOR: " << coat_ior << std::endl;
+            std::cout << "Albedo tables: " << LobeCount << " lobes × " << table_size << " view angles" << std::endl;
+        }
+    }
+
+    // Full layered BRDF: every lobe evaluated and summed (reference for the stochastic estimator)
+    Vector3 evaluate_brdf(const Vector3& wi, const Vector3& wo, const Vector3& normal, bool verbose = true) const override {
+        Vector3 result(0, 0, 0);
+        for (int lobe = 0; lobe < LobeCount; lobe++) {
+            result += evaluate_lobe(lobe, wi, wo, normal);
+        }
+        if (verbose) {
+            std::cout << "\n=== OpenPBR Layered BRDF Evaluation ===" << std::endl;
+            std::cout << "Sum of " << LobeCount << " weighted lobes: (" << result.x << ", " << result.y << ", "
+                      << result.z << ")" << std::endl;
+        }
+        return result;
+    }
+
+    int lobe_count() const override { return LobeCount; }
+
+    // Pick lobe k with probability p_k = w_k E_k / Σ_j w_j E_j
+    int select_lobe(const Vector3& wo, const Vector3& normal, float u, float& probability) const override {
+        float probabilities[LobeCount];
+        lobe_probabilities(normal.dot(wo), probabilities);
+        float cumulative = 0.0f;
+        int selected = LobeCount - 1;
+        for (int lobe = 0; lobe < LobeCount; lobe++) {
+            cumulative += probabilities[lobe];
+            if (u < cumulative) {
+                selected = lobe;
+                break;
+            }
+        }
+        // Floating-point round-off can leave u above the last cumulative sum: fall back to the
+        // last lobe that can actually be chosen
+        while (probabilities[selected] <= 0.0f && selected > 0) selected--;
+        probability = probabilities[selected];
+        return selected;
+    }
+
+    // w_k(μo) f_k(wi, wo): one lobe including its layering weight
+    Vector3 evaluate_lobe(int lobe, const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
+        float ndotl = normal.dot(wi);
+        float ndotv = normal.dot(wo);
+        if (ndotl <= 0.0f || ndotv <= 0.0f) return Vector3(0, 0, 0);
+        float weight = lobe_weight(lobe, ndotv);
+        if (weight <= 0.0f) return Vector3(0, 0, 0);
+        return unweighted_lobe(lobe, wi, wo, normal) * weight;
+    }
+
+    // Diffuse: cosine-weighted hemisphere; microfacet lobes: GGX half-vector sampling with the lobe's roughness
+    Vector3 sample_lobe(int lobe, const Vector3& wo, const Vector3& normal, float u1, float u2, float& pdf) const override {
+        if (lobe == Diffuse) {
+            return Material::sample_direction(wo, normal, u1, u2, pdf);
+        }
+        Vector3 wi = sample_ggx(wo, normal, lobe_alpha(lobe), u1, u2);
+        pdf = lobe_pdf(lobe, wi, wo, normal);
+        return wi;
+    }
+
+    float lobe_pdf(int lobe, const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
+        if (lobe == Diffuse) {
+            return Material::sample_pdf(wi, wo, normal);
+        }
+        return ggx_pdf(wi, wo, normal, lobe_alpha(lobe));
+    }
+
+    // One-sample mixture over the lobes: u1 selects the lobe and is rescaled to [0, 1) for reuse
+    Vector3 sample_direction(const Vector3& wo, const Vector3& normal, float u1, float u2, float& pdf) const override {
+        float probabilities[LobeCount];
+        lobe_probabilities(normal.dot(wo), probabilities);
+        float cumulative = 0.0f;
+        int lobe = 0;
+        for (; lobe < LobeCount - 1; lobe++) {
+            if (u1 < cumulative + probabilities[lobe]) break;
+            cumulative += probabilities[lobe];
+        }
+        float remapped = probabilities[lobe] > 0.0f ? std::min(0.99999994f, (u1 - cumulative) / probabilities[lobe]) : u1;
+        float lobe_density;
+        Vector3 wi = sample_lobe(lobe, wo, normal, std::max(0.0f, remapped), u2, lobe_density);
+        pdf = sample_pdf(wi, wo, normal);
+        return wi;
+    }
+
+    // Mixture density Σ_k p_k pdf_k(wi)
+    float sample_pdf(const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
+        float probabilities[LobeCount];
+        lobe_probabilities(normal.dot(wo), probabilities);
+        float pdf = 0.0f;
+        for (int lobe = 0; lobe < LobeCount; lobe++) {
+            if (probabilities[lobe] > 0.0f) pdf += probabilities[lobe] * lobe_pdf(lobe, wi, wo, normal);
+        }
+        return pdf;
+    }
+
+    // Directional albedo E_k(μ) of one unweighted lobe from the precomputed table
+    Vector3 lobe_albedo(int lobe, float cos_theta) const {
+        float position = std::max(0.0f, std::min(1.0f, cos_theta)) * table_size - 0.5f;
+        int i0 = std::max(0, std::min(table_size - 1, static_cast<int>(std::floor(position))));
+        int i1 = std::min(table_size - 1, i0 + 1);
+        float t = std::max(0.0f, std::min(1.0f, position - i0));
+        return albedo_table[lobe][i0] * (1.0f - t) + albedo_table[lobe][i1] * t;
+    }
+
+    // Layering weight w_k(μo) from the albedo-scaling formula above
+    float lobe_weight(int lobe, float ndotv) const {
+        float base = 1.0f - coat_weight * luminance(lobe_albedo(Coat, ndotv));
+        switch (lobe) {
+            case Coat: return coat_weight;
+            case Metal: return base * base_metalness;
+            case Specular: return base * (1.0f - base_metalness) * specular_weight;
+            case Diffuse: return base * (1.0f - base_metalness) *
+                                 (1.0f - specular_weight * luminance(lobe_albedo(Specular, ndotv)));
+            default: return 0.0f;
+        }
+    }
+
+    // Selection probabilities p_k ∝ w_k(μo) · luminance(E_k(μo)); all-diffuse when nothing reflects
+    void lobe_probabilities(float ndotv, float probabilities[LobeCount]) const {
+        float total = 0.0f;
+        for (int lobe = 0; lobe < LobeCount; lobe++) {
+            probabilities[lobe] = std::max(0.0f, lobe_weight(lobe, ndotv)) * luminance(lobe_albedo(lobe, ndotv));
+            total += probabilities[lobe];
+        }
+        for (int lobe = 0; lobe < LobeCount; lobe++) {
+            probabilities[lobe] = total > 0.0f ? probabilities[lobe] / total : (lobe == Diffuse ? 1.0f : 0.0f);
+        }
+    }
+
+    static const char* lobe_name(int lobe) {
+        switch (lobe) {
+            case Coat: return "coat";
+            case Specular: return "specular";
+            case Diffuse: return "diffuse";
+            case Metal: return "metal";
+            default: return "unknown";
+        }
+    }
+
+    void explain_brdf_evaluation(const Vector3& wi, const Vector3& wo, const Vector3& normal) const override {
+        std::cout << "\n=== OpenPBR Layered Material Breakdown ===" << std::endl;
+        std::cout << "f_r = c f_coat + (1 - c E_coat) [ m f_metal + (1 - m) (s f_spec + (1 - s E_spec) f_diffuse) ]" << std::endl;
+        float ndotv = normal.dot(wo);
+        float probabilities[LobeCount];
+        lobe_probabilities(ndotv, probabilities);
+        for (int lobe = 0; lobe < LobeCount; lobe++) {
+            Vector3 value = evaluate_lobe(lobe, wi, wo, normal);
+            std::cout << "  " << lobe_name(lobe) << ": weight " << lobe_weight(lobe, ndotv) << ", albedo "
+                      << luminance(lobe_albedo(lobe, ndotv)) << ", selection probability " << probabilities[lobe]
+                      << ", f = (" << value.x << ", " << value.y << ", " << value.z << ")" << std::endl;
+        }
+        Vector3 total = evaluate_brdf(wi, wo, normal, false);
+        std::cout << "Full BRDF: (" << total.x << ", " << total.y << ", " << total.z << ")" << std::endl;
+    }
+
+    std::unique_ptr<Material> clone() const override { return std::make_unique<OpenPBRMaterial>(*this); }
+
+    bool validate_parameters() const override {
+        auto unit = [](float v) { return v >= 0.0f && v <= 1.0f; };
+        return unit(base_color.x) && unit(base_color.y) && unit(base_color.z) && unit(base_metalness) &&
+               unit(specular_weight) && specular_roughness >= 0.01f && specular_roughness <= 1.0f &&
+               unit(coat_weight) && coat_roughness >= 0.01f && coat_roughness <= 1.0f &&
+               specular_ior >= 1.0f && specular_ior <= 3.0f && coat_ior >= 1.0f && coat_ior <= 3.0f;
+    }
+
+    // Clamp to valid ranges and rebuild the albedo tables (they depend on every parameter)
+    void clamp_to_valid_ranges() override {
+        auto unit = [](float v) { return std::max(0.0f, std::min(1.0f, v)); };
+        base_color = Vector3(unit(base_color.x), unit(base_color.y), unit(base_color.z));
+        base_metalness = unit(base_metalness);
+        specular_weight = unit(specular_weight);
+        specular_roughness = std::max(0.01f, std::min(1.0f, specular_roughness));
+        specular_ior = std::max(1.0f, std::min(3.0f, specular_ior));
+        coat_weight = unit(coat_weight);
+        coat_roughness = std::max(0.01f, std::min(1.0f, coat_roughness));
+        coat_ior = std::max(1.0f, std::min(3.0f, coat_ior));
+        update_albedo_tables();
+    }
+
+    // Integrate E_k(μ) for every lobe; call after changing parameters directly
+    // Stratified GGX importance sampling: E ≈ (1/N) Σ f_k(wi) cos(θi) / pdf_k(wi)
+    void update_albedo_tables() {
+        const Vector3 normal(0, 0, 1);
+        for (int i = 0; i < table_size; i++) {
+            float mu = (i + 0.5f) / table_size;
+            Vector3 wo(std::sqrt(std::max(0.0f, 1.0f - mu * mu)), 0.0f, mu);
+            for (int lobe = 0; lobe < LobeCount; lobe++) {
+                if (lobe == Diffuse) {
+                    albedo_table[lobe][i] = base_color;
+                    continue;
+                }
+                Vector3 sum(0, 0, 0);
+                for (int sy = 0; sy < table_strata; sy++) {
+                    for (int sx = 0; sx < table_strata; sx++) {
+                        float u1 = (sx + 0.5f) / table_strata, u2 = (sy + 0.5f) / table_strata;
+                        float alpha = lobe_alpha(lobe);
+                        Vector3 wi = sample_ggx(wo, normal, alpha, u1, u2);
+                        float pdf = ggx_pdf(wi, wo, normal, alpha);
+                        float cos_theta = normal.dot(wi);
+                        if (pdf <= 0.0f || cos_theta <= 0.0f) continue;
+                        sum += unweighted_lobe(lobe, wi, wo, normal) * (cos_theta / pdf);
+                    }
+                }
+                albedo_table[lobe][i] = sum * (1.0f / (table_strata * table_strata));
+            }
+        }
+    }
+
+    static constexpr int table_size = 16;      // View-angle bins per lobe
+    static constexpr int table_strata = 16;    // table_strata² integration samples per bin
+
+private:
+    std::array<std::array<Vector3, table_size>, LobeCount> albedo_table{};
+
+    static float luminance(const Vector3& c) {
+        return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+    }
+
+    float lobe_alpha(int lobe) const {
+        float roughness = lobe == Coat ? coat_roughness : specular_roughness;
+        return roughness * roughness;
+    }
+
+    Vector3 lobe_f0(int lobe) const {
+        if (lobe == Metal) return base_color;
+        return CookTorrance::FresnelFunction::f0_from_ior(lobe == Coat ? coat_ior : specular_ior);
+    }
+
+    // f_k without its layering weight: Lambert for the diffuse lobe, D G F / (4 n·l n·v) otherwise
+    Vector3 unweighted_lobe(int lobe, const Vector3& wi, const Vector3& wo, const Vector3& normal) const {
+        float ndotl = normal.dot(wi);
+        float ndotv = normal.dot(wo);
+        if (ndotl <= 0.0f || ndotv <= 0.0f) return Vector3(0, 0, 0);
+        if (lobe == Diffuse) {
+            return base_color * (1.0f / static_cast<float>(M_PI));
+        }
+        float alpha = lobe_alpha(lobe);
+        Vector3 halfway = (wi + wo).normalize();
+        float D = CookTorrance::NormalDistribution::ggx_distribution(std::max(0.0f, normal.dot(halfway)), alpha);
+        float G = CookTorrance::GeometryFunction::smith_g(ndotl, ndotv, alpha);
+        Vector3 F = CookTorrance::FresnelFunction::schlick_fresnel(std::max(0.0f, wo.dot(halfway)), lobe_f0(lobe));
+        return F * (D * G / (4.0f * ndotl * ndotv));
+    }
+
+    // Same GGX half-vector sampling as CookTorranceMaterial::sample_direction
+    static Vector3 sample_ggx(const Vector3& wo, const Vector3& normal, float alpha, float u1, float u2) {
+        float tan2_theta = alpha * alpha * u1 / std::max(1e-7f, 1.0f - u1);
+        float cos_theta = 1.0f / std::sqrt(1.0f + tan2_theta);
+        float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+        float phi = 2.0f * static_cast<float>(M_PI) * u2;
+        Vector3 tangent, bitangent;
+        build_orthonormal_basis(normal, tangent, bitangent);
+        Vector3 halfway = tangent * (sin_theta * std::cos(phi)) + bitangent * (sin_theta * std::sin(phi)) +
+                          normal * cos_theta;
+        return halfway * (2.0f * wo.dot(halfway)) - wo;
+    }
+
+    static float ggx_pdf(const Vector3& wi, const Vector3& wo, const Vector3& normal, float alpha) {
+        if (normal.dot(wi) <= 0.0f || normal.dot(wo) <= 0.0f) return 0.0f;
+        Vector3 halfway = (wi + wo).normalize();
+        float ndoth = std::max(0.0f, normal.dot(halfway));
+        float vdoth = std::abs(wo.dot(halfway));
+        if (vdoth <= 1e-7f) return 0.0f;
+        return CookTorrance::NormalDistribution::ggx_distribution(ndoth, alpha) * ndoth / (4.0f * vdoth);
+    }
+};
@@ -0,0 +1,217 @@
+// Golden-image validation harness for approximate fast rendering modes
+//
+// For every reference scene the harness renders the exact image with Renderer::render_frame
+// (through the scene BVH, whose exact traversal returns the same hits as the linear test),
+// then renders the same view with each registered fast mode and compares the two with
+// ImageMetrics (RMSE, PSNR, max error, FLIP-style perceptual error). A mode fails if any metric
+// exceeds its configured error budget. Speedup is reported next to the error so the
+// exactness/performance trade-off of each mode is visible in one table.
+//
+// Usage: golden_image_harness [--assets <dir>] [--resolution WxH] [--repeat N] [--mode <name>]
+// New fast modes register in registered_modes() with their error budget.
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/renderer.hpp"
+#include "src/core/checkerboard_renderer.hpp"
+#include "src/core/image_metrics.hpp"
+#include "src/core/image.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GoldenImageHarness {
+
+    // Maximum acceptable deviation from the exact render
+    struct ErrorBudget {
+        float max_rmse;
+        float min_psnr_db;
+        float max_error;
+        float max_flip;
+    };
+
+    // A fast rendering mode under test
+    // prepare: untimed setup before each timed render (e.g. history frames); may be empty
+    // render:  timed render of the frame compared against the exact reference
+    struct FastMode {
+        std::string name;
+        std::string description;
+        ErrorBudget budget;
+        std::function<void(const Scene&, const Camera&, int, int)> prepare;
+        std::function<void(const Scene&, const Camera&, int, int, std::vector<Vector3>&)> render;
+    };
+
+    // Reference scenes rendered in every mode (deterministic lighting only: area lights sample
+    // randomly, so their exact render is itself noisy and cannot serve as a golden image)
+    std::vector<std::string> reference_scenes() {
+        return {"showcase_scene.scene", "simple_scene.scene", "distant_clusters.scene"};
+    }
+
+    std::vector<FastMode> registered_modes() {
+        std::vector<FastMode> modes;
+
+        // Checkerboard first frame: half the rays, spatial reconstruction only (worst case)
+        modes.push_back({"checkerboard-spatial", "50% rays, neighbour interpolation (no history)",
+                         {0.015f, 38.0f, 0.4f, 0.02f},
+                         nullptr,
+                         [](const Scene& scene, const Camera& camera, int width, int height, std::vector<Vector3>& pixels) {
+                             CheckerboardRenderer checkerboard(width, height);
+                             checkerboard.render_frame(scene, camera, pixels);
+                         }});
+
+        // Checkerboard steady state: previous frame from a slightly offset camera, then reproject
+        auto temporal = std::make_shared<std::unique_ptr<CheckerboardRenderer>>();
+        modes.push_back({"checkerboard-temporal", "50% rays, reprojection of previous frame",
+                         {0.012f, 40.0f, 0.4f, 0.015f},
+                         [temporal](const Scene& scene, const Camera& camera, int width, int height) {
+                             *temporal = std::make_unique<CheckerboardRenderer>(width, height);
+                             Camera previous_camera = camera;
+                             previous_camera.translate(Vector3(-0.02f, 0.0f, 0.0f));
+                             std::vector<Vector3> previous_frame;
+                             (*temporal)->render_frame(scene, previous_camera, previous_frame);
+                         },
+                         [temporal](const Scene& scene, const Camera& camera, int, int, std::vector<Vector3>& pixels) {
+                             (*temporal)->render_frame(scene, camera, pixels);
+                         }});
+
+        // Level of detail: BVH nodes under one pixel rendered as bounding-sphere proxies
+        modes.push_back({"lod-bvh-1px", "BVH proxies below 1 pixel screen-space error",
+                         {0.004f, 48.0f, 0.3f, 0.002f},
+                         nullptr,
+                         [](const Scene& scene, const Camera& camera, int width, int height, std::vector<Vector3>& pixels) {
+                             Renderer::render_frame(scene, camera, width, height, pixels, 1.0f);
+                         }});
+
+        return modes;
+    }
+
+    // Best-of-N wall time in milliseconds (prepare runs untimed before each repetition)
+    double time_render(int repeat, const std::function<void()>& prepare, const std::function<void()>& render) {
+        double best_ms = 0.0;
+        for (int i = 0; i < repeat; i++) {
+            if (prepare) prepare();
+            auto start = std::chrono::high_resolution_clock::now();
+            render();
+            auto end = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            best_ms = (i == 0) ? ms : std::min(best_ms, ms);
+        }
+        return best_ms;
+    }
+
+    bool within_budget(const ImageMetrics& metrics, const ErrorBudget& budget) {
+        return metrics.rmse <= budget.max_rmse && metrics.psnr_db >= budget.min_psnr_db &&
+               metrics.max_error <= budget.max_error && metrics.flip <= budget.max_flip;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string assets_dir = "../assets";
+    Resolution resolution = Resolution::parse_from_string("160x120");
+    int repeat = 3;
+    std::string mode_filter;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--assets") == 0 && i + 1 < argc) {
+            assets_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            mode_filter = argv[++i];
+        } else {
+            std::cout << "Usage: golden_image_harness [--assets <dir>] [--resolution WxH] [--repeat N] [--mode <name>]" << std::endl;
+            return 1;
+        }
+    }
+
+    int width = resolution.width;
+    int height = resolution.height;
+    std::vector<GoldenImageHarness::FastMode> modes = GoldenImageHarness::registered_modes();
+
+    struct Result {
+        std::string scene;
+        std::string mode;
+        ImageMetrics metrics;
+        double speedup;
+        bool passed;
+        bool sized;    // Fast mode produced width * height pixels
+    };
+    std::vector<Result> results;
+
+    for (const std::string& scene_name : GoldenImageHarness::reference_scenes()) {
+        Scene scene = SceneLoader::load_from_file(assets_dir + "/" + scene_name);
+        if (scene.primitives.empty()) {
+            std::cout << "ERROR: Could not load reference scene " << scene_name << std::endl;
+            return 1;
+        }
+
+        scene.build_bvh();
+
+        Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                      static_cast<float>(width) / height);
+
+        std::vector<Vector3> reference;
+        double exact_ms = GoldenImageHarness::time_render(repeat, nullptr, [&]() {
+            Renderer::render_frame(scene, camera, width, height, reference);
+        });
+
+        for (const auto& mode : modes) {
+            if (!mode_filter.empty() && mode.name != mode_filter) continue;
+
+            std::vector<Vector3> fast;
+            std::function<void()> prepare;
+            if (mode.prepare) {
+                prepare = [&]() { mode.prepare(scene, camera, width, height); };
+            }
+            double fast_ms = GoldenImageHarness::time_render(repeat, prepare, [&]() {
+                mode.render(scene, camera, width, height, fast);
+            });
+
+            bool sized = fast.size() == reference.size();
+            ImageMetrics metrics = sized ? ImageMetrics::compare(fast, reference, width, height) : ImageMetrics::size_mismatch();
+            bool passed = sized && GoldenImageHarness::within_budget(metrics, mode.budget);
+            results.push_back({scene_name, mode.name, metrics, exact_ms / std::max(fast_ms, 1e-6), passed, sized});
+        }
+    }
+
+    std::cout << "\n=== Golden-Image Validation Results (" << width << "x" << height << ") ===" << std::endl;
+    std::cout << std::left << std::setw(24) << "Scene" << std::setw(24) << "Mode" << std::right
+              << std::setw(10) << "RMSE" << std::setw(10) << "PSNR" << std::setw(10) << "MaxErr"
+              << std::setw(10) << "FLIP" << std::setw(10) << "Speedup" << "  Result" << std::endl;
+    bool all_passed = true;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(24) << result.scene << std::setw(24) << result.mode << std::right
+                  << std::fixed << std::setprecision(4)
+                  << std::setw(10) << result.metrics.rmse << std::setw(10) << std::setprecision(2) << result.metrics.psnr_db
+                  << std::setw(10) << std::setprecision(4) << result.metrics.max_error
+                  << std::setw(10) << result.metrics.flip << std::setw(9) << std::setprecision(2) << result.speedup << "x"
+                  << "  " << (result.passed ? "PASS" : result.sized ? "FAIL (over budget)" : "FAIL (wrong image size)") << std::endl;
+        all_passed &= result.passed;
+    }
+
+    for (const auto& mode : modes) {
+        if (!mode_filter.empty() && mode.name != mode_filter) continue;
+        std::cout << std::defaultfloat << std::setprecision(4) << "Budget " << mode.name << " (" << mode.description << "): RMSE <= " << mode.budget.max_rmse
+                  << ", PSNR >= " << mode.budget.min_psnr_db << " dB, max error <= " << mode.budget.max_error
+                  << ", FLIP <= " << mode.budget.max_flip << std::endl;
+    }
+
+    if (results.empty()) {
+        std::cout << "ERROR: No fast mode matched '" << mode_filter << "'" << std::endl;
+        return 1;
+    }
+    std::cout << (all_passed ? "\n✅ ALL FAST MODES WITHIN ERROR BUDGET" : "\n❌ SOME FAST MODES EXCEED ERROR BUDGET") << std::endl;
+    return all_passed ? 0 : 1;
+}
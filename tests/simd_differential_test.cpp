@@ -0,0 +1,463 @@
+// SIMD differential test: every SimdKernels variant against the scalar implementations it replaces
+//
+// Lane bugs (a wrong mask, a swapped select, a tail group reading past the end) usually show up only
+// for rare inputs, so each kernel is fed millions of randomized inputs with a large share of
+// adversarial ones:
+//   spheres   grazing and tangent rays, ray origins on the surface and inside, zero radius
+//   BRDF      grazing light/view, wi = -wo (degenerate halfway), wi = wo = n, unnormalized vectors,
+//             roughness 0 and 1
+//   camera    degenerate bases, pixels on and outside the image edges
+//   all       NaN, ±Inf, denormals, ±0 and huge values injected into random components
+// Batches have random lengths, so every variant also runs partial lane groups.
+// Every variant this CPU supports (scalar, SSE, AVX2, AVX-512) is compared with the scalar code:
+//   Sphere::intersect, CookTorranceMaterial::evaluate_brdf, LambertMaterial::scatter_light and
+//   Camera::generate_ray. Values must agree within a relative tolerance (NaN only with NaN, Inf only
+//   with the same Inf). A hit/miss disagreement is tolerated only where the scalar decision itself is
+//   within rounding: a discriminant within 1e-5·b² of zero or a root within 1e-6 of the 1e-6 cutoff.
+// Exits non-zero on any failure.
+//
+// Usage: simd_differential_test [--samples N] [--seed S]
+
+#include "src/core/simd_kernels.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SimdDifferential {
+
+    constexpr double brdf_tolerance = 2e-5;     // π in float instead of double, (1 - cos)^5 instead of pow
+    constexpr double exact_tolerance = 1e-6;    // Kernels that repeat the scalar operations exactly
+    constexpr size_t max_batch = 67;            // Batch lengths 1..67 cover partial groups of every width
+
+    // Comparison totals of one kernel on one instruction set
+    struct Result {
+        std::string kernel;
+        SimdKernels::Isa isa;
+        size_t compared = 0;
+        size_t tolerated = 0;    // Hit/miss disagreements at a rounding-level decision
+        size_t failures = 0;
+        double max_relative_error = 0.0;
+        std::string first_failure;
+    };
+
+    // Relative error of actual against expected: 0 for equal values and for NaN against NaN,
+    // infinite if only one side is NaN or Inf
+    double relative_error(float expected, float actual) {
+        if (std::isnan(expected) || std::isnan(actual)) {
+            return std::isnan(expected) && std::isnan(actual) ? 0.0 : std::numeric_limits<double>::infinity();
+        }
+        if (expected == actual) return 0.0;
+        if (std::isinf(expected) || std::isinf(actual)) return std::numeric_limits<double>::infinity();
+        double magnitude = std::max(std::fabs(static_cast<double>(expected)), std::fabs(static_cast<double>(actual)));
+        return std::fabs(static_cast<double>(expected) - actual) / magnitude;
+    }
+
+    // describe() builds the failure text, only for the first failure
+    template <typename Describe>
+    void record(Result& result, double error, double tolerance, Describe describe) {
+        result.compared++;
+        if (error > result.max_relative_error && std::isfinite(error)) {
+            result.max_relative_error = error;
+        }
+        if (error > tolerance) {
+            if (result.failures == 0) result.first_failure = describe();
+            result.failures++;
+        }
+    }
+
+    std::string describe(const Vector3& v) {
+        std::ostringstream text;
+        text << std::setprecision(9) << "(" << v.x << ", " << v.y << ", " << v.z << ")";
+        return text.str();
+    }
+
+    // Random and adversarial inputs
+    class InputGenerator {
+    public:
+        explicit InputGenerator(uint32_t seed) : rng(seed) {}
+
+        float uniform(float low, float high) { return std::uniform_real_distribution<float>(low, high)(rng); }
+        int integer(int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); }
+        bool chance(float probability) { return uniform(0.0f, 1.0f) < probability; }
+
+        float special() {
+            static const float values[] = {
+                std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+                -std::numeric_limits<float>::infinity(), 1e-40f, -1e-45f, FLT_MIN, 0.0f, -0.0f,
+                FLT_MAX, -1e30f, 1e-30f};
+            return values[integer(0, static_cast<int>(sizeof(values) / sizeof(values[0])) - 1)];
+        }
+
+        // With the given probability, replace one component of v by a special value
+        Vector3 corrupt(Vector3 v, float probability) {
+            if (chance(probability)) {
+                float* component = integer(0, 2) == 0 ? &v.x : (integer(0, 1) == 0 ? &v.y : &v.z);
+                *component = special();
+            }
+            return v;
+        }
+
+        Vector3 unit() {
+            while (true) {
+                Vector3 v(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f));
+                float length_squared = v.length_squared();
+                if (length_squared > 1e-4f && length_squared <= 1.0f) return v.normalize();
+            }
+        }
+
+        // Unit vector perpendicular to unit vector d
+        Vector3 perpendicular(const Vector3& d) {
+            Vector3 helper = std::fabs(d.x) < 0.9f ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+            return d.cross(helper).normalize();
+        }
+
+        // Relative offsets that put a surface exactly on, or just inside or outside, a tangent
+        float tangent_offset() {
+            static const float offsets[] = {0.0f, 1e-7f, -1e-7f, 1e-6f, -1e-6f, 1e-4f, -1e-4f};
+            if (chance(0.2f)) return uniform(-1e-2f, 1e-2f);
+            return offsets[integer(0, static_cast<int>(sizeof(offsets) / sizeof(offsets[0])) - 1)];
+        }
+
+        size_t batch_length(size_t remaining) {
+            return std::min(remaining, static_cast<size_t>(integer(1, static_cast<int>(max_batch))));
+        }
+
+        std::mt19937 rng;
+    };
+
+    // Sphere::intersect: one ray against a batch of spheres
+    void test_spheres(InputGenerator& gen, size_t samples, const std::vector<SimdKernels::Isa>& isas,
+                      std::vector<Result>& results) {
+        Sphere reference(Point3(0.0f, 0.0f, 0.0f), 1.0f, 0);
+        std::vector<float> t;
+        for (size_t done = 0; done < samples;) {
+            size_t count = gen.batch_length(samples - done);
+            Vector3 unit_direction = gen.unit();
+            Point3 origin(gen.uniform(-20.0f, 20.0f), gen.uniform(-20.0f, 20.0f), gen.uniform(-20.0f, 20.0f));
+            Vector3 direction = unit_direction * (gen.chance(0.5f) ? 1.0f : std::pow(10.0f, gen.uniform(-3.0f, 3.0f)));
+
+            SimdKernels::SphereBatch spheres;
+            for (size_t i = 0; i < count; i++) {
+                Point3 center(gen.uniform(-20.0f, 20.0f), gen.uniform(-20.0f, 20.0f), gen.uniform(-20.0f, 20.0f));
+                float radius = gen.uniform(0.0f, 5.0f);
+                Vector3 side = gen.perpendicular(unit_direction);
+                switch (gen.integer(0, 4)) {
+                    case 1: {   // Grazing or tangent ray
+                        radius = gen.uniform(0.01f, 10.0f);
+                        Point3 along = origin + unit_direction * gen.uniform(0.5f, 30.0f);
+                        center = along + side * (radius * (1.0f + gen.tangent_offset()));
+                        break;
+                    }
+                    case 2: {   // Origin on the surface, or inside
+                        radius = gen.uniform(0.01f, 10.0f);
+                        float scale = gen.chance(0.5f) ? 1.0f + gen.tangent_offset() : gen.uniform(0.0f, 0.99f);
+                        center = origin + gen.unit() * (radius * scale);
+                        break;
+                    }
+                    case 3:     // Zero radius, sometimes exactly on the ray
+                        radius = 0.0f;
+                        if (gen.chance(0.5f)) center = origin + direction * gen.uniform(-2.0f, 2.0f);
+                        break;
+                    default:
+                        break;
+                }
+                Vector3 corrupted = gen.corrupt(Vector3(center.x, center.y, center.z), 0.05f);
+                reference.center = Point3(corrupted.x, corrupted.y, corrupted.z);
+                reference.radius = gen.chance(0.03f) ? gen.special() : radius;
+                spheres.add(reference);
+            }
+            if (gen.chance(0.05f)) {
+                Vector3 corrupted = gen.corrupt(Vector3(origin.x, origin.y, origin.z), 1.0f);
+                origin = Point3(corrupted.x, corrupted.y, corrupted.z);
+            }
+            direction = gen.corrupt(direction, 0.03f);
+            Ray ray(origin, direction);
+
+            std::vector<Sphere::Intersection> expected(count);
+            for (size_t i = 0; i < count; i++) {
+                reference.center = Point3(spheres.center_x[i], spheres.center_y[i], spheres.center_z[i]);
+                reference.radius = spheres.radius[i];
+                expected[i] = reference.intersect(ray, false);
+            }
+            for (size_t v = 0; v < isas.size(); v++) {
+                SimdKernels::intersect_spheres(isas[v], ray, spheres, t);
+                for (size_t i = 0; i < count; i++) {
+                    // A scalar hit at t = +inf reads as a miss, like in the kernels
+                    float expected_t = expected[i].hit ? expected[i].t : std::numeric_limits<float>::infinity();
+                    Point3 center(spheres.center_x[i], spheres.center_y[i], spheres.center_z[i]);
+                    auto describe_failure = [&]() {
+                        std::ostringstream text;
+                        text << std::setprecision(9) << "ray " << describe(origin - Point3(0.0f, 0.0f, 0.0f)) << " -> "
+                             << describe(direction) << ", sphere " << describe(center - Point3(0.0f, 0.0f, 0.0f))
+                             << " r=" << spheres.radius[i] << ": scalar t " << expected_t << ", lanes t " << t[i];
+                        return text.str();
+                    };
+                    if (std::isinf(expected_t) != std::isinf(t[i])) {
+                        // Hit against miss: recompute the scalar decision to see how close to a tie it was
+                        Vector3 oc = origin - center;
+                        float a = direction.dot(direction);
+                        float b = 2.0f * oc.dot(direction);
+                        float c = oc.dot(oc) - spheres.radius[i] * spheres.radius[i];
+                        float discriminant = b * b - 4 * a * c;
+                        float t_hit = std::isinf(expected_t) ? t[i] : expected_t;
+                        if (std::fabs(discriminant) <= 1e-5f * b * b || std::fabs(t_hit - 1e-6f) <= 1e-6f) {
+                            results[v].compared++;
+                            results[v].tolerated++;
+                            continue;
+                        }
+                    }
+                    record(results[v], relative_error(expected_t, t[i]), exact_tolerance, describe_failure);
+                }
+            }
+            done += count;
+        }
+    }
+
+    // Directions for one BRDF sample: random, grazing and degenerate configurations
+    void brdf_directions(InputGenerator& gen, Vector3& wi, Vector3& wo, Vector3& normal) {
+        normal = gen.unit();
+        wi = gen.unit();
+        wo = gen.unit();
+        switch (gen.integer(0, 6)) {
+            case 1:     // Both in the upper hemisphere
+                if (wi.dot(normal) < 0.0f) wi = wi * -1.0f;
+                if (wo.dot(normal) < 0.0f) wo = wo * -1.0f;
+                break;
+            case 2: {   // Grazing light or view
+                Vector3 tangent = gen.perpendicular(normal);
+                Vector3 grazing = (tangent + normal * gen.tangent_offset()).normalize();
+                if (gen.chance(0.5f)) wi = grazing; else wo = grazing;
+                break;
+            }
+            case 3:     // Opposite directions: the halfway vector degenerates to zero
+                wi = wo * -1.0f;
+                break;
+            case 4:     // Normal incidence: n·h = 1, tan θ = 0
+                wi = normal;
+                wo = normal;
+                break;
+            case 5:     // Unnormalized
+                wi = wi * std::pow(10.0f, gen.uniform(-20.0f, 20.0f));
+                wo = wo * std::pow(10.0f, gen.uniform(-20.0f, 20.0f));
+                break;
+            default:
+                break;
+        }
+        wi = gen.corrupt(wi, 0.03f);
+        wo = gen.corrupt(wo, 0.03f);
+        normal = gen.corrupt(normal, 0.03f);
+    }
+
+    // inputs() describes the sample, only for the first failure
+    template <typename Inputs>
+    void compare_vectors(Result& result, const Vector3& expected, const Vector3& actual, double tolerance,
+                         Inputs inputs) {
+        double error = std::max({relative_error(expected.x, actual.x), relative_error(expected.y, actual.y),
+                                 relative_error(expected.z, actual.z)});
+        record(result, error, tolerance, [&]() {
+            return inputs() + ": scalar " + describe(expected) + ", lanes " + describe(actual);
+        });
+    }
+
+    // CookTorranceMaterial::evaluate_brdf: batches of one material
+    void test_cook_torrance(InputGenerator& gen, size_t samples, const std::vector<SimdKernels::Isa>& isas,
+                            std::vector<Result>& results) {
+        SimdKernels::Vector3Batch wi, wo, normal, output;
+        for (size_t done = 0; done < samples;) {
+            size_t count = gen.batch_length(samples - done);
+            static const float roughness_values[] = {0.0f, 1e-3f, 0.05f, 1.0f};
+            float roughness = gen.chance(0.3f) ? roughness_values[gen.integer(0, 3)] : gen.uniform(0.0f, 1.0f);
+            float metallic = gen.chance(0.3f) ? static_cast<float>(gen.integer(0, 1)) : gen.uniform(0.0f, 1.0f);
+            CookTorranceMaterial material(Vector3(gen.uniform(0.0f, 1.0f), gen.uniform(0.0f, 1.0f), gen.uniform(0.0f, 1.0f)),
+                                          roughness, metallic, gen.uniform(0.0f, 0.1f), false);
+            material.roughness = roughness;   // Unclamped, so roughness 0 reaches the kernels
+
+            wi = wo = normal = SimdKernels::Vector3Batch();
+            std::vector<Vector3> expected(count);
+            for (size_t i = 0; i < count; i++) {
+                Vector3 l, v, n;
+                brdf_directions(gen, l, v, n);
+                wi.add(l);
+                wo.add(v);
+                normal.add(n);
+                expected[i] = material.evaluate_brdf(l, v, n, false);
+            }
+            for (size_t v = 0; v < isas.size(); v++) {
+                SimdKernels::cook_torrance_brdf(isas[v], material, wi, wo, normal, output);
+                for (size_t i = 0; i < count; i++) {
+                    compare_vectors(results[v], expected[i], output[i], brdf_tolerance, [&]() {
+                        std::ostringstream inputs;
+                        inputs << "wi " << describe(wi[i]) << ", wo " << describe(wo[i]) << ", n " << describe(normal[i])
+                               << ", roughness " << material.roughness << ", metallic " << material.metallic;
+                        return inputs.str();
+                    });
+                }
+            }
+            done += count;
+        }
+    }
+
+    // LambertMaterial::scatter_light: batches of one albedo
+    void test_lambert(InputGenerator& gen, size_t samples, const std::vector<SimdKernels::Isa>& isas,
+                      std::vector<Result>& results) {
+        SimdKernels::Vector3Batch light, normal, radiance, output;
+        for (size_t done = 0; done < samples;) {
+            size_t count = gen.batch_length(samples - done);
+            LambertMaterial material(Vector3(gen.uniform(0.0f, 1.0f), gen.uniform(0.0f, 1.0f), gen.uniform(0.0f, 1.0f)));
+            light = normal = radiance = SimdKernels::Vector3Batch();
+            std::vector<Vector3> expected(count);
+            for (size_t i = 0; i < count; i++) {
+                Vector3 l, v, n;
+                brdf_directions(gen, l, v, n);
+                Vector3 incident = gen.corrupt(Vector3(gen.uniform(0.0f, 10.0f), gen.uniform(0.0f, 10.0f),
+                                                       gen.uniform(0.0f, 10.0f)), 0.03f);
+                light.add(l);
+                normal.add(n);
+                radiance.add(incident);
+                expected[i] = material.scatter_light(l, v, n, incident, false);
+            }
+            for (size_t v = 0; v < isas.size(); v++) {
+                SimdKernels::lambert_scatter(isas[v], material, light, normal, radiance, output);
+                for (size_t i = 0; i < count; i++) {
+                    compare_vectors(results[v], expected[i], output[i], exact_tolerance, [&]() {
+                        return "l " + describe(light[i]) + ", n " + describe(normal[i]) + ", L " + describe(radiance[i]);
+                    });
+                }
+            }
+            done += count;
+        }
+    }
+
+    // Camera::generate_ray directions: batches of one camera
+    void test_camera(InputGenerator& gen, size_t samples, const std::vector<SimdKernels::Isa>& isas,
+                     std::vector<Result>& results) {
+        Camera camera(Point3(0.0f, 0.0f, 0.0f), Point3(0.0f, 0.0f, -1.0f), Vector3(0, 1, 0), 60.0f, 1.0f);
+        std::vector<float> pixel_x, pixel_y;
+        SimdKernels::Vector3Batch output;
+        for (size_t done = 0; done < samples;) {
+            size_t count = gen.batch_length(samples - done);
+            // Orthonormal basis, or a degenerate or corrupted one
+            camera.forward = gen.unit();
+            camera.right = gen.perpendicular(camera.forward);
+            camera.camera_up = camera.right.cross(camera.forward);
+            if (gen.chance(0.05f)) camera.right = Vector3(0.0f, 0.0f, 0.0f);
+            camera.forward = gen.corrupt(camera.forward, 0.02f);
+            camera.right = gen.corrupt(camera.right, 0.02f);
+            camera.camera_up = gen.corrupt(camera.camera_up, 0.02f);
+            camera.field_of_view_degrees = gen.chance(0.1f) ? (gen.chance(0.5f) ? 1.0f : 179.0f) : gen.uniform(1.0f, 179.0f);
+            camera.aspect_ratio = gen.uniform(0.1f, 10.0f);
+            int width = gen.integer(1, 4096);
+            int height = gen.integer(1, 4096);
+
+            pixel_x.clear();
+            pixel_y.clear();
+            for (size_t i = 0; i < count; i++) {
+                float x = gen.uniform(-static_cast<float>(width), 2.0f * width);
+                float y = gen.uniform(-static_cast<float>(height), 2.0f * height);
+                if (gen.chance(0.2f)) {   // Image edges and centre
+                    static const float fractions[] = {0.0f, 0.5f, 1.0f};
+                    x = width * fractions[gen.integer(0, 2)];
+                    y = height * fractions[gen.integer(0, 2)];
+                }
+                if (gen.chance(0.03f)) x = gen.special();
+                if (gen.chance(0.03f)) y = gen.special();
+                pixel_x.push_back(x);
+                pixel_y.push_back(y);
+            }
+            for (size_t v = 0; v < isas.size(); v++) {
+                SimdKernels::camera_ray_directions(isas[v], camera, pixel_x, pixel_y, width, height, output);
+                for (size_t i = 0; i < count; i++) {
+                    Vector3 expected = camera.generate_ray(pixel_x[i], pixel_y[i], width, height).direction;
+                    compare_vectors(results[v], expected, output[i], exact_tolerance, [&]() {
+                        std::ostringstream inputs;
+                        inputs << std::setprecision(9) << "pixel (" << pixel_x[i] << ", " << pixel_y[i] << ") of " << width
+                               << "x" << height << ", fov " << camera.field_of_view_degrees << ", aspect "
+                               << camera.aspect_ratio;
+                        return inputs.str();
+                    });
+                }
+            }
+            done += count;
+        }
+    }
+
+} // namespace SimdDifferential
+
+int main(int argc, char* argv[]) {
+    using namespace SimdDifferential;
+    const char* usage = "Usage: simd_differential_test [--samples N] [--seed S]";
+    size_t samples = 1000000;
+    uint32_t seed = 20240607;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = static_cast<size_t>(std::max(1LL, std::atoll(argv[++i])));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cout << usage << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<SimdKernels::Isa> isas = SimdKernels::supported_isas();
+    std::cout << "=== SIMD Differential Test ===" << std::endl;
+    std::cout << "Samples per kernel: " << samples << ", seed: " << seed << ", variants:";
+    for (SimdKernels::Isa isa : isas) std::cout << " " << SimdKernels::isa_name(isa);
+    std::cout << std::endl;
+
+    struct Kernel {
+        const char* name;
+        void (*run)(InputGenerator&, size_t, const std::vector<SimdKernels::Isa>&, std::vector<Result>&);
+    };
+    const Kernel kernels[] = {
+        {"Sphere::intersect", test_spheres},
+        {"CookTorrance BRDF", test_cook_torrance},
+        {"Lambert scatter", test_lambert},
+        {"camera rays", test_camera},
+    };
+    std::vector<Result> all_results;
+    for (const Kernel& kernel : kernels) {
+        InputGenerator gen(seed);
+        std::vector<Result> results(isas.size());
+        for (size_t v = 0; v < isas.size(); v++) {
+            results[v].kernel = kernel.name;
+            results[v].isa = isas[v];
+        }
+        kernel.run(gen, samples, isas, results);
+        all_results.insert(all_results.end(), results.begin(), results.end());
+    }
+
+    std::cout << "\n" << std::left << std::setw(20) << "Kernel" << std::setw(10) << "Variant" << std::right
+              << std::setw(10) << "Compared" << std::setw(14) << "Max rel err" << std::setw(11) << "Tolerated"
+              << std::setw(10) << "Failures" << std::endl;
+    size_t failures = 0;
+    for (const Result& result : all_results) {
+        std::cout << std::left << std::setw(20) << result.kernel << std::setw(10) << SimdKernels::isa_name(result.isa)
+                  << std::right << std::setw(10) << result.compared << std::setw(14) << std::setprecision(3)
+                  << result.max_relative_error << std::setw(11) << result.tolerated << std::setw(10) << result.failures
+                  << std::endl;
+        failures += result.failures;
+    }
+    for (const Result& result : all_results) {
+        if (result.failures > 0) {
+            std::cout << "First " << result.kernel << " failure (" << SimdKernels::isa_name(result.isa) << "): "
+                      << result.first_failure << std::endl;
+        }
+    }
+    if (failures > 0) {
+        std::cout << "FAIL: " << failures << " lane result(s) differ from the scalar implementations" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: every variant matches the scalar implementations" << std::endl;
+    return 0;
+}
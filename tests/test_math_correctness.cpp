@@ -12,11 +12,35 @@
 #include "../src/lights/point_light.hpp"
 #include "../src/lights/directional_light.hpp"
 #include "../src/lights/area_light.hpp"
+#include "../src/lights/sphere_light.hpp"
 #include "../src/core/camera.hpp"
 #include "../src/core/image.hpp"
 #include "../src/materials/lambert.hpp"
 #include "../src/materials/cook_torrance.hpp"
+#include "../src/materials/openpbr.hpp"
+#include "../src/materials/material_graph.hpp"
 #include "../src/materials/material_base.hpp"
+#include "../src/core/checkerboard_renderer.hpp"
+#include "../src/core/image_metrics.hpp"
+#include "../src/core/path_guiding.hpp"
+#include "../src/core/path_tracer.hpp"
+#include "../src/core/huge_pages.hpp"
+#include "../src/core/metrics_exporter.hpp"
+#include "../src/core/time_series_recorder.hpp"
+#include "../src/core/cost_predictor.hpp"
+#include "../src/core/render_cache.hpp"
+#include "../src/core/renderer.hpp"
+#include "../src/core/primary_rasterizer.hpp"
+#include "../src/core/sort_last_renderer.hpp"
+#include "../src/core/cpu_budget.hpp"
+#include "../src/core/memory_planner.hpp"
+#include "../src/core/simd_kernels.hpp"
+#include "../src/core/cost_attribution.hpp"
+#include "../src/core/shadow_bundle.hpp"
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <thread>
 
 namespace MathematicalTests {
 
@@ -2515,6 +2539,2132 @@ sphere 2.0 0.0 -5.0 1.0 legacy_green
         return true;
     }
 
+    // === CHECKERBOARD SEQUENCE RENDERING TESTS ===
+
+    bool test_camera_project_to_pixel_round_trip() {
+        std::cout << "\n=== Camera Projection Round-Trip Tests ===" << std::endl;
+
+        Camera camera(Point3(0.5f, 0.2f, 1.0f), Point3(0, 0, -6), Vector3(0, 1, 0), 60.0f, 4.0f / 3.0f);
+        int width = 64, height = 48;
+
+        // generate_ray followed by project_to_pixel must return the original pixel
+        const float pixels[3][2] = {{0.0f, 0.0f}, {31.0f, 17.0f}, {63.0f, 47.0f}};
+        for (const auto& p : pixels) {
+            Ray ray = camera.generate_ray(p[0], p[1], width, height);
+            float px = -1.0f, py = -1.0f;
+            bool in_front = camera.project_to_pixel(ray.at(7.5f), width, height, px, py);
+            std::cout << "  Pixel (" << p[0] << ", " << p[1] << ") -> (" << px << ", " << py << ")" << std::endl;
+            assert(in_front);
+            assert(std::abs(px - p[0]) < 1e-3f && std::abs(py - p[1]) < 1e-3f);
+        }
+
+        // Points behind the camera cannot be projected
+        float px, py;
+        assert(!camera.project_to_pixel(Point3(0.5f, 0.2f, 5.0f), width, height, px, py));
+
+        std::cout << "  Camera projection round trip: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_checkerboard_static_camera_reconstruction() {
+        std::cout << "\n=== Checkerboard Temporal Reconstruction Tests ===" << std::endl;
+
+        Scene scene;
+        int red = scene.add_material(LambertMaterial(Vector3(0.7f, 0.3f, 0.3f)));
+        int blue = scene.add_material(LambertMaterial(Vector3(0.3f, 0.3f, 0.7f)));
+        scene.add_sphere(Sphere(Point3(0, 0, -4), 1.0f, red));
+        scene.add_sphere(Sphere(Point3(1.2f, 0.5f, -6), 1.0f, blue));
+        scene.add_light(std::make_unique<::PointLight>(Vector3(2, 2, -2), Vector3(1, 1, 1), 10.0f));
+
+        int width = 48, height = 36;
+        Camera camera(Point3(0, 0, 1), Point3(0, 0, -6), Vector3(0, 1, 0), 60.0f, 4.0f / 3.0f);
+
+        std::vector<Vector3> reference;
+        Renderer::render_frame(scene, camera, width, height, reference);
+
+        CheckerboardRenderer checkerboard(width, height);
+        std::vector<Vector3> frame;
+
+        // Frame 0: no history, half the rays, spatial reconstruction only
+        CheckerboardRenderer::FrameStatistics first = checkerboard.render_frame(scene, camera, frame);
+        first.print();
+        assert(first.traced_rays == width * height / 2);
+        assert(first.reprojected_pixels == 0);
+
+        // Frame 1 with a static camera: history holds exactly the missing half
+        CheckerboardRenderer::FrameStatistics second = checkerboard.render_frame(scene, camera, frame);
+        second.print();
+        assert(second.traced_rays == width * height / 2);
+        assert(second.reprojected_pixels + second.spatial_pixels == width * height - second.traced_rays);
+        assert(second.reprojected_pixels > second.spatial_pixels);
+
+        int exact_pixels = 0;
+        for (size_t i = 0; i < reference.size(); i++) {
+            Vector3 diff = frame[i] - reference[i];
+            if (std::abs(diff.x) < 1e-6f && std::abs(diff.y) < 1e-6f && std::abs(diff.z) < 1e-6f) {
+                exact_pixels++;
+            }
+        }
+        float exact_fraction = static_cast<float>(exact_pixels) / reference.size();
+        std::cout << "  Exact pixels vs full render: " << (exact_fraction * 100.0f) << "%" << std::endl;
+        assert(exact_fraction > 0.95f);
+
+        // Moving camera: every pixel is still accounted for at ~50% ray cost
+        camera.translate(Vector3(0.05f, 0, 0));
+        CheckerboardRenderer::FrameStatistics moving = checkerboard.render_frame(scene, camera, frame);
+        moving.print();
+        assert(std::abs(moving.ray_fraction() - 0.5f) < 0.01f);
+        assert(moving.reprojected_pixels > 0);
+
+        std::cout << "  Checkerboard reconstruction: PASSED" << std::endl;
+        return true;
+    }
+
+    // === GOLDEN-IMAGE METRIC TESTS ===
+
+    bool test_image_metrics_known_values() {
+        std::cout << "\n=== Image Metrics Known-Value Tests ===" << std::endl;
+
+        int width = 8, height = 8;
+        std::vector<Vector3> reference(width * height, Vector3(0.5f, 0.5f, 0.5f));
+
+        // Identical images: zero error, infinite PSNR
+        ImageMetrics identical = ImageMetrics::compare(reference, reference, width, height);
+        assert(identical.rmse == 0.0f && identical.max_error == 0.0f && identical.flip == 0.0f);
+        assert(std::isinf(identical.psnr_db));
+
+        // Uniform offset of 0.1: RMSE = 0.1, PSNR = 20*log10(1/0.1) = 20 dB, max error = 0.1
+        std::vector<Vector3> offset(width * height, Vector3(0.6f, 0.6f, 0.6f));
+        ImageMetrics uniform = ImageMetrics::compare(offset, reference, width, height);
+        std::cout << "  Uniform offset: RMSE=" << uniform.rmse << ", PSNR=" << uniform.psnr_db
+                  << " dB, FLIP=" << uniform.flip << std::endl;
+        assert(std::abs(uniform.rmse - 0.1f) < 1e-4f);
+        assert(std::abs(uniform.psnr_db - 20.0f) < 0.01f);
+        assert(std::abs(uniform.max_error - 0.1f) < 1e-4f);
+        assert(uniform.flip > 0.0f && uniform.flip < 1.0f);
+
+        // A single bright pixel: RMSE = sqrt(0.5^2 / 64) = 0.0625. FLIP is a mean over pixels, so the
+        // localized spike scores below a uniform offset of equal RMSE; max error is what exposes it
+        std::vector<Vector3> spike = reference;
+        spike[3 * width + 3] = Vector3(1.0f, 1.0f, 1.0f);
+        ImageMetrics spiked = ImageMetrics::compare(spike, reference, width, height);
+        assert(std::abs(spiked.rmse - 0.0625f) < 1e-4f);
+        assert(std::abs(spiked.max_error - 0.5f) < 1e-4f);
+        std::vector<Vector3> equal_rmse(width * height, Vector3(0.5625f, 0.5625f, 0.5625f));
+        ImageMetrics spread = ImageMetrics::compare(equal_rmse, reference, width, height);
+        std::cout << "  Spike vs equal-RMSE offset: FLIP=" << spiked.flip << " vs " << spread.flip
+                  << ", max error=" << spiked.max_error << " vs " << spread.max_error << std::endl;
+        assert(std::abs(spread.rmse - spiked.rmse) < 1e-4f);
+        assert(spiked.flip > 0.0f && spiked.flip < spread.flip);
+        assert(spiked.max_error > 4.0f * spread.max_error);
+
+        // Buffers of the wrong size are never read past their end: they compare as maximally different
+        std::vector<Vector3> short_image(width * height - 1, Vector3(0.5f, 0.5f, 0.5f));
+        for (const ImageMetrics& mismatch : {ImageMetrics::compare(short_image, reference, width, height),
+                                             ImageMetrics::compare(std::vector<Vector3>(), reference, width, height),
+                                             ImageMetrics::compare(reference, reference, width, height + 1)}) {
+            assert(std::isinf(mismatch.rmse) && std::isinf(mismatch.max_error));
+            assert(mismatch.psnr_db < 0.0f && mismatch.flip == 1.0f);
+        }
+
+        std::cout << "  Image metrics: PASSED" << std::endl;
+        return true;
+    }
+
+    // === PATH GUIDING TESTS ===
+
+    bool test_material_sampling_pdf_consistency() {
+        std::cout << "\n=== Material Importance Sampling Tests ===" << std::endl;
+
+        Vector3 normal(0.0f, 0.0f, 1.0f);
+        Vector3 wo = Vector3(0.3f, 0.1f, 1.0f).normalize();
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+        // Lambert: E[f cos / pdf] = albedo exactly (cosine sampling cancels the cosine term)
+        LambertMaterial lambert(Vector3(0.6f, 0.6f, 0.6f));
+        CookTorranceMaterial glossy(Vector3(0.8f, 0.8f, 0.8f), 0.3f, 1.0f, 0.04f);
+        const Material* materials[2] = {&lambert, &glossy};
+        for (const Material* material : materials) {
+            double estimate = 0.0;
+            int samples = 20000;
+            for (int i = 0; i < samples; i++) {
+                float pdf = 0.0f;
+                Vector3 wi = material->sample_direction(wo, normal, uniform(rng), uniform(rng), pdf);
+                assert(std::abs(wi.length() - 1.0f) < 1e-3f);
+                if (pdf <= 0.0f || normal.dot(wi) <= 0.0f) continue;
+                // Returned pdf must agree with the standalone density evaluation
+                float evaluated = material->sample_pdf(wi, wo, normal);
+                assert(std::abs(evaluated - pdf) <= 1e-3f * std::max(1.0f, pdf));
+                estimate += material->evaluate_brdf(wi, wo, normal, false).x * normal.dot(wi) / pdf;
+            }
+            estimate /= samples;
+            std::cout << "  " << material->material_type_name() << " directional albedo estimate: " << estimate << std::endl;
+            assert(estimate > 0.0 && estimate <= 1.05);
+            if (material == &lambert) assert(std::abs(estimate - 0.6) < 1e-3);
+        }
+
+        std::cout << "  Material sampling: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_directional_quadtree_distribution() {
+        std::cout << "\n=== Directional Quadtree Distribution Tests ===" << std::endl;
+
+        // Canonical mapping round trip
+        Vector3 direction = Vector3(0.2f, -0.7f, 0.4f).normalize();
+        float u, v;
+        PathGuiding::direction_to_canonical(direction, u, v);
+        Vector3 mapped = PathGuiding::canonical_to_direction(u, v);
+        assert((mapped - direction).length() < 1e-4f);
+
+        // Concentrate energy in the cell u,v in [0.5,0.625) x [0.25,0.375)
+        PathGuiding::DirectionalQuadtree building;
+        for (int i = 0; i < 200; i++) building.record(0.55f, 0.3f, 1.0f);
+        building.record(0.1f, 0.9f, 1.0f);
+        PathGuiding::DirectionalQuadtree refined = building.refined(0.01f, 8);
+        assert(refined.node_count() > 1 && refined.total_energy() == 0.0f);
+        for (int i = 0; i < 200; i++) refined.record(0.55f, 0.3f, 1.0f);
+        refined.record(0.1f, 0.9f, 1.0f);
+
+        // pdf integrates to 1 over the unit square (midpoint quadrature)
+        int grid = 256;
+        double integral = 0.0, hot_mass = 0.0;
+        for (int j = 0; j < grid; j++) {
+            for (int i = 0; i < grid; i++) {
+                float cu = (i + 0.5f) / grid, cv = (j + 0.5f) / grid;
+                double mass = refined.pdf(cu, cv) / (grid * grid);
+                integral += mass;
+                if (cu >= 0.5f && cu < 0.625f && cv >= 0.25f && cv < 0.375f) hot_mass += mass;
+            }
+        }
+        std::cout << "  pdf integral: " << integral << ", hot cell mass: " << hot_mass << std::endl;
+        assert(std::abs(integral - 1.0) < 1e-3);
+        assert(hot_mass > 0.9);
+
+        // Sample frequencies follow the pdf
+        std::mt19937 rng(3);
+        int samples = 20000, hot_samples = 0;
+        for (int i = 0; i < samples; i++) {
+            float su, sv;
+            refined.sample(rng, su, sv);
+            assert(su >= 0.0f && su <= 1.0f && sv >= 0.0f && sv <= 1.0f);
+            assert(refined.pdf(su, sv) > 0.0f);
+            if (su >= 0.5f && su < 0.625f && sv >= 0.25f && sv < 0.375f) hot_samples++;
+        }
+        assert(std::abs(static_cast<double>(hot_samples) / samples - hot_mass) < 0.02);
+
+        // Empty tree is uniform
+        PathGuiding::DirectionalQuadtree empty;
+        assert(std::abs(empty.pdf(0.3f, 0.7f) - 1.0f) < 1e-6f);
+
+        std::cout << "  Directional quadtree: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_sdtree_merge_and_refine() {
+        std::cout << "\n=== SD-Tree Training Tests ===" << std::endl;
+
+        PathGuiding::SDTree::Settings settings;
+        settings.spatial_threshold = 100;
+        PathGuiding::SDTree tree(Vector3(-1, -1, -1), Vector3(1, 1, 1), settings);
+        Vector3 up(0.0f, 0.0f, 1.0f);
+
+        // Per-thread recorders merged into one tree; nothing is sampled before the first refine
+        PathGuiding::GuidingRecorder first, second;
+        for (int i = 0; i < 150; i++) {
+            float x = -0.9f + 1.8f * (i % 15) / 14.0f;
+            first.record(Vector3(x, 0.1f, 0.1f), up, 1.0f);
+            second.record(Vector3(x, -0.1f, -0.1f), up, 1.0f);
+        }
+        tree.merge(first);
+        tree.merge(second);
+        assert(!tree.is_trained(Vector3(0, 0, 0)));
+        assert(tree.spatial_leaf_count() == 1);
+
+        tree.refine();
+        assert(tree.iteration_count() == 1);
+        assert(tree.spatial_leaf_count() > 1);  // 300 records > threshold 100: leaf split
+        assert(tree.is_trained(Vector3(0.5f, 0.1f, 0.1f)));
+
+        // Learned distribution favours the recorded direction; density is per steradian
+        float pdf_up = tree.pdf(Vector3(0.5f, 0.1f, 0.1f), up);
+        float pdf_down = tree.pdf(Vector3(0.5f, 0.1f, 0.1f), Vector3(0.0f, 0.0f, -1.0f));
+        assert(pdf_up > 1.0f / (4.0f * static_cast<float>(M_PI)));
+        assert(pdf_down < pdf_up);
+
+        std::mt19937 rng(11);
+        float pdf = 0.0f;
+        Vector3 sampled = tree.sample(Vector3(0.5f, 0.1f, 0.1f), rng, pdf);
+        assert(std::abs(sampled.length() - 1.0f) < 1e-4f);
+        assert(std::abs(pdf - tree.pdf(Vector3(0.5f, 0.1f, 0.1f), sampled)) < 1e-3f * pdf);
+
+        std::cout << "  SD-tree: " << tree.spatial_leaf_count() << " leaves, PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_path_tracer_multithreaded_render() {
+        std::cout << "\n=== Path Tracer Multithreaded Render Tests ===" << std::endl;
+
+        Scene scene;
+        int floor_material = scene.add_material(LambertMaterial(Vector3(0.7f, 0.7f, 0.7f)));
+        int ball_material = scene.add_material(LambertMaterial(Vector3(0.7f, 0.3f, 0.3f)));
+        scene.add_sphere(Sphere(Point3(0, -101, -5), 100.0f, floor_material, false));
+        scene.add_sphere(Sphere(Point3(0, 0, -5), 1.0f, ball_material, false));
+        scene.add_light(std::make_unique<PointLight>(Vector3(2, 3, -3), Vector3(1, 1, 1), 4.0f));
+        Camera camera(Point3(0, 0, 1), Point3(0, 0, -6), Vector3(0, 1, 0), 60.0f, 4.0f / 3.0f);
+        int width = 24, height = 18;
+
+        // Without guiding, per-row seeding makes the image independent of thread count
+        PathTracer::Settings settings;
+        settings.samples_per_pixel = 4;
+        settings.max_bounces = 3;
+        settings.thread_count = 1;
+        std::vector<Vector3> single_thread, multi_thread;
+        PathTracer(scene, settings).render(camera, width, height, single_thread);
+        settings.thread_count = 3;
+        PathTracer::Statistics stats = PathTracer(scene, settings).render(camera, width, height, multi_thread);
+        assert(stats.passes == 4 && stats.paths == 4LL * width * height);
+        for (size_t i = 0; i < single_thread.size(); i++) {
+            assert((single_thread[i] - multi_thread[i]).length() < 1e-6f);
+        }
+
+        // Indirect light brightens the image relative to direct lighting alone
+        std::vector<Vector3> direct;
+        Renderer::render_frame(scene, camera, width, height, direct);
+        double direct_sum = 0.0, path_sum = 0.0;
+        for (size_t i = 0; i < direct.size(); i++) {
+            direct_sum += direct[i].x;
+            path_sum += single_thread[i].x;
+        }
+        assert(path_sum > direct_sum);
+
+        // Guided rendering trains the tree across passes and stays finite
+        settings.path_guiding = true;
+        settings.samples_per_pixel = 4;
+        settings.guiding.spatial_threshold = 200;
+        PathTracer guided(scene, settings);
+        std::vector<Vector3> guided_pixels;
+        PathTracer::Statistics guided_stats = guided.render(camera, width, height, guided_pixels);
+        assert(guided.guiding() != nullptr && guided.guiding()->iteration_count() == 3);  // after passes 1, 2, 4
+        assert(guided_stats.guided_samples > 0);
+        for (const Vector3& pixel : guided_pixels) assert(pixel.is_finite());
+
+        std::cout << "  Path tracer: " << guided_stats.guided_samples << " guided / " << guided_stats.brdf_samples
+                  << " BRDF bounces, PASSED" << std::endl;
+        return true;
+    }
+
+    // === LEVEL-OF-DETAIL BVH TESTS ===
+
+    bool test_lod_bvh_exact_matches_linear() {
+        std::cout << "\n=== BVH Exact Traversal vs Linear Intersection ===" << std::endl;
+
+        Scene scene;
+        scene.add_material(LambertMaterial(Vector3(0.7f, 0.3f, 0.3f)));
+        scene.add_material(LambertMaterial(Vector3(0.3f, 0.3f, 0.7f)));
+        std::mt19937 rng(105);
+        std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+        std::uniform_real_distribution<float> size(0.05f, 0.6f);
+        for (int i = 0; i < 300; i++) {
+            scene.primitives.push_back(Sphere(Point3(position(rng), position(rng), position(rng) - 10.0f), size(rng), i % 2));
+        }
+        scene.build_bvh();
+        assert(scene.bvh && scene.bvh->node_count() > 1);
+
+        // Closest hits must agree exactly for rays from inside and outside the cluster
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        int hits = 0;
+        for (int i = 0; i < 2000; i++) {
+            Point3 origin = (i % 2 == 0) ? Point3(0, 0, 2) : Point3(position(rng), position(rng), position(rng) - 10.0f);
+            Ray ray(origin, Vector3(direction(rng), direction(rng), direction(rng) - 0.5f).normalize());
+            Scene::Intersection bvh_hit = scene.intersect(ray, RayCone(), 0.0f);
+            std::unique_ptr<LodBVH> saved = std::move(scene.bvh);
+            Scene::Intersection linear_hit = scene.intersect(ray, false);
+            scene.bvh = std::move(saved);
+            assert(bvh_hit.hit == linear_hit.hit);
+            if (linear_hit.hit) {
+                hits++;
+                assert(bvh_hit.primitive == linear_hit.primitive);
+                assert(std::abs(bvh_hit.t - linear_hit.t) < 1e-5f);
+            }
+        }
+        std::cout << "  2000 rays, " << hits << " hits: BVH and linear results identical" << std::endl;
+
+        // Adding a sphere invalidates the BVH
+        scene.add_sphere(Sphere(Point3(0, 0, -3), 0.5f, 0, false));
+        assert(!scene.bvh);
+
+        std::cout << "  BVH exact traversal: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_lod_bvh_distant_cluster_proxies() {
+        std::cout << "\n=== BVH Level-of-Detail Proxy Tests ===" << std::endl;
+
+        // Dense cluster of 1000 small spheres 200 units away (half blue, half white by area)
+        Scene scene;
+        scene.add_material(LambertMaterial(Vector3(0.2f, 0.2f, 0.8f)));
+        scene.add_material(LambertMaterial(Vector3(0.8f, 0.8f, 0.8f)));
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+        for (int i = 0; i < 1000; i++) {
+            scene.primitives.push_back(Sphere(Point3(offset(rng), offset(rng), -200.0f + offset(rng)), 0.02f, i % 2));
+        }
+        scene.build_bvh();
+
+        // Root proxy: bounding sphere contains every member; averaged color is the area-weighted mean
+        Vector3 root_center = scene.bvh->proxy_center(0);
+        for (const Sphere& sphere : scene.primitives) {
+            Vector3 c(sphere.center.x, sphere.center.y, sphere.center.z);
+            assert((c - root_center).length() + sphere.radius <= scene.bvh->proxy_radius(0) + 1e-4f);
+        }
+        Vector3 average = scene.bvh->proxy_material(0).base_color;
+        assert(std::abs(average.x - 0.5f) < 1e-4f && std::abs(average.z - 0.8f) < 1e-4f);
+
+        // Camera at 512x384: the whole cluster spans ~7 pixels, each member ~0.07 pixels
+        int width = 512, height = 384;
+        Camera camera(Point3(0, 0, 1), Point3(0, 0, -200), Vector3(0, 1, 0), 60.0f, static_cast<float>(width) / height);
+        RayCone cone(0.0f, camera.pixel_spread_angle(height));
+        assert(std::abs(cone.spread_angle - 2.0f * std::tan(static_cast<float>(M_PI) / 6.0f) / height) < 1e-7f);
+
+        auto trace_cluster = [&](float lod_error, int& proxy_hits, int& coverage) {
+            scene.reset_statistics();
+            long long proxies_before = scene.bvh->proxy_hits;
+            coverage = 0;
+            for (int y = height / 2 - 8; y < height / 2 + 8; y++) {
+                for (int x = width / 2 - 8; x < width / 2 + 8; x++) {
+                    Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                    Scene::Intersection hit = scene.intersect(ray, cone, lod_error);
+                    if (hit.hit) coverage++;
+                    if (hit.hit && lod_error == 0.0f) assert(hit.primitive != nullptr);
+                }
+            }
+            proxy_hits = static_cast<int>(scene.bvh->proxy_hits - proxies_before);
+            return scene.total_intersection_tests.load();
+        };
+
+        int exact_proxies, exact_coverage, lod_proxies, lod_coverage, coarse_proxies, coarse_coverage;
+        int exact_tests = trace_cluster(0.0f, exact_proxies, exact_coverage);
+        int lod_tests = trace_cluster(1.0f, lod_proxies, lod_coverage);
+        int coarse_tests = trace_cluster(16.0f, coarse_proxies, coarse_coverage);
+        std::cout << "  Exact: " << exact_tests << " sphere tests, " << exact_coverage << " pixels covered" << std::endl;
+        std::cout << "  1 px threshold: " << lod_tests << " sphere tests, " << lod_proxies << " proxy hits, "
+                  << lod_coverage << " pixels covered" << std::endl;
+        std::cout << "  16 px threshold: " << coarse_tests << " sphere tests, " << coarse_proxies << " proxy hits" << std::endl;
+
+        assert(exact_proxies == 0);
+        assert(lod_proxies > 0 && lod_tests < exact_tests);
+        // Whole cluster below 16 pixels: a single proxy per ray, no exact sphere tests at all
+        assert(coarse_tests == 0 && coarse_proxies == coarse_coverage);
+        // Proxies only cover where the cluster's bounding spheres are: coverage cannot shrink
+        assert(lod_coverage >= exact_coverage);
+
+        std::cout << "  LOD proxies: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_lazy_bvh_matches_eager_and_expands_on_demand() {
+        std::cout << "\n=== Lazy BVH Construction Tests ===" << std::endl;
+
+        // Two clusters of 2000 spheres, left and right of the camera axis
+        Scene scene;
+        scene.add_material(LambertMaterial(Vector3(0.7f, 0.3f, 0.3f)));
+        std::mt19937 rng(109);
+        std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+        for (int i = 0; i < 4000; i++) {
+            float side = (i % 2 == 0) ? -10.0f : 10.0f;
+            scene.primitives.push_back(Sphere(Point3(side + offset(rng), offset(rng), -20.0f + offset(rng)), 0.1f, 0));
+        }
+        scene.build_bvh();
+        LodBVH& eager = *scene.bvh;
+        LodBVH lazy(scene.primitives, scene.materials, true, 2);
+        assert(!eager.lazy() && lazy.lazy());
+        assert(eager.expanded_node_count() == eager.interior_node_count());
+        assert(lazy.node_count() == eager.node_count());
+        assert(lazy.expanded_node_count() == 3);   // Eager depth 2: root and its two children
+
+        // Rays into the left cluster only: the right cluster's subtrees stay unexpanded
+        Camera camera(Point3(0, 0, 0), Point3(-10, 0, -20), Vector3(0, 1, 0), 30.0f, 1.0f);
+        int lazy_tests = 0, eager_tests = 0, hits = 0;
+        auto same_hit = [&](const Ray& ray) {
+            LodBVH::Hit a = lazy.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, lazy_tests);
+            LodBVH::Hit b = eager.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, eager_tests);
+            return a.hit == b.hit && (!a.hit || (a.primitive_index == b.primitive_index && a.t == b.t));
+        };
+        for (int y = 0; y < 32; y++) {
+            for (int x = 0; x < 32; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), 32, 32);
+                assert(same_hit(ray));
+                hits += eager.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, eager_tests).hit ? 1 : 0;
+            }
+        }
+        int left_only = lazy.expanded_node_count();
+        std::cout << "  1024 rays into one cluster (" << hits << " hits): " << left_only << " of "
+                  << lazy.interior_node_count() << " interior nodes expanded" << std::endl;
+        assert(hits > 0);
+        assert(left_only > 3 && left_only < lazy.interior_node_count() / 2 + 3);
+
+        // Concurrent first traversal of a fresh lazy tree: each node is built once, results match
+        LodBVH shared(scene.primitives, scene.materials, true, 1);
+        std::vector<std::thread> workers;
+        std::atomic<int> mismatches{0};
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([&, t]() {
+                std::mt19937 thread_rng(1000 + t);
+                std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+                int tests = 0, reference_tests = 0;
+                for (int i = 0; i < 500; i++) {
+                    Ray ray(Point3(0, 0, 0), Vector3(direction(thread_rng), 0.2f * direction(thread_rng), -1.0f).normalize());
+                    LodBVH::Hit a = shared.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, tests);
+                    LodBVH::Hit b = eager.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, reference_tests);
+                    if (a.hit != b.hit || (a.hit && a.primitive_index != b.primitive_index)) mismatches++;
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        std::cout << "  4 threads x 500 rays on a fresh lazy tree: " << mismatches.load() << " mismatches, "
+                  << shared.expanded_node_count() << " nodes expanded" << std::endl;
+        assert(mismatches.load() == 0);
+        assert(shared.expanded_node_count() <= shared.interior_node_count());
+
+        // Huge-page rehoming copies expanded and unexpanded slots alike
+        HugePages::Statistics stats;
+        lazy.use_huge_pages(stats);
+        for (int i = 0; i < 200; i++) {
+            Ray ray(Point3(0, 0, 0), Vector3(0.5f - i * 0.005f, 0.0f, -1.0f).normalize());
+            assert(same_hit(ray));
+        }
+
+        std::cout << "  Lazy BVH construction: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_stackless_bvh_traversal_matches_stack() {
+        std::cout << "\n=== Stackless BVH Traversal ===" << std::endl;
+
+        Scene scene;
+        scene.add_material(LambertMaterial(Vector3(0.6f, 0.6f, 0.6f)));
+        std::mt19937 rng(111);
+        std::uniform_real_distribution<float> position(-6.0f, 6.0f);
+        std::uniform_real_distribution<float> size(0.05f, 0.5f);
+        for (int i = 0; i < 700; i++) {
+            scene.primitives.push_back(Sphere(Point3(position(rng), position(rng), position(rng) - 12.0f), size(rng), 0));
+        }
+        LodBVH eager(scene.primitives, scene.materials);
+        LodBVH lazy(scene.primitives, scene.materials, true, 1);   // Parent links appear as nodes expand
+
+        // Rays from outside and inside the cloud; LOD cone for the proxy variant
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        std::vector<Ray> rays;
+        for (int i = 0; i < 1500; i++) {
+            Point3 origin = (i % 3 == 0) ? Point3(0, 0, 3) : Point3(position(rng), position(rng), position(rng) - 12.0f);
+            rays.push_back(Ray(origin, Vector3(direction(rng), direction(rng), direction(rng) - 0.3f).normalize()));
+        }
+        RayCone cone(0.0f, 0.01f);
+        int tests = 0;
+        auto same = [](const LodBVH::Hit& a, const LodBVH::Hit& b) {
+            return a.hit == b.hit && (!a.hit || (a.primitive_index == b.primitive_index && a.t == b.t));
+        };
+
+        eager.node_visits = 0;
+        std::vector<LodBVH::Hit> reference;
+        for (const Ray& ray : rays) reference.push_back(eager.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, tests));
+        long long stack_visits = eager.node_visits.exchange(0);
+        for (size_t i = 0; i < rays.size(); i++) {
+            assert(same(reference[i], eager.intersect_stackless(rays[i], RayCone(), 0.0f, scene.primitives, scene.materials, tests)));
+            assert(same(reference[i], lazy.intersect_stackless(rays[i], RayCone(), 0.0f, scene.primitives, scene.materials, tests)));
+            LodBVH::Hit lod_stack = eager.intersect(rays[i], cone, 2.0f, scene.primitives, scene.materials, tests);
+            LodBVH::Hit lod_stackless = eager.intersect_stackless(rays[i], cone, 2.0f, scene.primitives, scene.materials, tests);
+            assert(lod_stack.hit == lod_stackless.hit && lod_stack.t == lod_stackless.t);
+        }
+
+        // Same child order: the exact passes visit exactly the same nodes
+        eager.node_visits = 0;
+        for (const Ray& ray : rays) eager.intersect_stackless(ray, RayCone(), 0.0f, scene.primitives, scene.materials, tests);
+        assert(eager.node_visits.load() == stack_visits);
+
+        // Wide batches: both cursor kinds agree with single-ray traversal
+        std::vector<LodBVH::Hit> batch_stack, batch_stackless;
+        eager.intersect_batch(rays, LodBVH::Traversal::Stack, scene.primitives, scene.materials, batch_stack, tests);
+        eager.intersect_batch(rays, LodBVH::Traversal::Stackless, scene.primitives, scene.materials, batch_stackless, tests);
+        for (size_t i = 0; i < rays.size(); i++) {
+            assert(same(reference[i], batch_stack[i]) && same(reference[i], batch_stackless[i]));
+        }
+
+        size_t stack_bytes = LodBVH::traversal_state_bytes(LodBVH::Traversal::Stack);
+        size_t stackless_bytes = LodBVH::traversal_state_bytes(LodBVH::Traversal::Stackless);
+        std::cout << "  " << rays.size() << " rays, " << static_cast<double>(stack_visits) / rays.size()
+                  << " node visits/ray; state per in-flight ray: " << stack_bytes << " bytes (stack) vs "
+                  << stackless_bytes << " bytes (stackless)" << std::endl;
+        assert(stackless_bytes == 2 * sizeof(int) && stack_bytes > 30 * stackless_bytes);
+
+        std::cout << "  Stackless traversal: PASSED" << std::endl;
+        return true;
+    }
+
+    // === HUGE PAGE TESTS ===
+
+    bool test_huge_page_rehome() {
+        std::cout << "\n=== Huge Page Buffer Re-homing ===" << std::endl;
+
+        HugePages::Statistics stats;
+        stats.enabled = true;
+
+        // 12 MB framebuffer: contents survive the move; advised range is whole 2 MB pages inside the data
+        std::vector<Vector3> pixels(1024 * 1024);
+        for (size_t i = 0; i < pixels.size(); i++) pixels[i] = Vector3(static_cast<float>(i), 0.5f, -1.0f);
+        HugePages::rehome(pixels, "pixels", stats);
+        assert(pixels.size() == 1024 * 1024);
+        for (size_t i = 0; i < pixels.size(); i += 4097) {
+            assert(pixels[i].x == static_cast<float>(i) && pixels[i].y == 0.5f && pixels[i].z == -1.0f);
+        }
+        const HugePages::Buffer& large = stats.buffers[0];
+        assert(large.data == pixels.data() && large.bytes == pixels.size() * sizeof(Vector3));
+        assert(large.advised_bytes <= large.bytes);
+        size_t resident = HugePages::resident_huge_bytes(large.data, large.bytes);
+        assert(resident <= large.bytes);
+#ifdef __linux__
+        // At most the partial page before the first 2 MB boundary is left out
+        if (large.advised_bytes > 0) {
+            assert(large.advised_bytes + HugePages::huge_page_size > large.bytes);
+        }
+#endif
+        std::cout << "  12 MB buffer: advised " << large.advised_bytes / 1024 << " KB, huge-page backed "
+                  << resident / 1024 << " KB" << std::endl;
+
+        // Buffers below one huge page are left in place
+        std::vector<int> small(1000, 7);
+        const int* original = small.data();
+        HugePages::rehome(small, "small", stats);
+        assert(small.data() == original && stats.buffers[1].advised_bytes == 0);
+
+        // Counter degrades to -1 without perf events, otherwise counts misses
+        HugePages::TlbMissCounter counter;
+        counter.start();
+        long long misses = counter.stop();
+        assert(counter.available() ? misses >= 0 : misses == -1);
+
+        std::cout << "  Huge page re-homing: PASSED" << std::endl;
+        return true;
+    }
+
+    // === METRICS EXPORT TESTS ===
+
+    bool test_metrics_exporter_textfile() {
+        std::cout << "\n=== Prometheus Textfile Metrics Export ===" << std::endl;
+
+        std::string path = "test_metrics_export.prom";
+        MetricsExporter exporter(path, 3600.0);
+        MetricsExporter::Snapshot snapshot;
+        snapshot.rays["primary"] = 1000;
+        snapshot.rays["indirect"] = 2500;
+        snapshot.intersection_tests = 42000;
+        snapshot.tiles_done = 30;
+        snapshot.tiles_total = 120;
+        snapshot.eta_seconds = 12.5;
+        snapshot.samples_per_pixel = 16;
+        snapshot.samples_per_pixel_done = 4;
+        snapshot.thread_utilization = {0.95, 1.7};
+
+        // First update always writes; later updates wait for the interval
+        exporter.update(snapshot);
+        assert(exporter.writes() == 1);
+        snapshot.tiles_done = 60;
+        exporter.update(snapshot);
+        assert(exporter.writes() == 1);
+
+        auto read_file = [](const std::string& file_path) {
+            std::ifstream file(file_path);
+            std::stringstream contents;
+            contents << file.rdbuf();
+            return contents.str();
+        };
+        std::string text = read_file(path);
+        assert(text.find("# TYPE raytracer_rays_total counter") != std::string::npos);
+        assert(text.find("raytracer_rays_total{type=\"primary\"} 1000\n") != std::string::npos);
+        assert(text.find("raytracer_rays_total{type=\"indirect\"} 2500\n") != std::string::npos);
+        assert(text.find("raytracer_intersection_tests_total 42000\n") != std::string::npos);
+        assert(text.find("raytracer_tiles_done 30\n") != std::string::npos);
+        assert(text.find("raytracer_tiles_remaining 90\n") != std::string::npos);
+        assert(text.find("raytracer_eta_seconds 12.5\n") != std::string::npos);
+        assert(text.find("raytracer_thread_utilization_ratio{thread=\"1\"} 1\n") != std::string::npos);
+        assert(text.find("raytracer_samples_per_pixel 16\n") != std::string::npos);
+        assert(text.find("raytracer_render_active 1\n") != std::string::npos);
+        assert(text.find("raytracer_resident_memory_bytes ") != std::string::npos);
+
+        // Every sample line belongs to a declared metric family
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::string family = line.substr(0, line.find_first_of("{ "));
+            assert(text.find("# TYPE " + family + " ") != std::string::npos);
+        }
+
+        // Final write: inactive, no ETA, temporary file renamed away
+        exporter.finish(snapshot);
+        assert(exporter.writes() == 2);
+        text = read_file(path);
+        assert(text.find("raytracer_render_active 0\n") != std::string::npos);
+        assert(text.find("raytracer_eta_seconds 0\n") != std::string::npos);
+        assert(text.find("raytracer_tiles_done 60\n") != std::string::npos);
+        assert(!std::ifstream(path + ".tmp").good());
+        std::remove(path.c_str());
+
+        // Unwritable location: reported once, never throws
+        MetricsExporter broken("no_such_directory/metrics.prom", 0.001);
+        assert(!broken.write(snapshot, true));
+        broken.update(snapshot);
+        assert(broken.writes() == 0);
+
+        std::cout << "  Metrics export: PASSED" << std::endl;
+        return true;
+    }
+
+    // === COST PREDICTION TESTS ===
+
+    bool test_cost_predictor_extrapolation() {
+        std::cout << "\n=== Render Cost Prediction from Pre-sampling ===" << std::endl;
+
+        // Synthetic kernel: the bottom quarter of the image is 20× more expensive than the rest
+        int width = 160, height = 120;
+        CostPredictor predictor(width, height, CostPredictor::Settings());
+        volatile float sink = 0.0f;
+        std::vector<int> visited(static_cast<size_t>(width) * height, 0);
+        predictor.sample([&](int x, int y) {
+            visited[static_cast<size_t>(y) * width + x]++;
+            int iterations = y >= height * 3 / 4 ? 20000 : 1000;
+            for (int i = 0; i < iterations; i++) sink = sink + std::sqrt(static_cast<float>(i));
+        });
+
+        // 1% stratified: one pixel in every 10×10 block
+        assert(predictor.sampled_pixels() == 16 * 12);
+        for (int by = 0; by < 12; by++) {
+            for (int bx = 0; bx < 16; bx++) {
+                int count = 0;
+                for (int y = by * 10; y < by * 10 + 10; y++)
+                    for (int x = bx * 10; x < bx * 10 + 10; x++) count += visited[static_cast<size_t>(y) * width + x];
+                assert(count == 1);
+            }
+        }
+
+        std::map<std::string, size_t> memory = {{"framebuffer", 1000}, {"scene", 24}};
+        CostPredictor::Prediction single = predictor.predict(4, 1, memory);
+        assert(single.estimate_seconds > 0.0);
+        assert(single.lower_seconds <= single.estimate_seconds && single.estimate_seconds <= single.upper_seconds);
+        assert(std::abs(single.estimate_seconds - single.single_thread_seconds) < 1e-12);
+        assert(std::abs(single.single_thread_seconds - 4.0 * width * height * single.mean_pixel_ns * 1e-9) < 1e-9);
+        assert(single.total_memory_bytes() == 1024);
+
+        // More threads divide the work but never beat the costliest scanline
+        CostPredictor::Prediction threaded = predictor.predict(4, 8, memory);
+        assert(threaded.estimate_seconds < single.estimate_seconds);
+        assert(threaded.estimate_seconds >= single.estimate_seconds / 8.0 - 1e-12);
+
+        // Cost map: expensive bottom rows are scheduled first
+        std::vector<int> order = predictor.scanline_order();
+        assert(static_cast<int>(order.size()) == height);
+        for (int i = 0; i < height / 4; i++) {
+            assert(order[i] >= height * 3 / 4);
+        }
+
+        std::string json = single.to_json();
+        assert(json.find("\"render_seconds\": {\"estimate\": ") != std::string::npos);
+        assert(json.find("\"confidence_95\": [") != std::string::npos);
+        assert(json.find("\"memory_bytes\": {\"total\": 1024, \"framebuffer\": 1000, \"scene\": 24}") != std::string::npos);
+        assert(json.front() == '{' && json.find_last_of('}') == json.size() - 2);
+
+        std::cout << "  Predicted " << single.estimate_seconds * 1000.0 << " ms (95% CI " << single.lower_seconds * 1000.0
+                  << " - " << single.upper_seconds * 1000.0 << " ms), 8 threads: " << threaded.estimate_seconds * 1000.0 << " ms" << std::endl;
+        std::cout << "  Cost prediction: PASSED" << std::endl;
+        return true;
+    }
+
+    bool test_path_tracer_scanline_order_invariance() {
+        std::cout << "\n=== Path Tracer Scanline Scheduling Order ===" << std::endl;
+
+        Scene scene;
+        int material = scene.add_material(LambertMaterial(Vector3(0.6f, 0.6f, 0.6f)));
+        scene.add_sphere(Sphere(Point3(0, 0, -3), 1.0f, material, false));
+        scene.add_sphere(Sphere(Point3(0, -101, -3), 100.0f, material, false));
+        scene.add_light(std::make_unique<PointLight>(Vector3(2, 3, -1), Vector3(1, 1, 1), 10.0f));
+        Camera camera(Point3(0, 0, 0), Point3(0, 0, -3), Vector3(0, 1, 0), 45.0f, 1.0f);
+
+        PathTracer::Settings settings;
+        settings.samples_per_pixel = 2;
+        settings.max_bounces = 2;
+        settings.thread_count = 2;
+        std::vector<Vector3> top_down, scheduled;
+        PathTracer(scene, settings).render(camera, 24, 24, top_down);
+
+        // Any permutation of scanlines renders the same image: RNG streams are seeded per (pass, row)
+        for (int y = 23; y >= 0; y--) settings.scanline_order.push_back((y * 7) % 24);
+        PathTracer(scene, settings).render(camera, 24, 24, scheduled);
+        for (size_t i = 0; i < top_down.size(); i++) {
+            assert((top_down[i] - scheduled[i]).length() < 1e-6f);
+        }
+
+        std::cout << "  Scanline order invariance: PASSED" << std::endl;
+        return true;
+    }
+
+    // === RENDER CACHE TESTS ===
+
+    bool test_render_cache_images_and_tiles() {
+        std::cout << "\n=== Content-Addressed Render Cache ===" << std::endl;
+
+        // Keys are 128-bit FNV-1a (reference test vectors)
+        assert(RenderCache::hash_hex("") == "6c62272e07bb014262b821756295c58d");
+        assert(RenderCache::hash_hex("a") == "d228cb696f1a8caf78912b704e4a8964");
+        assert(RenderCache::hash_hex("foobar") == "343e1662793c64bf6f0d3597ba446f18");
+
+        // Randomly sampled lights make a render one noise realization among many: not cacheable
+        Scene sampled;
+        assert(RenderCache::deterministic(sampled));
+        sampled.lights.push_back(std::make_unique<PointLight>(Vector3(0, 4, 0), Vector3(1, 1, 1), 10.0f));
+        assert(RenderCache::deterministic(sampled));
+        sampled.lights.push_back(std::make_unique<SphereLight>(Vector3(0, 4, 0), 0.5f, Vector3(1, 1, 1), 10.0f));
+        assert(!RenderCache::deterministic(sampled));
+
+        std::string directory = "test_render_cache_dir";
+        std::filesystem::remove_all(directory);
+        auto make_scene = [](float moved_x) {
+            Scene scene;
+            scene.add_material(LambertMaterial(Vector3(0.8f, 0.2f, 0.2f)));
+            scene.add_material(LambertMaterial(Vector3(0.2f, 0.2f, 0.8f)));
+            scene.primitives.push_back(Sphere(Point3(-1.5f, 0.0f, -5.0f), 1.0f, 0));
+            scene.primitives.push_back(Sphere(Point3(1.5f, 0.0f, -5.0f), 1.0f, 1));
+            scene.primitives.push_back(Sphere(Point3(moved_x, 1.2f, -4.0f), 0.3f, 1));
+            scene.primitives.push_back(Sphere(Point3(0.0f, -101.0f, -5.0f), 100.0f, 0));
+            scene.lights.push_back(std::make_unique<PointLight>(Vector3(4.0f, 4.0f, -2.0f), Vector3(1, 1, 1), 20.0f));
+            return scene;
+        };
+        int width = 96, height = 64;
+        Camera camera(Point3(0, 0, 1), Point3(0, 0, -5), Vector3(0, 1, 0), 60.0f, static_cast<float>(width) / height);
+
+        // Same loop as main.cpp: skip reused tiles, record hit points of traced pixels
+        auto render = [&](const Scene& scene, RenderCache& cache, std::vector<Vector3>& pixels) {
+            pixels.assign(static_cast<size_t>(width) * height, Vector3(0, 0, 0));
+            int reused = cache.prepare_tiles(scene, camera, width, height, "direct", pixels);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    if (cache.tile_reused(x, y)) continue;
+                    Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                    Scene::Intersection hit = scene.intersect(ray, false);
+                    if (hit.hit) cache.record_hit(x, y, hit.point);
+                    pixels[static_cast<size_t>(y) * width + x] = Renderer::clamp_color(Renderer::trace_primary(scene, ray, camera.position));
+                }
+            }
+            cache.store_tiles(scene, pixels);
+            return reused;
+        };
+
+        // Equal content gives equal keys; any change in scene or options gives a new key
+        Scene original = make_scene(0.0f);
+        Scene moved = make_scene(0.3f);
+        std::string key = RenderCache::image_key(original, camera, width, height, "direct");
+        assert(key.size() == 32);
+        assert(key == RenderCache::image_key(make_scene(0.0f), camera, width, height, "direct"));
+        assert(key != RenderCache::image_key(moved, camera, width, height, "direct"));
+        assert(key != RenderCache::image_key(original, camera, width, height, "direct lod=1"));
+
+        RenderCache::Settings settings;
+        settings.directory = directory;
+        settings.tile_size = 16;
+        std::vector<Vector3> first, reference, partial;
+        {
+            RenderCache cache(settings);
+            assert(cache.enabled());
+            assert(render(original, cache, first) == 0);
+            assert(cache.store_image(key, width, height, first));
+        }
+        {
+            RenderCache cache(settings);
+            std::vector<Vector3> loaded;
+            assert(cache.load_image(key, width, height, loaded) && cache.statistics().image_hit);
+            assert(loaded.size() == first.size());
+            for (size_t i = 0; i < first.size(); i++) assert((loaded[i] - first[i]).length() == 0.0f);
+            assert(!cache.load_image(key, width + 1, height, loaded));
+        }
+
+        // Move the small sphere: tiles away from it and its shadow are reused, the result is exact
+        int reused;
+        {
+            RenderCache cache(settings);
+            reused = render(moved, cache, partial);
+            std::cout << "  Moved one sphere: " << reused << " of " << cache.statistics().tiles_total << " tiles reused" << std::endl;
+            assert(reused > 0 && reused < cache.statistics().tiles_total);
+        }
+        Renderer::render_frame(moved, camera, width, height, reference);
+        for (size_t i = 0; i < reference.size(); i++) assert((partial[i] - reference[i]).length() == 0.0f);
+
+        // Moving the light changes every tile key
+        {
+            Scene relit = make_scene(0.3f);
+            relit.lights[0] = std::make_unique<PointLight>(Vector3(-4.0f, 4.0f, -2.0f), Vector3(1, 1, 1), 20.0f);
+            RenderCache cache(settings);
+            assert(render(relit, cache, partial) == 0);
+        }
+
+        // Eviction keeps the directory below the bound, oldest entries first
+        {
+            settings.max_bytes = 64 * 1024;
+            RenderCache cache(settings);
+            cache.evict();
+            std::cout << "  Evicted " << cache.statistics().files_evicted << " files, "
+                      << cache.statistics().directory_bytes / 1024 << " KB left" << std::endl;
+            assert(cache.statistics().files_evicted > 0 && cache.statistics().directory_bytes <= settings.max_bytes);
+        }
+        std::filesystem::remove_all(directory);
+
+        std::cout << "  Render cache: PASSED" << std::endl;
+        return true;
+    }
+
+    // === LAYERED MATERIAL TESTS ===
+
+    bool test_openpbr_stochastic_lobe_selection() {
+        std::cout << "\n=== OpenPBR Stochastic Lobe Selection Tests ===" << std::endl;
+
+        Vector3 normal(0.0f, 0.0f, 1.0f);
+        OpenPBRMaterial plastic(Vector3(0.8f, 0.1f, 0.1f), 0.0f, 0.4f, 1.5f, 0.0f, 0.0f);
+        OpenPBRMaterial car_paint(Vector3(0.8f, 0.1f, 0.1f), 0.0f, 0.4f, 1.5f, 1.0f, 0.05f);
+        OpenPBRMaterial lacquered_gold(Vector3(1.0f, 0.8f, 0.3f), 1.0f, 0.35f, 1.5f, 0.7f, 0.1f);
+        const OpenPBRMaterial* materials[3] = {&plastic, &car_paint, &lacquered_gold};
+        Vector3 view_directions[3] = {Vector3(0.0f, 0.0f, 1.0f), Vector3(0.5f, 0.2f, 1.0f).normalize(),
+                                      Vector3(0.95f, 0.0f, 0.2f).normalize()};
+        Vector3 light_directions[3] = {Vector3(-0.3f, 0.1f, 1.0f).normalize(), Vector3(-0.5f, -0.2f, 1.0f).normalize(),
+                                       Vector3(0.2f, 0.6f, 0.5f).normalize()};
+
+        for (const OpenPBRMaterial* material : materials) {
+            assert(material->lobe_count() == OpenPBRMaterial::LobeCount);
+            for (const Vector3& wo : view_directions) {
+                // Selection probabilities form a distribution and select_lobe reports them exactly
+                float probabilities[OpenPBRMaterial::LobeCount];
+                material->lobe_probabilities(normal.dot(wo), probabilities);
+                float total = 0.0f;
+                for (float p : probabilities) total += p;
+                assert(std::abs(total - 1.0f) < 1e-5f);
+
+                // E_u[f_k / p_k] over stratified u equals the full layered BRDF for every light direction
+                for (const Vector3& wi : light_directions) {
+                    Vector3 full = material->evaluate_brdf(wi, wo, normal, false);
+                    Vector3 average(0, 0, 0);
+                    int strata = 4096;
+                    for (int i = 0; i < strata; i++) {
+                        float probability = 0.0f;
+                        int lobe = material->select_lobe(wo, normal, (i + 0.5f) / strata, probability);
+                        assert(probability > 0.0f && std::abs(probability - probabilities[lobe]) < 1e-6f);
+                        average += material->evaluate_lobe(lobe, wi, wo, normal) * (1.0f / (probability * strata));
+                    }
+                    float scale = std::max({full.x, full.y, full.z, 1e-3f});
+                    assert(std::abs(average.x - full.x) < 2e-3f * scale);
+                    assert(std::abs(average.y - full.y) < 2e-3f * scale);
+                    assert(std::abs(average.z - full.z) < 2e-3f * scale);
+                }
+            }
+        }
+        std::cout << "  Stochastic lobe average matches full evaluation: PASSED" << std::endl;
+
+        // A bare metal base has a single lobe with non-zero weight: it is always selected
+        OpenPBRMaterial gold(Vector3(1.0f, 0.8f, 0.3f), 1.0f, 0.3f, 1.5f, 0.0f, 0.0f);
+        for (int i = 0; i < 16; i++) {
+            float probability = 0.0f;
+            int lobe = gold.select_lobe(view_directions[1], normal, (i + 0.5f) / 16.0f, probability);
+            assert(lobe == OpenPBRMaterial::Metal && std::abs(probability - 1.0f) < 1e-6f);
+        }
+
+        // A clear coat takes selection probability from the base lobes, more so at grazing angles (Fresnel)
+        float normal_incidence[OpenPBRMaterial::LobeCount], grazing[OpenPBRMaterial::LobeCount];
+        car_paint.lobe_probabilities(1.0f, normal_incidence);
+        car_paint.lobe_probabilities(0.1f, grazing);
+        assert(normal_incidence[OpenPBRMaterial::Coat] > 0.0f);
+        assert(grazing[OpenPBRMaterial::Coat] > normal_incidence[OpenPBRMaterial::Coat]);
+        assert(normal_incidence[OpenPBRMaterial::Diffuse] > normal_incidence[OpenPBRMaterial::Specular]);
+
+        // Directional albedo: the single-lobe path estimator (sample one lobe, weight 1/p_k) agrees with
+        // the full mixture estimator, and the layered stack never reflects more than it receives
+        std::mt19937 rng(112);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        for (const OpenPBRMaterial* material : materials) {
+            for (const Vector3& wo : view_directions) {
+                double mixture = 0.0, stochastic = 0.0;
+                int samples = 40000;
+                for (int i = 0; i < samples; i++) {
+                    float pdf = 0.0f;
+                    Vector3 wi = material->sample_direction(wo, normal, uniform(rng), uniform(rng), pdf);
+                    if (pdf > 0.0f && normal.dot(wi) > 0.0f) {
+                        mixture += material->evaluate_brdf(wi, wo, normal, false).y * normal.dot(wi) / pdf;
+                    }
+
+                    float probability = 0.0f;
+                    int lobe = material->select_lobe(wo, normal, uniform(rng), probability);
+                    float lobe_pdf = 0.0f;
+                    Vector3 lobe_wi = material->sample_lobe(lobe, wo, normal, uniform(rng), uniform(rng), lobe_pdf);
+                    if (lobe_pdf > 0.0f && normal.dot(lobe_wi) > 0.0f) {
+                        assert(std::abs(material->lobe_pdf(lobe, lobe_wi, wo, normal) - lobe_pdf) <= 1e-3f * std::max(1.0f, lobe_pdf));
+                        stochastic += material->evaluate_lobe(lobe, lobe_wi, wo, normal).y * normal.dot(lobe_wi) /
+                                      (lobe_pdf * probability);
+                    }
+                }
+                mixture /= samples;
+                stochastic /= samples;
+                assert(mixture > 0.0 && mixture <= 1.02);
+                assert(std::abs(mixture - stochastic) < 0.03 * mixture + 2e-3);
+            }
+        }
+        std::cout << "  Albedo: single-lobe estimator matches mixture, stack conserves energy: PASSED" << std::endl;
+
+        // Scene files declare the layered material with material_openpbr
+        std::string filename = "test_openpbr.scene";
+        {
+            std::ofstream file(filename);
+            file << "material_openpbr car_paint 0.8 0.1 0.1 0.0 0.4 1.5 1.0 0.05\n";
+            file << "sphere 0 0 -3 1 car_paint\n";
+        }
+        Scene scene = SceneLoader::load_from_file(filename);
+        std::remove(filename.c_str());
+        assert(scene.materials.size() == 1 && scene.materials[0]->type == MaterialType::OpenPBR);
+        const auto* loaded = static_cast<const OpenPBRMaterial*>(scene.materials[0].get());
+        assert(loaded->coat_weight == 1.0f && loaded->specular_roughness == 0.4f);
+
+        std::cout << "  OpenPBR layered material: PASSED" << std::endl;
+        return true;
+    }
+
+    // === MATERIAL GRAPH TESTS ===
+
+    bool test_material_graph_compilation() {
+        std::cout << "\n=== Material Graph Compilation Tests ===" << std::endl;
+
+        // Cook-Torrance as a graph: uniform α and F0 are folded, the rest becomes a short register program
+        MaterialGraph graph = MaterialGraph::cook_torrance(Vector3(1.0f, 0.8f, 0.3f), 0.3f, 1.0f, 0.04f);
+        MaterialProgram program;
+        assert(graph.compile(program));
+        program.statistics.print();
+        assert(program.statistics.folded_nodes == 2);
+        assert(program.statistics.instructions == 16);   // 12 shading nodes + loads of N, V, L, H
+        assert(program.register_count < program.statistics.instructions);
+        assert(program.register_count <= MaterialProgram::max_registers);
+
+        // Program, batch and interpreter agree exactly; the hand-written material agrees to rounding
+        GraphMaterial material(program);
+        CookTorranceMaterial reference(Vector3(1.0f, 0.8f, 0.3f), 0.3f, 1.0f, 0.04f);
+        std::mt19937 rng(113);
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        std::vector<ShadingPoint> points;
+        for (int i = 0; i < 200; i++) {
+            Vector3 normal = Vector3(uniform(rng), uniform(rng), uniform(rng)).normalize();
+            Vector3 wi = Vector3(uniform(rng), uniform(rng), uniform(rng)).normalize();
+            Vector3 wo = Vector3(uniform(rng), uniform(rng), uniform(rng)).normalize();
+            points.push_back({wi, wo, normal});   // Includes below-horizon pairs, which must give zero
+        }
+        std::vector<Vector3> batch(points.size());
+        material.evaluate_brdf_batch(points.data(), points.size(), batch.data());
+        int lit = 0;
+        for (size_t i = 0; i < points.size(); i++) {
+            const ShadingPoint& p = points[i];
+            Vector3 single = material.evaluate_brdf(p.wi, p.wo, p.normal, false);
+            Vector3 expected = reference.evaluate_brdf(p.wi, p.wo, p.normal, false);
+            assert(single.x == batch[i].x && single.y == batch[i].y && single.z == batch[i].z);
+            float scale = std::max({expected.x, expected.y, expected.z, 1e-3f});
+            assert(std::abs(single.x - expected.x) <= 1e-5f * scale);
+            assert(std::abs(single.z - expected.z) <= 1e-5f * scale);
+            if (p.normal.dot(p.wi) > 0.0f && p.normal.dot(p.wo) > 0.0f) {
+                Vector3 interpreted = graph.evaluate_interpreted(p);
+                assert(interpreted.x == single.x && interpreted.y == single.y && interpreted.z == single.z);
+                lit++;
+            } else {
+                assert(single.x == 0.0f && single.y == 0.0f && single.z == 0.0f);
+            }
+        }
+        assert(lit > 20);
+        std::cout << "  Compiled, batched and interpreted evaluation agree (" << lit << " lit points): PASSED" << std::endl;
+
+        // A graph that depends only on constants folds to a constant program with no instructions
+        MaterialGraph uniform_graph;
+        assert(uniform_graph.add_node("albedo", "constant", {"0.5", "0.25", "1"}));
+        assert(uniform_graph.add_node("lambert", "multiply", {"albedo", "0.318309886"}));
+        uniform_graph.set_output("lambert");
+        MaterialProgram uniform_program;
+        assert(uniform_graph.compile(uniform_program));
+        assert(uniform_program.instructions.empty() && uniform_program.statistics.folded_nodes == 1);
+        GraphMaterial lambert_graph(uniform_program);
+        assert(std::abs(lambert_graph.base_color.y - 0.25f) < 1e-3f);   // Directional albedo of ρ/π is ρ
+
+        // Errors: unknown operation, wrong arity, undefined input, cycle
+        MaterialGraph broken;
+        assert(!broken.add_node("x", "sqrtt", {"N"}));
+        assert(!broken.add_node("x", "mix", {"N", "L"}));
+        assert(broken.add_node("a", "add", {"b", "N"}));
+        assert(broken.add_node("b", "multiply", {"a", "2"}));
+        broken.set_output("a");
+        MaterialProgram broken_program;
+        assert(!broken.compile(broken_program));
+        broken.set_output("missing");
+        assert(!broken.compile(broken_program));
+        std::cout << "  Constant folding and error reporting: PASSED" << std::endl;
+
+        // Scene files: graph_node lines compiled by material_graph
+        std::string filename = "test_material_graph.scene";
+        {
+            std::ofstream file(filename);
+            file << "graph_node matte albedo constant 0.6 0.6 0.6\n";
+            file << "graph_node matte brdf multiply albedo 0.318309886   # Lambert\n";
+            file << "material_graph matte brdf\n";
+            file << "sphere 0 0 -3 1 matte\n";
+        }
+        Scene scene = SceneLoader::load_from_file(filename);
+        std::remove(filename.c_str());
+        assert(scene.materials.size() == 1 && scene.materials[0]->type == MaterialType::Graph);
+        assert(scene.primitives.size() == 1 && scene.primitives[0].material_index == 0);
+        Vector3 n(0, 0, 1);
+        Vector3 value = scene.materials[0]->evaluate_brdf(Vector3(0.3f, 0, 1).normalize(), n, n, false);
+        assert(std::abs(value.x - 0.6f / static_cast<float>(M_PI)) < 1e-6f);
+
+        std::cout << "  Material graph: PASSED" << std::endl;
+        return true;
+    }
+
+    // === SPHERE LIGHT TESTS ===
+
+    bool test_sphere_light_cone_sampling() {
+        std::cout << "\n=== Sphere Light Cone Sampling Tests ===" << std::endl;
+        const float pi = static_cast<float>(M_PI);
+
+        // Bulb of radius 0.5 three units straight above a surface facing it: sin θmax = 1/6
+        SphereLight bulb(Vector3(0, 0, -3), 0.5f, Vector3(1, 1, 1), 2.0f);
+        Vector3 point(0, 0, 0);
+        Vector3 normal(0, 0, -1);
+        Vector3 to_center = Vector3(0, 0, -1);
+        float sin_squared_max = (0.5f * 0.5f) / (3.0f * 3.0f);
+        float cos_theta_max = std::sqrt(1.0f - sin_squared_max);
+        float expected_pdf = 1.0f / (2.0f * pi * (1.0f - cos_theta_max));
+
+        // Every sample lies inside the cone, lands on the front of the sphere and carries the exact pdf
+        const int strata = 64;
+        double irradiance = 0.0;
+        for (int i = 0; i < strata; i++) {
+            for (int j = 0; j < strata; j++) {
+                float u1 = (i + 0.5f) / strata;
+                float u2 = (j + 0.5f) / strata;
+                float pdf, distance;
+                Vector3 direction = bulb.sample_cone(point, u1, u2, pdf, distance);
+                assert(std::abs(direction.length() - 1.0f) < 1e-5f);
+                assert(direction.dot(to_center) >= cos_theta_max - 1e-6f);
+                assert(std::abs(pdf - expected_pdf) < 1e-3f * expected_pdf);
+                assert(std::abs(bulb.pdf(point, direction) - pdf) < 1e-3f * pdf);
+                Vector3 surface = point + direction * distance;
+                assert(std::abs((surface - bulb.center).length() - bulb.radius) < 1e-4f);
+                assert((surface - bulb.center).dot(direction) <= 1e-4f);   // Front side, facing the point
+                irradiance += bulb.intensity / pdf * std::max(0.0f, normal.dot(direction));
+            }
+        }
+        irradiance /= strata * strata;
+
+        // Analytic irradiance from a uniformly bright sphere overhead: E = π L sin²θmax
+        double analytic = pi * bulb.intensity * sin_squared_max;
+        std::cout << "Cone-sampled irradiance: " << irradiance << ", analytic: " << analytic << std::endl;
+        assert(std::abs(irradiance - analytic) < 1e-3 * analytic);
+
+        // Directions outside the cone have zero pdf
+        assert(bulb.pdf(point, Vector3(1, 0, -1).normalize()) == 0.0f);
+        assert(bulb.pdf(point, Vector3(0, 0, 1)) == 0.0f);
+
+        // illuminate() returns L / pdf = L Ω along a direction inside the cone
+        Vector3 light_direction;
+        float light_distance;
+        Vector3 radiance = bulb.illuminate(point, light_direction, light_distance);
+        float solid_angle = 2.0f * pi * (1.0f - cos_theta_max);
+        assert(std::abs(bulb.solid_angle(point) - solid_angle) < 1e-4f * solid_angle);
+        assert(std::abs(radiance.x - bulb.intensity * solid_angle) < 1e-3f * radiance.x);
+        assert(light_direction.dot(to_center) >= cos_theta_max - 1e-6f);
+        assert(light_distance >= 2.5f - 1e-4f && light_distance <= 3.0f);
+
+        // A tiny, distant bulb keeps its solid angle (π r²/d² to first order) without cancellation
+        SphereLight distant(Vector3(0, 0, -100), 0.01f, Vector3(1, 1, 1), 1.0f);
+        float small_angle = pi * 0.01f * 0.01f / (100.0f * 100.0f);
+        std::cout << "Distant bulb solid angle: " << distant.solid_angle(point) << " (expected ~" << small_angle << ")" << std::endl;
+        assert(std::abs(distant.solid_angle(point) - small_angle) < 1e-4f * small_angle);
+
+        // Inside the bulb the full sphere of directions is sampled and every ray exits through the surface
+        float inside_pdf, inside_distance;
+        Vector3 inside_point(0.1f, 0.0f, -3.0f);
+        Vector3 inside_direction = bulb.sample_cone(inside_point, 0.3f, 0.7f, inside_pdf, inside_distance);
+        assert(std::abs(inside_pdf - 1.0f / (4.0f * pi)) < 1e-6f);
+        assert(std::abs((inside_point + inside_direction * inside_distance - bulb.center).length() - bulb.radius) < 1e-4f);
+
+        // Scene loader integration
+        Scene scene = SceneLoader::load_from_string(
+            "material_lambert white 0.8 0.8 0.8\n"
+            "sphere 0.0 -101.0 -4.0 100.0 white\n"
+            "light_sphere 0.0 2.0 -4.0 0.25 1.0 0.9 0.7 40.0\n"
+            "light_sphere 0.0 2.0 -4.0 -1.0 1.0 1.0 1.0 1.0\n");   // Invalid radius: rejected
+        assert(scene.lights.size() == 1);
+        assert(scene.lights[0]->type == LightType::Sphere);
+        const SphereLight* loaded = dynamic_cast<const SphereLight*>(scene.lights[0].get());
+        assert(loaded && loaded->radius == 0.25f && loaded->intensity == 40.0f);
+
+        std::cout << "Sphere light cone sampling: PASS" << std::endl;
+        return true;
+    }
+
+    // === AREA LIGHT SAMPLING TESTS ===
+
+    // Irradiance from a uniformly emitting polygon (Lambert's formula): E = L/2 Σ Θi (n · ĝi)
+    // Θi is the angle the edge i→i+1 subtends at the point, ĝi the unit normal of that edge's plane
+    double polygon_irradiance(const std::vector<Vector3>& corners, const Vector3& point, const Vector3& normal, double radiance) {
+        double sum = 0.0;
+        for (size_t i = 0; i < corners.size(); i++) {
+            Vector3 a = (corners[i] - point).normalize();
+            Vector3 b = (corners[(i + 1) % corners.size()] - point).normalize();
+            double angle = std::acos(std::clamp(static_cast<double>(a.dot(b)), -1.0, 1.0));
+            sum += angle * normal.dot(a.cross(b).normalize());
+        }
+        return 0.5 * radiance * std::abs(sum);
+    }
+
+    bool test_area_light_solid_angle_sampling() {
+        std::cout << "\n=== Area Light Solid-Angle Sampling Tests ===" << std::endl;
+
+        // Large 4x4 light one unit above the floor, facing down
+        AreaLight area_light(Vector3(0, 1, 0), Vector3(0, -1, 0), 4.0f, 4.0f, Vector3(1, 1, 1), 1.0f, AreaLightSampling::Area);
+        AreaLight solid_angle_light(Vector3(0, 1, 0), Vector3(0, -1, 0), 4.0f, 4.0f, Vector3(1, 1, 1), 1.0f, AreaLightSampling::SolidAngle);
+        std::vector<Vector3> corners;
+        for (Vector3 offset : {Vector3(-0.5f, 0, -0.5f), Vector3(0.5f, 0, -0.5f), Vector3(0.5f, 0, 0.5f), Vector3(-0.5f, 0, 0.5f)}) {
+            corners.push_back(area_light.center + area_light.u_axis * (offset.x * 4.0f) + area_light.v_axis * (offset.z * 4.0f));
+        }
+
+        struct Receiver { const char* name; Vector3 point; Vector3 normal; };
+        std::vector<Receiver> receivers = {
+            {"close below the center", Vector3(0.3f, 0.9f, -0.2f), Vector3(0, 1, 0)},
+            {"grazing, beside the edge", Vector3(2.3f, 0.95f, 0.0f), Vector3(-1, 0, 0)},
+            {"far below the corner", Vector3(2.5f, -3.0f, 2.5f), Vector3(0, 1, 0)},
+        };
+
+        for (const Receiver& receiver : receivers) {
+            double analytic = polygon_irradiance(corners, receiver.point, receiver.normal, 1.0);
+            float solid_angle = solid_angle_light.solid_angle(receiver.point);
+
+            // Stratified checks: samples stay on the light, pdf is 1/Ω, the estimator integrates to E,
+            // and integrating cos θl / d² over the light area reproduces Ω
+            const int strata = 64;
+            double stratified = 0.0, area_integral = 0.0;
+            for (int i = 0; i < strata; i++) {
+                for (int j = 0; j < strata; j++) {
+                    float u = (i + 0.5f) / strata, v = (j + 0.5f) / strata;
+                    float pdf;
+                    Vector3 sample = solid_angle_light.sample_solid_angle(receiver.point, u, v, pdf);
+                    Vector3 local = sample - solid_angle_light.center;
+                    assert(std::abs(local.dot(solid_angle_light.normal)) < 1e-4f);
+                    assert(std::abs(local.dot(solid_angle_light.u_axis)) <= 2.0f + 1e-4f);
+                    assert(std::abs(local.dot(solid_angle_light.v_axis)) <= 2.0f + 1e-4f);
+                    assert(std::abs(pdf * solid_angle - 1.0f) < 1e-5f);
+                    Vector3 direction = (sample - receiver.point).normalize();
+                    stratified += std::max(0.0f, receiver.normal.dot(direction)) / pdf;
+                }
+            }
+            const int fine_strata = 512;   // cos θl / d² peaks sharply near the closest edge
+            for (int i = 0; i < fine_strata; i++) {
+                for (int j = 0; j < fine_strata; j++) {
+                    Vector3 area_sample = area_light.sample_area((i + 0.5f) / fine_strata, (j + 0.5f) / fine_strata) - receiver.point;
+                    float distance_squared = area_sample.length_squared();
+                    area_integral += area_light.normal.dot(area_sample.normalize() * -1.0f) * 16.0f / distance_squared;
+                }
+            }
+            stratified /= strata * strata;
+            area_integral /= fine_strata * fine_strata;
+            assert(std::abs(stratified - analytic) < 2e-3 * analytic);
+            assert(std::abs(area_integral - solid_angle) < 2e-3 * solid_angle);
+
+            // Variance at equal sample counts: 2000 estimates of E with 16 random samples each
+            std::mt19937 rng(115);
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+            const int estimates = 2000, samples = 16;
+            double area_mean = 0.0, area_square = 0.0, solid_mean = 0.0, solid_square = 0.0;
+            for (int e = 0; e < estimates; e++) {
+                double area_estimate = 0.0, solid_estimate = 0.0;
+                for (int s = 0; s < samples; s++) {
+                    float u = uniform(rng), v = uniform(rng);
+
+                    Vector3 to_light = area_light.sample_area(u, v) - receiver.point;
+                    float distance_squared = to_light.length_squared();
+                    Vector3 direction = to_light.normalize();
+                    float cos_light = area_light.normal.dot(direction * -1.0f);
+                    if (cos_light > 0.0f) {
+                        area_estimate += std::max(0.0f, receiver.normal.dot(direction)) * cos_light * 16.0f / distance_squared;
+                    }
+
+                    float pdf;
+                    Vector3 solid_direction = (solid_angle_light.sample_solid_angle(receiver.point, u, v, pdf) - receiver.point).normalize();
+                    solid_estimate += std::max(0.0f, receiver.normal.dot(solid_direction)) / pdf;
+                }
+                area_estimate /= samples;
+                solid_estimate /= samples;
+                area_mean += area_estimate;
+                area_square += area_estimate * area_estimate;
+                solid_mean += solid_estimate;
+                solid_square += solid_estimate * solid_estimate;
+            }
+            area_mean /= estimates;
+            solid_mean /= estimates;
+            double area_variance = area_square / estimates - area_mean * area_mean;
+            double solid_variance = solid_square / estimates - solid_mean * solid_mean;
+
+            std::cout << receiver.name << ": E = " << analytic << ", area mean " << area_mean << " (variance " << area_variance
+                      << "), solid-angle mean " << solid_mean << " (variance " << solid_variance << "), variance ratio "
+                      << area_variance / std::max(solid_variance, 1e-30) << "x" << std::endl;
+
+            // Both estimators are unbiased; solid-angle sampling is never noisier
+            assert(std::abs(area_mean - analytic) < 4.0 * std::sqrt(area_variance / estimates) + 1e-3 * analytic);
+            assert(std::abs(solid_mean - analytic) < 4.0 * std::sqrt(solid_variance / estimates) + 1e-3 * analytic);
+            assert(solid_variance < area_variance);
+        }
+
+        // Behind the light nothing is emitted
+        float behind_pdf;
+        solid_angle_light.sample_solid_angle(Vector3(0, 2, 0), 0.5f, 0.5f, behind_pdf);
+        assert(behind_pdf == 0.0f);
+        assert(solid_angle_light.solid_angle(Vector3(0, 2, 0)) == 0.0f);
+
+        // illuminate() returns L Ω for solid-angle sampling
+        Vector3 light_direction;
+        float distance;
+        Vector3 radiance = solid_angle_light.illuminate(receivers[0].point, light_direction, distance);
+        assert(std::abs(radiance.x - solid_angle_light.solid_angle(receivers[0].point)) < 1e-4f * radiance.x);
+        assert(light_direction.y > 0.0f && distance >= 0.1f - 1e-4f);
+
+        // Scene loader: optional sampling keyword, area sampling stays the default
+        Scene scene = SceneLoader::load_from_string(
+            "light_area 0.0 2.0 -4.0 0.0 -1.0 0.0 1.0 1.0 1.0 1.0 1.0 2.0 solid_angle\n"
+            "light_area 0.0 2.0 -4.0 0.0 -1.0 0.0 1.0 1.0 1.0 1.0 1.0 2.0\n"
+            "light_area 0.0 2.0 -4.0 0.0 -1.0 0.0 1.0 1.0 1.0 1.0 1.0 2.0   # ceiling panel\n"
+            "light_area 0.0 2.0 -4.0 0.0 -1.0 0.0 1.0 1.0 1.0 1.0 1.0 2.0 area\n"
+            "light_area 0.0 2.0 -4.0 0.0 -1.0 0.0 1.0 1.0 1.0 1.0 1.0 2.0 solid-angle\n"
+            "light_area 0.0 2.0 -4.0 0.0 -1.0 0.0 1.0 1.0 1.0 1.0 1.0 2.0 solidangle\n");
+        assert(scene.lights.size() == 4);   // Misspelled sampling keywords reject their line
+        assert(dynamic_cast<const AreaLight*>(scene.lights[0].get())->sampling == AreaLightSampling::SolidAngle);
+        assert(dynamic_cast<const AreaLight*>(scene.lights[1].get())->sampling == AreaLightSampling::Area);
+        assert(dynamic_cast<const AreaLight*>(scene.lights[2].get())->sampling == AreaLightSampling::Area);
+        assert(dynamic_cast<const AreaLight*>(scene.lights[3].get())->sampling == AreaLightSampling::Area);
+
+        std::cout << "Area light solid-angle sampling: PASS" << std::endl;
+        return true;
+    }
+
+    // === TIME SERIES TESTS ===
+
+    bool test_time_series_recorder() {
+        std::cout << "\n=== Time Series Recorder Tests ===" << std::endl;
+
+        // Busy workload reporting its progress; 10 ms samples into a 4-sample buffer force compaction
+        TimeSeriesRecorder recorder(10.0, 4);
+        recorder.start();
+        auto begin = std::chrono::steady_clock::now();
+        long long rays = 0;
+        int tiles = 0;
+        volatile double sink = 0.0;
+        while (std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(250)) {
+            for (int i = 0; i < 20000; i++) sink = sink + std::sqrt(static_cast<double>(i));
+            rays += 1000;
+            tiles++;
+            recorder.report(rays, tiles);
+        }
+        recorder.stop();
+
+        const std::vector<TimeSeriesRecorder::Sample>& samples = recorder.get_samples();
+        std::cout << samples.size() << " samples, interval now " << recorder.sample_interval_ms() << " ms" << std::endl;
+        assert(!samples.empty() && samples.size() <= 4);
+        assert(recorder.sample_interval_ms() > 10.0);   // The buffer filled up and was compacted
+
+        // Timeline is contiguous and totals end at the last report
+        double covered = 0.0, integrated_rays = 0.0;
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (i > 0) {
+                assert(samples[i].elapsed_seconds > samples[i - 1].elapsed_seconds);
+                assert(samples[i].rays >= samples[i - 1].rays);
+                assert(std::abs(samples[i].elapsed_seconds - samples[i - 1].elapsed_seconds - samples[i].interval_seconds) < 1e-6);
+            }
+            covered += samples[i].interval_seconds;
+            integrated_rays += samples[i].rays_per_second * samples[i].interval_seconds;
+            assert(samples[i].process_utilization >= 0.0);
+            assert(samples[i].thread_busy_min <= samples[i].thread_busy_mean + 1e-12);
+            assert(samples[i].thread_busy_mean <= samples[i].thread_busy_max + 1e-12);
+        }
+        assert(samples.back().rays == rays && samples.back().tiles_done == tiles);
+        assert(std::abs(covered - samples.back().elapsed_seconds) < 1e-6);
+        assert(std::abs(integrated_rays - rays) < 1e-6 * rays);   // Merging preserves ray counts
+        assert(samples.back().elapsed_seconds >= 0.25);
+#ifdef __linux__
+        assert(samples.back().resident_bytes > 0);
+        assert(samples.back().threads >= 1);   // The calling thread (the sampler is excluded)
+#endif
+
+        // Output formats
+        std::string csv = recorder.to_csv();
+        assert(csv.rfind("elapsed_s,interval_s,rays,", 0) == 0);
+        assert(static_cast<size_t>(std::count(csv.begin(), csv.end(), '\n')) == samples.size() + 1);
+        std::string json = recorder.to_json();
+        assert(json.find("\"samples\": [") != std::string::npos);
+        assert(json.find("\"thread_busy\"") != std::string::npos);
+        std::string plot = recorder.ascii_plot(40, 5);
+        std::cout << plot;
+        assert(std::count(plot.begin(), plot.end(), '\n') == 5 + 2);
+
+        std::cout << "Time series recorder: PASS" << std::endl;
+        return true;
+    }
+
+    // === RASTERIZED PRIMARY VISIBILITY TESTS ===
+
+    bool test_rasterized_primary_visibility() {
+        std::cout << "\n=== Rasterized Primary Visibility Tests ===" << std::endl;
+
+        const int width = 96, height = 64;
+        Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                      static_cast<float>(width) / height);
+        camera.set_aspect_ratio_from_resolution(width, height);
+
+        // Screen bounds of a sphere hug its projected ellipse: every covered pixel lies inside, and
+        // the box is about 4/π times the ellipse's area (here off-axis, so a genuine ellipse)
+        Sphere probe(Point3(1.2f, 0.6f, -4.0f), 0.8f, 0, false);
+        float min_x, max_x, min_y, max_y;
+        bool full_screen;
+        assert(PrimaryRasterizer::screen_bounds(camera, probe, width, height, min_x, max_x, min_y, max_y, full_screen));
+        assert(!full_screen);
+        int covered = 0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                if (probe.intersect(ray, false).hit) {
+                    covered++;
+                    assert(x >= min_x - 1.0f && x <= max_x + 1.0f && y >= min_y - 1.0f && y <= max_y + 1.0f);
+                }
+            }
+        }
+        double box_area = (max_x - min_x) * (max_y - min_y);
+        std::cout << "Probe sphere: " << covered << " covered pixels, bounds " << box_area << " pixels" << std::endl;
+        assert(covered > 50 && box_area < 1.45 * covered);
+
+        // Behind the eye: culled; enclosing the eye: full screen
+        Sphere behind(Point3(0.0f, 0.0f, 4.0f), 1.0f, 0, false);
+        assert(!PrimaryRasterizer::screen_bounds(camera, behind, width, height, min_x, max_x, min_y, max_y, full_screen));
+        Sphere around(Point3(0.0f, 0.0f, 1.5f), 3.0f, 0, false);
+        assert(PrimaryRasterizer::screen_bounds(camera, around, width, height, min_x, max_x, min_y, max_y, full_screen));
+        assert(full_screen);
+
+        // Visibility buffer equals the linear closest hit, including spheres partly off screen, a
+        // sphere around the eye, one behind it, an exact duplicate (first in scene order wins) and a
+        // sphere with an invalid material (ignored like Scene::intersect ignores it)
+        Scene scene;
+        int white = scene.add_material(std::make_unique<LambertMaterial>(Vector3(0.8f, 0.8f, 0.8f)));
+        int red = scene.add_material(std::make_unique<LambertMaterial>(Vector3(0.8f, 0.1f, 0.1f)));
+        scene.add_sphere(Sphere(Point3(0.0f, 0.0f, -5.0f), 1.0f, white, false));
+        scene.add_sphere(Sphere(Point3(0.0f, 0.0f, -5.0f), 1.0f, red, false));     // Duplicate: never visible
+        scene.add_sphere(Sphere(Point3(2.6f, 1.4f, -4.0f), 0.9f, red, false));     // Crosses the image corner
+        scene.add_sphere(Sphere(Point3(-0.5f, -0.3f, -3.0f), 0.4f, red, false));
+        scene.add_sphere(Sphere(Point3(0.0f, 0.0f, 3.0f), 1.0f, white, false));    // Behind the eye
+        scene.primitives.push_back(Sphere(Point3(0.5f, 0.0f, -4.0f), 0.5f, 7, false));  // Invalid material (add_sphere would refuse it)
+        scene.add_sphere(Sphere(Point3(0.0f, 0.0f, 0.0f), 20.0f, white, false));   // Encloses the eye
+        scene.add_light(std::make_unique<PointLight>(Vector3(2.0f, 3.0f, -1.0f), Vector3(1, 1, 1), 5.0f));
+
+        PrimaryRasterizer::Settings settings;
+        settings.tile_size = 8;
+        settings.thread_count = 3;
+        PrimaryRasterizer rasterizer(settings);
+        rasterizer.rasterize(scene, camera, width, height);
+        rasterizer.statistics().print();
+        assert(rasterizer.statistics().culled_spheres == 2);
+        assert(rasterizer.statistics().full_screen_spheres == 1);
+        assert(rasterizer.statistics().covered_pixels == width * height);   // The enclosing sphere is everywhere
+
+        int mismatches = 0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                Scene::Intersection expected = scene.intersect(ray, false);
+                Scene::Intersection actual = rasterizer.intersection(scene, ray, x, y);
+                if (expected.hit != actual.hit || expected.primitive != actual.primitive || expected.t != actual.t ||
+                    expected.material != actual.material) {
+                    mismatches++;
+                }
+            }
+        }
+        assert(mismatches == 0);
+        assert(rasterizer.primitive_at(width / 2, height / 2) == 0);
+
+        // Full frames through the shared shading path match pixel for pixel
+        std::vector<Vector3> exact, rasterized;
+        Renderer::render_frame(scene, camera, width, height, exact);
+        Renderer::render_frame(scene, camera, width, height, rasterized, rasterizer);
+        for (size_t i = 0; i < exact.size(); i++) {
+            assert(exact[i].x == rasterized[i].x && exact[i].y == rasterized[i].y && exact[i].z == rasterized[i].z);
+        }
+
+        std::cout << "Rasterized primary visibility: PASS" << std::endl;
+        return true;
+    }
+
+    // === QOI OUTPUT TESTS ===
+
+    bool test_qoi_banded_encoding() {
+        std::cout << "\n=== QOI Banded Encoding Tests ===" << std::endl;
+
+        auto round_trip = [](const std::vector<unsigned char>& pixels, int width, int height, int channels, int bands,
+                             int threads, size_t* encoded_size = nullptr) {
+            QoiEncoder::Settings settings;
+            settings.bands = bands;
+            settings.thread_count = threads;
+            std::vector<unsigned char> encoded = QoiEncoder::encode(pixels.data(), width, height, channels, settings);
+            if (encoded_size) *encoded_size = encoded.size();
+            int decoded_width, decoded_height, decoded_channels;
+            std::vector<unsigned char> decoded;
+            return QoiEncoder::decode(encoded, decoded_width, decoded_height, decoded_channels, decoded) &&
+                   decoded_width == width && decoded_height == height && decoded_channels == channels && decoded == pixels;
+        };
+
+        // Hand-encoded 4×1 stream: literal, run of 1, DIFF (+1, -1, 0), INDEX (hash(10,20,30,255) = 9)
+        std::vector<unsigned char> tiny = {10, 20, 30, 10, 20, 30, 11, 19, 30, 10, 20, 30};
+        QoiEncoder::Settings one_band;
+        one_band.bands = 1;
+        std::vector<unsigned char> encoded = QoiEncoder::encode(tiny.data(), 4, 1, 3, one_band);
+        std::vector<unsigned char> expected = {'q', 'o', 'i', 'f', 0, 0, 0, 4, 0, 0, 0, 1, 3, 0,
+                                               0xfe, 10, 20, 30, 0xc0, 0x76, 0x09, 0, 0, 0, 0, 0, 0, 0, 1};
+        assert(encoded == expected);
+
+        // Rule 2: (1, 0, 56, 255) and transparent black share table slot 0. The second band must not
+        // emit INDEX for (0, 0, 0, 0) from its zero-initialized table: a serial decoder holds (1, 0, 56, 255)
+        std::vector<unsigned char> slot_clash = {1, 0, 56, 255, 1, 0, 56, 255, 1, 0, 56, 255,
+                                                 6, 5, 5, 255, 0, 0, 0, 0, 0, 0, 0, 0};
+        assert(round_trip(slot_clash, 3, 2, 4, 2, 1));
+
+        // Synthetic RGBA image with runs, gradients (DIFF/LUMA), noise (literals) and alpha changes:
+        // every band count and thread count decodes serially to the same pixels
+        const int width = 67, height = 41;
+        std::mt19937 rng(7);
+        std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                unsigned char* p = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+                if (x < 20) {
+                    p[0] = 40; p[1] = 80; p[2] = 120; p[3] = 255;                             // Runs
+                } else if (x < 45) {
+                    p[0] = x * 3 + y; p[1] = x * 2 + y; p[2] = x + 2 * y; p[3] = 255;         // Gradient
+                } else {
+                    p[0] = rng() & 0xff; p[1] = rng() & 0xff; p[2] = rng() & 0xff;            // Noise
+                    p[3] = (x + y) % 5 == 0 ? 0 : 255;
+                }
+            }
+        }
+        std::vector<unsigned char> rgb;
+        for (size_t i = 0; i < rgba.size(); i += 4) rgb.insert(rgb.end(), rgba.begin() + i, rgba.begin() + i + 3);
+        size_t single_size = 0;
+        assert(round_trip(rgba, width, height, 4, 1, 1, &single_size));
+        for (int bands : {2, 3, 8, height}) {
+            for (int threads : {1, 3}) {
+                size_t banded_size = 0;
+                assert(round_trip(rgba, width, height, 4, bands, threads, &banded_size));
+                assert(round_trip(rgb, width, height, 3, bands, threads));
+                // Each extra band costs at most one literal
+                assert(banded_size <= single_size + static_cast<size_t>(bands - 1) * 5);
+            }
+        }
+        std::cout << "Round trips: 1 to " << height << " bands, RGB and RGBA: PASS" << std::endl;
+
+        // Corrupt input is rejected
+        std::vector<unsigned char> truncated(encoded.begin(), encoded.begin() + 16);
+        int w, h, c;
+        std::vector<unsigned char> decoded;
+        assert(!QoiEncoder::decode(truncated, w, h, c, decoded));
+
+        // Table-driven gamma bytes equal pow-based gamma correction (exhaustive check: see gamma_byte)
+        Image probe(1, 1);
+        int gamma_mismatches = 0;
+        for (int i = 0; i <= (1 << 20); i++) {
+            float value = static_cast<float>(i) / (1 << 20);
+            for (float c : {value, std::nextafter(value, 0.0f), std::nextafter(value, 1.0f)}) {
+                c = std::min(c, 1.0f);
+                Vector3 g = probe.gamma_correct(Vector3(c, c, c));
+                if (Image::gamma_byte(c) != (unsigned char)(g.x * 255.0f + 0.5f)) gamma_mismatches++;
+            }
+        }
+        assert(gamma_mismatches == 0);
+
+        // save_to_qoi writes the same 8-bit pixels save_to_png would
+        Image image(37, 23);
+        for (int y = 0; y < image.height; y++) {
+            for (int x = 0; x < image.width; x++) {
+                image.set_pixel(x, y, Vector3(x / 36.0f, y / 22.0f, 0.25f + 0.5f * ((x + y) % 2)));
+            }
+        }
+        std::string filename = "test_qoi_output.qoi";
+        QoiEncoder::Settings file_settings;
+        file_settings.bands = 4;
+        file_settings.thread_count = 2;
+        assert(image.save_to_qoi(filename, true, file_settings));
+        std::vector<unsigned char> file_data;
+        assert(QoiEncoder::read_file(filename, file_data));
+        assert(file_data[13] == 0);   // sRGB colorspace
+        assert(QoiEncoder::decode(file_data, w, h, c, decoded));
+        assert(w == 37 && h == 23 && c == 3 && decoded == image.to_8bit_rgb(true));
+        std::filesystem::remove(filename);
+
+        std::cout << "QOI banded encoding: PASS" << std::endl;
+        return true;
+    }
+
+    // === SORT-LAST RENDERING TESTS ===
+
+    bool test_sort_last_rendering() {
+        std::cout << "\n=== Sort-Last Rendering Tests ===" << std::endl;
+
+        // A row of spheres spread along x and z, so every chunk gets some and rays cross chunk boundaries
+        std::string filename = "test_sort_last.scene";
+        {
+            std::ofstream scene_file(filename);
+            scene_file << "material red 0.8 0.2 0.2\nmaterial blue 0.2 0.3 0.8\n";
+            scene_file << "sphere 0.0 -101.0 -8.0 100.0 blue\n";
+            for (int i = 0; i < 24; i++) {
+                scene_file << "sphere " << -4.0f + i * 0.35f << " " << 0.3f * (i % 3) << " " << -3.0f - i * 0.25f
+                           << " 0.3 " << (i % 2 ? "red" : "blue") << "\n";
+            }
+            scene_file << "light_point 1.0 3.0 -2.0 1.0 0.9 0.7 6.0\n";
+            scene_file << "light_directional -0.3 -1.0 -0.5 1.0 1.0 1.0 1.2\n";
+        }
+
+        SortLastRenderer::Settings settings;
+        settings.workers = 3;
+        SortLastRenderer sort_last(filename, "lambert", settings);
+        assert(sort_last.ready());
+
+        // Every sphere lands in exactly one chunk and no chunk holds the whole scene
+        int total = 0;
+        for (int spheres : sort_last.chunk_sizes()) {
+            assert(spheres > 0 && spheres < 25);
+            total += spheres;
+        }
+        assert(total == 25);
+
+        // The composited frame equals the single-process render of the full scene
+        int width = 48, height = 36;
+        Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                      static_cast<float>(width) / height);
+        camera.set_aspect_ratio_from_resolution(width, height);
+        std::vector<Vector3> distributed;
+        assert(sort_last.render_frame(camera, width, height, distributed));
+        Scene scene = SceneLoader::load_from_file(filename, "lambert");
+        scene.build_bvh();
+        std::vector<Vector3> reference;
+        Renderer::render_frame(scene, camera, width, height, reference);
+        assert(distributed.size() == reference.size());
+        int mismatches = 0;
+        for (size_t i = 0; i < reference.size(); i++) {
+            if (distributed[i].x != reference[i].x || distributed[i].y != reference[i].y ||
+                distributed[i].z != reference[i].z) mismatches++;
+        }
+        assert(mismatches == 0);
+        assert(sort_last.statistics().primary_rays == width * height);
+        std::filesystem::remove(filename);
+
+        std::cout << "Sort-last rendering: PASS" << std::endl;
+        return true;
+    }
+
+    // === CPU BUDGET TESTS ===
+
+    bool test_cpu_budget() {
+        std::cout << "\n=== CPU Budget Tests ===" << std::endl;
+
+        // cpu.max parsing
+        double cpus = -1.0;
+        assert(CpuBudget::parse_cpu_max("max 100000\n", cpus) && cpus == 0.0);
+        assert(CpuBudget::parse_cpu_max("250000 100000", cpus) && std::abs(cpus - 2.5) < 1e-9);
+        assert(CpuBudget::parse_cpu_max("50000 100000", cpus) && std::abs(cpus - 0.5) < 1e-9);
+        assert(!CpuBudget::parse_cpu_max("", cpus));
+        assert(!CpuBudget::parse_cpu_max("lots 100000", cpus));
+        assert(!CpuBudget::parse_cpu_max("100000 0", cpus));
+
+        // Fake cgroup v2 tree: the smallest quota on the path to the root wins
+        std::filesystem::path root = "test_cpu_budget_cgroup";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "jobs" / "render");
+        std::ofstream(root / "cpu.max") << "max 100000\n";
+        std::ofstream(root / "jobs" / "cpu.max") << "150000 100000\n";
+        std::ofstream(root / "jobs" / "render" / "cpu.max") << "400000 100000\n";
+        std::ofstream(root / "cgroup") << "1:cpu:/ignored\n0::/jobs/render\n";
+
+        CpuBudget::Limits limits = CpuBudget::detect(root.string(), (root / "cgroup").string());
+        assert(std::abs(limits.quota_cpus - 1.5) < 1e-9);
+        assert(limits.quota_source == (root / "jobs" / "cpu.max").string());
+        assert(limits.effective_cpus == 1);   // 1.5 CPUs rounds down: never throttled
+
+        // Loosen the parent: the leaf's 4 CPUs apply, further capped by hardware threads and affinity
+        std::ofstream(root / "jobs" / "cpu.max") << "max 100000\n";
+        limits = CpuBudget::detect(root.string(), (root / "cgroup").string());
+        assert(std::abs(limits.quota_cpus - 4.0) < 1e-9);
+        int expected = std::min(4, limits.hardware_threads);
+        if (limits.affinity_cpus > 0) expected = std::min(expected, limits.affinity_cpus);
+        assert(limits.effective_cpus == expected);
+
+        // No cgroup v2 entry: hardware threads and affinity only
+        std::ofstream(root / "cgroup") << "1:cpu:/jobs/render\n";
+        limits = CpuBudget::detect(root.string(), (root / "cgroup").string());
+        assert(limits.quota_cpus == 0.0 && limits.quota_source.empty());
+        assert(limits.effective_cpus >= 1 && limits.effective_cpus <= limits.hardware_threads);
+        std::filesystem::remove_all(root);
+
+        // Pools default to the process budget
+        assert(CpuBudget::default_thread_count() == CpuBudget::process_limits().effective_cpus);
+        assert(CpuBudget::default_thread_count() >= 1);
+
+        std::cout << "CPU budget: PASS" << std::endl;
+        return true;
+    }
+
+    // === MEMORY PLANNER TESTS ===
+
+    bool test_memory_planner() {
+        std::cout << "\n=== Memory Planner Tests ===" << std::endl;
+
+        // Budget sizes
+        size_t bytes = 0;
+        assert(MemoryPlanner::parse_size("1048576", bytes) && bytes == 1048576);
+        assert(MemoryPlanner::parse_size("512M", bytes) && bytes == 512ull << 20);
+        assert(MemoryPlanner::parse_size("1.5g", bytes) && bytes == 3ull << 29);
+        assert(MemoryPlanner::parse_size("2GiB", bytes) && bytes == 2ull << 30);
+        assert(!MemoryPlanner::parse_size("lots", bytes));
+        assert(!MemoryPlanner::parse_size("12Q", bytes));
+        assert(!MemoryPlanner::parse_size("-5M", bytes));
+
+        // The BVH estimate is exact: node slots are laid out before construction
+        for (int count : {1, 4, 5, 17, 100, 1000}) {
+            Scene scene;
+            int material = scene.add_material(LambertMaterial(Vector3(0.5f, 0.5f, 0.5f)));
+            for (int i = 0; i < count; i++) {
+                scene.primitives.push_back(Sphere(Point3(i * 0.1f, 0.0f, -5.0f), 0.05f, material, false));
+            }
+            scene.build_bvh();
+            assert(LodBVH::estimate_memory_bytes(count) == scene.bvh->memory_usage_bytes());
+        }
+
+        // cgroup memory.max: the smallest limit on the path to the root wins, "max" means none
+        std::filesystem::path root = "test_memory_planner_cgroup";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "jobs" / "render");
+        std::ofstream(root / "jobs" / "memory.max") << "268435456\n";
+        std::ofstream(root / "jobs" / "render" / "memory.max") << "max\n";
+        std::ofstream(root / "cgroup") << "0::/jobs/render\n";
+        std::string source;
+        assert(MemoryPlanner::cgroup_memory_limit(source, root.string(), (root / "cgroup").string()) == 268435456);
+        assert(source == (root / "jobs" / "memory.max").string());
+        std::ofstream(root / "jobs" / "memory.max") << "max\n";
+        assert(MemoryPlanner::cgroup_memory_limit(source, root.string(), (root / "cgroup").string()) == 0);
+        std::filesystem::remove_all(root);
+
+        // Plans: a generous budget keeps the request, tighter ones drop representations cheapest first
+        MemoryPlanner::Request request;
+        request.width = 1024;
+        request.height = 768;
+        request.scene_bytes = 64 * 1024;
+        request.sphere_count = 2000;
+        request.bvh = true;
+        request.raster_primary = true;
+        request.qoi_output = true;
+        request.threads = 1;
+        request.streaming_allowed = true;
+        MemoryPlanner::Plan generous = MemoryPlanner::plan(request, 1ull << 30, "test");
+        assert(generous.fits && generous.changes.empty() && generous.bvh && generous.raster_primary && !generous.streamed_output);
+        assert(generous.total_bytes() == generous.requested_bytes);
+
+        MemoryPlanner::Plan tight = MemoryPlanner::plan(request, generous.requested_bytes - 1, "test");
+        assert(tight.fits && tight.changes.size() == 1 && !tight.raster_primary && tight.bvh && !tight.streamed_output);
+
+        size_t framebuffer = static_cast<size_t>(request.width) * request.height * sizeof(Vector3);
+        MemoryPlanner::Plan streamed = MemoryPlanner::plan(request, generous.requested_bytes - framebuffer, "test");
+        assert(streamed.fits && streamed.streamed_output && streamed.bvh && streamed.qoi_bands > 1);
+        assert(streamed.total_bytes() <= streamed.budget_bytes);
+
+        MemoryPlanner::Plan impossible = MemoryPlanner::plan(request, MemoryPlanner::runtime_reserve_bytes, "test");
+        assert(!impossible.fits && !impossible.bvh && impossible.streamed_output);
+
+        // Progressive path tracing needs its accumulation buffer: never streamed
+        request.path_tracing = true;
+        MemoryPlanner::Plan path = MemoryPlanner::plan(request, generous.requested_bytes / 2, "test");
+        assert(!path.streamed_output && !path.raster_primary);
+
+        // Streamed output writes the same files as rendering into an Image first
+        Image image(29, 17);
+        auto color = [](int x, int y) { return Vector3(x / 28.0f, y / 16.0f, 0.25f + 0.5f * ((x * y) % 3 == 0)); };
+        for (int y = 0; y < image.height; y++) {
+            for (int x = 0; x < image.width; x++) image.set_pixel(x, y, color(x, y));
+        }
+        auto render_row = [&](int y, Vector3* row) {
+            for (int x = 0; x < image.width; x++) row[x] = color(x, y);
+        };
+        QoiEncoder::Settings settings;
+        settings.bands = 3;
+        settings.thread_count = 2;
+        auto read_bytes = [](const std::string& filename) {
+            std::ifstream file(filename, std::ios::binary);
+            return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        };
+        for (bool qoi : {false, true}) {
+            std::string extension = qoi ? ".qoi" : ".png";
+            assert(qoi ? image.save_to_qoi("test_stream_reference" + extension, true, settings)
+                       : image.save_to_png("test_stream_reference" + extension, true));
+            assert(Image::save_streamed("test_stream" + extension, image.width, image.height, qoi, settings, render_row));
+            assert(read_bytes("test_stream" + extension) == read_bytes("test_stream_reference" + extension));
+            std::filesystem::remove("test_stream" + extension);
+            std::filesystem::remove("test_stream_reference" + extension);
+        }
+
+        std::cout << "Memory planner: PASS" << std::endl;
+        return true;
+    }
+
+    // === SIMD KERNEL TESTS ===
+    // Every supported instruction set against the scalar code on ordinary inputs and every tail length
+    // (tests/simd_differential_test.cpp covers the adversarial inputs)
+    bool test_simd_kernels() {
+        std::cout << "\n=== SIMD Kernel Tests ===" << std::endl;
+        auto close = [](float expected, float actual) {
+            return std::abs(expected - actual) <= 1e-4f * std::max(1.0f, std::abs(expected));
+        };
+        Ray ray(Point3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f));
+        CookTorranceMaterial metal(Vector3(0.9f, 0.6f, 0.3f), 0.4f, 1.0f, 0.04f, false);
+        LambertMaterial diffuse(Vector3(0.8f, 0.5f, 0.2f));
+        Camera camera(Point3(0.0f, 0.0f, 0.0f), Point3(0.0f, 0.0f, -1.0f), Vector3(0, 1, 0), 60.0f, 4.0f / 3.0f);
+
+        for (SimdKernels::Isa isa : SimdKernels::supported_isas()) {
+            for (size_t count = 1; count <= 33; count++) {
+                // Spheres in front of, around and behind the ray origin
+                SimdKernels::SphereBatch spheres;
+                std::vector<Sphere> reference;
+                SimdKernels::Vector3Batch wi, wo, normal, radiance;
+                std::vector<float> pixel_x, pixel_y;
+                for (size_t i = 0; i < count; i++) {
+                    float offset = static_cast<float>(i) - 4.0f;
+                    reference.emplace_back(Point3(0.1f * (i % 3), 0.0f, -offset), 0.5f + 0.05f * i, 0);
+                    spheres.add(reference.back());
+                    float angle = 0.1f * i;
+                    wi.add(Vector3(std::sin(angle), 0.3f, std::cos(angle)).normalize());
+                    wo.add(Vector3(-0.2f, std::cos(angle), 0.5f).normalize());
+                    normal.add(Vector3(0.0f, std::sin(angle), 1.0f).normalize());
+                    radiance.add(Vector3(1.0f + i, 2.0f, 0.5f));
+                    pixel_x.push_back(7.0f * i - 10.0f);
+                    pixel_y.push_back(5.0f * i);
+                }
+                std::vector<float> t;
+                SimdKernels::intersect_spheres(isa, ray, spheres, t);
+                SimdKernels::Vector3Batch brdf, scattered, directions;
+                SimdKernels::cook_torrance_brdf(isa, metal, wi, wo, normal, brdf);
+                SimdKernels::lambert_scatter(isa, diffuse, wi, normal, radiance, scattered);
+                SimdKernels::camera_ray_directions(isa, camera, pixel_x, pixel_y, 160, 120, directions);
+                for (size_t i = 0; i < count; i++) {
+                    Sphere::Intersection hit = reference[i].intersect(ray, false);
+                    assert(hit.hit ? close(hit.t, t[i]) : std::isinf(t[i]));
+                    Vector3 expected = metal.evaluate_brdf(wi[i], wo[i], normal[i], false);
+                    assert(close(expected.x, brdf.x[i]) && close(expected.y, brdf.y[i]) && close(expected.z, brdf.z[i]));
+                    expected = diffuse.scatter_light(wi[i], wo[i], normal[i], radiance[i], false);
+                    assert(close(expected.x, scattered.x[i]) && close(expected.y, scattered.y[i]) &&
+                           close(expected.z, scattered.z[i]));
+                    expected = camera.generate_ray(pixel_x[i], pixel_y[i], 160, 120).direction;
+                    assert(close(expected.x, directions.x[i]) && close(expected.y, directions.y[i]) &&
+                           close(expected.z, directions.z[i]));
+                }
+            }
+            std::cout << "  " << SimdKernels::isa_name(isa) << ": matches the scalar kernels" << std::endl;
+        }
+
+        // Unsupported variants fall back to scalar instead of executing illegal instructions
+        SimdKernels::SphereBatch single;
+        single.add(Sphere(Point3(0.0f, 0.0f, -5.0f), 1.0f, 0));
+        std::vector<float> t;
+        for (SimdKernels::Isa isa : {SimdKernels::Isa::Scalar, SimdKernels::Isa::SSE, SimdKernels::Isa::AVX2,
+                                     SimdKernels::Isa::AVX512}) {
+            SimdKernels::intersect_spheres(isa, ray, single, t);
+            assert(t.size() == 1 && close(4.0f, t[0]));
+        }
+        assert(SimdKernels::isa_supported(SimdKernels::best_isa()));
+
+        std::cout << "SIMD kernels: PASS" << std::endl;
+        return true;
+    }
+
+    // === SCENE INCLUDE TESTS ===
+    // include merges a file as if its lines were pasted in; each file is parsed once per process
+    bool test_scene_includes() {
+        std::cout << "\n=== Scene Include Tests ===" << std::endl;
+        std::filesystem::path root = "test_scene_includes";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "library");
+        std::ofstream(root / "library" / "materials.scene")
+            << "material_lambert red 0.8 0.2 0.2\n"
+            << "material_cook_torrance gold 1.0 0.8 0.3 0.2 1.0 0.5\n";
+        // The second sphere uses a material the including scene defines
+        std::ofstream(root / "library" / "cluster.scene")
+            << "include materials.scene\n"
+            << "sphere 0 0 -5 1 red\n"
+            << "sphere 1 0 -5 0.5 floor\n"
+            << "light_point 0 5 0 1 1 1 10\n";
+        std::ofstream(root / "scene.scene")
+            << "material_lambert floor 0.5 0.5 0.5\n"
+            << "include \"library/cluster.scene\"\n"
+            << "sphere 0 -100 -5 99 gold\n";
+
+        // Same scene as the included lines pasted in
+        SceneLoader::clear_include_cache();
+        Scene scene = SceneLoader::load_from_file((root / "scene.scene").string());
+        Scene pasted = SceneLoader::load_from_string(
+            "material_lambert floor 0.5 0.5 0.5\n"
+            "material_lambert red 0.8 0.2 0.2\n"
+            "material_cook_torrance gold 1.0 0.8 0.3 0.2 1.0 0.5\n"
+            "sphere 0 0 -5 1 red\n"
+            "sphere 1 0 -5 0.5 floor\n"
+            "light_point 0 5 0 1 1 1 10\n"
+            "sphere 0 -100 -5 99 gold\n");
+        assert(scene.materials.size() == 3 && scene.primitives.size() == 3 && scene.lights.size() == 1);
+        for (size_t i = 0; i < pasted.primitives.size(); i++) {
+            assert(scene.primitives[i].material_index == pasted.primitives[i].material_index);
+            assert(scene.primitives[i].radius == pasted.primitives[i].radius);
+        }
+        for (size_t i = 0; i < pasted.materials.size(); i++) {
+            assert(scene.materials[i]->type == pasted.materials[i]->type);
+        }
+        SceneLoader::IncludeCacheStatistics stats = SceneLoader::include_cache_statistics();
+        assert(stats.parses == 2 && stats.hits == 0);
+        std::cout << "  Nested includes match the pasted scene: PASSED" << std::endl;
+
+        // A second scene (next view or frame) merges the parsed asset; cluster.scene is not read again
+        Scene again = SceneLoader::load_from_file((root / "scene.scene").string());
+        stats = SceneLoader::include_cache_statistics();
+        assert(stats.parses == 2 && stats.hits == 1);
+        assert(again.primitives.size() == 3 && again.primitives[1].material_index == 0);
+        assert(again.materials[1].get() != scene.materials[1].get());
+        std::cout << "  Second load served from the include cache: PASSED" << std::endl;
+
+        // Changing a nested include invalidates everything that includes it
+        auto modified = std::filesystem::last_write_time(root / "library" / "materials.scene");
+        std::ofstream(root / "library" / "materials.scene")
+            << "material_lambert red 0.1 0.9 0.1\n"
+            << "material_cook_torrance gold 1.0 0.8 0.3 0.2 1.0 0.5\n";
+        std::filesystem::last_write_time(root / "library" / "materials.scene", modified + std::chrono::seconds(10));
+        Scene changed = SceneLoader::load_from_file((root / "scene.scene").string());
+        stats = SceneLoader::include_cache_statistics();
+        assert(stats.parses == 4 && stats.hits == 1);
+        assert(std::abs(changed.materials[1]->base_color.y - 0.9f) < 1e-6f);
+        std::cout << "  Modified include parsed again: PASSED" << std::endl;
+
+        // Names the including scene does not define skip those spheres; the filter sees merged spheres
+        int filter_calls = 0;
+        Scene unresolved = SceneLoader::load_from_string(
+            "include library/cluster.scene\n", "lambert",
+            [&](const Sphere&) { filter_calls++; return true; }, (root / "scene.scene").string());
+        assert(unresolved.primitives.size() == 1 && unresolved.materials.size() == 2 && filter_calls == 1);
+        std::cout << "  Unresolved material names: PASSED" << std::endl;
+
+        // Cycles are reported instead of recursing; the rest of each file still loads
+        std::ofstream(root / "cycle_a.scene") << "include cycle_b.scene\nmaterial_lambert a 0.5 0.5 0.5\n";
+        std::ofstream(root / "cycle_b.scene") << "include cycle_a.scene\nmaterial_lambert b 0.5 0.5 0.5\n";
+        std::ofstream(root / "self.scene") << "include self.scene\nmaterial_lambert s 0.5 0.5 0.5\n";
+        Scene cycle = SceneLoader::load_from_file((root / "cycle_a.scene").string());
+        assert(cycle.materials.size() == 2);
+        Scene self = SceneLoader::load_from_file((root / "self.scene").string());
+        assert(self.materials.size() == 1);
+        Scene missing = SceneLoader::load_from_string("include no_such_file.scene\nmaterial_lambert m 0.5 0.5 0.5\n");
+        assert(missing.materials.size() == 1);
+
+        // A cached asset whose nested include was missing is parsed again once that file exists
+        std::ofstream(root / "outer.scene") << "include inner.scene\nmaterial_lambert o 0.5 0.5 0.5\n";
+        std::string outer_scene = "include outer.scene\n";
+        std::string outer_source = (root / "scene.scene").string();
+        Scene without_inner = SceneLoader::load_from_string(outer_scene, "lambert", nullptr, outer_source);
+        assert(without_inner.materials.size() == 1);
+        assert(SceneLoader::load_from_string(outer_scene, "lambert", nullptr, outer_source).materials.size() == 1);
+        std::ofstream(root / "inner.scene") << "material_lambert i 0.5 0.5 0.5\n";
+        Scene with_inner = SceneLoader::load_from_string(outer_scene, "lambert", nullptr, outer_source);
+        assert(with_inner.materials.size() == 2);
+        std::cout << "  Include cycles and missing files: PASSED" << std::endl;
+
+        std::filesystem::remove_all(root);
+        SceneLoader::clear_include_cache();
+        return true;
+    }
+
+    // === COST ATTRIBUTION TESTS ===
+    // Shading cost per material and light: counts match the shading work, images are unchanged
+    bool test_cost_attribution() {
+        std::cout << "\n=== Cost Attribution Tests ===" << std::endl;
+        // Light 1 sits behind the blocker for hits on the left sphere
+        Scene scene = SceneLoader::load_from_string(
+            "material_lambert matte 0.7 0.7 0.7\n"
+            "material_cook_torrance metal 0.9 0.6 0.3 0.3 1.0 0.5\n"
+            "sphere -1.5 0 -5 1 matte\n"
+            "sphere 1.5 0 -5 1 metal\n"
+            "sphere -1.5 0 -1 0.3 matte\n"
+            "light_point 0 5 -3 1 1 1 10\n"
+            "light_point -1.5 0 2 1 1 1 10\n");
+        assert(scene.materials.size() == 2 && scene.lights.size() == 2 && scene.primitives.size() == 3);
+
+        CostAttribution::Counters costs(scene);
+        Point3 eye(0.0f, 0.0f, 0.0f);
+        long long hits[2] = {0, 0}, occluded[2] = {0, 0}, unoccluded = 0;
+        for (int i = 0; i < 40; i++) {
+            float x = (i % 2 == 0 ? -1.5f : 1.5f) + 0.02f * (i / 2 - 10);
+            Ray ray(eye, Vector3(x, 0.1f, -5.0f).normalize());
+            Scene::Intersection hit = scene.intersect(ray, false);
+            if (!hit.hit || hit.primitive != &scene.primitives[i % 2]) continue;
+            Vector3 plain = Renderer::shade_direct_lighting(scene, hit, eye);
+            Vector3 attributed = Renderer::shade_direct_lighting(scene, hit, eye, &costs);
+            assert(plain.x == attributed.x && plain.y == attributed.y && plain.z == attributed.z);
+            hits[hit.primitive->material_index]++;
+            Vector3 p(hit.point.x, hit.point.y, hit.point.z);
+            for (size_t l = 0; l < scene.lights.size(); l++) {
+                Vector3 direction;
+                float distance;
+                scene.lights[l]->illuminate(p, direction, distance);
+                bool blocked = scene.lights[l]->is_occluded(p, direction, distance, scene);
+                occluded[l] += blocked ? 1 : 0;
+                unoccluded += blocked ? 0 : 1;
+            }
+        }
+        assert(hits[0] > 0 && hits[1] > 0);
+        for (int m = 0; m < 2; m++) {
+            assert(costs.materials[m].shading_events == hits[m]);
+        }
+        for (int l = 0; l < 2; l++) {
+            assert(costs.lights[l].shadow_rays == hits[0] + hits[1]);
+            assert(costs.lights[l].occluded == occluded[l]);
+        }
+        assert(occluded[1] > 0);
+        assert(costs.materials[0].brdf_evaluations + costs.materials[1].brdf_evaluations == unoccluded);
+        assert(costs.materials[0].shading_ms > 0.0 && costs.lights[0].light_ms > 0.0);
+
+        // Merging per-thread counters sums them
+        CostAttribution::Counters merged;
+        merged.merge(costs);
+        merged.merge(costs);
+        assert(merged.materials.size() == 2 && merged.materials[1].shading_events == 2 * hits[1]);
+        assert(merged.lights[1].occluded == 2 * occluded[1]);
+
+        // LOD proxy hits have no primitive and count in their own entry
+        Scene::Intersection proxy_hit = scene.intersect(Ray(eye, Vector3(-1.5f, 0.1f, -5.0f).normalize()), false);
+        proxy_hit.primitive = nullptr;
+        assert(CostAttribution::material_index(proxy_hit) == CostAttribution::lod_proxy);
+        costs.record_shading(CostAttribution::material_index(proxy_hit), CostAttribution::Clock::now());
+        costs.record_brdf_evaluation(CostAttribution::lod_proxy);
+        merged.merge(costs);
+        assert(merged.lod_proxies.shading_events == 1 && merged.lod_proxies.brdf_evaluations == 1);
+        assert(merged.materials[0].shading_events == 3 * hits[0]);
+        CostAttribution::print(merged, scene);
+        std::cout << "  Direct lighting counts and merge: PASSED" << std::endl;
+
+        // Path tracing with per-thread counters renders the same image
+        PathTracer::Settings settings;
+        settings.samples_per_pixel = 2;
+        settings.max_bounces = 2;
+        settings.thread_count = 2;
+        std::vector<Vector3> plain_pixels, attributed_pixels;
+        Camera camera(Point3(0, 0, 0), Point3(0, 0, -5), Vector3(0, 1, 0), 60.0f, 16.0f / 12.0f);
+        PathTracer::Statistics plain_stats = PathTracer(scene, settings).render(camera, 16, 12, plain_pixels);
+        settings.cost_attribution = true;
+        PathTracer::Statistics stats = PathTracer(scene, settings).render(camera, 16, 12, attributed_pixels);
+        assert(plain_pixels.size() == attributed_pixels.size());
+        for (size_t i = 0; i < plain_pixels.size(); i++) {
+            assert(plain_pixels[i].x == attributed_pixels[i].x && plain_pixels[i].y == attributed_pixels[i].y &&
+                   plain_pixels[i].z == attributed_pixels[i].z);
+        }
+        assert(plain_stats.costs.materials.empty());
+        long long events = 0, evaluations = 0;
+        for (const auto& cost : stats.costs.materials) {
+            events += cost.shading_events;
+            evaluations += cost.brdf_evaluations;
+        }
+        assert(events > 0 && events <= stats.paths + stats.bounces);
+        assert(evaluations >= stats.bounces);
+        for (const auto& cost : stats.costs.lights) {
+            assert(cost.shadow_rays <= events && cost.occluded <= cost.shadow_rays);
+        }
+        CostAttribution::print(stats.costs, scene, 1);
+        std::cout << "  Path tracing per-thread attribution: PASSED" << std::endl;
+        return true;
+    }
+
+    // === SHADOW BUNDLE TESTS ===
+    // Bundled point-light shadow rays must give exactly the per-ray occlusion and image
+    bool test_shadow_bundles() {
+        std::cout << "\n=== Shadow Bundle Tests ===" << std::endl;
+        // A floor of small spheres under a blocker row, one point light and one directional light
+        std::ostringstream content;
+        content << "material_lambert matte 0.7 0.7 0.7\n";
+        for (int z = 0; z < 12; z++) {
+            for (int x = 0; x < 12; x++) {
+                content << "sphere " << (x - 5.5f) * 0.5f << " -1.5 " << -3.0f - z * 0.5f << " 0.3 matte\n";
+            }
+        }
+        for (int x = 0; x < 6; x++) {
+            content << "sphere " << (x - 2.5f) * 0.9f << " 0.5 -5 0.35 matte\n";
+        }
+        content << "light_point 0.3 3 -5.5 1 1 1 20\n";
+        content << "light_directional -0.3 -1 -0.2 1 1 1 0.5\n";
+        Scene scene = SceneLoader::load_from_string(content.str());
+        assert(scene.primitives.size() == 150 && scene.lights.size() == 2);
+        const Vector3& light_position = static_cast<const PointLight&>(*scene.lights[0]).position;
+
+        int width = 32, height = 24;
+        Camera camera(Point3(0, 0, 1), Point3(0, -1, -5), Vector3(0, 1, 0), 60.0f, static_cast<float>(width) / height);
+        std::vector<ShadowBundleTracer::ShadowRay> rays;
+        std::vector<unsigned char> expected;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Scene::Intersection hit = scene.intersect(camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height), false);
+                if (!hit.hit) continue;
+                Vector3 p(hit.point.x, hit.point.y, hit.point.z), direction;
+                float distance;
+                scene.lights[0]->illuminate(p, direction, distance);
+                rays.push_back(ShadowBundleTracer::shadow_ray(p, direction, distance));
+                expected.push_back(scene.lights[0]->is_occluded(p, direction, distance, scene) ? 1 : 0);
+            }
+        }
+        long long occluded_count = std::count(expected.begin(), expected.end(), 1);
+        assert(occluded_count > 0 && occluded_count < static_cast<long long>(expected.size()));
+
+        // Without a BVH every ray is traced on its own; with one, nodes are culled for the whole bundle
+        for (int with_bvh = 0; with_bvh < 2; with_bvh++) {
+            if (with_bvh) scene.build_bvh();
+            ShadowBundleTracer::Statistics stats;
+            std::vector<unsigned char> occluded;
+            ShadowBundleTracer::trace_bundle(scene, light_position, rays, occluded, stats);
+            assert(occluded == expected);
+            assert(stats.occluded_rays == occluded_count);
+            if (with_bvh) {
+                assert(stats.bundles == 1 && stats.nodes_culled > 0);
+                assert(stats.leaf_ray_tests < static_cast<long long>(rays.size() * scene.primitives.size()));
+            }
+        }
+        std::cout << "  Bundle occlusion equals is_occluded (" << occluded_count << " of " << rays.size()
+                  << " occluded): PASSED" << std::endl;
+
+        // Tiled frames match Renderer::render_frame pixel for pixel, for any tile size
+        std::vector<Vector3> reference;
+        Renderer::render_frame(scene, camera, width, height, reference);
+        for (int tile : {1, 5, 8, 64}) {
+            ShadowBundleTracer::Settings settings;
+            settings.tile_size = tile;
+            ShadowBundleTracer tracer(settings);
+            std::vector<Vector3> pixels;
+            tracer.render_frame(scene, camera, width, height, pixels);
+            assert(pixels.size() == reference.size());
+            for (size_t i = 0; i < pixels.size(); i++) {
+                assert(pixels[i].x == reference[i].x && pixels[i].y == reference[i].y && pixels[i].z == reference[i].z);
+            }
+            assert(tracer.statistics().single_rays > 0);
+        }
+        std::cout << "  Tiled bundle frames equal per-ray frames: PASSED" << std::endl;
+        return true;
+    }
+
 } // namespace MathematicalTests
 
 int main() {
@@ -2604,6 +4754,90 @@ int main() {
         all_passed &= MathematicalTests::test_light_parameter_validation();
         all_passed &= MathematicalTests::test_scene_multi_light_management();
         
+        // Checkerboard sequence rendering tests
+        std::cout << "\n=== CHECKERBOARD SEQUENCE RENDERING TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_camera_project_to_pixel_round_trip();
+        all_passed &= MathematicalTests::test_checkerboard_static_camera_reconstruction();
+        
+        // Golden-image metric tests
+        std::cout << "\n=== GOLDEN-IMAGE METRIC TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_image_metrics_known_values();
+        
+        // Path guiding tests
+        std::cout << "\n=== PATH GUIDING TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_material_sampling_pdf_consistency();
+        all_passed &= MathematicalTests::test_directional_quadtree_distribution();
+        all_passed &= MathematicalTests::test_sdtree_merge_and_refine();
+        all_passed &= MathematicalTests::test_path_tracer_multithreaded_render();
+        
+        // Level-of-detail BVH tests
+        std::cout << "\n=== LEVEL-OF-DETAIL BVH TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_lod_bvh_exact_matches_linear();
+        all_passed &= MathematicalTests::test_lod_bvh_distant_cluster_proxies();
+        all_passed &= MathematicalTests::test_lazy_bvh_matches_eager_and_expands_on_demand();
+        all_passed &= MathematicalTests::test_stackless_bvh_traversal_matches_stack();
+        
+        // Huge page tests
+        std::cout << "\n=== HUGE PAGE TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_huge_page_rehome();
+        
+        // Metrics export tests
+        std::cout << "\n=== METRICS EXPORT TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_metrics_exporter_textfile();
+        
+        // Cost prediction tests
+        std::cout << "\n=== COST PREDICTION TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_cost_predictor_extrapolation();
+        all_passed &= MathematicalTests::test_path_tracer_scanline_order_invariance();
+        
+        // Render cache tests
+        std::cout << "\n=== RENDER CACHE TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_render_cache_images_and_tiles();
+        
+        // Layered material tests
+        std::cout << "\n=== LAYERED MATERIAL TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_openpbr_stochastic_lobe_selection();
+        
+        // Material graph tests
+        std::cout << "\n=== MATERIAL GRAPH TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_material_graph_compilation();
+
+        std::cout << "\n=== SPHERE LIGHT TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_sphere_light_cone_sampling();
+
+        std::cout << "\n=== AREA LIGHT SAMPLING TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_area_light_solid_angle_sampling();
+
+        std::cout << "\n=== TIME SERIES TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_time_series_recorder();
+
+        std::cout << "\n=== RASTERIZED PRIMARY VISIBILITY TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_rasterized_primary_visibility();
+
+        std::cout << "\n=== QOI OUTPUT TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_qoi_banded_encoding();
+        
+        std::cout << "\n=== SORT-LAST RENDERING TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_sort_last_rendering();
+        
+        std::cout << "\n=== CPU BUDGET TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_cpu_budget();
+        
+        std::cout << "\n=== MEMORY PLANNER TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_memory_planner();
+        
+        std::cout << "\n=== SIMD KERNEL TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_simd_kernels();
+
+        std::cout << "\n=== SCENE INCLUDE TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_scene_includes();
+
+        std::cout << "\n=== COST ATTRIBUTION TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_cost_attribution();
+
+        std::cout << "\n=== SHADOW BUNDLE TESTS ===" << std::endl;
+        all_passed &= MathematicalTests::test_shadow_bundles();
+        
         if (all_passed) {
             std::cout << "\n✅ ALL MATHEMATICAL TESTS PASSED" << std::endl;
             std::cout << "Mathematical foundation verified for Epic 1 & 3 development." << std::endl;
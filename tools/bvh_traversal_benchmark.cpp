@@ -0,0 +1,175 @@
+// BVH traversal benchmark: conventional stack vs stackless (parent links) on the same tree
+//
+// Builds one LodBVH over the scene and a wide batch of rays: the camera's primary rays plus one
+// diffuse bounce ray from every primary hit (incoherent, like a path tracer's second segment).
+// The batch is traced four ways:
+//   1. one ray at a time, stack traversal         (LodBVH::intersect)
+//   2. one ray at a time, stackless traversal     (LodBVH::intersect_stackless)
+//   3. whole batch in flight, stack cursors       (LodBVH::intersect_batch, Traversal::Stack)
+//   4. whole batch in flight, stackless cursors   (LodBVH::intersect_batch, Traversal::Stackless)
+// and reports traversal state per in-flight ray, batch state memory, node visits and rays per
+// second. Exits non-zero if any traversal finds a different closest hit, so the build's test
+// suite catches a broken parent link or child order.
+//
+// Usage: bvh_traversal_benchmark --scene <file> [--resolution WxH] [--repeat N]
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/camera.hpp"
+#include "src/core/image.hpp"
+#include "src/core/lod_bvh.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Time `repeat` passes over the batch, returning total milliseconds
+template <typename TraceFunction>
+static double time_passes(int repeat, TraceFunction trace) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        trace();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string scene_filename;
+    Resolution resolution = Resolution::parse_from_string("256x192");
+    int repeat = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scene_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cout << "Usage: bvh_traversal_benchmark --scene <file> [--resolution WxH] [--repeat N]" << std::endl;
+            return 1;
+        }
+    }
+    if (scene_filename.empty()) {
+        std::cout << "Usage: bvh_traversal_benchmark --scene <file> [--resolution WxH] [--repeat N]" << std::endl;
+        return 1;
+    }
+
+    Scene scene = SceneLoader::load_from_file(scene_filename);
+    if (scene.primitives.empty()) {
+        std::cout << "ERROR: Scene has no spheres" << std::endl;
+        return 1;
+    }
+    LodBVH bvh(scene.primitives, scene.materials);
+
+    // Same default camera as the main renderer
+    int width = resolution.width;
+    int height = resolution.height;
+    Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                  static_cast<float>(width) / height);
+    camera.set_aspect_ratio_from_resolution(width, height);
+
+    // Batch: primary rays, then a cosine-weighted bounce from every primary hit
+    std::vector<Ray> rays;
+    int tests = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            rays.push_back(camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height));
+        }
+    }
+    std::mt19937 rng(111);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    size_t primary_count = rays.size();
+    for (size_t i = 0; i < primary_count; i++) {
+        LodBVH::Hit hit = bvh.intersect(rays[i], RayCone(), 0.0f, scene.primitives, scene.materials, tests);
+        if (!hit.hit) continue;
+        Vector3 n = hit.normal;
+        Vector3 tangent = (std::abs(n.x) > 0.9f ? Vector3(0, 1, 0) : Vector3(1, 0, 0)).cross(n).normalize();
+        Vector3 bitangent = n.cross(tangent);
+        float r = std::sqrt(uniform(rng)), phi = 2.0f * static_cast<float>(M_PI) * uniform(rng);
+        Vector3 direction = tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) +
+                            n * std::sqrt(std::max(0.0f, 1.0f - r * r));
+        Vector3 origin = Vector3(hit.point.x, hit.point.y, hit.point.z) + n * 0.001f;
+        rays.push_back(Ray(Point3(origin.x, origin.y, origin.z), direction.normalize()));
+    }
+
+    std::cout << "=== BVH Traversal Benchmark ===" << std::endl;
+    std::cout << "Scene: " << scene_filename << " (" << scene.primitives.size() << " spheres, " << bvh.node_count()
+              << " nodes, depth " << bvh.depth() << ")" << std::endl;
+    std::cout << "Ray batch: " << rays.size() << " rays (" << primary_count << " primary, "
+              << rays.size() - primary_count << " diffuse bounces)" << std::endl;
+
+    struct Result {
+        const char* name;
+        bool batch;
+        size_t state_bytes;
+        double ms;
+        long long visits;
+        std::vector<LodBVH::Hit> hits;
+    };
+    std::vector<Result> results = {
+        {"single ray, stack",     false, sizeof(int) * 129, 0.0, 0, {}},   // intersect(): 128-entry stack + size
+        {"single ray, stackless", false, LodBVH::traversal_state_bytes(LodBVH::Traversal::Stackless), 0.0, 0, {}},
+        {"batch, stack",          true,  LodBVH::traversal_state_bytes(LodBVH::Traversal::Stack), 0.0, 0, {}},
+        {"batch, stackless",      true,  LodBVH::traversal_state_bytes(LodBVH::Traversal::Stackless), 0.0, 0, {}},
+    };
+    for (size_t mode = 0; mode < results.size(); mode++) {
+        Result& result = results[mode];
+        bvh.node_visits = 0;
+        result.ms = time_passes(repeat, [&]() {
+            if (mode < 2) {
+                result.hits.resize(rays.size());
+                for (size_t i = 0; i < rays.size(); i++) {
+                    result.hits[i] = mode == 0
+                        ? bvh.intersect(rays[i], RayCone(), 0.0f, scene.primitives, scene.materials, tests)
+                        : bvh.intersect_stackless(rays[i], RayCone(), 0.0f, scene.primitives, scene.materials, tests);
+                }
+            } else {
+                bvh.intersect_batch(rays, mode == 2 ? LodBVH::Traversal::Stack : LodBVH::Traversal::Stackless,
+                                    scene.primitives, scene.materials, result.hits, tests);
+            }
+        });
+        result.visits = bvh.node_visits.load() / repeat;
+    }
+
+    // Every traversal must find the same closest hit for every ray
+    int mismatches = 0;
+    for (size_t mode = 1; mode < results.size(); mode++) {
+        for (size_t i = 0; i < rays.size(); i++) {
+            const LodBVH::Hit& a = results[0].hits[i];
+            const LodBVH::Hit& b = results[mode].hits[i];
+            if (a.hit != b.hit || (a.hit && (a.primitive_index != b.primitive_index || a.t != b.t))) mismatches++;
+        }
+    }
+
+    std::cout << "\n=== BVH Traversal Results ===" << std::endl;
+    std::cout << "Passes per traversal: " << repeat << std::endl;
+    for (const Result& result : results) {
+        double rays_per_second = rays.size() * repeat / (result.ms / 1000.0);
+        std::cout << "  " << result.name << ": " << result.state_bytes << " bytes/ray in flight";
+        if (result.batch) {
+            std::cout << " (" << result.state_bytes * rays.size() / 1024 << " KB for the batch)";
+        }
+        std::cout << ", " << static_cast<double>(result.visits) / rays.size() << " node visits/ray, "
+                  << result.ms << " ms (" << rays_per_second << " rays/sec)" << std::endl;
+    }
+    std::cout << "Batch state reduction: " << static_cast<double>(results[2].state_bytes) / results[3].state_bytes << "x" << std::endl;
+    std::cout << "Stackless vs stack throughput (batch): " << results[2].ms / std::max(results[3].ms, 1e-6) << "x" << std::endl;
+    std::cout << "Closest-hit mismatches: " << mismatches << std::endl;
+
+    if (mismatches > 0) {
+        std::cout << "FAIL: traversals disagree" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: stack and stackless traversals find identical hits" << std::endl;
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Compiled scene benchmark and equivalence check
+//
+// Renders the same scene twice with the same camera:
+//   1. Generic path: SceneLoader + Renderer::render_frame (virtual materials/lights, loops)
+//   2. Compiled path: CompiledScene::render_frame generated by tools/scene_compiler
+// and reports rays per second for both, the speedup, and the maximum per-channel pixel
+// difference. Exits non-zero if the images differ by more than the tolerance, so the
+// build's test suite catches any drift between the compiler and the generic renderer.
+//
+// Usage: compiled_scene_benchmark --scene <file> [--resolution WxH] [--repeat N] [--tolerance T]
+// The --scene file must be the one the linked compiled translation unit was generated from.
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/renderer.hpp"
+#include "src/core/compiled_scene.hpp"
+#include "src/core/image.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Time `repeat` full-frame renders, returning total milliseconds
+template <typename RenderFunction>
+static double time_renders(int repeat, RenderFunction render) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        render();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string scene_filename;
+    Resolution resolution = Resolution::SMALL;
+    int repeat = 3;
+    float tolerance = 1e-3f;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scene_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = std::stof(argv[++i]);
+        } else {
+            std::cout << "Usage: compiled_scene_benchmark --scene <file> [--resolution WxH] [--repeat N] [--tolerance T]" << std::endl;
+            return 1;
+        }
+    }
+
+    CompiledScene::Info info = CompiledScene::info();
+    if (scene_filename.empty()) {
+        scene_filename = info.source_file;
+    }
+
+    std::cout << "=== Compiled Scene Benchmark ===" << std::endl;
+    std::cout << "Compiled from: " << info.source_file << " (" << info.sphere_count << " spheres, "
+              << info.material_count << " materials, " << info.light_count << " lights)" << std::endl;
+
+    Scene scene = SceneLoader::load_from_file(scene_filename);
+    if (static_cast<int>(scene.primitives.size()) != info.sphere_count ||
+        static_cast<int>(scene.lights.size()) != info.light_count) {
+        std::cout << "ERROR: Scene file does not match the compiled scene" << std::endl;
+        return 1;
+    }
+
+    // Same default camera as the main renderer
+    int width = resolution.width;
+    int height = resolution.height;
+    Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                  static_cast<float>(width) / height);
+    camera.set_aspect_ratio_from_resolution(width, height);
+
+    std::vector<Vector3> generic_pixels;
+    std::vector<Vector3> compiled_pixels;
+    double generic_ms = time_renders(repeat, [&]() {
+        Renderer::render_frame(scene, camera, width, height, generic_pixels);
+    });
+    double compiled_ms = time_renders(repeat, [&]() {
+        CompiledScene::render_frame(camera, width, height, compiled_pixels);
+    });
+
+    // Maximum per-channel difference between the two renders
+    float max_difference = 0.0f;
+    for (size_t i = 0; i < generic_pixels.size(); i++) {
+        max_difference = std::max(max_difference, std::abs(generic_pixels[i].x - compiled_pixels[i].x));
+        max_difference = std::max(max_difference, std::abs(generic_pixels[i].y - compiled_pixels[i].y));
+        max_difference = std::max(max_difference, std::abs(generic_pixels[i].z - compiled_pixels[i].z));
+    }
+
+    double rays = static_cast<double>(width) * height * repeat;
+    double generic_rays_per_second = rays / (generic_ms / 1000.0);
+    double compiled_rays_per_second = rays / (compiled_ms / 1000.0);
+
+    std::cout << "\n=== Compiled Scene Results ===" << std::endl;
+    std::cout << "Resolution: " << width << "x" << height << ", renders per path: " << repeat << std::endl;
+    std::cout << "Generic renderer:  " << generic_ms << " ms (" << generic_rays_per_second << " rays/sec)" << std::endl;
+    std::cout << "Compiled scene:    " << compiled_ms << " ms (" << compiled_rays_per_second << " rays/sec)" << std::endl;
+    std::cout << "Speedup: " << (generic_ms / std::max(compiled_ms, 1e-6)) << "x" << std::endl;
+    std::cout << "Max pixel difference: " << max_difference << " (tolerance " << tolerance << ")" << std::endl;
+
+    if (max_difference > tolerance) {
+        std::cout << "FAIL: compiled scene does not match generic renderer" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: compiled scene matches generic renderer" << std::endl;
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Image output benchmark: PNG (stb deflate) vs QOI in parallel row bands
+//
+// Renders one frame of a scene with the default camera, then times
+//   1. float → 8-bit conversion + stbi_write_png_to_func (what save_to_png does, minus the disk)
+//   2. QoiEncoder with 1 band on 1 thread (a plain serial QOI stream)
+//   3. QoiEncoder with --bands bands on --threads threads
+// and reports milliseconds, MB/s of raw RGB and the compression ratio of each. Every QOI stream is
+// decoded again with the serial decoder; exits non-zero unless all of them reproduce the 8-bit image
+// exactly, so the build's test suite catches a band boundary that breaks the standard stream.
+//
+// Usage: image_output_benchmark --scene <file> [--resolution WxH] [--threads N] [--bands N] [--repeat N]
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/camera.hpp"
+#include "src/core/image.hpp"
+#include "src/core/cpu_budget.hpp"
+#include "src/core/qoi_encoder.hpp"
+#include "src/core/renderer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Time `repeat` passes, returning milliseconds per pass
+template <typename PassFunction>
+static double time_passes(int repeat, PassFunction pass) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        pass();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repeat;
+}
+
+static void append_bytes(void* context, void* data, int size) {
+    auto* output = static_cast<std::vector<unsigned char>*>(context);
+    output->insert(output->end(), static_cast<unsigned char*>(data), static_cast<unsigned char*>(data) + size);
+}
+
+int main(int argc, char* argv[]) {
+    const char* usage = "Usage: image_output_benchmark --scene <file> [--resolution WxH] [--threads N] [--bands N] [--repeat N]";
+    std::string scene_filename;
+    Resolution resolution = Resolution::parse_from_string("1024x768");
+    int threads = CpuBudget::default_thread_count();
+    int bands = 0;
+    int repeat = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scene_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--bands") == 0 && i + 1 < argc) {
+            bands = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cout << usage << std::endl;
+            return 1;
+        }
+    }
+    if (scene_filename.empty()) {
+        std::cout << usage << std::endl;
+        return 1;
+    }
+
+    Scene scene = SceneLoader::load_from_file(scene_filename);
+    int width = resolution.width;
+    int height = resolution.height;
+    Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                  static_cast<float>(width) / height);
+    camera.set_aspect_ratio_from_resolution(width, height);
+    Image image(width, height);
+    Renderer::render_frame(scene, camera, width, height, image.pixels);
+    std::vector<unsigned char> rgb = image.to_8bit_rgb(true);
+    double raw_megabytes = rgb.size() / (1024.0 * 1024.0);
+
+    std::cout << "=== Image Output Benchmark ===" << std::endl;
+    std::cout << "Scene: " << scene_filename << ", " << width << "x" << height << " (" << raw_megabytes
+              << " MB raw RGB), passes: " << repeat << std::endl;
+
+    // 1. PNG: conversion + deflate, as Image::save_to_png
+    std::vector<unsigned char> png;
+    double png_ms = time_passes(repeat, [&]() {
+        png.clear();
+        std::vector<unsigned char> converted = image.to_8bit_rgb(true);
+        stbi_write_png_to_func(append_bytes, &png, width, height, 3, converted.data(), width * 3);
+    });
+
+    // 2./3. QOI: conversion inside the band threads, as Image::save_to_qoi
+    auto encode_qoi = [&](const QoiEncoder::Settings& settings, QoiEncoder::Statistics& stats) {
+        return QoiEncoder::encode(width, height, 3, [&](int first_row, int last_row, unsigned char* destination) {
+            image.to_8bit_rgb_rows(first_row, last_row, destination, true);
+        }, settings, &stats);
+    };
+    QoiEncoder::Settings serial_settings;
+    serial_settings.bands = 1;
+    serial_settings.thread_count = 1;
+    QoiEncoder::Settings banded_settings;
+    banded_settings.bands = bands;
+    banded_settings.thread_count = threads;
+    QoiEncoder::Statistics serial_stats, banded_stats;
+    std::vector<unsigned char> serial_qoi, banded_qoi;
+    double serial_ms = time_passes(repeat, [&]() { serial_qoi = encode_qoi(serial_settings, serial_stats); });
+    double banded_ms = time_passes(repeat, [&]() { banded_qoi = encode_qoi(banded_settings, banded_stats); });
+
+    // Encoding alone (pre-converted rows): the part QOI replaces deflate with
+    double encode_only_ms = time_passes(repeat, [&]() { QoiEncoder::encode(rgb.data(), width, height, 3, serial_settings); });
+
+    // Every stream must decode, serially, to the exact 8-bit image
+    int failures = 0;
+    for (int band_count : {1, 2, 3, 7, std::max(1, banded_stats.bands)}) {
+        QoiEncoder::Settings settings;
+        settings.bands = band_count;
+        settings.thread_count = threads;
+        std::vector<unsigned char> encoded = QoiEncoder::encode(rgb.data(), width, height, 3, settings);
+        int decoded_width, decoded_height, decoded_channels;
+        std::vector<unsigned char> decoded;
+        bool ok = QoiEncoder::decode(encoded, decoded_width, decoded_height, decoded_channels, decoded) &&
+                  decoded_width == width && decoded_height == height && decoded_channels == 3 && decoded == rgb;
+        if (!ok) {
+            std::cout << "Round trip with " << band_count << " band(s): MISMATCH" << std::endl;
+            failures++;
+        }
+    }
+
+    auto throughput = [&](double ms) { return raw_megabytes / (ms / 1000.0); };
+    auto ratio = [&](size_t bytes) { return static_cast<double>(rgb.size()) / bytes; };
+    std::cout << "\n=== Output Results (per frame) ===" << std::endl;
+    std::cout << "  PNG (stb deflate):         " << png_ms << " ms, " << throughput(png_ms) << " MB/s, "
+              << png.size() << " bytes (" << ratio(png.size()) << ":1)" << std::endl;
+    std::cout << "  QOI, 1 band:               " << serial_ms << " ms, " << throughput(serial_ms) << " MB/s, "
+              << serial_qoi.size() << " bytes (" << ratio(serial_qoi.size()) << ":1)" << std::endl;
+    std::cout << "  QOI, " << banded_stats.bands << " bands on " << banded_stats.threads << " thread(s): " << banded_ms
+              << " ms, " << throughput(banded_ms) << " MB/s, " << banded_qoi.size() << " bytes ("
+              << ratio(banded_qoi.size()) << ":1)" << std::endl;
+    std::cout << "  QOI encoding only, 1 band: " << encode_only_ms << " ms, " << throughput(encode_only_ms) << " MB/s"
+              << std::endl;
+    std::cout << "QOI (" << banded_stats.bands << " bands) vs PNG: " << png_ms / std::max(banded_ms, 1e-6) << "x faster"
+              << std::endl;
+
+    if (failures > 0) {
+        std::cout << "FAIL: QOI round trip differs from the 8-bit image" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: every QOI stream decodes to the exact 8-bit image" << std::endl;
+    return 0;
+}
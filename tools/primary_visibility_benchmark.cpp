@@ -0,0 +1,181 @@
+// Primary visibility benchmark: ray traversal vs rasterized visibility buffer
+//
+// Resolves "which sphere does each pixel see?" for the camera's primary rays three ways:
+//   1. linear Scene::intersect per pixel          (every ray against every sphere)
+//   2. BVH traversal per pixel                    (LodBVH::intersect, exact)
+//   3. PrimaryRasterizer: tile-binned sphere bounds, exact ray-sphere tests against the tile's bin,
+//      on one thread and on --threads threads
+// and reports ray-sphere tests per pixel and pixels per second. Exits non-zero if the visibility
+// buffer differs from the linear closest hit (sphere and t, bit-exact) anywhere, or if a full frame
+// shaded from the visibility buffer differs from Renderer::render_frame, so the build's test suite
+// catches a bound that clips a sphere.
+//
+// Usage: primary_visibility_benchmark --scene <file> [--resolution WxH] [--threads N] [--repeat N]
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/camera.hpp"
+#include "src/core/image.hpp"
+#include "src/core/cpu_budget.hpp"
+#include "src/core/lod_bvh.hpp"
+#include "src/core/primary_rasterizer.hpp"
+#include "src/core/renderer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Time `repeat` passes, returning total milliseconds
+template <typename PassFunction>
+static double time_passes(int repeat, PassFunction pass) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        pass();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const char* usage = "Usage: primary_visibility_benchmark --scene <file> [--resolution WxH] [--threads N] [--repeat N]";
+    std::string scene_filename;
+    Resolution resolution = Resolution::parse_from_string("256x192");
+    int threads = CpuBudget::default_thread_count();
+    int repeat = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scene_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cout << usage << std::endl;
+            return 1;
+        }
+    }
+    if (scene_filename.empty()) {
+        std::cout << usage << std::endl;
+        return 1;
+    }
+
+    Scene scene = SceneLoader::load_from_file(scene_filename);
+    if (scene.primitives.empty()) {
+        std::cout << "ERROR: Scene has no spheres" << std::endl;
+        return 1;
+    }
+    LodBVH bvh(scene.primitives, scene.materials);
+
+    // Same default camera as the main renderer
+    int width = resolution.width;
+    int height = resolution.height;
+    Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                  static_cast<float>(width) / height);
+    camera.set_aspect_ratio_from_resolution(width, height);
+    size_t pixel_count = static_cast<size_t>(width) * height;
+
+    std::cout << "=== Primary Visibility Benchmark ===" << std::endl;
+    std::cout << "Scene: " << scene_filename << " (" << scene.primitives.size() << " spheres), " << width << "x"
+              << height << ", passes: " << repeat << std::endl;
+
+    // 1. Linear reference
+    std::vector<const Sphere*> linear_hits(pixel_count);
+    std::vector<float> linear_depths(pixel_count);
+    int tests_before = scene.total_intersection_tests.load();
+    double linear_ms = time_passes(repeat, [&]() {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                Scene::Intersection hit = scene.intersect(ray, false);
+                size_t pixel = static_cast<size_t>(y) * width + x;
+                linear_hits[pixel] = hit.hit ? hit.primitive : nullptr;
+                linear_depths[pixel] = hit.hit ? hit.t : 0.0f;
+            }
+        }
+    });
+    long long linear_tests = static_cast<long long>(scene.total_intersection_tests.load() - tests_before) / repeat;
+
+    // 2. BVH traversal
+    int bvh_tests = 0;
+    double bvh_ms = time_passes(repeat, [&]() {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                bvh.intersect(ray, RayCone(), 0.0f, scene.primitives, scene.materials, bvh_tests);
+            }
+        }
+    });
+
+    // 3. Rasterized visibility buffer, single- and multithreaded
+    PrimaryRasterizer::Settings single_settings;
+    single_settings.thread_count = 1;
+    PrimaryRasterizer single(single_settings);
+    double single_ms = time_passes(repeat, [&]() { single.rasterize(scene, camera, width, height); });
+    PrimaryRasterizer::Settings threaded_settings;
+    threaded_settings.thread_count = threads;
+    PrimaryRasterizer threaded(threaded_settings);
+    double threaded_ms = time_passes(repeat, [&]() { threaded.rasterize(scene, camera, width, height); });
+
+    // Visibility buffers must match the linear closest hit exactly
+    int mismatches = 0;
+    for (const PrimaryRasterizer* rasterizer : {&single, &threaded}) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                size_t pixel = static_cast<size_t>(y) * width + x;
+                int index = rasterizer->primitive_at(x, y);
+                const Sphere* sphere = index >= 0 ? &scene.primitives[index] : nullptr;
+                if (sphere != linear_hits[pixel]) {
+                    mismatches++;
+                    continue;
+                }
+                if (sphere) {
+                    Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                    if (rasterizer->intersection(scene, ray, x, y).t != linear_depths[pixel]) mismatches++;
+                }
+            }
+        }
+    }
+
+    // Shaded frames must be identical too
+    std::vector<Vector3> exact_frame, raster_frame;
+    Renderer::render_frame(scene, camera, width, height, exact_frame);
+    Renderer::render_frame(scene, camera, width, height, raster_frame, threaded);
+    int pixel_mismatches = 0;
+    for (size_t i = 0; i < pixel_count; i++) {
+        const Vector3& a = exact_frame[i];
+        const Vector3& b = raster_frame[i];
+        if (a.x != b.x || a.y != b.y || a.z != b.z) pixel_mismatches++;
+    }
+
+    auto rate = [&](double ms) { return pixel_count * static_cast<double>(repeat) / (ms / 1000.0); };
+    const PrimaryRasterizer::Statistics& stats = threaded.statistics();
+    std::cout << "\n=== Primary Visibility Results ===" << std::endl;
+    std::cout << "  linear Scene::intersect: " << static_cast<double>(linear_tests) / pixel_count << " tests/pixel, "
+              << linear_ms << " ms (" << rate(linear_ms) << " pixels/sec)" << std::endl;
+    std::cout << "  BVH traversal:           " << static_cast<double>(bvh_tests) / repeat / pixel_count << " tests/pixel, "
+              << bvh_ms << " ms (" << rate(bvh_ms) << " pixels/sec)" << std::endl;
+    std::cout << "  rasterized, 1 thread:    " << static_cast<double>(single.statistics().ray_sphere_tests) / pixel_count
+              << " tests/pixel, " << single_ms << " ms (" << rate(single_ms) << " pixels/sec)" << std::endl;
+    std::cout << "  rasterized, " << stats.threads << " thread(s): " << static_cast<double>(stats.ray_sphere_tests) / pixel_count
+              << " tests/pixel, " << threaded_ms << " ms (" << rate(threaded_ms) << " pixels/sec)" << std::endl;
+    stats.print();
+    std::cout << "Rasterized (1 thread) vs BVH: " << bvh_ms / std::max(single_ms, 1e-6) << "x" << std::endl;
+    std::cout << "Visibility mismatches: " << mismatches << ", shaded pixel mismatches: " << pixel_mismatches << std::endl;
+
+    if (mismatches > 0 || pixel_mismatches > 0) {
+        std::cout << "FAIL: rasterized primary visibility disagrees with ray traversal" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: rasterized and traced primary visibility agree" << std::endl;
+    return 0;
+}
@@ -0,0 +1,350 @@
+// Scene-to-code compiler for fixed production scenes
+//
+// Reads a .scene file through SceneLoader and emits a C++ translation unit implementing
+// the CompiledScene interface (src/core/compiled_scene.hpp). The emitted code bakes the
+// scene into the binary:
+//   - sphere data as constexpr arrays
+//   - unrolled closest-hit and any-hit intersection (one block per sphere)
+//   - material constants inlined (Lambert albedo/π, Cook-Torrance α and F0)
+//   - fixed light loop (one block per light, constants folded)
+//
+// Educational focus: shows what a generic renderer pays for flexibility (virtual calls,
+// loops over containers, per-call statistics) by generating the specialized equivalent.
+//
+// Usage: scene_compiler <input.scene> <output.cpp>
+// Supported: Lambert and Cook-Torrance materials, point and directional lights.
+// Area lights use Monte Carlo sampling and are rejected (render those scenes generically).
+
+#include "src/core/scene.hpp"
+#include "src/core/scene_loader.hpp"
+#include "src/core/renderer.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+class SceneCompiler {
+public:
+    SceneCompiler(const Scene& scene, const std::string& source_file)
+        : scene(scene), source_file(source_file) {}
+
+    // Check every scene element has a compiled equivalent
+    // Returns false (with explanation) for unsupported materials or lights
+    bool validate_supported() const {
+        bool supported = true;
+        for (size_t i = 0; i < scene.materials.size(); ++i) {
+            MaterialType type = scene.materials[i]->type;
+            if (type != MaterialType::Lambert && type != MaterialType::CookTorrance) {
+                std::cout << "ERROR: Material " << i << " (" << scene.materials[i]->material_type_name()
+                          << ") is not supported by the scene compiler" << std::endl;
+                supported = false;
+            }
+        }
+        for (size_t i = 0; i < scene.lights.size(); ++i) {
+            if (scene.lights[i]->type == LightType::Area || scene.lights[i]->type == LightType::Sphere) {
+                std::cout << "ERROR: Light " << i << " is an area or sphere light; stochastic light sampling "
+                          << "cannot be baked into a deterministic compiled scene" << std::endl;
+                supported = false;
+            }
+        }
+        if (scene.primitives.empty()) {
+            std::cout << "ERROR: Scene has no spheres to compile" << std::endl;
+            supported = false;
+        }
+        return supported;
+    }
+
+    // Emit the complete translation unit
+    std::string emit() const {
+        std::ostringstream out;
+        emit_preamble(out);
+        emit_sphere_data(out);
+        emit_intersection(out);
+        emit_materials(out);
+        emit_lights(out);
+        emit_interface(out);
+        return out.str();
+    }
+
+private:
+    const Scene& scene;
+    std::string source_file;
+
+    // Float literal that round-trips exactly (9 significant digits) with 'f' suffix
+    static std::string lit(float value) {
+        std::ostringstream s;
+        s << std::setprecision(9) << value;
+        std::string text = s.str();
+        if (text.find_first_of(".en") == std::string::npos) {
+            text += ".0";
+        }
+        return text + "f";
+    }
+
+    static std::string vec_lit(const Vector3& v) {
+        return "Vector3(" + lit(v.x) + ", " + lit(v.y) + ", " + lit(v.z) + ")";
+    }
+
+    // Quoted C string literal: quotes and backslashes escaped (Windows paths), other control and
+    // non-ASCII bytes as three-digit octal escapes so the following character can never extend them
+    static std::string string_lit(const std::string& value) {
+        std::ostringstream s;
+        s << '"';
+        for (unsigned char c : value) {
+            if (c == '"' || c == '\\') {
+                s << '\\' << c;
+            } else if (c < 0x20 || c >= 0x7f) {
+                s << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            } else {
+                s << c;
+            }
+        }
+        s << '"';
+        return s.str();
+    }
+
+    void emit_preamble(std::ostringstream& out) const {
+        out << "// Generated by tools/scene_compiler from: " << string_lit(source_file) << "\n";
+        out << "// DO NOT EDIT - regenerate with: scene_compiler <input.scene> <output.cpp>\n";
+        out << "// Spheres: " << scene.primitives.size() << ", materials: " << scene.materials.size()
+            << ", lights: " << scene.lights.size() << "\n";
+        out << "#include \"src/core/compiled_scene.hpp\"\n";
+        out << "#include \"src/materials/cook_torrance.hpp\"\n";
+        out << "#include <algorithm>\n";
+        out << "#include <cmath>\n";
+        out << "#include <limits>\n\n";
+        out << "namespace CompiledScene {\n";
+        out << "namespace {\n\n";
+    }
+
+    void emit_sphere_data(std::ostringstream& out) const {
+        size_t count = scene.primitives.size();
+        out << "// Sphere data baked as constexpr arrays; every access below uses a literal index\n";
+        out << "constexpr int SPHERE_COUNT = " << count << ";\n";
+
+        auto emit_array = [&](const char* name, auto field) {
+            out << "constexpr float " << name << "[SPHERE_COUNT] = {";
+            for (size_t i = 0; i < count; ++i) {
+                out << (i == 0 ? " " : ", ") << lit(field(scene.primitives[i]));
+            }
+            out << " };\n";
+        };
+        emit_array("SPHERE_CENTER_X", [](const Sphere& s) { return s.center.x; });
+        emit_array("SPHERE_CENTER_Y", [](const Sphere& s) { return s.center.y; });
+        emit_array("SPHERE_CENTER_Z", [](const Sphere& s) { return s.center.z; });
+        emit_array("SPHERE_RADIUS_SQUARED", [](const Sphere& s) { return s.radius * s.radius; });
+
+        out << "constexpr int SPHERE_MATERIAL[SPHERE_COUNT] = {";
+        for (size_t i = 0; i < count; ++i) {
+            out << (i == 0 ? " " : ", ") << scene.primitives[i].material_index;
+        }
+        out << " };\n\n";
+    }
+
+    void emit_intersection(std::ostringstream& out) const {
+        out << "// Ray-sphere test for compile-time sphere index I\n";
+        out << "// Same root selection as Sphere::intersect plus Scene's t > 0.001 self-intersection threshold\n";
+        out << "template <int I>\n";
+        out << "inline bool hit_sphere(const Ray& ray, float a, float& t) {\n";
+        out << "    Vector3 oc(ray.origin.x - SPHERE_CENTER_X[I], ray.origin.y - SPHERE_CENTER_Y[I], ray.origin.z - SPHERE_CENTER_Z[I]);\n";
+        out << "    float b = 2.0f * oc.dot(ray.direction);\n";
+        out << "    float c = oc.dot(oc) - SPHERE_RADIUS_SQUARED[I];\n";
+        out << "    float discriminant = b * b - 4 * a * c;\n";
+        out << "    if (discriminant < 0) return false;\n";
+        out << "    float sqrt_discriminant = std::sqrt(discriminant);\n";
+        out << "    float t1 = (-b - sqrt_discriminant) / (2 * a);\n";
+        out << "    float t2 = (-b + sqrt_discriminant) / (2 * a);\n";
+        out << "    if (t1 > 1e-6f) t = t1;\n";
+        out << "    else if (t2 > 1e-6f) t = t2;\n";
+        out << "    else return false;\n";
+        out << "    return t > 0.001f;\n";
+        out << "}\n\n";
+
+        out << "// Unrolled closest-hit over all spheres; returns sphere index or -1\n";
+        out << "inline int closest_hit(const Ray& ray, float& t_closest) {\n";
+        out << "    const float a = ray.direction.dot(ray.direction);\n";
+        out << "    int hit = -1;\n";
+        out << "    float t;\n";
+        out << "    t_closest = std::numeric_limits<float>::max();\n";
+        for (size_t i = 0; i < scene.primitives.size(); ++i) {
+            out << "    if (hit_sphere<" << i << ">(ray, a, t) && t < t_closest) { t_closest = t; hit = " << i << "; }\n";
+        }
+        out << "    return hit;\n";
+        out << "}\n\n";
+
+        out << "// Unrolled any-hit for shadow rays: exits on the first blocker before t_max\n";
+        out << "inline bool any_hit(const Ray& ray, float t_max) {\n";
+        out << "    const float a = ray.direction.dot(ray.direction);\n";
+        out << "    float t;\n";
+        for (size_t i = 0; i < scene.primitives.size(); ++i) {
+            out << "    if (hit_sphere<" << i << ">(ray, a, t) && t < t_max) return true;\n";
+        }
+        out << "    return false;\n";
+        out << "}\n\n";
+    }
+
+    void emit_materials(std::ostringstream& out) const {
+        out << "// Cook-Torrance lobe with baked α and F0 (matches CookTorranceMaterial::evaluate_brdf)\n";
+        out << "inline Vector3 cook_torrance(const Vector3& wi, const Vector3& wo, const Vector3& n,\n";
+        out << "                             const Vector3& radiance, float cos_theta, float alpha, const Vector3& f0) {\n";
+        out << "    Vector3 halfway = (wi + wo).normalize();\n";
+        out << "    float ndotl = std::max(0.0f, n.dot(wi));\n";
+        out << "    float ndotv = std::max(0.0f, n.dot(wo));\n";
+        out << "    float ndoth = std::max(0.0f, n.dot(halfway));\n";
+        out << "    float vdoth = std::max(0.0f, wo.dot(halfway));\n";
+        out << "    if (ndotl <= 0.0f || ndotv <= 0.0f) return Vector3(0.0f, 0.0f, 0.0f);\n";
+        out << "    float D = CookTorrance::NormalDistribution::ggx_distribution(ndoth, alpha);\n";
+        out << "    float G = CookTorrance::GeometryFunction::smith_g(ndotl, ndotv, alpha);\n";
+        out << "    Vector3 F = CookTorrance::FresnelFunction::schlick_fresnel(vdoth, f0);\n";
+        out << "    float denominator = 4.0f * ndotl * ndotv;\n";
+        out << "    if (denominator <= 0.0f) return Vector3(0.0f, 0.0f, 0.0f);\n";
+        out << "    return Vector3((D * G * F.x) / denominator * radiance.x * cos_theta,\n";
+        out << "                   (D * G * F.y) / denominator * radiance.y * cos_theta,\n";
+        out << "                   (D * G * F.z) / denominator * radiance.z * cos_theta);\n";
+        out << "}\n\n";
+
+        // Lambert cases ignore the view direction: leave wo unnamed when no material reads it
+        bool reads_wo = std::any_of(scene.materials.begin(), scene.materials.end(),
+                                    [](const auto& material) { return material->type != MaterialType::Lambert; });
+        out << "// Material dispatch with inlined constants: L_o = f_r * L_i * max(0, n·wi)\n";
+        out << "inline Vector3 scatter(int material, const Vector3& wi, const Vector3& " << (reads_wo ? "wo" : "/*wo*/")
+            << ",\n";
+        out << "                       const Vector3& n, const Vector3& radiance) {\n";
+        out << "    float cos_theta = std::max(0.0f, n.dot(wi));\n";
+        out << "    switch (material) {\n";
+        for (size_t i = 0; i < scene.materials.size(); ++i) {
+            const Material* material = scene.materials[i].get();
+            if (material->type == MaterialType::Lambert) {
+                // Lambert BRDF is constant: evaluate once at compile time
+                Vector3 brdf = material->evaluate_brdf(Vector3(0, 0, 1), Vector3(0, 0, 1), Vector3(0, 0, 1), false);
+                out << "        case " << i << ":  // Lambert, f_r = albedo/π\n";
+                out << "            return Vector3(" << lit(brdf.x) << " * radiance.x * cos_theta, "
+                    << lit(brdf.y) << " * radiance.y * cos_theta, " << lit(brdf.z) << " * radiance.z * cos_theta);\n";
+            } else {
+                const auto* ct = static_cast<const CookTorranceMaterial*>(material);
+                float alpha = ct->roughness * ct->roughness;
+                Vector3 f0 = Vector3(ct->specular, ct->specular, ct->specular) * (1.0f - ct->metallic) +
+                             ct->base_color * ct->metallic;
+                out << "        case " << i << ":  // Cook-Torrance, roughness " << ct->roughness
+                    << ", metallic " << ct->metallic << ", specular " << ct->specular << "\n";
+                out << "            return cook_torrance(wi, wo, n, radiance, cos_theta, " << lit(alpha)
+                    << ", " << vec_lit(f0) << ");\n";
+            }
+        }
+        out << "        default:\n";
+        out << "            return Vector3(0.0f, 0.0f, 0.0f);\n";
+        out << "    }\n";
+        out << "}\n\n";
+    }
+
+    void emit_lights(std::ostringstream& out) const {
+        out << "// Fixed light loop: one block per scene light with shadow ray any-hit testing\n";
+        out << "inline Vector3 direct_lighting(const Vector3& p, const Vector3& n, const Vector3& wo, int material) {\n";
+        out << "    Vector3 color(0.0f, 0.0f, 0.0f);\n";
+        out << "    const float epsilon = 0.001f;\n";
+        for (size_t i = 0; i < scene.lights.size(); ++i) {
+            const Light* light = scene.lights[i].get();
+            Vector3 radiance = light->color * light->intensity;
+            if (light->type == LightType::Point) {
+                const auto* point = static_cast<const PointLight*>(light);
+                out << "    {  // Light " << i << ": point light\n";
+                out << "        Vector3 light_vector = " << vec_lit(point->position) << " - p;\n";
+                out << "        float distance = light_vector.length();\n";
+                out << "        if (distance >= 1e-6f) {\n";
+                out << "            Vector3 wi = light_vector * (1.0f / distance);\n";
+                out << "            Vector3 radiance = " << vec_lit(radiance) << " * (1.0f / (distance * distance));\n";
+                out << "            Vector3 origin = p + wi * epsilon;\n";
+                out << "            if (!any_hit(Ray(Point3(origin.x, origin.y, origin.z), wi), distance - epsilon)) {\n";
+                out << "                color += scatter(material, wi, wo, n, radiance);\n";
+                out << "            }\n";
+                out << "        }\n";
+                out << "    }\n";
+            } else {
+                const auto* directional = static_cast<const DirectionalLight*>(light);
+                Vector3 wi = directional->direction * -1.0f;
+                out << "    {  // Light " << i << ": directional light\n";
+                out << "        const Vector3 wi = " << vec_lit(wi) << ";\n";
+                out << "        Vector3 origin = p + wi * epsilon;\n";
+                out << "        if (!any_hit(Ray(Point3(origin.x, origin.y, origin.z), wi), std::numeric_limits<float>::max())) {\n";
+                out << "            color += scatter(material, wi, wo, n, " << vec_lit(radiance) << ");\n";
+                out << "        }\n";
+                out << "    }\n";
+            }
+        }
+        out << "    return color;\n";
+        out << "}\n\n";
+        out << "}  // namespace\n\n";
+    }
+
+    void emit_interface(std::ostringstream& out) const {
+        Vector3 background = Renderer::background_color();
+        out << "Info info() {\n";
+        out << "    return Info{" << string_lit(source_file) << ", " << scene.primitives.size() << ", "
+            << scene.materials.size() << ", " << scene.lights.size() << "};\n";
+        out << "}\n\n";
+
+        out << "Vector3 trace_primary(const Ray& ray, const Point3& eye) {\n";
+        out << "    float t;\n";
+        out << "    int sphere = closest_hit(ray, t);\n";
+        out << "    if (sphere < 0) return " << vec_lit(background) << ";\n";
+        out << "    Point3 hit_point = ray.at(t);\n";
+        out << "    Point3 center(SPHERE_CENTER_X[sphere], SPHERE_CENTER_Y[sphere], SPHERE_CENTER_Z[sphere]);\n";
+        out << "    Vector3 normal = (hit_point - center).normalize();\n";
+        out << "    Vector3 view_direction = (eye - hit_point).normalize();\n";
+        out << "    return direct_lighting(Vector3(hit_point.x, hit_point.y, hit_point.z), normal, view_direction,\n";
+        out << "                           SPHERE_MATERIAL[sphere]);\n";
+        out << "}\n\n";
+
+        out << "void render_frame(const Camera& camera, int width, int height, std::vector<Vector3>& pixels) {\n";
+        out << "    pixels.assign(static_cast<size_t>(width) * height, Vector3(0, 0, 0));\n";
+        out << "    for (int y = 0; y < height; y++) {\n";
+        out << "        for (int x = 0; x < width; x++) {\n";
+        out << "            Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);\n";
+        out << "            Vector3 c = trace_primary(ray, camera.position);\n";
+        out << "            pixels[static_cast<size_t>(y) * width + x] = Vector3(std::max(0.0f, std::min(c.x, 1.0f)),\n";
+        out << "                                                                 std::max(0.0f, std::min(c.y, 1.0f)),\n";
+        out << "                                                                 std::max(0.0f, std::min(c.z, 1.0f)));\n";
+        out << "        }\n";
+        out << "    }\n";
+        out << "}\n\n";
+        out << "}  // namespace CompiledScene\n";
+    }
+};
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: scene_compiler <input.scene> <output.cpp>" << std::endl;
+        std::cout << "Emits a C++ translation unit implementing src/core/compiled_scene.hpp" << std::endl;
+        return 1;
+    }
+
+    std::string input_file = argv[1];
+    std::string output_file = argv[2];
+
+    std::cout << "=== Scene-to-Code Compiler ===" << std::endl;
+    Scene scene = SceneLoader::load_from_file(input_file);
+
+    SceneCompiler compiler(scene, input_file);
+    if (!compiler.validate_supported()) {
+        std::cout << "Scene compilation failed: unsupported scene contents" << std::endl;
+        return 1;
+    }
+
+    std::string code = compiler.emit();
+    std::ofstream output(output_file);
+    if (!output.is_open()) {
+        std::cout << "ERROR: Cannot write output file: " << output_file << std::endl;
+        return 1;
+    }
+    output << code;
+    output.close();
+
+    std::cout << "\n=== Scene Compilation Summary ===" << std::endl;
+    std::cout << "Spheres baked: " << scene.primitives.size() << " (unrolled intersection)" << std::endl;
+    std::cout << "Materials inlined: " << scene.materials.size() << std::endl;
+    std::cout << "Lights in fixed loop: " << scene.lights.size() << std::endl;
+    std::cout << "Generated: " << output_file << " (" << code.size() << " bytes)" << std::endl;
+    return 0;
+}
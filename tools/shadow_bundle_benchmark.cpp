@@ -0,0 +1,190 @@
+// Shadow bundle benchmark: per-ray shadow rays vs shared-origin bundles toward point lights
+//
+// Renders the scene's direct lighting twice over the same BVH:
+//   1. Renderer::render_frame: one BVH traversal per shadow ray (PointLight::is_occluded)
+//   2. ShadowBundleTracer: one traversal per tile and point light, culling nodes for the whole
+//      bundle, individual ray tests only at leaves (for each --tile size)
+// and reports BVH node visits and ray-sphere tests per point-light shadow ray and render time.
+// Exits non-zero if any bundled occlusion result differs from is_occluded or the images differ in
+// any pixel, so the build's test suite catches a culling test that is not conservative.
+//
+// Usage: shadow_bundle_benchmark --scene <file> [--resolution WxH] [--tile N]... [--repeat N]
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/camera.hpp"
+#include "src/core/image.hpp"
+#include "src/core/renderer.hpp"
+#include "src/core/shadow_bundle.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Time `repeat` passes, returning total milliseconds
+template <typename PassFunction>
+static double time_passes(int repeat, PassFunction pass) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        pass();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const char* usage = "Usage: shadow_bundle_benchmark --scene <file> [--resolution WxH] [--tile N]... [--repeat N]";
+    std::string scene_filename;
+    Resolution resolution = Resolution::parse_from_string("256x192");
+    std::vector<int> tile_sizes;
+    int repeat = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scene_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            tile_sizes.push_back(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cout << usage << std::endl;
+            return 1;
+        }
+    }
+    if (scene_filename.empty()) {
+        std::cout << usage << std::endl;
+        return 1;
+    }
+    if (tile_sizes.empty()) {
+        tile_sizes = {4, 8, 16};
+    }
+
+    Scene scene = SceneLoader::load_from_file(scene_filename);
+    if (scene.primitives.empty()) {
+        std::cout << "ERROR: Scene has no spheres" << std::endl;
+        return 1;
+    }
+    scene.build_bvh();
+    int point_lights = 0;
+    for (const auto& light : scene.lights) {
+        if (light->type == LightType::Point) point_lights++;
+    }
+
+    // Same default camera as the main renderer
+    int width = resolution.width;
+    int height = resolution.height;
+    Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                  static_cast<float>(width) / height);
+    camera.set_aspect_ratio_from_resolution(width, height);
+    size_t pixel_count = static_cast<size_t>(width) * height;
+
+    std::cout << "=== Shadow Bundle Benchmark ===" << std::endl;
+    std::cout << "Scene: " << scene_filename << " (" << scene.primitives.size() << " spheres, " << point_lights
+              << " of " << scene.lights.size() << " lights are point lights), " << width << "x" << height
+              << ", passes: " << repeat << std::endl;
+
+    // Primary hits, grouped by tile like ShadowBundleTracer::render_frame
+    auto tile_hits = [&](int tile) {
+        std::vector<std::vector<Vector3>> tiles;
+        for (int tile_y = 0; tile_y < height; tile_y += tile) {
+            for (int tile_x = 0; tile_x < width; tile_x += tile) {
+                std::vector<Vector3> points;
+                for (int y = tile_y; y < std::min(tile_y + tile, height); y++) {
+                    for (int x = tile_x; x < std::min(tile_x + tile, width); x++) {
+                        Ray ray = camera.generate_ray(static_cast<float>(x), static_cast<float>(y), width, height);
+                        Scene::Intersection hit = scene.intersect(ray, false);
+                        if (hit.hit) points.push_back(Vector3(hit.point.x, hit.point.y, hit.point.z));
+                    }
+                }
+                tiles.push_back(points);
+            }
+        }
+        return tiles;
+    };
+
+    // 1. Per-ray shadow rays: node visits of point-light shadow rays only (primary rays excluded)
+    std::vector<std::vector<Vector3>> reference_tiles = tile_hits(8);
+    long long shadow_rays = 0;
+    long long visits_before = scene.bvh->node_visits.load();
+    for (const auto& light : scene.lights) {
+        if (light->type != LightType::Point) continue;
+        for (const auto& points : reference_tiles) {
+            for (const Vector3& point : points) {
+                Vector3 direction;
+                float distance;
+                light->illuminate(point, direction, distance);
+                light->is_occluded(point, direction, distance, scene);
+                shadow_rays++;
+            }
+        }
+    }
+    long long per_ray_visits = scene.bvh->node_visits.load() - visits_before;
+    std::vector<Vector3> reference_frame;
+    double per_ray_ms = time_passes(repeat, [&]() { Renderer::render_frame(scene, camera, width, height, reference_frame); });
+
+    std::cout << "\n=== Shadow Bundle Results ===" << std::endl;
+    std::cout << "  per-ray:  " << (shadow_rays > 0 ? static_cast<double>(per_ray_visits) / shadow_rays : 0.0)
+              << " node visits per point-light shadow ray, frame " << per_ray_ms / repeat << " ms" << std::endl;
+
+    // 2. Bundles per tile size: occlusion must match is_occluded ray by ray, frames pixel by pixel
+    int occlusion_mismatches = 0;
+    int pixel_mismatches = 0;
+    for (int tile : tile_sizes) {
+        ShadowBundleTracer::Statistics bundle_stats;
+        for (const auto& light : scene.lights) {
+            if (light->type != LightType::Point) continue;
+            const Vector3& light_position = static_cast<const PointLight&>(*light).position;
+            for (const auto& points : tile_hits(tile)) {
+                std::vector<ShadowBundleTracer::ShadowRay> rays;
+                std::vector<unsigned char> expected;
+                for (const Vector3& point : points) {
+                    Vector3 direction;
+                    float distance;
+                    light->illuminate(point, direction, distance);
+                    rays.push_back(ShadowBundleTracer::shadow_ray(point, direction, distance));
+                    expected.push_back(light->is_occluded(point, direction, distance, scene) ? 1 : 0);
+                }
+                std::vector<unsigned char> occluded;
+                ShadowBundleTracer::trace_bundle(scene, light_position, rays, occluded, bundle_stats);
+                for (size_t i = 0; i < rays.size(); i++) {
+                    if (occluded[i] != expected[i]) occlusion_mismatches++;
+                }
+            }
+        }
+
+        ShadowBundleTracer::Settings settings;
+        settings.tile_size = tile;
+        std::vector<Vector3> bundle_frame;
+        double bundle_ms = time_passes(repeat, [&]() {
+            ShadowBundleTracer tracer(settings);
+            tracer.render_frame(scene, camera, width, height, bundle_frame);
+        });
+        for (size_t i = 0; i < pixel_count; i++) {
+            const Vector3& a = reference_frame[i];
+            const Vector3& b = bundle_frame[i];
+            if (a.x != b.x || a.y != b.y || a.z != b.z) pixel_mismatches++;
+        }
+
+        double rays = static_cast<double>(std::max(1LL, bundle_stats.bundle_rays));
+        std::cout << "  tile " << tile << "x" << tile << ": " << bundle_stats.node_visits / rays
+                  << " node visits per shadow ray (" << bundle_stats.nodes_culled << " culled for whole bundles), "
+                  << bundle_stats.leaf_ray_tests / rays << " leaf ray-sphere tests per ray, frame "
+                  << bundle_ms / repeat << " ms (" << per_ray_ms / std::max(bundle_ms, 1e-6) << "x)" << std::endl;
+    }
+
+    std::cout << "Occlusion mismatches: " << occlusion_mismatches << ", pixel mismatches: " << pixel_mismatches << std::endl;
+    if (occlusion_mismatches > 0 || pixel_mismatches > 0) {
+        std::cout << "FAIL: bundled shadow rays disagree with per-ray shadow testing" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: bundled and per-ray shadow rays agree" << std::endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Sort-last benchmark: single-process render vs spatially partitioned worker processes
+//
+// Renders one frame of a scene with the default camera twice:
+//   1. Renderer::render_frame over the whole scene in this process, linear and with a BVH
+//   2. SortLastRenderer with --workers processes, each holding one spatial chunk and its BVH
+// and reports render times, the share of the scene each worker holds, and how many rays were
+// forwarded between chunks. Workers trace with a BVH over their chunk, so the single-process BVH
+// frame is the reference: exits non-zero unless both are identical pixel for pixel, so the build's
+// test suite catches a partition, routing or compositing error.
+//
+// Usage: sort_last_benchmark --scene <file> [--resolution WxH] [--workers N]
+
+#include "src/core/scene_loader.hpp"
+#include "src/core/camera.hpp"
+#include "src/core/image.hpp"
+#include "src/core/renderer.hpp"
+#include "src/core/sort_last_renderer.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    const char* usage = "Usage: sort_last_benchmark --scene <file> [--resolution WxH] [--workers N]";
+    std::string scene_filename;
+    Resolution resolution = Resolution::parse_from_string("256x192");
+    SortLastRenderer::Settings settings;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scene_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            try {
+                resolution = Resolution::parse_from_string(argv[++i]);
+            } catch (const std::invalid_argument& e) {
+                std::cout << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            settings.workers = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cout << usage << std::endl;
+            return 1;
+        }
+    }
+    if (scene_filename.empty()) {
+        std::cout << usage << std::endl;
+        return 1;
+    }
+
+    // Workers are forked before this process loads the full scene, as main.cpp would
+    SortLastRenderer sort_last(scene_filename, "lambert", settings);
+    if (!sort_last.ready()) {
+        return 1;
+    }
+
+    int width = resolution.width;
+    int height = resolution.height;
+    Camera camera(Point3(0.0f, 0.0f, 1.0f), Point3(0.0f, 0.0f, -6.0f), Vector3(0, 1, 0), 60.0f,
+                  static_cast<float>(width) / height);
+    camera.set_aspect_ratio_from_resolution(width, height);
+
+    std::vector<Vector3> distributed;
+    auto distributed_start = std::chrono::high_resolution_clock::now();
+    bool rendered = sort_last.render_frame(camera, width, height, distributed);
+    double distributed_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() -
+                                                                      distributed_start).count();
+    if (!rendered) {
+        std::cout << "FAIL: sort-last render did not complete" << std::endl;
+        return 1;
+    }
+
+    Scene scene = SceneLoader::load_from_file(scene_filename);
+    std::vector<Vector3> reference;
+    auto reference_start = std::chrono::high_resolution_clock::now();
+    Renderer::render_frame(scene, camera, width, height, reference);
+    double reference_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() -
+                                                                    reference_start).count();
+
+    scene.build_bvh();
+    std::vector<Vector3> bvh_frame;
+    auto bvh_start = std::chrono::high_resolution_clock::now();
+    Renderer::render_frame(scene, camera, width, height, bvh_frame);
+    double bvh_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - bvh_start).count();
+
+    // Workers trace their chunks with a BVH, so the BVH frame is the bit-exact reference
+    auto count_differences = [&](const std::vector<Vector3>& frame) {
+        int differences = 0;
+        for (size_t i = 0; i < frame.size(); i++) {
+            const Vector3& a = frame[i];
+            const Vector3& b = distributed[i];
+            if (a.x != b.x || a.y != b.y || a.z != b.z) differences++;
+        }
+        return differences;
+    };
+    int mismatches = count_differences(bvh_frame);
+    int linear_differences = count_differences(reference);
+
+    std::cout << "\n=== Sort-Last Benchmark ===" << std::endl;
+    std::cout << "Scene: " << scene_filename << " (" << scene.primitives.size() << " spheres), " << width << "x" << height
+              << std::endl;
+    sort_last.statistics().print();
+    std::cout << "Single process (linear Scene::intersect): " << reference_ms << " ms" << std::endl;
+    std::cout << "Single process (BVH):                     " << bvh_ms << " ms" << std::endl;
+    std::cout << "Sort-last, " << settings.workers << " workers:             " << distributed_ms << " ms" << std::endl;
+    std::cout << "Pixel mismatches vs single-process BVH: " << mismatches << " (vs linear: " << linear_differences
+              << ", grazing hits the BVH slab test rounds differently)" << std::endl;
+
+    if (mismatches > 0) {
+        std::cout << "FAIL: sort-last image differs from the single-process render" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: sort-last and single-process images are identical" << std::endl;
+    return 0;
+}